@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <pthread.h>
 #include <string.h>
@@ -25,6 +26,9 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif
 
 #include "common.h"
 #include "parser.h"
@@ -185,6 +189,54 @@ strnchr(const char *s, int c, unsigned int len)
     return (char *)s;
 }
 
+size_t
+strncspn(const char *s, const char *reject, int ctrl, size_t len)
+{
+    size_t i = 0;
+    const char *r;
+#ifdef __SSE2__
+    __m128i chars[4], ctrl_max, block, match;
+    int j, count, mask;
+
+    assert(strlen(reject) <= 4);
+
+    /* compare 16 characters at once */
+    for (count = 0; reject[count]; ++count) {
+        chars[count] = _mm_set1_epi8(reject[count]);
+    }
+    ctrl_max = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= len; i += 16) {
+        block = _mm_loadu_si128((const __m128i *)&s[i]);
+        if (ctrl) {
+            /* unsigned block <= 0x1f */
+            match = _mm_cmpeq_epi8(_mm_min_epu8(block, ctrl_max), block);
+        } else {
+            match = _mm_setzero_si128();
+        }
+        for (j = 0; j < count; ++j) {
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(block, chars[j]));
+        }
+        mask = _mm_movemask_epi8(match);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < len; ++i) {
+        if (ctrl && ((unsigned char)s[i] < 0x20)) {
+            return i;
+        }
+        for (r = reject; *r; ++r) {
+            if (s[i] == *r) {
+                return i;
+            }
+        }
+    }
+
+    return i;
+}
+
 const char *
 strnodetype(LYS_NODE type)
 {
@@ -1321,6 +1373,99 @@ ly_realloc(void *ptr, size_t size)
     return new_mem;
 }
 
+struct ly_arena_chunk {
+    uint32_t used;                  /* number of the used bytes including this header */
+    uint32_t refs;                  /* number of the live objects plus one while the arena allocates from the chunk,
+                                       objects can be freed from any thread so it is always modified atomically */
+};
+
+/* objects are aligned for any lyd_node member */
+#define LY_ARENA_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+/* every object is in the chunk starting at its address aligned down to the chunk size */
+#define LY_ARENA_CHUNK(ptr) ((struct ly_arena_chunk *)((uintptr_t)(ptr) & ~(uintptr_t)(LY_ARENA_CHUNK_SIZE - 1)))
+
+static void
+ly_arena_chunk_unref(struct ly_arena_chunk *chunk)
+{
+    if (!__sync_sub_and_fetch(&chunk->refs, 1)) {
+        free(chunk);
+    }
+}
+
+struct ly_arena *
+ly_arena_new(void)
+{
+    struct ly_arena *arena;
+
+    arena = calloc(1, sizeof *arena);
+    LY_CHECK_ERR_RETURN(!arena, LOGMEM(NULL), NULL);
+
+    return arena;
+}
+
+void *
+ly_arena_calloc(struct ly_arena *arena, size_t size)
+{
+    struct ly_arena_chunk *chunk = arena->chunk;
+    void *mem;
+
+    size = LY_ARENA_ALIGN(size);
+    if (size > LY_ARENA_CHUNK_SIZE - LY_ARENA_ALIGN(sizeof *chunk)) {
+        return NULL;
+    }
+
+    if (!chunk || (chunk->used + size > LY_ARENA_CHUNK_SIZE)) {
+        /* the chunk is full, continue with a new one */
+        if (posix_memalign(&mem, LY_ARENA_CHUNK_SIZE, LY_ARENA_CHUNK_SIZE)) {
+            LOGMEM(NULL);
+            return NULL;
+        }
+        if (chunk) {
+            /* no more objects are going to be allocated from it */
+            ly_arena_chunk_unref(chunk);
+        }
+        arena->chunk = chunk = mem;
+        chunk->used = LY_ARENA_ALIGN(sizeof *chunk);
+        chunk->refs = 1;
+    }
+
+    mem = (char *)chunk + chunk->used;
+    chunk->used += size;
+    __sync_add_and_fetch(&chunk->refs, 1);
+    memset(mem, 0, size);
+
+    return mem;
+}
+
+void
+ly_arena_free(void *ptr)
+{
+    struct ly_arena_chunk *chunk;
+
+    if (!ptr) {
+        return;
+    }
+
+    chunk = LY_ARENA_CHUNK(ptr);
+
+    /* nodes of one tree can be moved into another trees */
+    ly_arena_chunk_unref(chunk);
+}
+
+void
+ly_arena_release(struct ly_arena *arena)
+{
+    if (!arena) {
+        return;
+    }
+
+    if (arena->chunk) {
+        ly_arena_chunk_unref(arena->chunk);
+    }
+    free(arena);
+}
+
 int
 ly_strequal_(const char *s1, const char *s2)
 {
@@ -1366,6 +1511,28 @@ dec64cmp(int64_t num1, uint8_t dig1, int64_t num2, uint8_t dig2)
     return (num1 > num2 ? 1 : -1);
 }
 
+void
+dec64_to_str(int64_t num, uint8_t dig, char *str, size_t size)
+{
+    int64_t div, whole, frac;
+
+    div = dec_pow(dig);
+    whole = num / div;
+    frac = num % div;
+
+    /* frac should always be positive, remove trailing zeros */
+    if (frac < 0) {
+        frac *= -1;
+    }
+    while ((dig > 1) && !(frac % 10)) {
+        frac /= 10;
+        --dig;
+    }
+
+    /* handle special case of int64_t not supporting printing -0 */
+    snprintf(str, size, "%s%"PRId64".%.*"PRId64, (whole == 0) && (num < 0) ? "-" : "", whole, dig, frac);
+}
+
 LYB_HASH
 lyb_hash(struct lys_node *sibling, uint8_t collision_id)
 {
@@ -1382,8 +1549,8 @@ lyb_hash(struct lys_node *sibling, uint8_t collision_id)
 
     mod = lys_node_module(sibling);
 
-    full_hash = dict_hash_multi(0, mod->name, strlen(mod->name));
-    full_hash = dict_hash_multi(full_hash, sibling->name, strlen(sibling->name));
+    full_hash = dict_hash_oaat_multi(0, mod->name, strlen(mod->name));
+    full_hash = dict_hash_oaat_multi(full_hash, sibling->name, strlen(sibling->name));
     if (collision_id) {
         if (collision_id > strlen(mod->name)) {
             /* fine, we will not hash more bytes, just use more bits from the hash than previously */
@@ -1392,9 +1559,9 @@ lyb_hash(struct lys_node *sibling, uint8_t collision_id)
             /* use one more byte from the module name than before */
             ext_len = collision_id;
         }
-        full_hash = dict_hash_multi(full_hash, mod->name, ext_len);
+        full_hash = dict_hash_oaat_multi(full_hash, mod->name, ext_len);
     }
-    full_hash = dict_hash_multi(full_hash, NULL, 0);
+    full_hash = dict_hash_oaat_multi(full_hash, NULL, 0);
 
     /* use the shortened hash */
     hash = full_hash & (LYB_HASH_MASK >> collision_id);
@@ -30,6 +30,8 @@
 #include "parser.h"
 #include "tree_internal.h"
 #include "resolve.h"
+#include "validation.h"
+#include "xpath.h"
 
 /*
  * counter for references to the extensions plugins (for the number of contexts)
@@ -98,6 +100,18 @@ ly_ctx_new(const char *search_dir, int options)
     /* dictionary */
     lydict_init(&ctx->dict);
 
+    /* XPath expressions cache */
+    pthread_mutex_init(&ctx->xpath_cache_lock, NULL);
+
+    /* compiled patterns cache */
+    pthread_mutex_init(&ctx->pattern_cache_lock, NULL);
+
+    /* validation dependencies */
+    pthread_mutex_init(&ctx->val_deps_lock, NULL);
+
+    /* data order of schema nodes */
+    pthread_mutex_init(&ctx->data_pos_lock, NULL);
+
     /* plugins */
     ly_load_plugins();
 
@@ -113,6 +127,7 @@ ly_ctx_new(const char *search_dir, int options)
     ctx->models.flags = options;
     ctx->models.used = 0;
     ctx->models.size = 16;
+    ly_ctx_module_index_rebuild(ctx);
     if (search_dir) {
         search_dir_list = strdup(search_dir);
         LY_CHECK_ERR_GOTO(!search_dir_list, LOGMEM(NULL), error);
@@ -419,6 +434,32 @@ ly_ctx_unset_trusted(struct ly_ctx *ctx)
     ly_ctx_unset_option(ctx, LY_CTX_TRUSTED);
 }
 
+API void
+ly_ctx_set_val_threads(struct ly_ctx *ctx, uint16_t count)
+{
+    FUN_IN;
+
+    if (!ctx) {
+        LOGARG;
+        return;
+    }
+
+    ctx->val_threads = count;
+}
+
+API uint16_t
+ly_ctx_get_val_threads(const struct ly_ctx *ctx)
+{
+    FUN_IN;
+
+    if (!ctx) {
+        LOGARG;
+        return 0;
+    }
+
+    return ctx->val_threads;
+}
+
 API int
 ly_ctx_get_options(struct ly_ctx *ctx)
 {
@@ -521,6 +562,20 @@ ly_ctx_unset_searchdirs(struct ly_ctx *ctx, int index)
     }
 }
 
+API void
+ly_ctx_refresh_searchdirs(struct ly_ctx *ctx)
+{
+    FUN_IN;
+
+    if (!ctx) {
+        LOGARG;
+        return;
+    }
+
+    lys_searchdir_index_free(ctx->models.searchdir_index);
+    ctx->models.searchdir_index = NULL;
+}
+
 API void
 ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_node *node, void *priv))
 {
@@ -532,7 +587,8 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
         return;
     }
 
-    /* models list */
+    /* models list, searched for without the indexes while being freed */
+    ly_ctx_module_index_free(ctx);
     for (; ctx->models.used > 0; ctx->models.used--) {
         /* remove the applied deviations and augments */
         lys_sub_module_remove_devs_augs(ctx->models.list[ctx->models.used - 1]);
@@ -545,12 +601,29 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
         }
         free(ctx->models.search_paths);
     }
+    lys_searchdir_index_free(ctx->models.searchdir_index);
     free(ctx->models.list);
 
     /* clean the error list */
     ly_err_clean(ctx, 0);
     pthread_key_delete(ctx->errlist_key);
 
+    /* XPath expressions cache */
+    lyxp_expr_cache_free(ctx);
+    pthread_mutex_destroy(&ctx->xpath_cache_lock);
+
+    /* compiled patterns cache */
+    lyp_pattern_cache_free(ctx);
+    pthread_mutex_destroy(&ctx->pattern_cache_lock);
+
+    /* validation dependencies */
+    lyv_data_deps_free(ctx);
+    pthread_mutex_destroy(&ctx->val_deps_lock);
+
+    /* data order of schema nodes */
+    lys_data_order_free(ctx);
+    pthread_mutex_destroy(&ctx->data_pos_lock);
+
     /* dictionary */
     lydict_clean(&ctx->dict);
 
@@ -643,19 +716,170 @@ ly_ctx_get_submodule(const struct ly_ctx *ctx, const char *module, const char *r
     return ret;
 }
 
+/* key searched for in the module indexes */
+struct ly_ctx_module_key {
+    const char *key;
+    size_t key_len;
+};
+
+static int
+ly_ctx_module_index_val_equal(void *val1_p, void *val2_p, int mod, void *cb_data)
+{
+    struct ly_ctx_module_key *key;
+    const char *val;
+
+    if (mod) {
+        /* the same module */
+        return *(struct lys_module **)val1_p == *(struct lys_module **)val2_p;
+    }
+
+    /* cb_data is the offset of the indexed string in the module */
+    key = (struct ly_ctx_module_key *)val1_p;
+    val = *(const char **)(((char *)*(struct lys_module **)val2_p) + (uintptr_t)cb_data);
+    return !strncmp(key->key, val, key->key_len) && !val[key->key_len];
+}
+
+static uint32_t
+ly_ctx_module_index_hash(const char *key, size_t key_len)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, key, key_len);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+void
+ly_ctx_module_index_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->models.name_ht);
+    ctx->models.name_ht = NULL;
+    lyht_free(ctx->models.ns_ht);
+    ctx->models.ns_ht = NULL;
+}
+
+void
+ly_ctx_module_index_add(struct lys_module *mod)
+{
+    struct ly_modules_list *models = &mod->ctx->models;
+
+    if (!models->name_ht) {
+        /* the modules are not indexed */
+        return;
+    }
+
+    if (!mod->ns || (lyht_insert(models->name_ht, &mod, ly_ctx_module_index_hash(mod->name, strlen(mod->name)), NULL) == -1)
+            || (lyht_insert(models->ns_ht, &mod, ly_ctx_module_index_hash(mod->ns, strlen(mod->ns)), NULL) == -1)) {
+        /* the module would not be found, search the list instead */
+        ly_ctx_module_index_free(mod->ctx);
+    }
+}
+
+void
+ly_ctx_module_index_rebuild(struct ly_ctx *ctx)
+{
+    uint32_t size;
+    int i;
+
+    ly_ctx_module_index_free(ctx);
+
+    for (size = 16; size < (unsigned)ctx->models.used * 2; size <<= 1);
+    ctx->models.name_ht = lyht_new(size, sizeof(struct lys_module *), ly_ctx_module_index_val_equal,
+                                   (void *)(uintptr_t)offsetof(struct lys_module, name), 1);
+    ctx->models.ns_ht = lyht_new(size, sizeof(struct lys_module *), ly_ctx_module_index_val_equal,
+                                 (void *)(uintptr_t)offsetof(struct lys_module, ns), 1);
+    if (!ctx->models.name_ht || !ctx->models.ns_ht) {
+        ly_ctx_module_index_free(ctx);
+        return;
+    }
+
+    for (i = 0; ctx->models.name_ht && (i < ctx->models.used); ++i) {
+        ly_ctx_module_index_add(ctx->models.list[i]);
+    }
+}
+
+/**
+ * @brief Check whether a module with the matching key is the one searched for by ly_ctx_get_module_by().
+ *
+ * @param[in] mod Module with the matching key.
+ * @param[in] revision Searched revision, NULL for the newest one.
+ * @param[in] implemented Whether the implemented module is searched for.
+ * @param[in,out] result The best module found so far.
+ * @return 1 if \p mod is the result and the search can end, 0 otherwise.
+ */
+static int
+ly_ctx_get_module_match(struct lys_module *mod, const char *revision, int implemented, struct lys_module **result)
+{
+    if (!revision) {
+        /* compare revisons and remember the newest one */
+        if (*result) {
+            if (!mod->rev_size) {
+                /* the current have no revision, keep the previous with some revision */
+                return 0;
+            }
+            if ((*result)->rev_size && strcmp(mod->rev[0].date, (*result)->rev[0].date) < 0) {
+                /* the previous found matching module has a newer revision */
+                return 0;
+            }
+        }
+        if (implemented) {
+            if (mod->implemented) {
+                /* we have the implemented revision */
+                *result = mod;
+                return 1;
+            }
+
+            /* do not remember the result, we are supposed to return the implemented revision
+             * not the newest one */
+            return 0;
+        }
+
+        /* remember the current match and search for newer version */
+        *result = mod;
+    } else if (mod->rev_size && !strcmp(revision, mod->rev[0].date)) {
+        /* matching revision */
+        *result = mod;
+        return 1;
+    }
+
+    return 0;
+}
+
 static const struct lys_module *
 ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, size_t key_len, int offset, const char *revision,
                      int with_disabled, int implemented)
 {
     int i;
     char *val;
-    struct lys_module *result = NULL;
+    uint32_t hash;
+    struct hash_table *ht;
+    struct ly_ctx_module_key mod_key;
+    struct lys_module *result = NULL, **match;
 
     if (!ctx || !key) {
         LOGARG;
         return NULL;
     }
 
+    ht = (offset == offsetof(struct lys_module, name)) ? ctx->models.name_ht : ctx->models.ns_ht;
+    if (ht) {
+        mod_key.key = key;
+        mod_key.key_len = key_len ? key_len : strlen(key);
+        hash = ly_ctx_module_index_hash(key, mod_key.key_len);
+
+        if (lyht_find(ht, &mod_key, hash, (void **)&match)) {
+            return NULL;
+        }
+        do {
+            /* the following modules only have the same hash */
+            if ((with_disabled || !(*match)->disabled) && ly_ctx_module_index_val_equal(&mod_key, match, 0, ht->cb_data)
+                    && ly_ctx_get_module_match(*match, revision, implemented, &result)) {
+                break;
+            }
+        } while (!lyht_find_next(ht, match, hash, (void **)&match));
+
+        return result;
+    }
+
     for (i = 0; i < ctx->models.used; i++) {
         if (!with_disabled && ctx->models.list[i]->disabled) {
             /* skip the disabled modules */
@@ -670,38 +894,8 @@ ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, size_t key_len,
             continue;
         }
 
-        if (!revision) {
-            /* compare revisons and remember the newest one */
-            if (result) {
-                if (!ctx->models.list[i]->rev_size) {
-                    /* the current have no revision, keep the previous with some revision */
-                    continue;
-                }
-                if (result->rev_size && strcmp(ctx->models.list[i]->rev[0].date, result->rev[0].date) < 0) {
-                    /* the previous found matching module has a newer revision */
-                    continue;
-                }
-            }
-            if (implemented) {
-                if (ctx->models.list[i]->implemented) {
-                    /* we have the implemented revision */
-                    result = ctx->models.list[i];
-                    break;
-                } else {
-                    /* do not remember the result, we are supposed to return the implemented revision
-                     * not the newest one */
-                    continue;
-                }
-            }
-
-            /* remember the current match and search for newer version */
-            result = ctx->models.list[i];
-        } else {
-            if (ctx->models.list[i]->rev_size && !strcmp(revision, ctx->models.list[i]->rev[0].date)) {
-                /* matching revision */
-                result = ctx->models.list[i];
-                break;
-            }
+        if (ly_ctx_get_module_match(ctx->models.list[i], revision, implemented, &result)) {
+            break;
         }
     }
 
@@ -847,6 +1041,31 @@ ly_ctx_set_priv_dup_clb(struct ly_ctx *ctx, void *(*priv_dup_clb)(const void *pr
 
 #endif
 
+/**
+ * @brief Search for a (sub)module file in the context search paths, see lys_search_localfile().
+ *
+ * The search paths are read only when there is no index of their files yet or it is out-of-date.
+ */
+static int
+ly_ctx_search_localfile(struct ly_ctx *ctx, const char *name, const char *revision, char **localfile, LYS_INFORMAT *format)
+{
+    int cwd = !(ctx->models.flags & LY_CTX_DISABLE_SEARCHDIR_CWD);
+
+    if (ctx->models.searchdir_index
+            && !lys_searchdir_index_valid(ctx->models.searchdir_index, ly_ctx_get_searchdirs(ctx), cwd)) {
+        /* the search paths changed or some files were added or removed */
+        ly_ctx_refresh_searchdirs(ctx);
+    }
+    if (!ctx->models.searchdir_index) {
+        ctx->models.searchdir_index = lys_searchdir_index_new(ly_ctx_get_searchdirs(ctx), cwd);
+        if (!ctx->models.searchdir_index) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return lys_searchdir_index_find(ctx->models.searchdir_index, name, revision, localfile, format);
+}
+
 /* if module is !NULL, then the function searches for submodule */
 static struct lys_module *
 ly_ctx_load_localfile(struct ly_ctx *ctx, struct lys_module *module, const char *name, const char *revision,
@@ -858,8 +1077,7 @@ ly_ctx_load_localfile(struct ly_ctx *ctx, struct lys_module *module, const char
     LYS_INFORMAT format;
     struct lys_module *result = NULL;
 
-    if (lys_search_localfile(ly_ctx_get_searchdirs(ctx), !(ctx->models.flags & LY_CTX_DISABLE_SEARCHDIR_CWD), name, revision,
-                             &filepath, &format)) {
+    if (ly_ctx_search_localfile(ctx, name, revision, &filepath, &format)) {
         goto cleanup;
     } else if (!filepath) {
         if (!module && !revision) {
@@ -1476,6 +1694,7 @@ ly_ctx_remove_module(const struct lys_module *module,
         }
     }
     /* ... and hide the module from the further processing of the context modules list */
+    ly_ctx_module_index_free(ctx);
     for (i = ctx->internal_module_count; i < ctx->models.used; i++) {
         if (mod == ctx->models.list[i]) {
             ctx->models.list[i] = NULL;
@@ -1572,6 +1791,7 @@ imported:
         lys_free((struct lys_module *)mods->set.g[u], private_destructor, 1, 0);
     }
     ly_set_free(mods);
+    ly_ctx_module_index_rebuild(ctx);
 
     return EXIT_SUCCESS;
 }
@@ -1585,7 +1805,8 @@ ly_ctx_clean(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_nod
         return;
     }
 
-    /* models list */
+    /* models list, searched for without the indexes while being freed */
+    ly_ctx_module_index_free(ctx);
     for (; ctx->models.used > ctx->internal_module_count; ctx->models.used--) {
         /* remove the applied deviations and augments */
         lys_sub_module_remove_devs_augs(ctx->models.list[ctx->models.used - 1]);
@@ -1595,6 +1816,7 @@ ly_ctx_clean(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_nod
         ctx->models.list[ctx->models.used - 1] = NULL;
     }
     ctx->models.module_set_id++;
+    ly_ctx_module_index_rebuild(ctx);
 
     /* maintain backlinks (actually done only with ietf-yang-library since its leafs can be target of leafref) */
     ctx_modules_undo_backlinks(ctx, NULL);
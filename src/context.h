@@ -35,6 +35,11 @@ struct ly_modules_list {
     uint8_t parsed_submodules_count;
     uint16_t module_set_id;
     int flags; /* see @ref contextoptions. */
+    /* modules of the list indexed by their name and namespace, see ly_ctx_get_module_by() */
+    struct hash_table *name_ht;
+    struct hash_table *ns_ht;
+    /* (sub)module files in the search paths, see ly_ctx_search_localfile() */
+    struct lys_searchdir_index *searchdir_index;
 };
 
 struct ly_ctx {
@@ -49,6 +54,52 @@ struct ly_ctx {
 #endif
     pthread_key_t errlist_key;
     uint8_t internal_module_count;
+    /* parsed XPath expressions of must and when conditions, see lyxp_expr_cached() */
+    struct hash_table *xpath_cache;
+    pthread_mutex_t xpath_cache_lock;
+    uint16_t xpath_cache_set_id;
+    /* compiled patterns of re-match() and of types without their own, see lyp_pattern_cached() */
+    struct hash_table *pattern_cache;
+    pthread_mutex_t pattern_cache_lock;
+    /* schema nodes with when/must/leafref and the nodes they depend on, see lyv_data_deps_affected() */
+    struct lyv_data_dep *val_deps;
+    pthread_mutex_t val_deps_lock;
+    uint16_t val_deps_set_id;
+    /* positions of schema nodes among their data siblings and of modules, see lys_data_order() */
+    struct hash_table *data_pos;
+    pthread_mutex_t data_pos_lock;
+    uint16_t data_pos_set_id;
+    /* number of threads validating with LYD_OPT_VAL_PARALLEL, 0 for the number of processors */
+    uint16_t val_threads;
+    /* number of data nodes with not yet parsed children (#LYD_OPT_LYB_LAZY), see lyb_lazy_load_tree() */
+    uint32_t lyb_lazy_count;
 };
 
+/**
+ * @brief Create the name and namespace indexes of the context modules list again.
+ *
+ * The indexes are never removed from, the modules are only searched for in the list after a module
+ * is removed from it until the indexes are rebuilt. That way searching the indexes never modifies
+ * them (there are no deleted records to skip) and it can be done from several threads at once.
+ *
+ * @param[in] ctx Context with the modules list.
+ */
+void ly_ctx_module_index_rebuild(struct ly_ctx *ctx);
+
+/**
+ * @brief Free the name and namespace indexes of the context modules list.
+ *
+ * The modules are searched for in the list until ly_ctx_module_index_rebuild() is called.
+ *
+ * @param[in] ctx Context with the modules list.
+ */
+void ly_ctx_module_index_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Add a module into the name and namespace indexes of its context, if there are any.
+ *
+ * @param[in] mod Module just added into the context modules list.
+ */
+void ly_ctx_module_index_add(struct lys_module *mod);
+
 #endif /* LY_CONTEXT_H_ */
@@ -48,81 +48,81 @@ lydict_val_eq(void *val1_p, void *val2_p, int UNUSED(mod), void *cb_data)
 void
 lydict_init(struct dict_table *dict)
 {
+    unsigned int i;
+
     if (!dict) {
         LOGARG;
         return;
     }
 
-    dict->hash_tab = lyht_new(1024, sizeof(struct dict_rec), lydict_val_eq, NULL, 1);
-    LY_CHECK_ERR_RETURN(!dict->hash_tab, LOGINT(NULL), );
-    pthread_mutex_init(&dict->lock, NULL);
+    for (i = 0; i < LYDICT_SHARDS; ++i) {
+        dict->shards[i].hash_tab = lyht_new(64, sizeof(struct dict_rec), lydict_val_eq, NULL, 1);
+        LY_CHECK_ERR_RETURN(!dict->shards[i].hash_tab, LOGINT(NULL), );
+        pthread_mutex_init(&dict->shards[i].lock, NULL);
+    }
 }
 
 void
 lydict_clean(struct dict_table *dict)
 {
-    unsigned int i;
+    unsigned int i, j;
     struct dict_rec *dict_rec  = NULL;
     struct ht_rec *rec = NULL;
+    struct hash_table *ht;
 
     if (!dict) {
         LOGARG;
         return;
     }
 
-    for (i = 0; i < dict->hash_tab->size; i++) {
-        /* get ith record */
-        rec = (struct ht_rec *)&dict->hash_tab->recs[i * dict->hash_tab->rec_size];
-        if (rec->hits == 1) {
-            /*
-             * this should not happen, all records inserted into
-             * dictionary are supposed to be removed using lydict_remove()
-             * before calling lydict_clean()
-             */
-            dict_rec  = (struct dict_rec *)rec->val;
-            LOGWRN(NULL, "String \"%s\" not freed from the dictionary, refcount %d", dict_rec->value, dict_rec->refcount);
-            /* if record wasn't removed before free string allocated for that record */
+    for (j = 0; j < LYDICT_SHARDS; ++j) {
+        ht = dict->shards[j].hash_tab;
+        if (!ht) {
+            continue;
+        }
+
+        for (i = 0; i < ht->size; i++) {
+            /* get ith record */
+            rec = (struct ht_rec *)&ht->recs[i * ht->rec_size];
+            if (rec->hits == 1) {
+                /*
+                 * this should not happen, all records inserted into
+                 * dictionary are supposed to be removed using lydict_remove()
+                 * before calling lydict_clean()
+                 */
+                dict_rec  = (struct dict_rec *)rec->val;
+                LOGWRN(NULL, "String \"%s\" not freed from the dictionary, refcount %d", dict_rec->value, dict_rec->refcount);
+                /* if record wasn't removed before free string allocated for that record */
 #ifdef NDEBUG
-            free(dict_rec->value);
+                free(dict_rec->value);
 #endif
+            }
         }
+
+        /* free table and destroy mutex */
+        lyht_free(ht);
+        pthread_mutex_destroy(&dict->shards[j].lock);
     }
+}
 
-    /* free table and destroy mutex */
-    lyht_free(dict->hash_tab);
-    pthread_mutex_destroy(&dict->lock);
+/* get the dictionary shard storing strings with the hash */
+static struct dict_shard *
+dict_shard(struct ly_ctx *ctx, uint32_t hash)
+{
+    return &ctx->dict.shards[hash >> (32 - LYDICT_SHARD_BITS)];
 }
 
 /*
  * Bob Jenkin's one-at-a-time hash
  * http://www.burtleburtle.net/bob/hash/doobs.html
  *
- * Spooky hash is faster, but it works only for little endian architectures.
- */
-static uint32_t
-dict_hash(const char *key, size_t len)
-{
-    uint32_t hash, i;
-
-    for (hash = i = 0; i < len; ++i) {
-        hash += key[i];
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
-    }
-    hash += (hash << 3);
-    hash ^= (hash >> 11);
-    hash += (hash << 15);
-    return hash;
-}
-
-/*
- * Usage:
- * - init hash to 0
- * - repeatedly call dict_hash_multi(), provide hash from the last call
- * - call dict_hash_multi() with key_part = NULL to finish the hash
+ * Hashes the key a byte at a time, so the value does not depend on the byte order. It is used
+ * by dict_hash_multi() (the dictionary and data hash tables) only without ENABLE_WORD_HASH, and
+ * always for the schema node hashes stored in LYB data. Values of dict_hash_multi() must not be
+ * stored with either hash since they change with the build option, LYB uses this function directly.
  */
 uint32_t
-dict_hash_multi(uint32_t hash, const char *key_part, size_t len)
+dict_hash_oaat_multi(uint32_t hash, const char *key_part, size_t len)
 {
     uint32_t i;
 
@@ -141,6 +141,124 @@ dict_hash_multi(uint32_t hash, const char *key_part, size_t len)
     return hash;
 }
 
+#ifdef LY_ENABLED_WORD_HASH
+
+/*
+ * wyhash by Wang Yi (public domain)
+ * https://github.com/wangyi-fudan/wyhash
+ *
+ * Reads the key 8 bytes at a time (or 4 bytes for short keys) and mixes them
+ * using 64x64->128 bit multiplication. It is used by dict_hash_multi() with ENABLE_WORD_HASH
+ * (the default). The value depends on the byte order, so it must never be stored.
+ */
+#define WYH_P0 0xa0761d6478bd642fULL
+#define WYH_P1 0xe7037ed1a0b428dbULL
+#define WYH_P2 0x8ebc6af09c88c6e3ULL
+
+static inline uint64_t
+wyh_mix(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b, hi, lo;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+
+    lo = t + (rm1 << 32);
+    c += lo < t;
+    hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t
+wyh_read8(const unsigned char *p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t
+wyh_read4(const unsigned char *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint32_t
+wyhash(const char *key, size_t len, uint64_t seed)
+{
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t a, b, h;
+    size_t i;
+
+    seed ^= WYH_P0;
+    if (len <= 16) {
+        if (len >= 4) {
+            /* 2 overlapping 4-byte reads from both ends cover the whole key */
+            a = (wyh_read4(p) << 32) | wyh_read4(p + ((len >> 3) << 2));
+            b = (wyh_read4(p + len - 4) << 32) | wyh_read4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        for (i = len; i > 16; i -= 16, p += 16) {
+            seed = wyh_mix(wyh_read8(p) ^ WYH_P1, wyh_read8(p + 8) ^ seed);
+        }
+        /* the last 16 bytes, may overlap the already hashed ones */
+        a = wyh_read8(p + i - 16);
+        b = wyh_read8(p + i - 8);
+    }
+
+    h = wyh_mix(WYH_P1 ^ len, wyh_mix(a ^ WYH_P1, b ^ seed ^ WYH_P2));
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static uint32_t
+dict_hash(const char *key, size_t len)
+{
+    return wyhash(key, len, 0);
+}
+
+/*
+ * Every part is hashed separately with the hash of the previous parts as the seed,
+ * so the hash is already final after the last part.
+ */
+uint32_t
+dict_hash_multi(uint32_t hash, const char *key_part, size_t len)
+{
+    if (key_part) {
+        hash = wyhash(key_part, len, hash);
+    }
+
+    return hash;
+}
+
+#else
+
+static uint32_t
+dict_hash(const char *key, size_t len)
+{
+    return dict_hash_oaat_multi(dict_hash_oaat_multi(0, key, len), NULL, 0);
+}
+
+uint32_t
+dict_hash_multi(uint32_t hash, const char *key_part, size_t len)
+{
+    return dict_hash_oaat_multi(hash, key_part, len);
+}
+
+#endif
+
 static int
 lydict_resize_val_eq(void *val1_p, void *val2_p, int mod, void *cb_data)
 {
@@ -179,6 +297,7 @@ lydict_remove(struct ly_ctx *ctx, const char *value)
     int ret;
     uint32_t hash;
     struct dict_rec rec, *match = NULL;
+    struct dict_shard *shard;
     char *val_p;
 
     if (!value || !ctx) {
@@ -187,16 +306,17 @@ lydict_remove(struct ly_ctx *ctx, const char *value)
 
     len = strlen(value);
     hash = dict_hash(value, len);
+    shard = dict_shard(ctx, hash);
 
     /* create record for lyht_find call */
     rec.value = (char *)value;
     rec.refcount = 0;
 
-    pthread_mutex_lock(&ctx->dict.lock);
+    pthread_mutex_lock(&shard->lock);
     /* set len as data for compare callback */
-    lyht_set_cb_data(ctx->dict.hash_tab, (void *)&len);
+    lyht_set_cb_data(shard->hash_tab, (void *)&len);
     /* check if value is already inserted */
-    ret = lyht_find(ctx->dict.hash_tab, &rec, hash, (void **)&match);
+    ret = lyht_find(shard->hash_tab, &rec, hash, (void **)&match);
 
     if (ret == 0) {
         LY_CHECK_ERR_GOTO(!match, LOGINT(ctx), finish);
@@ -210,32 +330,36 @@ lydict_remove(struct ly_ctx *ctx, const char *value)
              * free it after it is removed from hash table
              */
             val_p = match->value;
-            ret = lyht_remove_with_resize_cb(ctx->dict.hash_tab, &rec, hash, lydict_resize_val_eq);
+            ret = lyht_remove_with_resize_cb(shard->hash_tab, &rec, hash, lydict_resize_val_eq);
             free(val_p);
             LY_CHECK_ERR_GOTO(ret, LOGINT(ctx), finish);
         }
     }
 
 finish:
-    pthread_mutex_unlock(&ctx->dict.lock);
+    pthread_mutex_unlock(&shard->lock);
 }
 
 static char *
 dict_insert(struct ly_ctx *ctx, char *value, size_t len, int zerocopy)
 {
     struct dict_rec *match = NULL, rec;
+    struct dict_shard *shard;
+    char *result = NULL;
     int ret = 0;
     uint32_t hash;
 
     hash = dict_hash(value, len);
-    /* set len as data for compare callback */
-    lyht_set_cb_data(ctx->dict.hash_tab, (void *)&len);
+    shard = dict_shard(ctx, hash);
     /* create record for lyht_insert */
     rec.value = value;
     rec.refcount = 1;
 
     LOGDBG(LY_LDGDICT, "inserting \"%s\"", rec.value);
-    ret = lyht_insert_with_resize_cb(ctx->dict.hash_tab, (void *)&rec, hash, lydict_resize_val_eq, (void **)&match);
+    pthread_mutex_lock(&shard->lock);
+    /* set len as data for compare callback */
+    lyht_set_cb_data(shard->hash_tab, (void *)&len);
+    ret = lyht_insert_with_resize_cb(shard->hash_tab, (void *)&rec, hash, lydict_resize_val_eq, (void **)&match);
     if (ret == 1) {
         match->refcount++;
         if (zerocopy) {
@@ -248,17 +372,20 @@ dict_insert(struct ly_ctx *ctx, char *value, size_t len, int zerocopy)
              * record is already inserted in hash table
              */
             match->value = malloc(sizeof *match->value * (len + 1));
-            LY_CHECK_ERR_RETURN(!match->value, LOGMEM(ctx), NULL);
+            LY_CHECK_ERR_GOTO(!match->value, LOGMEM(ctx), finish);
             memcpy(match->value, value, len);
             match->value[len] = '\0';
         }
     } else {
         /* lyht_insert returned error */
         LOGINT(ctx);
-        return NULL;
+        goto finish;
     }
+    result = match->value;
 
-    return match->value;
+finish:
+    pthread_mutex_unlock(&shard->lock);
+    return result;
 }
 
 API const char *
@@ -276,9 +403,7 @@ lydict_insert(struct ly_ctx *ctx, const char *value, size_t len)
         len = strlen(value);
     }
 
-    pthread_mutex_lock(&ctx->dict.lock);
     result = dict_insert(ctx, (char *)value, len, 0);
-    pthread_mutex_unlock(&ctx->dict.lock);
 
     return result;
 }
@@ -294,9 +419,7 @@ lydict_insert_zc(struct ly_ctx *ctx, char *value)
         return NULL;
     }
 
-    pthread_mutex_lock(&ctx->dict.lock);
     result = dict_insert(ctx, value, strlen(value), 1);
-    pthread_mutex_unlock(&ctx->dict.lock);
 
     return result;
 }
@@ -427,9 +550,11 @@ lyht_resize(struct hash_table *ht, int enlarge)
 }
 
 /* return: 0 - hash found, returned its record,
- *         1 - hash not found, returned the record where it would be inserted */
+ *         1 - hash not found, returned the record where it would be inserted
+ * the found record is moved only if relocate is set, lookups must not modify the table
+ * so that it can be searched from several threads at once */
 static int
-lyht_find_first(struct hash_table *ht, uint32_t hash, struct ht_rec **rec_p)
+lyht_find_first(struct hash_table *ht, uint32_t hash, int relocate, struct ht_rec **rec_p)
 {
     struct ht_rec *rec, *inval_rec = NULL;
     uint32_t i, idx;
@@ -471,7 +596,7 @@ lyht_find_first(struct hash_table *ht, uint32_t hash, struct ht_rec **rec_p)
 
     /* we have found a record with equal (shortened) hash,
      * move it to the first invalid record so that the next search is faster */
-    if (inval_rec) {
+    if (relocate && inval_rec) {
         memcpy(inval_rec, rec, ht->rec_size);
         rec->hits = -1;
         rec = inval_rec;
@@ -488,11 +613,12 @@ lyht_find_first(struct hash_table *ht, uint32_t hash, struct ht_rec **rec_p)
  * @param[in] ht Hash table to search in.
  * @param[in,out] last Last returned collision record.
  * @param[in] first First collision record (hits > 1).
+ * @param[in] relocate Whether the found collision can be moved to an invalid record.
  * @return 0 when hash collision found, \p last points to this next collision,
  *         1 when hash collision not found, \p last points to the record where it would be inserted.
  */
 static int
-lyht_find_collision(struct hash_table *ht, struct ht_rec **last, struct ht_rec *first)
+lyht_find_collision(struct hash_table *ht, struct ht_rec **last, struct ht_rec *first, int relocate)
 {
     struct ht_rec *inval_rec = NULL;
     uint32_t i, idx;
@@ -521,7 +647,7 @@ lyht_find_collision(struct hash_table *ht, struct ht_rec **last, struct ht_rec *
     if ((*last)->hits > 0) {
         /* we found a collision, so move it to the first invalid record so the next search is faster */
         assert((*last)->hits == 1);
-        if (inval_rec) {
+        if (relocate && inval_rec) {
             memcpy(inval_rec, *last, ht->rec_size);
             (*last)->hits = -1;
             *last = inval_rec;
@@ -543,7 +669,7 @@ lyht_find(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p)
     uint32_t i, c;
     int r;
 
-    if (lyht_find_first(ht, hash, &rec)) {
+    if (lyht_find_first(ht, hash, 0, &rec)) {
         /* not found */
         return 1;
     }
@@ -559,7 +685,7 @@ lyht_find(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p)
     crec = rec;
     c = rec->hits;
     for (i = 1; i < c; ++i) {
-        r = lyht_find_collision(ht, &rec, crec);
+        r = lyht_find_collision(ht, &rec, crec, 0);
         assert(!r);
         (void)r;
 
@@ -583,7 +709,7 @@ lyht_find_next(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p
     uint32_t i, c;
     int r, found = 0;
 
-    if (lyht_find_first(ht, hash, &rec)) {
+    if (lyht_find_first(ht, hash, 0, &rec)) {
         /* not found, cannot happen */
         assert(0);
     }
@@ -604,7 +730,7 @@ lyht_find_next(struct hash_table *ht, void *val_p, uint32_t hash, void **match_p
     crec = rec;
     c = rec->hits;
     for (i = 1; i < c; ++i) {
-        r = lyht_find_collision(ht, &rec, crec);
+        r = lyht_find_collision(ht, &rec, crec, 0);
         assert(!r);
         (void)r;
 
@@ -730,7 +856,7 @@ lyht_insert_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash,
     lyht_dbgprint_ht(ht, "before");
     lyht_dbgprint_value(val_p, hash, ht->rec_size, "inserting");
 
-    if (!lyht_find_first(ht, hash, &rec)) {
+    if (!lyht_find_first(ht, hash, 1, &rec)) {
         /* we found matching shortened hash */
         if ((rec->hash == hash) && ht->val_equal(val_p, &rec->val, 1, ht->cb_data)) {
             /* even the value matches */
@@ -743,7 +869,7 @@ lyht_insert_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash,
         /* some collisions, we need to go through them, too */
         crec = rec;
         for (i = 1; i < crec->hits; ++i) {
-            r = lyht_find_collision(ht, &rec, crec);
+            r = lyht_find_collision(ht, &rec, crec, 1);
             assert(!r);
 
             /* compare values */
@@ -756,7 +882,7 @@ lyht_insert_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash,
         }
 
         /* value not found, get the record where it will be inserted */
-        r = lyht_find_collision(ht, &rec, crec);
+        r = lyht_find_collision(ht, &rec, crec, 1);
         assert(r);
     }
 
@@ -825,7 +951,7 @@ lyht_remove_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash, va
     lyht_dbgprint_ht(ht, "before");
     lyht_dbgprint_value(val_p, hash, ht->rec_size, "removing");
 
-    if (lyht_find_first(ht, hash, &rec)) {
+    if (lyht_find_first(ht, hash, 1, &rec)) {
         /* hash not found */
         LOGDBG(LY_LDGHASH, "remove failed");
         return 1;
@@ -838,7 +964,7 @@ lyht_remove_with_resize_cb(struct hash_table *ht, void *val_p, uint32_t hash, va
     /* we always need to go through collisions */
     crec = rec;
     for (i = 1; i < crec->hits; ++i) {
-        r = lyht_find_collision(ht, &rec, crec);
+        r = lyht_find_collision(ht, &rec, crec, 1);
         assert(!r);
 
         /* compare values */
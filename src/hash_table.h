@@ -25,6 +25,9 @@
 /**
  * @brief Compute hash from (several) string(s).
  *
+ * The hash function depends on the build options (see LY_ENABLED_WORD_HASH) so the hashes
+ * must never be stored.
+ *
  * Usage:
  * - init hash to 0
  * - repeatedly call dict_hash_multi(), provide hash from the last call
@@ -32,6 +35,14 @@
  */
 uint32_t dict_hash_multi(uint32_t hash, const char *key_part, size_t len);
 
+/**
+ * @brief Compute hash from (several) string(s) using always the one-at-a-time hash.
+ *
+ * To be used for hashes that are stored (LYB format), usage is the same as for dict_hash_multi().
+ * Hashing the parts separately results in the same hash as hashing them at once.
+ */
+uint32_t dict_hash_oaat_multi(uint32_t hash, const char *key_part, size_t len);
+
 /**
  * @brief Callback for checking hash table values equivalence.
  *
@@ -89,14 +100,29 @@ struct dict_rec {
     uint32_t refcount;
 } _PACKED;
 
+/** number of hash bits selecting the dictionary shard */
+#define LYDICT_SHARD_BITS 5
+
+/** number of dictionary shards */
+#define LYDICT_SHARDS (1 << LYDICT_SHARD_BITS)
+
 /**
- * dictionary to store repeating strings
+ * part of the dictionary with its own lock so that threads working with
+ * different strings do not serialize on a single mutex
  */
-struct dict_table {
+struct dict_shard {
     struct hash_table *hash_tab;
     pthread_mutex_t lock;
 };
 
+/**
+ * dictionary to store repeating strings, split into shards by the highest
+ * bits of the string hash (the lowest bits are used by the hash tables)
+ */
+struct dict_table {
+    struct dict_shard shards[LYDICT_SHARDS];
+};
+
 /**
  * @brief Initiate content (non-zero values) of the dictionary
  *
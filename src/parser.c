@@ -39,6 +39,16 @@
 
 #define LYP_URANGE_LEN 19
 
+/* compile the patterns into machine code if libpcre supports it */
+#ifdef PCRE_STUDY_JIT_COMPILE
+#   define LYP_PCRE_STUDY_OPTS PCRE_STUDY_JIT_COMPILE
+#else
+#   define LYP_PCRE_STUDY_OPTS 0
+#endif
+
+/* maximum number of compiled patterns cached in a context */
+#define LYP_PATTERN_CACHE_SIZE 256
+
 static char *lyp_ublock2urange[][2] = {
     {"BasicLatin", "[\\x{0000}-\\x{007F}]"},
     {"Latin-1Supplement", "[\\x{0080}-\\x{00FF}]"},
@@ -605,7 +615,9 @@ validate_pattern(struct ly_ctx *ctx, const char *val_str, struct lys_type *type,
     int rc;
     unsigned int i;
 #ifndef LY_ENABLED_CACHE
+    int cached;
     pcre *precomp;
+    pcre_extra *study;
 #endif
 
     assert(ctx && (type->base == LY_TYPE_STRING));
@@ -636,14 +648,18 @@ validate_pattern(struct ly_ctx *ctx, const char *val_str, struct lys_type *type,
 
     for (i = 0; i < type->info.str.pat_count; ++i) {
 #ifdef LY_ENABLED_CACHE
-        rc = pcre_exec((pcre *)type->info.str.patterns_pcre[2 * i], (pcre_extra *)type->info.str.patterns_pcre[2 * i + 1],
-                       val_str, strlen(val_str), 0, 0, NULL, 0);
+        rc = lyp_exec_pattern((pcre *)type->info.str.patterns_pcre[2 * i],
+                              (pcre_extra *)type->info.str.patterns_pcre[2 * i + 1], val_str);
 #else
-        if (lyp_check_pattern(ctx, &type->info.str.patterns[i].expr[1], &precomp)) {
+        cached = lyp_pattern_cached(ctx, &type->info.str.patterns[i].expr[1], &precomp, &study);
+        if (cached == -1) {
             return EXIT_FAILURE;
         }
-        rc = pcre_exec(precomp, NULL, val_str, strlen(val_str), 0, 0, NULL, 0);
-        free(precomp);
+        rc = lyp_exec_pattern(precomp, study, val_str);
+        if (cached) {
+            pcre_free(precomp);
+            pcre_free_study(study);
+        }
 #endif
         if ((rc && type->info.str.patterns[i].expr[0] == 0x06) || (!rc && type->info.str.patterns[i].expr[0] == 0x15)) {
             LOGVAL(ctx, LYE_NOCONSTR, LY_VLOG_LYD, node, val_str, &type->info.str.patterns[i].expr[1]);
@@ -959,7 +975,7 @@ lyp_precompile_pattern(struct ly_ctx *ctx, const char *pattern, pcre** pcre_cmp,
     }
 
     if (pcre_std && pcre_cmp) {
-        (*pcre_std) = pcre_study(*pcre_cmp, 0, &err_msg);
+        (*pcre_std) = pcre_study(*pcre_cmp, LYP_PCRE_STUDY_OPTS, &err_msg);
         if (err_msg) {
             LOGWRN(ctx, "Studying pattern \"%s\" failed (%s).", pattern, err_msg);
         }
@@ -968,6 +984,117 @@ lyp_precompile_pattern(struct ly_ctx *ctx, const char *pattern, pcre** pcre_cmp,
     return EXIT_SUCCESS;
 }
 
+int
+lyp_exec_pattern(pcre *pcre_cmp, pcre_extra *pcre_std, const char *str)
+{
+    int rc;
+
+    rc = pcre_exec(pcre_cmp, pcre_std, str, strlen(str), 0, 0, NULL, 0);
+#ifdef PCRE_ERROR_JIT_STACKLIMIT
+    if (rc == PCRE_ERROR_JIT_STACKLIMIT) {
+        /* the default JIT stack is too small for this value, use the interpreter */
+        rc = pcre_exec(pcre_cmp, NULL, str, strlen(str), 0, 0, NULL, 0);
+    }
+#endif
+
+    return rc;
+}
+
+/* compiled pattern in the context cache, see lyp_pattern_cached() */
+struct lyp_pattern {
+    char *expr;
+    pcre *pcre_cmp;
+    pcre_extra *pcre_std;
+};
+
+static int
+lyp_pattern_cache_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyp_pattern *pat1 = *(struct lyp_pattern **)val1_p, *pat2 = *(struct lyp_pattern **)val2_p;
+
+    return !strcmp(pat1->expr, pat2->expr);
+}
+
+int
+lyp_pattern_cached(struct ly_ctx *ctx, const char *pattern, pcre **pcre_cmp, pcre_extra **pcre_std)
+{
+    struct lyp_pattern key, *pat_p = &key, **match;
+    uint32_t hash;
+    int ret = EXIT_SUCCESS;
+
+    key.expr = (char *)pattern;
+    hash = dict_hash_multi(0, pattern, strlen(pattern));
+    hash = dict_hash_multi(hash, NULL, 0);
+
+    pthread_mutex_lock(&ctx->pattern_cache_lock);
+
+    if (!ctx->pattern_cache) {
+        ctx->pattern_cache = lyht_new(64, sizeof pat_p, lyp_pattern_cache_equal, NULL, 1);
+        LY_CHECK_ERR_GOTO(!ctx->pattern_cache, LOGMEM(ctx); ret = -1, cleanup);
+    }
+
+    if (!lyht_find(ctx->pattern_cache, &pat_p, hash, (void **)&match)) {
+        /* compiled before */
+        *pcre_cmp = (*match)->pcre_cmp;
+        *pcre_std = (*match)->pcre_std;
+        goto cleanup;
+    }
+
+    *pcre_std = NULL;
+    if (lyp_precompile_pattern(ctx, pattern, pcre_cmp, pcre_std)) {
+        ret = -1;
+        goto cleanup;
+    }
+
+    if (ctx->pattern_cache->used >= LYP_PATTERN_CACHE_SIZE) {
+        /* the patterns may come from data, do not let the cache grow without limits */
+        ret = 1;
+        goto cleanup;
+    }
+
+    pat_p = malloc(sizeof *pat_p);
+    LY_CHECK_ERR_GOTO(!pat_p, LOGMEM(ctx); ret = 1, cleanup);
+    pat_p->expr = strdup(pattern);
+    LY_CHECK_ERR_GOTO(!pat_p->expr, LOGMEM(ctx); free(pat_p); ret = 1, cleanup);
+    pat_p->pcre_cmp = *pcre_cmp;
+    pat_p->pcre_std = *pcre_std;
+    if (lyht_insert(ctx->pattern_cache, &pat_p, hash, NULL)) {
+        LOGINT(ctx);
+        free(pat_p->expr);
+        free(pat_p);
+        ret = 1;
+    }
+
+cleanup:
+    pthread_mutex_unlock(&ctx->pattern_cache_lock);
+    return ret;
+}
+
+void
+lyp_pattern_cache_free(struct ly_ctx *ctx)
+{
+    struct ht_rec *rec;
+    struct lyp_pattern *pat;
+    uint32_t i;
+
+    if (!ctx->pattern_cache) {
+        return;
+    }
+
+    for (i = 0; i < ctx->pattern_cache->size; ++i) {
+        rec = lyht_get_rec(ctx->pattern_cache->recs, ctx->pattern_cache->rec_size, i);
+        if (rec->hits > 0) {
+            pat = *(struct lyp_pattern **)rec->val;
+            pcre_free(pat->pcre_cmp);
+            pcre_free_study(pat->pcre_std);
+            free(pat->expr);
+            free(pat);
+        }
+    }
+    lyht_free(ctx->pattern_cache);
+    ctx->pattern_cache = NULL;
+}
+
 /**
  * @brief Change the value into its canonical form. In libyang, additionally to the RFC,
  * all identities have their module as a prefix in their canonical form.
@@ -3702,6 +3829,7 @@ lyp_ctx_add_module(struct lys_module *module)
     }
     module->ctx->models.list[module->ctx->models.used++] = module;
     module->ctx->models.module_set_id++;
+    ly_ctx_module_index_add(module);
 
     return 0;
 }
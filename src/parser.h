@@ -41,7 +41,8 @@ struct lys_submodule *yin_read_submodule(struct lys_module *module, const char *
  * @defgroup xmldata XML data format support
  * @{
  */
-struct lyd_node *xml_read_data(struct ly_ctx *ctx, const char *data, int options);
+struct lyd_node *lyd_parse_xml_mem(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
+                                   const struct lyd_node *data_tree, const char *yang_data_name);
 
 /**@} xmldata */
 
@@ -52,6 +53,9 @@ struct lyd_node *xml_read_data(struct ly_ctx *ctx, const char *data, int options
 struct lyd_node *lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
                                 const struct lyd_node *data_tree, const char *yang_data_name);
 
+struct lyd_json_stream *lyd_json_stream_create(struct ly_ctx *ctx, int options, const struct lyd_node *rpc_act,
+                                               const struct lyd_node *data_tree, const char *yang_data_name);
+
 /**@} jsondata */
 
 /**
@@ -110,6 +114,33 @@ int lyp_check_length_range(struct ly_ctx *ctx, const char *expr, struct lys_type
 int lyp_check_pattern(struct ly_ctx *ctx, const char *pattern, pcre **pcre_precomp);
 int lyp_precompile_pattern(struct ly_ctx *ctx, const char *pattern, pcre** pcre_cmp, pcre_extra **pcre_std);
 
+/**
+ * @brief Match a string against a pattern compiled by lyp_precompile_pattern(). Does not log.
+ *
+ * @return 0 on match, non-zero otherwise (see pcre_exec()).
+ */
+int lyp_exec_pattern(pcre *pcre_cmp, pcre_extra *pcre_std, const char *str);
+
+/**
+ * @brief Get a pattern compiled by lyp_precompile_pattern() from the context cache, compile it
+ * if it is not there yet. Logs directly.
+ *
+ * @param[in] ctx Context with the cache.
+ * @param[in] pattern Pattern to get.
+ * @param[out] pcre_cmp Compiled pattern.
+ * @param[out] pcre_std Studied pattern.
+ * @return EXIT_SUCCESS if the compiled pattern is owned by the cache, 1 if the cache is full and
+ * the caller must free it, -1 on error.
+ */
+int lyp_pattern_cached(struct ly_ctx *ctx, const char *pattern, pcre **pcre_cmp, pcre_extra **pcre_std);
+
+/**
+ * @brief Free all the cached compiled patterns of a context.
+ *
+ * @param[in] ctx Context with the cache.
+ */
+void lyp_pattern_cache_free(struct ly_ctx *ctx);
+
 int fill_yin_type(struct lys_module *module, struct lys_node *parent, struct lyxml_elem *yin, struct lys_type *type,
                   int tpdftype, struct unres_schema *unres);
 
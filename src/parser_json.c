@@ -393,10 +393,20 @@ json_get_anydata(struct lyd_node_anydata *any, const char *data)
         return 0;
     }
 
-    /* count opening '{' and closing '}' brackets to get the end of the object without its parsing */
+    /* count opening '{' and closing '}' brackets outside strings to get the end of the object without its parsing */
     c = len = 0;
     do {
         switch (data[len]) {
+        case '"':
+            for (len++; data[len] && (data[len] != '"'); len++) {
+                if ((data[len] == '\\') && data[len + 1]) {
+                    len++;
+                }
+            }
+            if (!data[len]) {
+                continue;
+            }
+            break;
         case '{':
             c++;
             break;
@@ -533,7 +543,7 @@ inval:
             }
 
             /* another instance of the leaf-list */
-            new = calloc(1, sizeof(struct lyd_node_leaf_list));
+            new = (struct lyd_node_leaf_list *)lyd_node_calloc(sizeof *new, unres->arena);
             LY_CHECK_ERR_RETURN(!new, LOGMEM(ctx), 0);
 
             new->parent = leaf->parent;
@@ -849,55 +859,69 @@ json_skip_unknown(struct ly_ctx *ctx, struct lyd_node *parent, const char *data,
     return 0;
 }
 
-static unsigned int
-json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *schema_parent, struct lyd_node **parent,
-                struct lyd_node *first_sibling, struct lyd_node *prev, struct attr_cont **attrs, int options,
-                struct unres_data *unres, struct lyd_node **act_notif, const char *yang_data_name)
+static void
+free_attrs(struct ly_ctx *ctx, struct attr_cont **attrs)
 {
-    unsigned int len = 0;
-    unsigned int r;
-    unsigned int flag_leaflist = 0;
-    int i;
-    uint8_t pos;
-    char *name, *prefix = NULL, *str = NULL;
-    const struct lys_module *module = NULL;
-    struct lys_node *schema = NULL;
-    const struct lys_node *sparent = NULL;
-    struct lyd_node *result = NULL, *new, *list, *diter = NULL;
-    struct lyd_attr *attr;
     struct attr_cont *attrs_aux;
 
+    while (*attrs) {
+        attrs_aux = *attrs;
+        *attrs = (*attrs)->next;
+
+        lyd_free_attr(ctx, NULL, attrs_aux->attr, 1);
+        free(attrs_aux);
+    }
+}
+
+/**
+ * @brief Parse the name of an object member up to the beginning of its value.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] data Input data pointing to the member.
+ * @param[in] parent Parent data node for logging.
+ * @param[out] str Parsed member name, to be freed by the caller.
+ * @param[out] prefix Module name part of \p str, NULL if not present.
+ * @param[out] name Node name part of \p str (without the '@' of attributes).
+ * @return Number of bytes read (\p data + the return value points to the member value), 0 on error.
+ */
+static unsigned int
+json_parse_name(struct ly_ctx *ctx, const char *data, struct lyd_node *parent, char **str, char **prefix, char **name)
+{
+    unsigned int len = 0, r;
+
+    *str = *prefix = *name = NULL;
+
     /* each YANG data node representation starts with string (node identifier) */
     if (data[len] != '"') {
-        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, (*parent),
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, parent,
                "JSON data (missing quotation-mark at the beginning of string)");
         return 0;
     }
     len++;
 
-    str = lyjson_parse_text(ctx, &data[len], &r);
-    if (!str) {
-        goto error;
+    *str = lyjson_parse_text(ctx, &data[len], &r);
+    if (!*str) {
+        return 0;
     }
 
     if (!r) {
         goto error;
     } else if (data[len + r] != '"') {
-        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, (*parent),
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, parent,
                "JSON data (missing quotation-mark at the end of string)");
         goto error;
     }
-    if ((name = strchr(str, ':'))) {
-        *name = '\0';
-        name++;
-        prefix = str;
-        if (prefix[0] == '@') {
-            prefix++;
+    if ((*name = strchr(*str, ':'))) {
+        **name = '\0';
+        (*name)++;
+        *prefix = *str;
+        if ((*prefix)[0] == '@') {
+            (*prefix)++;
         }
     } else {
-        name = str;
-        if (name[0] == '@') {
-            name++;
+        *name = *str;
+        if ((*name)[0] == '@') {
+            (*name)++;
         }
     }
 
@@ -905,46 +929,29 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
     len += r + 1;
     len += skip_ws(&data[len]);
     if (data[len] != ':') {
-        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, (*parent), "JSON data (missing name-separator)");
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, parent, "JSON data (missing name-separator)");
         goto error;
     }
     len++;
     len += skip_ws(&data[len]);
 
-    if (str[0] == '@' && !str[1]) {
-        /* process attribute of the parent object (container or list) */
-        if (!(*parent)) {
-            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "attribute with no corresponding element to belongs to");
-            goto error;
-        }
-
-        r = json_parse_attr((*parent)->schema->module, &attr, &data[len], options);
-        if (!r) {
-            LOGPATH(ctx, LY_VLOG_LYD, *parent);
-            goto error;
-        }
-        len += r;
-
-        if ((*parent)->attr) {
-            lyd_free_attr(ctx, NULL, attr, 1);
-        } else {
-            (*parent)->attr = attr;
-            for (; attr; attr = attr->next) {
-                attr->parent = *parent;
-            }
-        }
+    return len;
 
-        /* check edit-config attribute correctness */
-        if ((options & LYD_OPT_EDIT) && lyp_check_edit_attr(ctx, (*parent)->attr, *parent, NULL)) {
-            goto error;
-        }
+error:
+    free(*str);
+    *str = *prefix = *name = NULL;
+    return 0;
+}
 
-        free(str);
-        return len;
-    }
+static struct lys_node *
+json_find_schema(struct ly_ctx *ctx, const char *prefix, const char *name, struct lyd_node *parent,
+                 const struct lys_node *schema_parent, int options, const char *yang_data_name)
+{
+    const struct lys_module *module = NULL;
+    struct lys_node *schema = NULL;
+    const struct lys_node *sparent = NULL;
 
-    /* find schema node */
-    if (!(*parent)) {
+    if (!parent) {
         /* starting in root */
         /* get the proper schema */
         module = ly_ctx_get_module(ctx, prefix, NULL, 0);
@@ -990,8 +997,8 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
         }
 
         /* go through RPC's input/output following the options' data type */
-        if ((*parent)->schema->nodetype == LYS_RPC || (*parent)->schema->nodetype == LYS_ACTION) {
-            while ((schema = (struct lys_node *)lys_getnext(schema, (*parent)->schema, NULL, LYS_GETNEXT_WITHINOUT))) {
+        if (parent->schema->nodetype == LYS_RPC || parent->schema->nodetype == LYS_ACTION) {
+            while ((schema = (struct lys_node *)lys_getnext(schema, parent->schema, NULL, LYS_GETNEXT_WITHINOUT))) {
                 if ((options & LYD_OPT_RPC) && (schema->nodetype == LYS_INPUT)) {
                     break;
                 } else if ((options & LYD_OPT_RPCREPLY) && (schema->nodetype == LYS_OUTPUT)) {
@@ -1011,73 +1018,30 @@ json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *sch
                 }
             }
         } else {
-            while ((schema = (struct lys_node *)lys_getnext(schema, (*parent)->schema, NULL, 0))) {
+            while ((schema = (struct lys_node *)lys_getnext(schema, parent->schema, NULL, 0))) {
                 if (!strcmp(schema->name, name)
                         && ((prefix && !strcmp(lys_node_module(schema)->name, prefix))
-                        || (!prefix && (lys_node_module(schema) == lyd_node_module(*parent))))) {
+                        || (!prefix && (lys_node_module(schema) == lyd_node_module(parent))))) {
                     break;
                 }
             }
         }
     }
 
-    module = lys_node_module(schema);
-    if (!module || !module->implemented || module->disabled) {
-        if (options & LYD_OPT_STRICT) {
-            LOGVAL(ctx, LYE_INELEM, (*parent ? LY_VLOG_LYD : LY_VLOG_NONE), (*parent), name);
-            goto error;
-        } else {
-            if (json_skip_unknown(ctx, *parent, data, &len)) {
-                goto error;
-            }
-            free(str);
-            return len;
-        }
-    }
-
-    if (str[0] == '@') {
-        /* attribute for some sibling node */
-        if (data[len] == '[') {
-            flag_leaflist = 1;
-            len++;
-            len += skip_ws(&data[len]);
-        }
-
-attr_repeat:
-        r = json_parse_attr((struct lys_module *)module, &attr, &data[len], options);
-        if (!r) {
-            LOGPATH(ctx, LY_VLOG_LYD, (*parent));
-            goto error;
-        }
-        len += r;
-
-        if (attr) {
-            attrs_aux = malloc(sizeof *attrs_aux);
-            LY_CHECK_ERR_GOTO(!attrs_aux, LOGMEM(ctx), error);
-            attrs_aux->attr = attr;
-            attrs_aux->index = flag_leaflist;
-            attrs_aux->schema = schema;
-            attrs_aux->next = *attrs;
-            *attrs = attrs_aux;
-        }
-
-        if (flag_leaflist) {
-            if (data[len] == ',') {
-                len++;
-                len += skip_ws(&data[len]);
-                flag_leaflist++;
-                goto attr_repeat;
-            } else if (data[len] != ']') {
-                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, (*parent), "JSON data (missing end-array)");
-                goto error;
-            }
-            len++;
-            len += skip_ws(&data[len]);
-        }
+    return schema;
+}
 
-        free(str);
-        return len;
-    }
+/**
+ * @brief Create a data node and connect it as the last child of \p parent (list keys are placed
+ * at their position instead).
+ */
+static struct lyd_node *
+json_node_new(struct ly_ctx *ctx, struct lys_node *schema, struct lyd_node *parent, struct lyd_node **first_sibling,
+              struct lyd_node *prev, struct unres_data *unres)
+{
+    int i;
+    uint8_t pos;
+    struct lyd_node *result = NULL, *diter;
 
     switch (schema->nodetype) {
     case LYS_CONTAINER:
@@ -1085,38 +1049,38 @@ attr_repeat:
     case LYS_NOTIF:
     case LYS_RPC:
     case LYS_ACTION:
-        result = calloc(1, sizeof *result);
+        result = lyd_node_calloc(sizeof *result, unres->arena);
         break;
     case LYS_LEAF:
     case LYS_LEAFLIST:
-        result = calloc(1, sizeof(struct lyd_node_leaf_list));
+        result = lyd_node_calloc(sizeof(struct lyd_node_leaf_list), unres->arena);
         break;
     case LYS_ANYXML:
     case LYS_ANYDATA:
-        result = calloc(1, sizeof(struct lyd_node_anydata));
+        result = lyd_node_calloc(sizeof(struct lyd_node_anydata), unres->arena);
         break;
     default:
         LOGINT(ctx);
-        goto error;
+        return NULL;
     }
-    LY_CHECK_ERR_GOTO(!result, LOGMEM(ctx), error);
+    LY_CHECK_ERR_RETURN(!result, LOGMEM(ctx), NULL);
 
     result->prev = result;
     result->schema = schema;
-    result->parent = *parent;
+    result->parent = parent;
     diter = NULL;
     if (schema->nodetype == LYS_LEAF && lys_is_key((struct lys_node_leaf *)schema, &pos)) {
         /* it is key and we need to insert it into a correct place (we must have parent then, a key cannot be top-level) */
-        assert(*parent);
-        for (i = 0, diter = (*parent)->child;
+        assert(parent);
+        for (i = 0, diter = parent->child;
                 diter && i < pos && diter->schema->nodetype == LYS_LEAF && lys_is_key((struct lys_node_leaf *)diter->schema, NULL);
                 i++, diter = diter->next);
         if (diter) {
             /* out of order insertion - insert list's key to the correct position, before the diter */
-            if ((*parent)->child == diter) {
-                (*parent)->child = result;
+            if (parent->child == diter) {
+                parent->child = result;
                 /* update first_sibling */
-                first_sibling = result;
+                *first_sibling = result;
             }
             if (diter->prev->next) {
                 diter->prev->next = result;
@@ -1128,18 +1092,18 @@ attr_repeat:
     }
     if (!diter) {
         /* simplified (faster) insert as the last node */
-        if (*parent && !(*parent)->child) {
-            (*parent)->child = result;
+        if (parent && !parent->child) {
+            parent->child = result;
         }
         if (prev) {
             result->prev = prev;
             prev->next = result;
 
             /* fix the "last" pointer */
-            first_sibling->prev = result;
+            (*first_sibling)->prev = result;
         } else {
             result->prev = result;
-            first_sibling = result;
+            *first_sibling = result;
         }
     }
     result->validity = ly_new_node_validity(result->schema);
@@ -1147,121 +1111,311 @@ attr_repeat:
         result->when_status = LYD_WHEN;
     }
 
-    /* type specific processing */
-    switch (schema->nodetype) {
-    case LYS_LEAF:
-    case LYS_LEAFLIST:
-        /* type detection and assigning the value */
-        r = json_get_value((struct lyd_node_leaf_list *)result, &first_sibling, &data[len], options, unres);
-        if (!r) {
-            goto error;
-        }
-        /* only for leaf-list */
-        while (result->next && (result->next->schema == result->schema)) {
-            result = result->next;
-        }
+    return result;
+}
 
-        len += r;
-        len += skip_ws(&data[len]);
-        break;
-    case LYS_ANYDATA:
-    case LYS_ANYXML:
-        r = json_get_anydata((struct lyd_node_anydata *)result, &data[len]);
-        if (!r) {
-            goto error;
+/**
+ * @brief Start a container, RPC/action, or notification node before parsing its children.
+ */
+static int
+json_node_start(struct ly_ctx *ctx, struct lyd_node *result, int options, struct lyd_node **act_notif)
+{
+    struct lys_node *schema = result->schema;
+
+    if (schema->nodetype & (LYS_RPC | LYS_ACTION)) {
+        if (!(options & LYD_OPT_RPC) || *act_notif) {
+            LOGVAL(ctx, LYE_INELEM, LY_VLOG_LYD, result, schema->name);
+            LOGVAL(ctx, LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected %s node \"%s\".",
+                   (schema->nodetype == LYS_RPC ? "rpc" : "action"), schema->name);
+            return -1;
         }
+        *act_notif = result;
+    } else if (schema->nodetype == LYS_NOTIF) {
+        if (!(options & LYD_OPT_NOTIF) || *act_notif) {
+            LOGVAL(ctx, LYE_INELEM, LY_VLOG_LYD, result, schema->name);
+            LOGVAL(ctx, LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected notification node \"%s\".", schema->name);
+            return -1;
+        }
+        *act_notif = result;
+    }
 
 #ifdef LY_ENABLED_CACHE
-        /* calculate the hash and insert it into parent */
-        lyd_hash(result);
-        lyd_insert_hash(result);
+    /* calculate the hash and insert it into parent */
+    lyd_hash(result);
+    lyd_insert_hash(result);
 #endif
 
-        len += r;
-        len += skip_ws(&data[len]);
-        break;
-    case LYS_CONTAINER:
-    case LYS_RPC:
-    case LYS_ACTION:
-    case LYS_NOTIF:
-        if (schema->nodetype & (LYS_RPC | LYS_ACTION)) {
-            if (!(options & LYD_OPT_RPC) || *act_notif) {
-                LOGVAL(ctx, LYE_INELEM, LY_VLOG_LYD, result, schema->name);
-                LOGVAL(ctx, LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected %s node \"%s\".",
-                       (schema->nodetype == LYS_RPC ? "rpc" : "action"), schema->name);
-                goto error;
-            }
-            *act_notif = result;
-        } else if (schema->nodetype == LYS_NOTIF) {
-            if (!(options & LYD_OPT_NOTIF) || *act_notif) {
-                LOGVAL(ctx, LYE_INELEM, LY_VLOG_LYD, result, schema->name);
-                LOGVAL(ctx, LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected notification node \"%s\".", schema->name);
-                goto error;
-            }
-            *act_notif = result;
-        }
+    return 0;
+}
+
+/**
+ * @brief Finish an object (inner node or list instance) whose all children were parsed.
+ */
+static int
+json_node_end(struct ly_ctx *ctx, struct lyd_node *result, struct attr_cont **attrs, int options)
+{
+    struct attr_cont *attrs_aux;
 
 #ifdef LY_ENABLED_CACHE
-        /* calculate the hash and insert it into parent */
+    /* calculate the hash and insert it into parent */
+    if ((result->schema->nodetype == LYS_LIST) && !((struct lys_node_list *)result->schema)->keys_size) {
         lyd_hash(result);
         lyd_insert_hash(result);
+    }
 #endif
 
-        if (data[len] != '{') {
-            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing begin-object)");
-            goto error;
-        }
-        len++;
-        len += skip_ws(&data[len]);
+    /* store attributes */
+    attrs_aux = *attrs;
+    *attrs = NULL;
+    if (store_attrs(ctx, attrs_aux, result->child, options)) {
+        return -1;
+    }
 
-        if (data[len] != '}') {
-            /* non-empty container */
-            len--;
-            diter = NULL;
-            attrs_aux = NULL;
-            do {
-                len++;
-                len += skip_ws(&data[len]);
+    /* if we have empty non-presence container, mark it as default */
+    if (result->schema->nodetype == LYS_CONTAINER && !result->child &&
+            !result->attr && !((struct lys_node_container *)result->schema)->presence) {
+        result->dflt = 1;
+    }
 
-                r = json_parse_data(ctx, &data[len], NULL, &result, result->child, diter, &attrs_aux, options, unres, act_notif, yang_data_name);
-                if (!r) {
-                    goto error;
-                }
-                len += r;
+    return 0;
+}
 
-                if (result->child) {
-                    diter = result->child->prev;
-                }
-            } while(data[len] == ',');
+/**
+ * @brief Validate a finished list instance and create the next one.
+ */
+static struct lyd_node *
+json_list_next(struct ly_ctx *ctx, struct lyd_node *list, struct lyd_node **first_sibling, struct lyd_node *prev,
+               int options, struct unres_data *unres)
+{
+    struct lyd_node *new;
 
-            /* store attributes */
-            if (store_attrs(ctx, attrs_aux, result->child, options)) {
-                goto error;
-            }
-        }
+    /* various validation checks */
+    if (lyv_data_context(list, options | LYD_OPT_TRUSTED, unres) ||
+            lyv_data_content(list, options, unres) ||
+            lyv_multicases(list, NULL, prev ? first_sibling : NULL, 0, NULL)) {
+        return NULL;
+    }
 
-        if (data[len] != '}') {
-            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing end-object)");
-            goto error;
-        }
-        len++;
-        len += skip_ws(&data[len]);
+    /* another instance of the list */
+    new = lyd_node_calloc(sizeof *new, unres->arena);
+    LY_CHECK_ERR_RETURN(!new, LOGMEM(ctx), NULL);
+    new->parent = list->parent;
+    new->prev = list;
+    list->next = new;
 
-        /* if we have empty non-presence container, mark it as default */
-        if (schema->nodetype == LYS_CONTAINER && !result->child &&
-                !result->attr && !((struct lys_node_container *)schema)->presence) {
-            result->dflt = 1;
-        }
-        break;
-    case LYS_LIST:
-        if (data[len] != '[') {
-            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing begin-array)");
-            goto error;
-        }
+    /* copy the validity and when flags */
+    new->validity = list->validity;
+    new->when_status = list->when_status;
 
-        list = result;
-        do {
-            len++;
+    /* fix the "last" pointer */
+    (*first_sibling)->prev = new;
+
+    new->schema = list->schema;
+    return new;
+}
+
+static int
+json_node_validate(struct lyd_node *result, struct lyd_node **first_sibling, struct lyd_node *prev, int options,
+                   struct unres_data *unres)
+{
+    /* various validation checks (LYD_OPT_TRUSTED is used just so that the order of elements is not checked) */
+    if (lyv_data_context(result, options | LYD_OPT_TRUSTED, unres) ||
+            lyv_data_content(result, options, unres) ||
+            lyv_multicases(result, NULL, prev ? first_sibling : NULL, 0, NULL)) {
+        return -1;
+    }
+
+    /* validation successful */
+    if (result->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
+        /* postpone checking of unique when there will be all list/leaflist instances */
+        result->validity |= LYD_VAL_DUP;
+    }
+
+    return 0;
+}
+
+static unsigned int
+json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *schema_parent, struct lyd_node **parent,
+                struct lyd_node *first_sibling, struct lyd_node *prev, struct attr_cont **attrs, int options,
+                struct unres_data *unres, struct lyd_node **act_notif, const char *yang_data_name);
+
+/**
+ * @brief Parse the value of an object member whose name was already parsed by json_parse_name().
+ *
+ * @param[in] data Input data pointing to the member (its name).
+ * @param[in] len Offset of the member value in \p data.
+ * @param[in] str Member name, always freed.
+ * @param[in] name Node name part of \p str.
+ * @param[in] schema Schema node of the member, NULL if not found.
+ * @return Number of bytes read from \p data, 0 on error.
+ */
+static unsigned int
+json_parse_value(struct ly_ctx *ctx, const char *data, unsigned int len, char *str, const char *name,
+                 struct lys_node *schema, struct lyd_node **parent, struct lyd_node *first_sibling, struct lyd_node *prev,
+                 struct attr_cont **attrs, int options, struct unres_data *unres, struct lyd_node **act_notif,
+                 const char *yang_data_name)
+{
+    unsigned int r;
+    unsigned int flag_leaflist = 0;
+    int i;
+    const struct lys_module *module;
+    struct lyd_node *result = NULL, *list, *diter = NULL;
+    struct lyd_attr *attr;
+    struct attr_cont *attrs_aux;
+
+    module = lys_node_module(schema);
+    if (!module || !module->implemented || module->disabled) {
+        if (options & LYD_OPT_STRICT) {
+            LOGVAL(ctx, LYE_INELEM, (*parent ? LY_VLOG_LYD : LY_VLOG_NONE), (*parent), name);
+            goto error;
+        } else {
+            if (json_skip_unknown(ctx, *parent, data, &len)) {
+                goto error;
+            }
+            free(str);
+            return len;
+        }
+    }
+
+    if (str[0] == '@') {
+        /* attribute for some sibling node */
+        if (data[len] == '[') {
+            flag_leaflist = 1;
+            len++;
+            len += skip_ws(&data[len]);
+        }
+
+attr_repeat:
+        r = json_parse_attr((struct lys_module *)module, &attr, &data[len], options);
+        if (!r) {
+            LOGPATH(ctx, LY_VLOG_LYD, (*parent));
+            goto error;
+        }
+        len += r;
+
+        if (attr) {
+            attrs_aux = malloc(sizeof *attrs_aux);
+            LY_CHECK_ERR_GOTO(!attrs_aux, LOGMEM(ctx), error);
+            attrs_aux->attr = attr;
+            attrs_aux->index = flag_leaflist;
+            attrs_aux->schema = schema;
+            attrs_aux->next = *attrs;
+            *attrs = attrs_aux;
+        }
+
+        if (flag_leaflist) {
+            if (data[len] == ',') {
+                len++;
+                len += skip_ws(&data[len]);
+                flag_leaflist++;
+                goto attr_repeat;
+            } else if (data[len] != ']') {
+                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, (*parent), "JSON data (missing end-array)");
+                goto error;
+            }
+            len++;
+            len += skip_ws(&data[len]);
+        }
+
+        free(str);
+        return len;
+    }
+
+    result = json_node_new(ctx, schema, *parent, &first_sibling, prev, unres);
+    if (!result) {
+        goto error;
+    }
+
+    /* type specific processing */
+    switch (schema->nodetype) {
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        /* type detection and assigning the value */
+        r = json_get_value((struct lyd_node_leaf_list *)result, &first_sibling, &data[len], options, unres);
+        if (!r) {
+            goto error;
+        }
+        /* only for leaf-list */
+        while (result->next && (result->next->schema == result->schema)) {
+            result = result->next;
+        }
+
+        len += r;
+        len += skip_ws(&data[len]);
+        break;
+    case LYS_ANYDATA:
+    case LYS_ANYXML:
+        r = json_get_anydata((struct lyd_node_anydata *)result, &data[len]);
+        if (!r) {
+            goto error;
+        }
+
+#ifdef LY_ENABLED_CACHE
+        /* calculate the hash and insert it into parent */
+        lyd_hash(result);
+        lyd_insert_hash(result);
+#endif
+
+        len += r;
+        len += skip_ws(&data[len]);
+        break;
+    case LYS_CONTAINER:
+    case LYS_RPC:
+    case LYS_ACTION:
+    case LYS_NOTIF:
+        if (json_node_start(ctx, result, options, act_notif)) {
+            goto error;
+        }
+
+        if (data[len] != '{') {
+            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing begin-object)");
+            goto error;
+        }
+        len++;
+        len += skip_ws(&data[len]);
+
+        attrs_aux = NULL;
+        if (data[len] != '}') {
+            /* non-empty container */
+            len--;
+            diter = NULL;
+            do {
+                len++;
+                len += skip_ws(&data[len]);
+
+                r = json_parse_data(ctx, &data[len], NULL, &result, result->child, diter, &attrs_aux, options, unres, act_notif, yang_data_name);
+                if (!r) {
+                    goto error;
+                }
+                len += r;
+
+                if (result->child) {
+                    diter = result->child->prev;
+                }
+            } while(data[len] == ',');
+        }
+
+        /* store attributes */
+        if (json_node_end(ctx, result, &attrs_aux, options)) {
+            goto error;
+        }
+
+        if (data[len] != '}') {
+            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing end-object)");
+            goto error;
+        }
+        len++;
+        len += skip_ws(&data[len]);
+        break;
+    case LYS_LIST:
+        if (data[len] != '[') {
+            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, result, "JSON data (missing begin-array)");
+            goto error;
+        }
+
+        list = result;
+        do {
+            len++;
             len += skip_ws(&data[len]);
 
             if (data[len] != '{') {
@@ -1286,16 +1440,8 @@ attr_repeat:
                 }
             } while (data[len] == ',');
 
-#ifdef LY_ENABLED_CACHE
-            /* calculate the hash and insert it into parent */
-            if (!((struct lys_node_list *)list->schema)->keys_size) {
-                lyd_hash(list);
-                lyd_insert_hash(list);
-            }
-#endif
-
             /* store attributes */
-            if (store_attrs(ctx, attrs_aux, list->child, options)) {
+            if (json_node_end(ctx, list, &attrs_aux, options)) {
                 goto error;
             }
 
@@ -1309,29 +1455,10 @@ attr_repeat:
             len += skip_ws(&data[len]);
 
             if (data[len] == ',') {
-                /* various validation checks */
-                if (lyv_data_context(list, options | LYD_OPT_TRUSTED, unres) ||
-                        lyv_data_content(list, options, unres) ||
-                        lyv_multicases(list, NULL, prev ? &first_sibling : NULL, 0, NULL)) {
+                list = json_list_next(ctx, list, &first_sibling, prev, options, unres);
+                if (!list) {
                     goto error;
                 }
-
-                /* another instance of the list */
-                new = calloc(1, sizeof *new);
-                LY_CHECK_ERR_GOTO(!new, LOGMEM(ctx), error);
-                new->parent = list->parent;
-                new->prev = list;
-                list->next = new;
-
-                /* copy the validity and when flags */
-                new->validity = list->validity;
-                new->when_status = list->when_status;
-
-                /* fix the "last" pointer */
-                first_sibling->prev = new;
-
-                new->schema = list->schema;
-                list = new;
             }
         } while (data[len] == ',');
         result = list;
@@ -1348,19 +1475,10 @@ attr_repeat:
         goto error;
     }
 
-    /* various validation checks (LYD_OPT_TRUSTED is used just so that the order of elements is not checked) */
-    if (lyv_data_context(result, options | LYD_OPT_TRUSTED, unres) ||
-            lyv_data_content(result, options, unres) ||
-            lyv_multicases(result, NULL, prev ? &first_sibling : NULL, 0, NULL)) {
+    if (json_node_validate(result, &first_sibling, prev, options, unres)) {
         goto error;
     }
 
-    /* validation successful */
-    if (result->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
-        /* postpone checking of unique when there will be all list/leaflist instances */
-        result->validity |= LYD_VAL_DUP;
-    }
-
     if (!(*parent)) {
         *parent = result;
     }
@@ -1376,13 +1494,7 @@ error:
             unres_data_del(unres, i);
         }
     }
-    while (*attrs) {
-        attrs_aux = *attrs;
-        *attrs = (*attrs)->next;
-
-        lyd_free_attr(ctx, NULL, attrs_aux->attr, 1);
-        free(attrs_aux);
-    }
+    free_attrs(ctx, attrs);
 
     lyd_free(result);
     free(str);
@@ -1390,139 +1502,166 @@ error:
     return 0;
 }
 
-struct lyd_node *
-lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
-               const struct lyd_node *data_tree, const char *yang_data_name)
+static unsigned int
+json_parse_data(struct ly_ctx *ctx, const char *data, const struct lys_node *schema_parent, struct lyd_node **parent,
+                struct lyd_node *first_sibling, struct lyd_node *prev, struct attr_cont **attrs, int options,
+                struct unres_data *unres, struct lyd_node **act_notif, const char *yang_data_name)
 {
-    struct lyd_node *result = NULL, *next, *iter, *reply_parent = NULL, *reply_top = NULL, *act_notif = NULL;
-    struct unres_data *unres = NULL;
-    unsigned int len = 0, r;
-    int act_cont = 0;
-    struct attr_cont *attrs = NULL;
-
-    if (!ctx || !data) {
-        LOGARG;
-        return NULL;
-    }
-
-    /* skip leading whitespaces */
-    len += skip_ws(&data[len]);
+    unsigned int len, r;
+    char *name, *prefix, *str;
+    struct lys_node *schema;
+    struct lyd_attr *attr;
 
-    /* expect top-level { */
-    if (data[len] != '{') {
-        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level begin-object)");
-        return NULL;
+    len = json_parse_name(ctx, data, *parent, &str, &prefix, &name);
+    if (!len) {
+        goto error;
     }
 
-    /* check for empty object */
-    r = len + 1;
-    r += skip_ws(&data[r]);
-    if (data[r] == '}') {
-        if (options & LYD_OPT_DATA_ADD_YANGLIB) {
-            result = ly_ctx_info(ctx);
+    if (str[0] == '@' && !str[1]) {
+        /* process attribute of the parent object (container or list) */
+        if (!(*parent)) {
+            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "attribute with no corresponding element to belongs to");
+            goto error;
         }
-        lyd_validate(&result, options, ctx);
-        return result;
-    }
 
-    unres = calloc(1, sizeof *unres);
-    LY_CHECK_ERR_RETURN(!unres, LOGMEM(ctx), NULL);
+        r = json_parse_attr((*parent)->schema->module, &attr, &data[len], options);
+        if (!r) {
+            LOGPATH(ctx, LY_VLOG_LYD, *parent);
+            goto error;
+        }
+        len += r;
 
-    /* create RPC/action reply part that is not in the parsed data */
-    if (rpc_act) {
-        assert(options & LYD_OPT_RPCREPLY);
-        if (rpc_act->schema->nodetype == LYS_RPC) {
-            /* RPC request */
-            reply_top = reply_parent = _lyd_new(NULL, rpc_act->schema, 0);
+        if ((*parent)->attr) {
+            lyd_free_attr(ctx, NULL, attr, 1);
         } else {
-            /* action request */
-            reply_top = lyd_dup(rpc_act, 1);
-            LY_TREE_DFS_BEGIN(reply_top, iter, reply_parent) {
-                if (reply_parent->schema->nodetype == LYS_ACTION) {
-                    break;
-                }
-                LY_TREE_DFS_END(reply_top, iter, reply_parent);
-            }
-            if (!reply_parent) {
-                LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-                goto error;
+            (*parent)->attr = attr;
+            for (; attr; attr = attr->next) {
+                attr->parent = *parent;
             }
-            lyd_free_withsiblings(reply_parent->child);
         }
+
+        /* check edit-config attribute correctness */
+        if ((options & LYD_OPT_EDIT) && lyp_check_edit_attr(ctx, (*parent)->attr, *parent, NULL)) {
+            goto error;
+        }
+
+        free(str);
+        return len;
     }
 
-    iter = NULL;
-    next = reply_parent;
-    do {
-        len++;
-        len += skip_ws(&data[len]);
+    /* find schema node */
+    schema = json_find_schema(ctx, prefix, name, *parent, schema_parent, options, yang_data_name);
 
-        if (!act_cont) {
-            if (!strncmp(&data[len], "\"yang:action\"", 13)) {
-                len += 13;
-                len += skip_ws(&data[len]);
-                if (data[len] != ':') {
-                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level begin-object)");
-                    goto error;
-                }
-                ++len;
-                len += skip_ws(&data[len]);
-                if (data[len] != '{') {
-                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level yang:action object)");
-                    goto error;
-                }
-                ++len;
-                len += skip_ws(&data[len]);
+    return json_parse_value(ctx, data, len, str, name, schema, parent, first_sibling, prev, attrs, options, unres,
+                            act_notif, yang_data_name);
 
-                act_cont = 1;
-            } else {
-                act_cont = -1;
-            }
-        }
+error:
+    free_attrs(ctx, attrs);
+    free(str);
 
-        r = json_parse_data(ctx, &data[len], NULL, &next, result, iter, &attrs, options, unres, &act_notif, yang_data_name);
-        if (!r) {
-            goto error;
-        }
-        len += r;
+    return 0;
+}
 
-        if (!result) {
-            if (reply_parent) {
-                result = next->child;
-                iter = next->child ? next->child->prev : NULL;
-            } else {
-                for (iter = next; iter && iter->prev->next; iter = iter->prev);
-                result = iter;
-                if (iter && (options & LYD_OPT_DATA_ADD_YANGLIB) && iter->schema->module == ctx->models.list[ctx->internal_module_count - 1]) {
-                    /* ietf-yang-library data present, so ignore the option to add them */
-                    options &= ~LYD_OPT_DATA_ADD_YANGLIB;
+static void
+json_free_unres(struct unres_data *unres)
+{
+    if (!unres) {
+        return;
+    }
+
+    free(unres->node);
+    free(unres->type);
+    ly_arena_release(unres->arena);
+    free(unres);
+}
+
+/**
+ * @brief Prepare the unresolved items and the RPC/action reply part that is not in the parsed data.
+ */
+static int
+json_parse_start(struct ly_ctx *ctx, int options, const struct lyd_node *rpc_act, struct unres_data **unres,
+                 struct lyd_node **reply_top, struct lyd_node **reply_parent)
+{
+    struct lyd_node *iter;
+
+    *reply_top = *reply_parent = NULL;
+
+    *unres = calloc(1, sizeof **unres);
+    LY_CHECK_ERR_RETURN(!*unres, LOGMEM(ctx), -1);
+    if (options & LYD_OPT_ARENA) {
+        (*unres)->arena = ly_arena_new();
+        LY_CHECK_ERR_RETURN(!(*unres)->arena, free(*unres); *unres = NULL, -1);
+    }
+
+    /* create RPC/action reply part that is not in the parsed data */
+    if (rpc_act) {
+        assert(options & LYD_OPT_RPCREPLY);
+        if (rpc_act->schema->nodetype == LYS_RPC) {
+            /* RPC request */
+            *reply_top = *reply_parent = _lyd_new(NULL, rpc_act->schema, 0);
+        } else {
+            /* action request */
+            *reply_top = lyd_dup(rpc_act, 1);
+            LY_TREE_DFS_BEGIN(*reply_top, iter, *reply_parent) {
+                if ((*reply_parent)->schema->nodetype == LYS_ACTION) {
+                    break;
                 }
-                iter = next;
+                LY_TREE_DFS_END(*reply_top, iter, *reply_parent);
             }
-        } else {
-            iter = result->prev;
-        }
-        if (!reply_parent) {
-            next = NULL;
+            if (!*reply_parent) {
+                LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
+                lyd_free_withsiblings(*reply_top);
+                *reply_top = NULL;
+                json_free_unres(*unres);
+                *unres = NULL;
+                return -1;
+            }
+            lyd_free_withsiblings((*reply_parent)->child);
         }
-    } while (data[len] == ',');
-
-    if (data[len] != '}') {
-        /* expecting end-object */
-        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
-        goto error;
     }
-    len++;
-    len += skip_ws(&data[len]);
 
-    if (act_cont == 1) {
-        if (data[len] != '}') {
-            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
-            goto error;
+    return 0;
+}
+
+/**
+ * @brief Update the top-level siblings after parsing a top-level member.
+ */
+static void
+json_parse_top(struct ly_ctx *ctx, struct lyd_node *reply_parent, struct lyd_node **next, struct lyd_node **result,
+               struct lyd_node **iter, int *options)
+{
+    if (!*result) {
+        if (reply_parent) {
+            *result = (*next)->child;
+            *iter = (*next)->child ? (*next)->child->prev : NULL;
+        } else {
+            for (*iter = *next; *iter && (*iter)->prev->next; *iter = (*iter)->prev);
+            *result = *iter;
+            if (*iter && (*options & LYD_OPT_DATA_ADD_YANGLIB)
+                    && (*iter)->schema->module == ctx->models.list[ctx->internal_module_count - 1]) {
+                /* ietf-yang-library data present, so ignore the option to add them */
+                *options &= ~LYD_OPT_DATA_ADD_YANGLIB;
+            }
+            *iter = *next;
         }
-        len++;
-        len += skip_ws(&data[len]);
+    } else {
+        *iter = (*result)->prev;
+    }
+    if (!reply_parent) {
+        *next = NULL;
     }
+}
+
+/**
+ * @brief Finish the parsed data tree - store top-level attributes, add default nodes and resolve
+ * the unresolved items. Both \p unres and, on error, the parsed data are freed.
+ */
+static struct lyd_node *
+json_parse_finish(struct ly_ctx *ctx, struct lyd_node *result, int options, const struct lyd_node *rpc_act,
+                  const struct lyd_node *data_tree, struct lyd_node *reply_top, struct lyd_node *reply_parent,
+                  struct lyd_node *act_notif, struct attr_cont *attrs, struct unres_data *unres)
+{
+    struct lyd_node *iter;
 
     /* store attributes */
     if (store_attrs(ctx, attrs, result, options)) {
@@ -1584,9 +1723,7 @@ lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct l
         goto error;
     }
 
-    free(unres->node);
-    free(unres->type);
-    free(unres);
+    json_free_unres(unres);
 
     return result;
 
@@ -1595,9 +1732,894 @@ error:
     if (reply_top && result != reply_top) {
         lyd_free_withsiblings(reply_top);
     }
-    free(unres->node);
-    free(unres->type);
-    free(unres);
+    json_free_unres(unres);
+
+    return NULL;
+}
+
+struct lyd_node *
+lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
+               const struct lyd_node *data_tree, const char *yang_data_name)
+{
+    struct lyd_node *result = NULL, *next, *iter, *reply_parent = NULL, *reply_top = NULL, *act_notif = NULL;
+    struct unres_data *unres = NULL;
+    unsigned int len = 0, r;
+    int act_cont = 0;
+    struct attr_cont *attrs = NULL;
+
+    if (!ctx || !data) {
+        LOGARG;
+        return NULL;
+    }
+
+    /* skip leading whitespaces */
+    len += skip_ws(&data[len]);
+
+    /* expect top-level { */
+    if (data[len] != '{') {
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level begin-object)");
+        return NULL;
+    }
+
+    /* check for empty object */
+    r = len + 1;
+    r += skip_ws(&data[r]);
+    if (data[r] == '}') {
+        if (options & LYD_OPT_DATA_ADD_YANGLIB) {
+            result = ly_ctx_info(ctx);
+        }
+        lyd_validate(&result, options, ctx);
+        return result;
+    }
+
+    if (json_parse_start(ctx, options, rpc_act, &unres, &reply_top, &reply_parent)) {
+        return NULL;
+    }
+
+    iter = NULL;
+    next = reply_parent;
+    do {
+        len++;
+        len += skip_ws(&data[len]);
+
+        if (!act_cont) {
+            if (!strncmp(&data[len], "\"yang:action\"", 13)) {
+                len += 13;
+                len += skip_ws(&data[len]);
+                if (data[len] != ':') {
+                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level begin-object)");
+                    goto error;
+                }
+                ++len;
+                len += skip_ws(&data[len]);
+                if (data[len] != '{') {
+                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level yang:action object)");
+                    goto error;
+                }
+                ++len;
+                len += skip_ws(&data[len]);
+
+                act_cont = 1;
+            } else {
+                act_cont = -1;
+            }
+        }
+
+        r = json_parse_data(ctx, &data[len], NULL, &next, result, iter, &attrs, options, unres, &act_notif, yang_data_name);
+        if (!r) {
+            goto error;
+        }
+        len += r;
+
+        json_parse_top(ctx, reply_parent, &next, &result, &iter, &options);
+    } while (data[len] == ',');
+
+    if (data[len] != '}') {
+        /* expecting end-object */
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+        goto error;
+    }
+    len++;
+    len += skip_ws(&data[len]);
+
+    if (act_cont == 1) {
+        if (data[len] != '}') {
+            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+            goto error;
+        }
+        len++;
+        len += skip_ws(&data[len]);
+    }
+
+    return json_parse_finish(ctx, result, options, rpc_act, data_tree, reply_top, reply_parent, act_notif, attrs, unres);
+
+error:
+    free_attrs(ctx, &attrs);
+    lyd_free_withsiblings(result);
+    if (reply_top && result != reply_top) {
+        lyd_free_withsiblings(reply_top);
+    }
+    json_free_unres(unres);
 
     return NULL;
 }
+
+/**
+ * @brief Position of the streaming JSON parser in the input.
+ */
+enum json_stream_state {
+    JSON_STREAM_START,      /**< expecting the top-level begin-object */
+    JSON_STREAM_EMPTY,      /**< after the top-level begin-object, the object may be empty */
+    JSON_STREAM_MEMBER,     /**< expecting an object member */
+    JSON_STREAM_VALUE,      /**< waiting for the end of a member value that is parsed at once */
+    JSON_STREAM_SKIP,       /**< skipping a member value of an unknown node */
+    JSON_STREAM_OBJECT,     /**< after the begin-object of an inner node */
+    JSON_STREAM_NEXT,       /**< after an object member, expecting value-separator or end-object */
+    JSON_STREAM_INSTANCE,   /**< expecting the begin-object of a list instance */
+    JSON_STREAM_INSTANCE_NEXT, /**< after a list instance, expecting value-separator or end-array */
+    JSON_STREAM_ACTION_END, /**< expecting the end-object of the yang:action object */
+    JSON_STREAM_DONE,       /**< the top-level object was parsed */
+    JSON_STREAM_ERROR       /**< parsing failed */
+};
+
+/**
+ * @brief Inner node (or list instance) whose members are being parsed.
+ */
+struct json_stream_frame {
+    struct lyd_node *node;          /**< container, RPC/action, notification or the current list instance */
+    struct lyd_node *first;         /**< first sibling of the node */
+    struct lyd_node *prev;          /**< previous sibling of the node (of the first list instance) */
+    struct attr_cont *attrs;        /**< attributes of the node children */
+};
+
+struct lyd_json_stream {
+    struct ly_ctx *ctx;
+    int options;
+    const struct lyd_node *rpc_act;
+    const struct lyd_node *data_tree;
+    const char *yang_data_name;
+
+    enum json_stream_state state;
+    int act_cont;
+
+    char *buf;                      /**< not yet parsed input, always NUL-terminated */
+    size_t size;                    /**< allocated size of buf */
+    size_t used;                    /**< length of the input in buf */
+    size_t pos;                     /**< current position in buf */
+
+    /* member being buffered or skipped */
+    size_t value;                   /**< offset of the member value in buf (relative to pos) */
+    size_t scan;                    /**< how far the value was scanned (relative to pos) */
+    uint32_t objects;               /**< nested objects of the value */
+    uint32_t arrays;                /**< nested arrays of the value */
+    uint8_t qstr;                   /**< inside a string of the value */
+    uint8_t escape;                 /**< after a backslash inside a string of the value */
+    char *str;                      /**< member name */
+    const char *name;               /**< node name part of str */
+    struct lys_node *schema;        /**< schema node of the member */
+
+    struct json_stream_frame *frames;
+    uint32_t frame_count;
+    uint32_t frame_size;
+
+    /* lyd_parse_json() state */
+    struct unres_data *unres;
+    struct lyd_node *result;
+    struct lyd_node *iter;
+    struct lyd_node *next;
+    struct lyd_node *reply_top;
+    struct lyd_node *reply_parent;
+    struct lyd_node *act_notif;
+    struct attr_cont *attrs;
+};
+
+struct lyd_json_stream *
+lyd_json_stream_create(struct ly_ctx *ctx, int options, const struct lyd_node *rpc_act,
+                       const struct lyd_node *data_tree, const char *yang_data_name)
+{
+    struct lyd_json_stream *stream;
+
+    stream = calloc(1, sizeof *stream);
+    LY_CHECK_ERR_RETURN(!stream, LOGMEM(ctx), NULL);
+
+    stream->ctx = ctx;
+    stream->options = options;
+    stream->rpc_act = rpc_act;
+    stream->data_tree = data_tree;
+    stream->yang_data_name = yang_data_name;
+    stream->state = JSON_STREAM_START;
+
+    return stream;
+}
+
+/**
+ * @brief Free the partially parsed data of a stream.
+ */
+static void
+json_stream_clean(struct lyd_json_stream *stream)
+{
+    struct lyd_node *node;
+    uint32_t i;
+
+    free(stream->str);
+    stream->str = NULL;
+    for (i = 0; i < stream->frame_count; i++) {
+        free_attrs(stream->ctx, &stream->frames[i].attrs);
+    }
+    free_attrs(stream->ctx, &stream->attrs);
+
+    if (stream->reply_top) {
+        /* the parsed nodes are all children of reply_parent */
+        lyd_free_withsiblings(stream->reply_top);
+    } else {
+        /* the top-level node being parsed may not be connected to the result yet */
+        node = stream->result ? stream->result : (stream->frame_count ? stream->frames[0].node : NULL);
+        if (node) {
+            for (; node->prev->next; node = node->prev);
+            lyd_free_withsiblings(node);
+        }
+    }
+    stream->reply_top = stream->reply_parent = stream->result = stream->next = stream->iter = NULL;
+    stream->frame_count = 0;
+
+    json_free_unres(stream->unres);
+    stream->unres = NULL;
+
+    stream->state = JSON_STREAM_ERROR;
+}
+
+/**
+ * @brief Skip whitespaces at the current position and check that there is another character to process.
+ *
+ * @return 1 if a character is available (or no more input will come), 0 if more input is needed.
+ */
+static int
+json_stream_peek(struct lyd_json_stream *stream, int last)
+{
+    stream->pos += skip_ws(&stream->buf[stream->pos]);
+    return (stream->pos < stream->used) || last;
+}
+
+/**
+ * @brief Check whether the whole member name, the name-separator and the beginning of the member value
+ * are available at the current position.
+ */
+static int
+json_stream_member(struct lyd_json_stream *stream)
+{
+    const char *data = &stream->buf[stream->pos];
+    size_t len = stream->used - stream->pos, i;
+
+    if (data[0] != '"') {
+        /* invalid, let the parser report it */
+        return 1;
+    }
+    for (i = 1; (i < len) && (data[i] != '"'); i++) {
+        if (data[i] == '\\') {
+            i++;
+        }
+    }
+    if (i >= len) {
+        return 0;
+    }
+    i++;
+    i += skip_ws(&data[i]);
+    if (i >= len) {
+        return 0;
+    } else if (data[i] != ':') {
+        return 1;
+    }
+    i++;
+    i += skip_ws(&data[i]);
+
+    return i < len;
+}
+
+/**
+ * @brief Continue scanning the member value for its end.
+ *
+ * A value is complete after its closing quotation-mark, end-object or end-array, other values
+ * (numbers and literals) after the following delimiter. Skipped values of unknown nodes end
+ * (as in json_skip_unknown()) with the value-separator or end of the parent object.
+ *
+ * @param[in] skip Whether the value is being skipped (the scanned input is dropped).
+ * @return 1 if the end of the value was found, 0 if more input is needed, -1 on error.
+ */
+static int
+json_stream_scan(struct lyd_json_stream *stream, int skip)
+{
+    char c;
+    int any;
+
+    /* anydata objects are not parsed, only their objects are counted (as in json_get_anydata()) */
+    any = !skip && stream->schema && stream->str && (stream->str[0] != '@') && (stream->schema->nodetype & LYS_ANYDATA);
+
+    for (; stream->pos + stream->scan < stream->used; stream->scan++) {
+        c = stream->buf[stream->pos + stream->scan];
+        if (stream->qstr) {
+            if (stream->escape) {
+                stream->escape = 0;
+            } else if (c == '\\') {
+                stream->escape = 1;
+            } else if (c == '"') {
+                stream->qstr = 0;
+                if (!skip && !stream->objects && !stream->arrays) {
+                    stream->scan++;
+                    return 1;
+                }
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            stream->qstr = 1;
+            break;
+        case '{':
+            stream->objects++;
+            break;
+        case '[':
+            if (!any) {
+                stream->arrays++;
+            }
+            break;
+        case '}':
+            if (!stream->objects) {
+                if (skip && stream->arrays) {
+                    LOGVAL(stream->ctx, LYE_XML_INVAL, LY_VLOG_LYD,
+                           stream->frame_count ? stream->frames[stream->frame_count - 1].node : NULL,
+                           "JSON data (missing end-array)");
+                    return -1;
+                }
+                return 1;
+            }
+            stream->objects--;
+            if (!skip && !stream->objects && !stream->arrays) {
+                stream->scan++;
+                return 1;
+            }
+            break;
+        case ']':
+            if (any) {
+                break;
+            } else if (!stream->arrays) {
+                if (skip && stream->objects) {
+                    LOGVAL(stream->ctx, LYE_XML_INVAL, LY_VLOG_LYD,
+                           stream->frame_count ? stream->frames[stream->frame_count - 1].node : NULL,
+                           "JSON data (missing end-object)");
+                    return -1;
+                }
+                return 1;
+            }
+            stream->arrays--;
+            if (!skip && !stream->objects && !stream->arrays) {
+                stream->scan++;
+                return 1;
+            }
+            break;
+        case ',':
+            if (!stream->objects && !stream->arrays) {
+                return 1;
+            }
+            break;
+        default:
+            if (!skip && !stream->objects && !stream->arrays && lyjson_isspace(c)) {
+                return 1;
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief A member was parsed, update the top-level siblings if it was a top-level one.
+ */
+static void
+json_stream_member_done(struct lyd_json_stream *stream)
+{
+    if (!stream->frame_count) {
+        json_parse_top(stream->ctx, stream->reply_parent, &stream->next, &stream->result, &stream->iter,
+                       &stream->options);
+    }
+    stream->state = JSON_STREAM_NEXT;
+}
+
+/**
+ * @brief Parse the member at the current position, either by descending into the inner node it
+ * represents or by waiting for the whole member to be buffered.
+ */
+static int
+json_stream_parse_member(struct lyd_json_stream *stream)
+{
+    struct ly_ctx *ctx = stream->ctx;
+    struct json_stream_frame *frame;
+    struct lyd_node *parent, *first, *prev, *node;
+    const struct lys_module *module;
+    struct lys_node *schema;
+    char *str, *prefix, *name;
+    unsigned int len;
+    void *mem;
+
+    if (stream->frame_count) {
+        frame = &stream->frames[stream->frame_count - 1];
+        parent = frame->node;
+        first = parent->child;
+    } else {
+        parent = stream->next;
+        first = stream->result;
+    }
+    prev = first ? first->prev : NULL;
+
+    len = json_parse_name(ctx, &stream->buf[stream->pos], parent, &str, &prefix, &name);
+    if (!len) {
+        return -1;
+    }
+
+    stream->value = len;
+    stream->scan = len;
+    stream->objects = stream->arrays = 0;
+    stream->qstr = stream->escape = 0;
+    if (str[0] == '@' && !str[1]) {
+        /* attribute of the parent, parsed with the whole member */
+        free(str);
+        stream->str = NULL;
+        stream->state = JSON_STREAM_VALUE;
+        return 0;
+    }
+
+    schema = json_find_schema(ctx, prefix, name, parent, NULL, stream->options, stream->yang_data_name);
+    module = lys_node_module(schema);
+    if (!module || !module->implemented || module->disabled) {
+        if (!(stream->options & LYD_OPT_STRICT)) {
+            /* skip the unknown node without keeping it in the buffer */
+            free(str);
+            stream->state = JSON_STREAM_SKIP;
+            return 0;
+        }
+    } else if ((str[0] != '@')
+            && (((schema->nodetype & (LYS_CONTAINER | LYS_NOTIF | LYS_RPC | LYS_ACTION)) && (stream->buf[stream->pos + len] == '{'))
+            || ((schema->nodetype == LYS_LIST) && (stream->buf[stream->pos + len] == '[')))) {
+        /* inner node, its members are parsed as they come */
+        free(str);
+        node = json_node_new(ctx, schema, parent, &first, prev, stream->unres);
+        if (!node) {
+            return -1;
+        }
+
+        if (stream->frame_count == stream->frame_size) {
+            mem = realloc(stream->frames, (stream->frame_size ? stream->frame_size * 2 : 8) * sizeof *stream->frames);
+            if (!mem) {
+                LOGMEM(ctx);
+                lyd_free(node);
+                return -1;
+            }
+            stream->frames = mem;
+            stream->frame_size = stream->frame_size ? stream->frame_size * 2 : 8;
+        }
+        frame = &stream->frames[stream->frame_count++];
+        frame->node = node;
+        frame->first = first;
+        frame->prev = prev;
+        frame->attrs = NULL;
+
+        if (schema->nodetype == LYS_LIST) {
+            stream->state = JSON_STREAM_INSTANCE;
+        } else {
+            if (json_node_start(ctx, node, stream->options, &stream->act_notif)) {
+                return -1;
+            }
+            stream->state = JSON_STREAM_OBJECT;
+        }
+        stream->pos += len + 1;
+        return 0;
+    }
+
+    /* parsed with the whole member */
+    stream->str = str;
+    stream->name = name;
+    stream->schema = schema;
+    stream->state = JSON_STREAM_VALUE;
+    return 0;
+}
+
+/**
+ * @brief Parse the buffered member at the current position.
+ */
+static int
+json_stream_parse_value(struct lyd_json_stream *stream)
+{
+    struct json_stream_frame *frame = NULL;
+    struct lyd_node **parent, *first;
+    struct attr_cont **attrs;
+    unsigned int r;
+    char *str;
+
+    if (stream->frame_count) {
+        frame = &stream->frames[stream->frame_count - 1];
+        parent = &frame->node;
+        first = frame->node->child;
+        attrs = &frame->attrs;
+    } else {
+        parent = &stream->next;
+        first = stream->result;
+        attrs = &stream->attrs;
+    }
+
+    if (!stream->str) {
+        /* parent attribute */
+        r = json_parse_data(stream->ctx, &stream->buf[stream->pos], NULL, parent, first, first ? first->prev : NULL,
+                            attrs, stream->options, stream->unres, &stream->act_notif, stream->yang_data_name);
+    } else {
+        str = stream->str;
+        stream->str = NULL;
+        r = json_parse_value(stream->ctx, &stream->buf[stream->pos], stream->value, str, stream->name,
+                             stream->schema, parent, first, first ? first->prev : NULL, attrs, stream->options,
+                             stream->unres, &stream->act_notif, stream->yang_data_name);
+    }
+    if (!r) {
+        return -1;
+    }
+
+    stream->pos += r;
+    json_stream_member_done(stream);
+    return 0;
+}
+
+/**
+ * @brief Validate the inner node of the innermost frame whose all members were parsed and leave the frame.
+ */
+static int
+json_stream_pop(struct lyd_json_stream *stream)
+{
+    struct json_stream_frame *frame = &stream->frames[stream->frame_count - 1];
+
+    if (json_node_validate(frame->node, &frame->first, frame->prev, stream->options, stream->unres)) {
+        return -1;
+    }
+
+    --stream->frame_count;
+    if (!stream->frame_count && !stream->next) {
+        stream->next = frame->node;
+    }
+    json_stream_member_done(stream);
+    return 0;
+}
+
+/**
+ * @brief Parse as much of the buffered input as possible.
+ *
+ * @param[in] last Whether there is no more input, all the remaining input is parsed then.
+ * @return 0 on success, -1 on error.
+ */
+static int
+json_stream_parse(struct lyd_json_stream *stream, int last)
+{
+    struct ly_ctx *ctx = stream->ctx;
+    struct json_stream_frame *frame;
+    struct lyd_node *node;
+    size_t len;
+    int r;
+
+    while (1) {
+        frame = stream->frame_count ? &stream->frames[stream->frame_count - 1] : NULL;
+
+        switch (stream->state) {
+        case JSON_STREAM_START:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            /* expect top-level { */
+            if (stream->buf[stream->pos] != '{') {
+                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level begin-object)");
+                return -1;
+            }
+            stream->pos++;
+            stream->state = JSON_STREAM_EMPTY;
+            break;
+        case JSON_STREAM_EMPTY:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            if (stream->buf[stream->pos] == '}') {
+                /* empty object */
+                stream->pos++;
+                stream->state = JSON_STREAM_DONE;
+                break;
+            }
+            if (json_parse_start(ctx, stream->options, stream->rpc_act, &stream->unres, &stream->reply_top,
+                                 &stream->reply_parent)) {
+                return -1;
+            }
+            stream->next = stream->reply_parent;
+            stream->state = JSON_STREAM_MEMBER;
+            break;
+        case JSON_STREAM_MEMBER:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            if (!frame && !stream->act_cont) {
+                len = stream->used - stream->pos;
+                if (!last && (len < 13) && !strncmp(&stream->buf[stream->pos], "\"yang:action\"", len)) {
+                    return 0;
+                }
+                if (!strncmp(&stream->buf[stream->pos], "\"yang:action\"", 13)) {
+                    /* the whole wrapper up to the begin-object must be available */
+                    len = 13;
+                    len += skip_ws(&stream->buf[stream->pos + len]);
+                    if (stream->buf[stream->pos + len] == ':') {
+                        ++len;
+                        len += skip_ws(&stream->buf[stream->pos + len]);
+                    }
+                    if (!last && (stream->pos + len >= stream->used)) {
+                        return 0;
+                    }
+
+                    stream->pos += 13;
+                    stream->pos += skip_ws(&stream->buf[stream->pos]);
+                    if (stream->buf[stream->pos] != ':') {
+                        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level begin-object)");
+                        return -1;
+                    }
+                    ++stream->pos;
+                    stream->pos += skip_ws(&stream->buf[stream->pos]);
+                    if (stream->buf[stream->pos] != '{') {
+                        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level yang:action object)");
+                        return -1;
+                    }
+                    ++stream->pos;
+
+                    stream->act_cont = 1;
+                    break;
+                } else {
+                    stream->act_cont = -1;
+                }
+            }
+            if (!last && !json_stream_member(stream)) {
+                return 0;
+            }
+            if (json_stream_parse_member(stream)) {
+                return -1;
+            }
+            break;
+        case JSON_STREAM_VALUE:
+            if (!last && !json_stream_scan(stream, 0)) {
+                return 0;
+            }
+            if (json_stream_parse_value(stream)) {
+                return -1;
+            }
+            break;
+        case JSON_STREAM_SKIP:
+            r = json_stream_scan(stream, 1);
+            if (r == -1) {
+                return -1;
+            }
+            /* drop the skipped input */
+            stream->pos += stream->scan;
+            stream->scan = 0;
+            if (!r && !last) {
+                return 0;
+            }
+            json_stream_member_done(stream);
+            break;
+        case JSON_STREAM_OBJECT:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            /* empty or non-empty container */
+            stream->state = (stream->buf[stream->pos] == '}') ? JSON_STREAM_NEXT : JSON_STREAM_MEMBER;
+            break;
+        case JSON_STREAM_NEXT:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            if (stream->buf[stream->pos] == ',') {
+                stream->pos++;
+                stream->state = JSON_STREAM_MEMBER;
+                break;
+            }
+
+            if (!frame) {
+                if (stream->buf[stream->pos] != '}') {
+                    /* expecting end-object */
+                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+                    return -1;
+                }
+                stream->pos++;
+                stream->state = (stream->act_cont == 1) ? JSON_STREAM_ACTION_END : JSON_STREAM_DONE;
+                break;
+            }
+
+            /* store attributes */
+            if (json_node_end(ctx, frame->node, &frame->attrs, stream->options)) {
+                return -1;
+            }
+            if (frame->node->schema->nodetype == LYS_LIST) {
+                if (stream->buf[stream->pos] != '}') {
+                    /* expecting end-object */
+                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, frame->node,
+                           "JSON data (missing list instance's end-object)");
+                    return -1;
+                }
+                stream->pos++;
+                stream->state = JSON_STREAM_INSTANCE_NEXT;
+                break;
+            }
+            if (stream->buf[stream->pos] != '}') {
+                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, frame->node, "JSON data (missing end-object)");
+                return -1;
+            }
+            stream->pos++;
+            if (json_stream_pop(stream)) {
+                return -1;
+            }
+            break;
+        case JSON_STREAM_INSTANCE:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            if (stream->buf[stream->pos] != '{') {
+                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, frame->node,
+                       "JSON data (missing list instance's begin-object)");
+                return -1;
+            }
+            stream->pos++;
+            stream->state = JSON_STREAM_MEMBER;
+            break;
+        case JSON_STREAM_INSTANCE_NEXT:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            if (stream->buf[stream->pos] == ',') {
+                node = json_list_next(ctx, frame->node, &frame->first, frame->prev, stream->options, stream->unres);
+                if (!node) {
+                    return -1;
+                }
+                frame->node = node;
+                stream->pos++;
+                stream->state = JSON_STREAM_INSTANCE;
+                break;
+            }
+            if (stream->buf[stream->pos] != ']') {
+                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_LYD, frame->node, "JSON data (missing end-array)");
+                return -1;
+            }
+            stream->pos++;
+            if (json_stream_pop(stream)) {
+                return -1;
+            }
+            break;
+        case JSON_STREAM_ACTION_END:
+            if (!json_stream_peek(stream, last)) {
+                return 0;
+            }
+            if (stream->buf[stream->pos] != '}') {
+                LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+                return -1;
+            }
+            stream->pos++;
+            stream->state = JSON_STREAM_DONE;
+            break;
+        case JSON_STREAM_DONE:
+            /* the rest of the input is ignored */
+            stream->pos = stream->used;
+            return 0;
+        case JSON_STREAM_ERROR:
+            return -1;
+        }
+    }
+}
+
+API int
+lyd_json_stream_feed(struct lyd_json_stream *stream, const char *data, size_t len)
+{
+    FUN_IN;
+
+    char *mem;
+    size_t size;
+
+    if (!stream || (!data && len)) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+    if (stream->state == JSON_STREAM_ERROR) {
+        LOGERR(stream->ctx, LY_EINVAL, "%s: parsing of the JSON data already failed.", __func__);
+        return EXIT_FAILURE;
+    }
+
+    /* append the data to the unparsed input */
+    if (stream->used + len + 1 > stream->size) {
+        for (size = stream->size ? stream->size : 1024; size < stream->used + len + 1; size *= 2);
+        mem = realloc(stream->buf, size);
+        LY_CHECK_ERR_RETURN(!mem, LOGMEM(stream->ctx); json_stream_clean(stream), EXIT_FAILURE);
+        stream->buf = mem;
+        stream->size = size;
+    }
+    memcpy(&stream->buf[stream->used], data, len);
+    stream->used += len;
+    stream->buf[stream->used] = '\0';
+
+    ly_errno = LY_SUCCESS;
+    if (json_stream_parse(stream, 0) || ly_errno) {
+        json_stream_clean(stream);
+        return EXIT_FAILURE;
+    }
+
+    /* keep only the input that could not be parsed yet */
+    if (stream->pos) {
+        stream->used -= stream->pos;
+        memmove(stream->buf, &stream->buf[stream->pos], stream->used + 1);
+        stream->pos = 0;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+API struct lyd_node *
+lyd_json_stream_finish(struct lyd_json_stream *stream)
+{
+    FUN_IN;
+
+    struct lyd_node *result = NULL;
+
+    if (!stream) {
+        LOGARG;
+        return NULL;
+    }
+    if (stream->state == JSON_STREAM_ERROR) {
+        LOGERR(stream->ctx, LY_EINVAL, "%s: parsing of the JSON data already failed.", __func__);
+        return NULL;
+    }
+
+    if (!stream->buf) {
+        /* no input at all */
+        stream->buf = strdup("");
+        LY_CHECK_ERR_RETURN(!stream->buf, LOGMEM(stream->ctx); json_stream_clean(stream), NULL);
+    }
+
+    ly_errno = LY_SUCCESS;
+    if (json_stream_parse(stream, 1) || ly_errno) {
+        json_stream_clean(stream);
+        return NULL;
+    }
+
+    if (!stream->unres) {
+        /* empty object */
+        if (stream->options & LYD_OPT_DATA_ADD_YANGLIB) {
+            result = ly_ctx_info(stream->ctx);
+        }
+        lyd_validate(&result, stream->options, stream->ctx);
+    } else {
+        result = json_parse_finish(stream->ctx, stream->result, stream->options, stream->rpc_act, stream->data_tree,
+                                   stream->reply_top, stream->reply_parent, stream->act_notif, stream->attrs,
+                                   stream->unres);
+        stream->unres = NULL;
+        stream->attrs = NULL;
+        stream->result = stream->reply_top = stream->reply_parent = stream->next = stream->iter = NULL;
+    }
+    if (ly_errno) {
+        lyd_free_withsiblings(result);
+        result = NULL;
+    }
+
+    /* the stream cannot be used anymore */
+    stream->state = JSON_STREAM_ERROR;
+    return result;
+}
+
+API void
+lyd_json_stream_free(struct lyd_json_stream *stream)
+{
+    FUN_IN;
+
+    if (!stream) {
+        return;
+    }
+
+    json_stream_clean(stream);
+    free(stream->frames);
+    free(stream->buf);
+    free(stream);
+}
@@ -36,6 +36,15 @@ lyb_read(const char *data, uint8_t *buf, size_t count, struct lyb_state *lybs)
 
     assert(data && lybs);
 
+    if (lybs->version != LYB_VERSION_1) {
+        /* no chunks, the subtree sizes are known */
+        if (buf) {
+            memcpy(buf, data, count);
+        }
+        lybs->offset += count;
+        return count;
+    }
+
     while (1) {
         /* check for fully-read (empty) data chunks */
         to_read = count;
@@ -90,6 +99,41 @@ lyb_read(const char *data, uint8_t *buf, size_t count, struct lyb_state *lybs)
     return ret;
 }
 
+static int
+lyb_read_varint(size_t *num, const char *data, struct lyb_state *lybs)
+{
+    int ret = 0;
+    uint8_t byte;
+
+    *num = 0;
+    do {
+        if (ret == LYB_VARINT_MAX_BYTES) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB size.");
+            return -1;
+        }
+        byte = data[ret];
+        *num |= (size_t)(byte & 0x7f) << (7 * ret);
+        ++ret;
+    } while (byte & 0x80);
+
+    lybs->offset += ret;
+    return ret;
+}
+
+/**
+ * @brief Get the number of bytes left in the current chunk of the current subtree,
+ * which is the whole rest of the subtree in LYB v2.
+ */
+static size_t
+lyb_left(struct lyb_state *lybs)
+{
+    if (lybs->version == LYB_VERSION_1) {
+        return lybs->written[lybs->used - 1];
+    }
+
+    return lybs->written[lybs->used - 1] - lybs->offset;
+}
+
 static int
 lyb_read_number(void *num, size_t num_size, size_t bytes, const char *data, struct lyb_state *lybs)
 {
@@ -154,7 +198,7 @@ lyb_read_string(const char *data, char **str, int with_length, struct lyb_state
         LYB_HAVE_READ_GOTO(r, data, error);
     } else {
         /* read until the end of this subtree */
-        len = lybs->written[lybs->used - 1];
+        len = lyb_left(lybs);
         if (lybs->position[lybs->used - 1]) {
             next_chunk = 1;
         }
@@ -192,10 +236,46 @@ error:
     return -1;
 }
 
+/**
+ * @brief Read a string (until the end of the current subtree) directly into the dictionary.
+ * Unless the string spans several chunks, it is stored contiguously in the data and is inserted
+ * straight from them (for lyd_parse_fd() from the mapped file image) without an intermediate copy.
+ */
+static int
+lyb_read_string_dict(const char *data, const char **str, struct lyb_state *lybs)
+{
+    int i, ret;
+    size_t len;
+    char *buf;
+
+    len = lyb_left(lybs);
+    for (i = 0; (lybs->version == LYB_VERSION_1) && (i < lybs->used); ++i) {
+        if (lybs->position[i] && (lybs->written[i] <= len)) {
+            /* chunk meta information in the way (or right after the string, for simplicity) */
+            break;
+        }
+    }
+
+    if ((lybs->version == LYB_VERSION_1) && (i < lybs->used)) {
+        /* fallback, concatenate the chunks */
+        ret = lyb_read_string(data, &buf, 0, lybs);
+        if (ret > -1) {
+            *str = lydict_insert_zc(lybs->ctx, buf);
+        }
+        return ret;
+    }
+
+    *str = lydict_insert(lybs->ctx, len ? data : "", len);
+    LY_CHECK_RETURN(!*str, -1);
+
+    /* just move in the data */
+    return lyb_read(data, NULL, len, lybs);
+}
+
 static void
 lyb_read_stop_subtree(struct lyb_state *lybs)
 {
-    if (lybs->written[lybs->used - 1]) {
+    if (lyb_left(lybs)) {
         LOGINT(lybs->ctx);
     }
 
@@ -205,6 +285,8 @@ lyb_read_stop_subtree(struct lyb_state *lybs)
 static int
 lyb_read_start_subtree(const char *data, struct lyb_state *lybs)
 {
+    int r;
+    size_t size;
     uint8_t meta_buf[LYB_META_BYTES];
 
     if (lybs->used == lybs->size) {
@@ -215,6 +297,23 @@ lyb_read_start_subtree(const char *data, struct lyb_state *lybs)
         LY_CHECK_ERR_RETURN(!lybs->written || !lybs->position || !lybs->inner_chunks, LOGMEM(lybs->ctx), -1);
     }
 
+    if (lybs->version != LYB_VERSION_1) {
+        /* whole subtree size, remember where it ends */
+        r = lyb_read_varint(&size, data, lybs);
+        LY_CHECK_RETURN(r < 0, -1);
+
+        if (lybs->used && (lybs->offset + size > lybs->written[lybs->used - 1])) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB subtree size.");
+            return -1;
+        }
+
+        ++lybs->used;
+        lybs->written[lybs->used - 1] = lybs->offset + size;
+        lybs->inner_chunks[lybs->used - 1] = 0;
+        lybs->position[lybs->used - 1] = 0;
+        return r;
+    }
+
     memcpy(meta_buf, data, LYB_META_BYTES);
 
     ++lybs->used;
@@ -281,7 +380,7 @@ error:
 }
 
 static struct lyd_node *
-lyb_new_node(const struct lys_node *schema, int options)
+lyb_new_node(const struct lys_node *schema, int options, int lazy, struct ly_arena *arena)
 {
     struct lyd_node *node;
 
@@ -291,15 +390,16 @@ lyb_new_node(const struct lys_node *schema, int options)
     case LYS_NOTIF:
     case LYS_RPC:
     case LYS_ACTION:
-        node = calloc(sizeof(struct lyd_node), 1);
+        /* the children may be left unparsed, make room for them */
+        node = lyd_node_calloc(lazy ? sizeof(struct lyd_node_lazy) : sizeof(struct lyd_node), arena);
         break;
     case LYS_LEAF:
     case LYS_LEAFLIST:
-        node = calloc(sizeof(struct lyd_node_leaf_list), 1);
+        node = lyd_node_calloc(sizeof(struct lyd_node_leaf_list), arena);
         break;
     case LYS_ANYDATA:
     case LYS_ANYXML:
-        node = calloc(sizeof(struct lyd_node_anydata), 1);
+        node = lyd_node_calloc(sizeof(struct lyd_node_anydata), arena);
         break;
     default:
         return NULL;
@@ -325,7 +425,6 @@ static int
 lyb_parse_anydata(struct lyd_node *node, const char *data, struct lyb_state *lybs)
 {
     int r, ret = 0;
-    char *str = NULL;
     struct lyd_node_anydata *any = (struct lyd_node_anydata *)node;
 
     /* read value type */
@@ -341,11 +440,8 @@ lyb_parse_anydata(struct lyd_node *node, const char *data, struct lyb_state *lyb
         ret += (r = lyb_read_string(data, &any->value.mem, 0, lybs));
         LYB_HAVE_READ_RETURN(r, data, -1);
     } else {
-        ret += (r = lyb_read_string(data, &str, 0, lybs));
+        ret += (r = lyb_read_string_dict(data, &any->value.str, lybs));
         LYB_HAVE_READ_RETURN(r, data, -1);
-
-        /* add to dictionary */
-        any->value.str = lydict_insert_zc(node->schema->module->ctx, str);
     }
 
     return ret;
@@ -358,16 +454,12 @@ lyb_parse_val_1(struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_fl
 {
     int r, ret;
     size_t i;
-    char *str = NULL;
     uint8_t byte;
     uint64_t num;
 
     if (value_flags & LY_VALUE_USER) {
         /* just read value_str */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            *value_str = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_string_dict(data, value_str, lybs);
         return ret;
     }
 
@@ -390,19 +482,13 @@ lyb_parse_val_1(struct lys_type *type, LY_DATA_TYPE value_type, uint8_t value_fl
     case LY_TYPE_IDENT:
     case LY_TYPE_UNION:
         /* we do not actually fill value now, but value_str */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            *value_str = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_string_dict(data, value_str, lybs);
         break;
     case LY_TYPE_BINARY:
     case LY_TYPE_STRING:
     case LY_TYPE_UNKNOWN:
         /* read string */
-        ret = lyb_read_string(data, &str, 0, lybs);
-        if (ret > -1) {
-            value->string = lydict_insert_zc(lybs->ctx, str);
-        }
+        ret = lyb_read_string_dict(data, &value->string, lybs);
         break;
     case LY_TYPE_BITS:
         value->bit = calloc(type->info.bits.count, sizeof *value->bit);
@@ -476,9 +562,8 @@ lyb_parse_val_2(struct lys_type *type, struct lyd_node_leaf_list *leaf, struct l
     struct lys_module *mod;
     struct lys_type *rtype = NULL;
     char num_str[22], *str;
-    int64_t frac, num;
     uint32_t i, str_len;
-    uint8_t *value_flags, dig;
+    uint8_t *value_flags;
     const char **value_str;
     LY_DATA_TYPE value_type;
     lyd_val *value;
@@ -627,21 +712,7 @@ lyb_parse_val_2(struct lys_type *type, struct lyd_node_leaf_list *leaf, struct l
         *value_str = lydict_insert(ctx, num_str, 0);
         break;
     case LY_TYPE_DEC64:
-        num = value->dec64 / (int64_t)rtype->info.dec64.div;
-        frac = value->dec64 % (int64_t)rtype->info.dec64.div;
-        dig = rtype->info.dec64.dig;
-
-        /* frac should always be positive, remove trailing zeros */
-        if (frac < 0) {
-            frac *= -1;
-        }
-        while ((dig > 1) && !(frac % 10)) {
-            frac /= 10;
-            --dig;
-        }
-
-        /* handle special case of int64_t not supporting printing -0 */
-        snprintf(num_str, sizeof(num_str), "%s%"PRId64".%.*"PRId64, (num == 0) && (value->dec64 < 0) ? "-" : "", num, dig, frac);
+        dec64_to_str(value->dec64, rtype->info.dec64.dig, num_str, sizeof num_str);
         *value_str = lydict_insert(ctx, num_str, 0);
         break;
     default:
@@ -681,8 +752,10 @@ static int
 lyb_parse_value(struct lys_type *type, struct lyd_node_leaf_list *leaf, struct lyd_attr *attr, const char *data,
                 struct unres_data *unres, struct lyb_state *lybs)
 {
-    int r, ret = 0;
+    int r, ret = 0, found;
     uint8_t start_byte;
+    size_t idx;
+    struct lys_type *member;
 
     const char **value_str;
     lyd_val *value;
@@ -720,13 +793,31 @@ lyb_parse_value(struct lys_type *type, struct lyd_node_leaf_list *leaf, struct l
         *value_flags |= LY_VALUE_UNRES;
     }
 
+    if ((type->base == LY_TYPE_UNION) && !(*value_flags & LY_VALUE_USER) && (lybs->version != LYB_VERSION_1)
+            && !type->info.uni.has_ptr_type && (*value_type != LY_TYPE_UNION)) {
+        /* value stored natively as one of the union member types, learn which one */
+        ret += (r = lyb_read_varint(&idx, data, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+
+        member = NULL;
+        do {
+            found = 0;
+            member = lyp_get_next_union_type(type, member, &found);
+        } while (member && idx--);
+        if (!member || (member->base != *value_type)) {
+            LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB union member.");
+            return -1;
+        }
+
+        /* now it is just a value of the member type */
+        type = member;
+    }
+
     ret += (r = lyb_parse_val_1(type, *value_type, *value_flags, data, value_str, value, lybs));
     LYB_HAVE_READ_RETURN(r, data, -1);
 
-    /* union is handled specially */
-    if ((type->base == LY_TYPE_UNION) && !(*value_flags & LY_VALUE_USER)) {
-        assert(*value_type == LY_TYPE_STRING);
-
+    /* union stored as a string is handled specially */
+    if ((type->base == LY_TYPE_UNION) && !(*value_flags & LY_VALUE_USER) && (*value_type == LY_TYPE_STRING)) {
         *value_str = value->string;
         value->string = NULL;
         *value_type = LY_TYPE_UNION;
@@ -828,9 +919,9 @@ lyb_parse_attributes(struct lyd_node *node, const char *data, int options, struc
         if (!mod || !ext) {
             /* unknown attribute, skip it */
             do {
-                ret += (r = lyb_read(data, NULL, lybs->written[lybs->used - 1], lybs));
+                ret += (r = lyb_read(data, NULL, lyb_left(lybs), lybs));
                 LYB_HAVE_READ_GOTO(r, data, error);
-            } while (lybs->written[lybs->used - 1]);
+            } while (lyb_left(lybs));
             goto stop_subtree;
         }
 
@@ -989,6 +1080,11 @@ lyb_skip_subtree(const char *data, struct lyb_state *lybs)
 {
     int r, ret = 0;
 
+    if (lybs->version != LYB_VERSION_1) {
+        /* just jump to its end */
+        return lyb_read(data, NULL, lyb_left(lybs), lybs);
+    }
+
     do {
         /* first skip any meta information inside */
         r = lybs->inner_chunks[lybs->used - 1] * LYB_META_BYTES;
@@ -1003,12 +1099,31 @@ lyb_skip_subtree(const char *data, struct lyb_state *lybs)
     return ret;
 }
 
+/**
+ * @brief Release a reference of a LYB image, free it with the last one.
+ *
+ * @param[in] img Image to release, may be NULL.
+ */
+static void
+lyb_image_release(struct lyb_image *img)
+{
+    /* nodes of one image may be freed in several threads */
+    if (!img || __sync_sub_and_fetch(&img->refs, 1)) {
+        return;
+    }
+
+    free(img->data);
+    free(img->models);
+    free(img);
+}
+
 static int
 lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **first_sibling, const char *yang_data_name,
         int options, struct unres_data *unres, struct lyb_state *lybs)
 {
-    int r, ret = 0;
+    int r, ret = 0, i;
     struct lyd_node *node = NULL, *iter;
+    struct lyd_node_lazy *lazy;
     const struct lys_module *mod;
     struct lys_node *snode;
 
@@ -1046,7 +1161,7 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
     /*
      * read the node
      */
-    node = lyb_new_node(snode, options);
+    node = lyb_new_node(snode, options, lybs->img ? 1 : 0, unres->arena);
     if (!node) {
         goto error;
     }
@@ -1100,14 +1215,39 @@ lyb_parse_subtree(const char *data, struct lyd_node *parent, struct lyd_node **f
         *first_sibling = node;
     }
 
+    if (lybs->img && !(snode->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+        /* parsed lazily, but list keys are always needed (list hash, predicates) */
+        if (snode->nodetype == LYS_LIST) {
+            for (i = 0; (i < ((struct lys_node_list *)snode)->keys_size) && lyb_left(lybs); ++i) {
+                ret += (r = lyb_parse_subtree(data, node, NULL, NULL, options, unres, lybs));
+                LYB_HAVE_READ_GOTO(r, data, error);
+            }
+        }
+
+        if (lyb_left(lybs)) {
+            /* remember the rest of the children and skip them */
+            lazy = (struct lyd_node_lazy *)node;
+            lazy->img = lybs->img;
+            __sync_add_and_fetch(&lazy->img->refs, 1);
+            lazy->data = data;
+            lazy->size = lyb_left(lybs);
+            node->lazy = 1;
+            __sync_add_and_fetch(&lybs->ctx->lyb_lazy_count, 1);
+
+            ret += (r = lyb_read(data, NULL, lazy->size, lybs));
+            LYB_HAVE_READ_GOTO(r, data, error);
+        }
+    }
+
     /* read all descendants */
-    while (lybs->written[lybs->used - 1]) {
+    while (lyb_left(lybs)) {
         ret += (r = lyb_parse_subtree(data, node, NULL, NULL, options, unres, lybs));
         LYB_HAVE_READ_GOTO(r, data, error);
     }
 
-    /* make containers default if should be */
-    if ((node->schema->nodetype == LYS_CONTAINER) && !((struct lys_node_container *)node->schema)->presence) {
+    /* make containers default if should be (known once all the children are parsed) */
+    if ((node->schema->nodetype == LYS_CONTAINER) && !((struct lys_node_container *)node->schema)->presence
+            && !node->lazy) {
         LY_TREE_FOR(node->child, iter) {
             if (!iter->dflt) {
                 break;
@@ -1195,14 +1335,57 @@ lyb_parse_magic_number(const char *data, struct lyb_state *lybs)
 }
 
 static int
-lyb_parse_header(const char *data, struct lyb_state *lybs)
+lyb_parse_header(const char *data, int *offsets, struct lyb_state *lybs)
 {
     int ret = 0;
-    uint8_t byte = 0;
+    uint8_t byte = 0, version, flags;
 
-    /* TODO version, any flags? */
     ret += lyb_read(data, (uint8_t *)&byte, sizeof byte, lybs);
+    version = byte & LYB_VERSION_MASK;
+    flags = byte & ~LYB_VERSION_MASK;
+
+    if ((version != LYB_VERSION_1) && (version != LYB_VERSION_2)) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Unsupported LYB format version %u.", version);
+        return -1;
+    }
+    if ((version == LYB_VERSION_1) ? flags : (flags & ~LYB_HEADER_OFFSETS)) {
+        LOGERR(lybs->ctx, LY_EINVAL, "Invalid LYB header flags \"0x%02x\".", flags);
+        return -1;
+    }
+
+    /* the following data are read according to the version */
+    lybs->version = version;
+    lybs->offset = 0;
+    *offsets = (flags & LYB_HEADER_OFFSETS) ? 1 : 0;
+
+    return ret;
+}
+
+/**
+ * @brief Read the offsets of the top-level subtrees of LYB v2 data.
+ *
+ * @param[in] data Data to read from.
+ * @param[out] last Offset of the last subtree relative to the end of the offsets, optional.
+ * @param[in] lybs LYB state.
+ * @return Number of bytes read, -1 on error.
+ */
+static int
+lyb_parse_offsets(const char *data, size_t *last, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    size_t count, i, offset = 0;
+
+    ret += (r = lyb_read_varint(&count, data, lybs));
+    LYB_HAVE_READ_RETURN(r, data, -1);
 
+    for (i = 0; i < count; ++i) {
+        ret += (r = lyb_read_varint(&offset, data, lybs));
+        LYB_HAVE_READ_RETURN(r, data, -1);
+    }
+
+    if (last) {
+        *last = offset;
+    }
     return ret;
 }
 
@@ -1210,7 +1393,8 @@ struct lyd_node *
 lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *data_tree,
               const char *yang_data_name, int *parsed)
 {
-    int r = 0, ret = 0;
+    int r = 0, ret = 0, offsets, len;
+    const char *start = data;
     struct lyd_node *node = NULL, *next, *act_notif = NULL;
     struct unres_data *unres = NULL;
     struct lyb_state lybs;
@@ -1229,21 +1413,54 @@ lyd_parse_lyb(struct ly_ctx *ctx, const char *data, int options, const struct ly
     lybs.models = NULL;
     lybs.mod_count = 0;
     lybs.ctx = ctx;
+    lybs.version = LYB_VERSION_1;
+    lybs.offset = 0;
+    lybs.img = NULL;
 
     unres = calloc(1, sizeof *unres);
     LY_CHECK_ERR_GOTO(!unres, LOGMEM(ctx), finish);
+    if (options & LYD_OPT_ARENA) {
+        unres->arena = ly_arena_new();
+        LY_CHECK_GOTO(!unres->arena, finish);
+    }
 
     /* read magic number */
     ret += (r = lyb_parse_magic_number(data, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
     /* read header */
-    ret += (r = lyb_parse_header(data, &lybs));
+    ret += (r = lyb_parse_header(data, &offsets, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
+    if ((options & LYD_OPT_LYB_LAZY) && (lybs.version != LYB_VERSION_1)) {
+        /* v1 subtrees cannot be parsed separately, otherwise keep a copy of the data for parsing the children later */
+        len = lyd_lyb_data_length(start);
+        LY_CHECK_ERR_GOTO(len < 0, LOGERR(ctx, LY_EINVAL, "Invalid LYB data."), finish);
+
+        lybs.img = calloc(1, sizeof *lybs.img);
+        LY_CHECK_ERR_GOTO(!lybs.img, LOGMEM(ctx), finish);
+        lybs.img->refs = 1;
+        /* the children are parsed in the thread accessing them, never in parallel */
+        lybs.img->options = options & ~LYD_OPT_VAL_PARALLEL;
+        lybs.img->data = malloc(len);
+        LY_CHECK_ERR_GOTO(!lybs.img->data, LOGMEM(ctx), finish);
+        memcpy(lybs.img->data, start, len);
+        data = lybs.img->data + ret;
+    }
+
     /* read used models */
     ret += (r = lyb_parse_data_models(data, options, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
+    if (lybs.img) {
+        lybs.img->models = lybs.models;
+        lybs.img->mod_count = lybs.mod_count;
+    }
+
+    if (offsets) {
+        /* all the subtrees are read in order, offsets not needed */
+        ret += (r = lyb_parse_offsets(data, NULL, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
 
     /* read subtree(s) */
     while (data[0]) {
@@ -1290,10 +1507,17 @@ finish:
     free(lybs.written);
     free(lybs.position);
     free(lybs.inner_chunks);
-    free(lybs.models);
+    if (lybs.img) {
+        /* the models are kept with the image (if still needed) */
+        lybs.img->models = lybs.models;
+        lyb_image_release(lybs.img);
+    } else {
+        free(lybs.models);
+    }
     if (unres) {
         free(unres->node);
         free(unres->type);
+        ly_arena_release(unres->arena);
         free(unres);
     }
 
@@ -1303,15 +1527,163 @@ finish:
     return node;
 }
 
+int
+lyb_lazy_load(struct lyd_node *node)
+{
+    struct lyd_node_lazy *lazy = (struct lyd_node_lazy *)node;
+    struct lyd_node *root, *iter;
+    struct lyb_image *img;
+    struct unres_data unres;
+    struct lyb_state lybs;
+    const char *data;
+    int r, ret = EXIT_FAILURE;
+
+    assert(node->lazy);
+
+    /* parsed only once */
+    img = lazy->img;
+    data = lazy->data;
+    node->lazy = 0;
+    lazy->img = NULL;
+    __sync_sub_and_fetch(&node->schema->module->ctx->lyb_lazy_count, 1);
+
+    memset(&unres, 0, sizeof unres);
+    memset(&lybs, 0, sizeof lybs);
+    lybs.written = malloc(LYB_STATE_STEP * sizeof *lybs.written);
+    lybs.position = malloc(LYB_STATE_STEP * sizeof *lybs.position);
+    lybs.inner_chunks = malloc(LYB_STATE_STEP * sizeof *lybs.inner_chunks);
+    LY_CHECK_ERR_GOTO(!lybs.written || !lybs.position || !lybs.inner_chunks, LOGMEM(node->schema->module->ctx), finish);
+    lybs.size = LYB_STATE_STEP;
+    lybs.models = img->models;
+    lybs.mod_count = img->mod_count;
+    lybs.ctx = node->schema->module->ctx;
+    lybs.version = LYB_VERSION_2;
+    lybs.img = img;
+
+    /* continue in the subtree of the node, its children are all that is left */
+    lybs.used = 1;
+    lybs.written[0] = lazy->size;
+    lybs.position[0] = 0;
+    lybs.inner_chunks[0] = 0;
+
+    while (lyb_left(&lybs)) {
+        r = lyb_parse_subtree(data, node, NULL, NULL, img->options, &unres, &lybs);
+        if (r < 0) {
+            goto finish;
+        }
+        data += r;
+    }
+
+    /* make containers default if should be */
+    if ((node->schema->nodetype == LYS_CONTAINER) && !((struct lys_node_container *)node->schema)->presence) {
+        LY_TREE_FOR(node->child, iter) {
+            if (!iter->dflt) {
+                break;
+            }
+        }
+
+        if (!iter) {
+            node->dflt = 1;
+        }
+    }
+
+    /* resolve any references in the new nodes */
+    if (unres.count) {
+        for (root = node; root->parent; root = root->parent);
+        while (root->prev->next) {
+            root = root->prev;
+        }
+        if (resolve_unres_data(lybs.ctx, &unres, &root, img->options)) {
+            goto finish;
+        }
+    }
+
+    ret = EXIT_SUCCESS;
+
+finish:
+    free(lybs.written);
+    free(lybs.position);
+    free(lybs.inner_chunks);
+    free(unres.node);
+    free(unres.type);
+    lyb_image_release(img);
+    return ret;
+}
+
+void
+lyb_lazy_free(struct lyd_node *node)
+{
+    struct lyd_node_lazy *lazy = (struct lyd_node_lazy *)node;
+
+    assert(node->lazy);
+
+    node->lazy = 0;
+    lyb_image_release(lazy->img);
+    lazy->img = NULL;
+    __sync_sub_and_fetch(&node->schema->module->ctx->lyb_lazy_count, 1);
+}
+
+int
+lyb_lazy_load_tree(const struct lyd_node *node, int siblings)
+{
+    struct lyd_node *iter;
+
+    if (!node || !__sync_add_and_fetch(&node->schema->module->ctx->lyb_lazy_count, 0)) {
+        /* nothing parsed lazily in the context */
+        return EXIT_SUCCESS;
+    }
+
+    if (siblings) {
+        /* the siblings may not be parsed yet themselves */
+        if (node->parent && node->parent->lazy && lyb_lazy_load(node->parent)) {
+            return EXIT_FAILURE;
+        }
+        for (; node->prev->next; node = node->prev);
+    }
+
+    LY_TREE_FOR((struct lyd_node *)node, iter) {
+        if (lyd_lyb_load(iter)) {
+            return EXIT_FAILURE;
+        }
+        if (!siblings) {
+            break;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+API int
+lyd_lyb_load(struct lyd_node *node)
+{
+    FUN_IN;
+
+    struct lyd_node *next, *elem;
+
+    if (!node) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    LY_TREE_DFS_BEGIN(node, next, elem) {
+        /* parse the children before descending into them */
+        if (elem->lazy && lyb_lazy_load(elem)) {
+            return EXIT_FAILURE;
+        }
+        LY_TREE_DFS_END(node, next, elem);
+    }
+
+    return EXIT_SUCCESS;
+}
+
 API int
 lyd_lyb_data_length(const char *data)
 {
     FUN_IN;
 
     struct lyb_state lybs;
-    int r = 0, ret = 0, i;
-    size_t len;
-    uint8_t buf[LYB_SIZE_MAX];
+    int r = 0, ret = 0, i, offsets;
+    size_t len, last;
 
     if (!data) {
         return -1;
@@ -1326,13 +1698,15 @@ lyd_lyb_data_length(const char *data)
     lybs.models = NULL;
     lybs.mod_count = 0;
     lybs.ctx = NULL;
+    lybs.version = LYB_VERSION_1;
+    lybs.offset = 0;
 
     /* read magic number */
     ret += (r = lyb_parse_magic_number(data, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
     /* read header */
-    ret += (r = lyb_parse_header(data, &lybs));
+    ret += (r = lyb_parse_header(data, &offsets, &lybs));
     LYB_HAVE_READ_GOTO(r, data, finish);
 
     /* read model count */
@@ -1347,12 +1721,20 @@ lyd_lyb_data_length(const char *data)
         LYB_HAVE_READ_GOTO(r, data, finish);
 
         /* model name */
-        ret += (r = lyb_read(data, buf, len, &lybs));
+        ret += (r = lyb_read(data, NULL, len, &lybs));
         LYB_HAVE_READ_GOTO(r, data, finish);
 
         /* revision */
-        ret += (r = lyb_read(data, buf, 2, &lybs));
+        ret += (r = lyb_read(data, NULL, 2, &lybs));
+        LYB_HAVE_READ_GOTO(r, data, finish);
+    }
+
+    if (offsets) {
+        /* jump right to the last subtree */
+        ret += (r = lyb_parse_offsets(data, &last, &lybs));
         LYB_HAVE_READ_GOTO(r, data, finish);
+        ret += last;
+        data += last;
     }
 
     while (data[0]) {
@@ -99,11 +99,82 @@ xml_get_value(struct lyd_node *node, struct lyxml_elem *xml, int editbits)
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Element read directly from the input. Only its start tag is parsed when it is passed to xml_parse_data(),
+ * its content is parsed while the data node children are being created.
+ */
+struct xml_stream {
+    const char *data;       /**< current position in the input data */
+    char *prefix;           /**< element's prefix to check the end tag */
+    int closed;             /**< flag whether the end tag was already parsed */
+};
+
+/* logs directly */
+static int
+xml_stream_finish(struct ly_ctx *ctx, struct lyxml_elem *xml, struct xml_stream *stream)
+{
+    unsigned int len;
+
+    if (!stream->closed) {
+        if (lyxml_parse_elem_content(ctx, stream->data, &len, xml, stream->prefix, 0)) {
+            return EXIT_FAILURE;
+        }
+        stream->data += len;
+        stream->closed = 1;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* logs directly */
+static int
+xml_stream_skip(struct ly_ctx *ctx, struct lyxml_elem *xml, struct xml_stream *stream)
+{
+    struct lyxml_elem *child;
+    unsigned int len;
+    char *str;
+    int r;
+
+    while (!stream->closed) {
+        r = lyxml_parse_elem_next(ctx, stream->data, &len, xml, stream->prefix, &str);
+        free(str);
+        if (r == -1) {
+            return EXIT_FAILURE;
+        }
+        stream->data += len;
+        if (r == 1) {
+            /* skip the whole child */
+            child = lyxml_parse_elem(ctx, stream->data, &len, xml, 0);
+            if (!child) {
+                return EXIT_FAILURE;
+            }
+            lyxml_free(ctx, child);
+            stream->data += len;
+        } else if (!r) {
+            stream->closed = 1;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* logs directly, returns 1 if the element is to be ignored */
+static int
+xml_check_mixed(struct ly_ctx *ctx, struct lyxml_elem *xml, int options)
+{
+    if (options & LYD_OPT_STRICT) {
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, xml, "XML element with mixed content");
+        return -1;
+    }
+
+    return 1;
+}
+
 /* logs directly */
 static int
 xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *parent, struct lyd_node *first_sibling,
                struct lyd_node *prev, int options, struct unres_data *unres, struct lyd_node **result,
-               struct lyd_node **act_notif, const char *yang_data_name)
+               struct lyd_node **act_notif, const char *yang_data_name, struct xml_stream *stream)
 {
     const struct lys_module *mod = NULL;
     struct lyd_node *diter, *dlast;
@@ -113,19 +184,25 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
     struct lyd_attr *dattr, *dattr_iter;
     struct lyxml_attr *attr;
     struct lyxml_elem *child, *next;
-    int i, j, havechildren, r, editbits = 0, filterflag = 0, found;
+    struct xml_stream child_stream;
+    int i, j, havechildren, r, editbits = 0, filterflag = 0, found, child_elems = 0;
+    unsigned int len;
+    uint32_t unres_count;
     uint8_t pos;
     int ret = 0;
     const char *str = NULL;
-    char *msg;
+    char *msg, *text;
 
     assert(xml);
     assert(result);
     *result = NULL;
 
+    if (stream && (!xml->ns || !xml->ns->value) && xml_stream_finish(ctx, xml, stream)) {
+        return -1;
+    }
+
     if (xml->flags & LYXML_ELEM_MIXED) {
-        if (options & LYD_OPT_STRICT) {
-            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, xml, "XML element with mixed content");
+        if (xml_check_mixed(ctx, xml, options) == -1) {
             return -1;
         } else {
             return 0;
@@ -210,8 +287,23 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
         }
     }
 
+    if (stream && (!schema || !(schema->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF | LYS_RPC | LYS_ACTION)))) {
+        /* terminal and unknown nodes are read whole, only inner nodes have their children read one by one */
+        if (xml_stream_finish(ctx, xml, stream)) {
+            return -1;
+        }
+        if ((xml->flags & LYXML_ELEM_MIXED) && (xml_check_mixed(ctx, xml, options) == -1)) {
+            return -1;
+        } else if (xml->flags & LYXML_ELEM_MIXED) {
+            return 0;
+        }
+    }
+
     mod = lys_node_module(schema);
     if (!mod || !mod->implemented || mod->disabled) {
+        if (stream && xml_stream_skip(ctx, xml, stream)) {
+            return -1;
+        }
         if (options & LYD_OPT_STRICT) {
             LOGVAL(ctx, LYE_INELEM, (parent ? LY_VLOG_LYD : LY_VLOG_STR), (parent ? (void *)parent : (void *)"/") , xml->name);
             return -1;
@@ -237,17 +329,17 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
                 return -1;
             }
         }
-        *result = calloc(1, sizeof **result);
+        *result = lyd_node_calloc(sizeof **result, unres->arena);
         havechildren = 1;
         break;
     case LYS_LEAF:
     case LYS_LEAFLIST:
-        *result = calloc(1, sizeof(struct lyd_node_leaf_list));
+        *result = lyd_node_calloc(sizeof(struct lyd_node_leaf_list), unres->arena);
         havechildren = 0;
         break;
     case LYS_ANYXML:
     case LYS_ANYDATA:
-        *result = calloc(1, sizeof(struct lyd_node_anydata));
+        *result = lyd_node_calloc(sizeof(struct lyd_node_anydata), unres->arena);
         havechildren = 0;
         break;
     default:
@@ -272,7 +364,7 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
                 LOGVAL(ctx, LYE_INORDER, LY_VLOG_LYD, *result, schema->name, diter->schema->name);
                 LOGVAL(ctx, LYE_SPEC, LY_VLOG_PREV, NULL, "Invalid position of the key \"%s\" in a list \"%s\".",
                        schema->name, parent->schema->name);
-                free(*result);
+                lyd_node_free_mem(*result);
                 *result = NULL;
                 return -1;
             } else {
@@ -504,15 +596,78 @@ attr_error:
 #endif
 
     /* first part of validation checks */
+    unres_count = unres->count;
     if (lyv_data_context(*result, options, unres)) {
         goto error;
     }
 
     /* process children */
-    if (havechildren && xml->child) {
+    if (havechildren && stream) {
+        diter = dlast = NULL;
+        while (!stream->closed) {
+            r = lyxml_parse_elem_next(ctx, stream->data, &len, xml, stream->prefix, &text);
+            if (r == -1) {
+                goto error;
+            }
+            stream->data += len;
+
+            if (!r) {
+                stream->closed = 1;
+            } else if (r == 2) {
+                for (i = 0; is_xmlws(text[i]); ++i);
+                if (!text[i]) {
+                    /* only formatting */
+                    free(text);
+                    continue;
+                }
+
+                /* text content, it is an error unless it is mixed with child elements, even the ignored ones */
+                lydict_remove(ctx, xml->content);
+                xml->content = lydict_insert_zc(ctx, text);
+                if (child_elems) {
+                    goto mixed;
+                }
+            } else {
+                if (xml->content && xml->content[0]) {
+                    goto mixed;
+                }
+                ++child_elems;
+
+                child = lyxml_parse_elem_start(ctx, stream->data, &len, xml, &child_stream.prefix, &child_stream.closed);
+                if (!child) {
+                    goto error;
+                }
+                child_stream.data = stream->data + len;
+
+                r = xml_parse_data(ctx, child, *result, (*result)->child, dlast, options, unres, &diter, act_notif,
+                                   yang_data_name, &child_stream);
+                stream->data = child_stream.data;
+                free(child_stream.prefix);
+                lyxml_free(ctx, child);
+                if (r) {
+                    goto error;
+                }
+                if (diter && !diter->next) {
+                    /* the child was parsed/created and it was placed as the last child. The child can be inserted
+                     * out of order (not as the last one) in case it is a list's key present out of the correct order */
+                    dlast = diter;
+                }
+            }
+        }
+
+        if (xml->content && xml->content[0]) {
+            msg = malloc(22 + strlen(xml->content) + 1);
+            LY_CHECK_ERR_GOTO(!msg, LOGMEM(ctx), error);
+            sprintf(msg, "node with text data \"%s\"", xml->content);
+            LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, xml, msg);
+            free(msg);
+            goto error;
+        }
+    } else if (havechildren && xml->child) {
         diter = dlast = NULL;
         LY_TREE_FOR_SAFE(xml->child, next, child) {
-            r = xml_parse_data(ctx, child, *result, (*result)->child, dlast, options, unres, &diter, act_notif, yang_data_name);
+            r = xml_parse_data(ctx, child, *result, (*result)->child, dlast, options, unres, &diter, act_notif,
+                               yang_data_name, NULL);
             if (r) {
                 goto error;
             } else if (options & LYD_OPT_DESTRUCT) {
@@ -546,6 +701,24 @@ attr_error:
 
     return ret;
 
+mixed:
+    /* the same as if the whole element was read first, ignore it with all the children parsed so far */
+    if (xml_check_mixed(ctx, xml, options) == -1) {
+        goto error;
+    }
+    if (xml_stream_skip(ctx, xml, stream)) {
+        goto error;
+    }
+    unres->count = unres_count;
+    for (diter = *act_notif; diter && (diter != *result); diter = diter->parent);
+    if (diter) {
+        /* the action/notification was inside */
+        *act_notif = NULL;
+    }
+    lyd_free(*result);
+    *result = NULL;
+    return 0;
+
 unlink_node_error:
     lyd_unlink_internal(*result, 2);
 error:
@@ -561,52 +734,27 @@ error:
     return -1;
 }
 
-API struct lyd_node *
-lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
+/* logs directly, either root or data is set */
+static struct lyd_node *
+xml_parse_(struct ly_ctx *ctx, struct lyxml_elem **root, const char *data, int options, const struct lyd_node *rpc_act,
+           const struct lyd_node *data_tree, const char *yang_data_name)
 {
-    FUN_IN;
-
-    va_list ap;
-    int r;
+    int r, first = 1;
+    unsigned int len;
+    char *text, *action_prefix = NULL;
     struct unres_data *unres = NULL;
-    const struct lyd_node *rpc_act = NULL, *data_tree = NULL;
     struct lyd_node *result = NULL, *iter, *last, *reply_parent = NULL, *reply_top = NULL, *act_notif = NULL;
-    struct lyxml_elem *xmlstart, *xmlelem, *xmlaux, *xmlfree = NULL;
-    const char *yang_data_name = NULL;
-
-    if (!ctx || !root) {
-        LOGARG;
-        return NULL;
-    }
-
-    if (lyp_data_check_options(ctx, options, __func__)) {
-        return NULL;
-    }
-
-    if (!(*root) && !(options & LYD_OPT_RPCREPLY)) {
-        /* empty tree */
-        if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) {
-            /* error, top level node identify RPC and Notification */
-            LOGERR(ctx, LY_EINVAL, "%s: *root identifies RPC/Notification so it cannot be NULL.", __func__);
-            return NULL;
-        } else if (!(options & LYD_OPT_RPCREPLY)) {
-            /* others - no work is needed, just check for missing mandatory nodes */
-            lyd_validate(&result, options, ctx);
-            return result;
-        }
-        /* continue with empty RPC reply, for which we need RPC */
-    }
+    struct lyxml_elem *xmlstart = NULL, *xmlelem, *xmlaux, *xmlfree = NULL;
+    struct xml_stream stream;
 
     unres = calloc(1, sizeof *unres);
     LY_CHECK_ERR_RETURN(!unres, LOGMEM(ctx), NULL);
+    if (options & LYD_OPT_ARENA) {
+        unres->arena = ly_arena_new();
+        LY_CHECK_ERR_RETURN(!unres->arena, free(unres), NULL);
+    }
 
-    va_start(ap, options);
     if (options & LYD_OPT_RPCREPLY) {
-        rpc_act = va_arg(ap, const struct lyd_node *);
-        if (!rpc_act || rpc_act->parent || !(rpc_act->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
-            LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-            goto error;
-        }
         if (rpc_act->schema->nodetype == LYS_RPC) {
             /* RPC request */
             reply_top = reply_parent = _lyd_new(NULL, rpc_act->schema, 0);
@@ -627,65 +775,114 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
             lyd_free_withsiblings(reply_parent->child);
         }
     }
-    if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF | LYD_OPT_RPCREPLY)) {
-        data_tree = va_arg(ap, const struct lyd_node *);
-        if (data_tree) {
-            if (options & LYD_OPT_NOEXTDEPS) {
-                LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree and LYD_OPT_NOEXTDEPS set).",
-                       __func__);
+
+    iter = last = NULL;
+    if (data) {
+        /* build the data tree directly from the input, only the ancestors of the currently processed node
+         * are kept as XML elements */
+        while (1) {
+            if (xmlfree) {
+                /* children of the action element */
+                r = lyxml_parse_elem_next(ctx, data, &len, xmlfree, action_prefix, &text);
+                free(text);
+                if ((r == 2) && (xml_check_mixed(ctx, xmlfree, options) == -1)) {
+                    goto error;
+                }
+            } else {
+                r = lyxml_parse_misc(ctx, data, &len);
+            }
+            if (r == -1) {
                 goto error;
             }
+            data += len;
+            if (!r) {
+                break;
+            } else if (r == 2) {
+                continue;
+            }
 
-            LY_TREE_FOR((struct lyd_node *)data_tree, iter) {
-                if (iter->parent) {
-                    /* a sibling is not top-level */
-                    LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
-                    goto error;
+            xmlelem = lyxml_parse_elem_start(ctx, data, &len, xmlfree, &stream.prefix, &stream.closed);
+            if (!xmlelem) {
+                goto error;
+            }
+            stream.data = data + len;
+
+            if (first && (options & LYD_OPT_RPC)
+                    && !strcmp(xmlelem->name, "action")
+                    && xmlelem->ns && !strcmp(xmlelem->ns->value, LY_NSYANG)) {
+                /* it's an action, not a simple RPC */
+                xmlfree = xmlelem;
+                action_prefix = stream.prefix;
+                data = stream.data;
+                first = 0;
+                if (stream.closed) {
+                    break;
                 }
+                continue;
             }
+            first = 0;
 
-            /* move it to the beginning */
-            for (; data_tree->prev->next; data_tree = data_tree->prev);
+            r = xml_parse_data(ctx, xmlelem, reply_parent, result, last, options, unres, &iter, &act_notif,
+                               yang_data_name, &stream);
+            data = stream.data;
+            free(stream.prefix);
+            lyxml_free(ctx, xmlelem);
+            if (r) {
+                if (reply_top) {
+                    result = reply_top;
+                }
+                goto error;
+            }
+            if (iter) {
+                last = iter;
+                if ((options & LYD_OPT_DATA_ADD_YANGLIB) && iter->schema->module == ctx->models.list[ctx->internal_module_count - 1]) {
+                    /* ietf-yang-library data present, so ignore the option to add them */
+                    options &= ~LYD_OPT_DATA_ADD_YANGLIB;
+                }
+            }
+            if (!result) {
+                result = iter;
+            }
 
-            /* LYD_OPT_NOSIBLINGS cannot be set in this case */
             if (options & LYD_OPT_NOSIBLINGS) {
-                LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
-                goto error;
+                /* stop after the first processed root */
+                for (; is_xmlws(*data); ++data);
+                if (!xmlfree && *data) {
+                    LOGWRN(ctx, "There are some not parsed data:\n%s", data);
+                }
+                break;
             }
         }
-    }
-    if (options & LYD_OPT_DATA_TEMPLATE) {
-        yang_data_name = va_arg(ap, const char *);
-    }
-
-    if ((*root) && !(options & LYD_OPT_NOSIBLINGS)) {
-        /* locate the first root to process */
-        if ((*root)->parent) {
-            xmlstart = (*root)->parent->child;
+    } else {
+        if ((*root) && !(options & LYD_OPT_NOSIBLINGS)) {
+            /* locate the first root to process */
+            if ((*root)->parent) {
+                xmlstart = (*root)->parent->child;
+            } else {
+                xmlstart = *root;
+                while(xmlstart->prev->next) {
+                    xmlstart = xmlstart->prev;
+                }
+            }
         } else {
             xmlstart = *root;
-            while(xmlstart->prev->next) {
-                xmlstart = xmlstart->prev;
-            }
         }
-    } else {
-        xmlstart = *root;
-    }
 
-    if ((options & LYD_OPT_RPC)
-            && !strcmp(xmlstart->name, "action")
-            && xmlstart->ns && !strcmp(xmlstart->ns->value, LY_NSYANG)) {
-        /* it's an action, not a simple RPC */
-        xmlstart = xmlstart->child;
-        if (options & LYD_OPT_DESTRUCT) {
-            /* free it later */
-            xmlfree = xmlstart->parent;
+        if ((options & LYD_OPT_RPC)
+                && !strcmp(xmlstart->name, "action")
+                && xmlstart->ns && !strcmp(xmlstart->ns->value, LY_NSYANG)) {
+            /* it's an action, not a simple RPC */
+            xmlstart = xmlstart->child;
+            if (options & LYD_OPT_DESTRUCT) {
+                /* free it later */
+                xmlfree = xmlstart->parent;
+            }
         }
     }
 
-    iter = last = NULL;
     LY_TREE_FOR_SAFE(xmlstart, xmlaux, xmlelem) {
-        r = xml_parse_data(ctx, xmlelem, reply_parent, result, last, options, unres, &iter, &act_notif, yang_data_name);
+        r = xml_parse_data(ctx, xmlelem, reply_parent, result, last, options, unres, &iter, &act_notif,
+                           yang_data_name, NULL);
         if (r) {
             if (reply_top) {
                 result = reply_top;
@@ -758,10 +955,11 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
     if (xmlfree) {
         lyxml_free(ctx, xmlfree);
     }
+    free(action_prefix);
     free(unres->node);
     free(unres->type);
+    ly_arena_release(unres->arena);
     free(unres);
-    va_end(ap);
     return result;
 
 error:
@@ -769,9 +967,115 @@ error:
     if (xmlfree) {
         lyxml_free(ctx, xmlfree);
     }
+    free(action_prefix);
     free(unres->node);
     free(unres->type);
+    ly_arena_release(unres->arena);
     free(unres);
-    va_end(ap);
     return NULL;
 }
+
+API struct lyd_node *
+lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
+{
+    FUN_IN;
+
+    va_list ap;
+    const struct lyd_node *rpc_act = NULL, *data_tree = NULL, *iter;
+    struct lyd_node *result = NULL;
+    const char *yang_data_name = NULL;
+
+    if (!ctx || !root) {
+        LOGARG;
+        return NULL;
+    }
+
+    if (lyp_data_check_options(ctx, options, __func__)) {
+        return NULL;
+    }
+
+    if (!(*root) && !(options & LYD_OPT_RPCREPLY)) {
+        /* empty tree */
+        if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) {
+            /* error, top level node identify RPC and Notification */
+            LOGERR(ctx, LY_EINVAL, "%s: *root identifies RPC/Notification so it cannot be NULL.", __func__);
+            return NULL;
+        } else if (!(options & LYD_OPT_RPCREPLY)) {
+            /* others - no work is needed, just check for missing mandatory nodes */
+            lyd_validate(&result, options, ctx);
+            return result;
+        }
+        /* continue with empty RPC reply, for which we need RPC */
+    }
+
+    va_start(ap, options);
+    if (options & LYD_OPT_RPCREPLY) {
+        rpc_act = va_arg(ap, const struct lyd_node *);
+        if (!rpc_act || rpc_act->parent || !(rpc_act->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
+            LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
+            goto error;
+        }
+    }
+    if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF | LYD_OPT_RPCREPLY)) {
+        data_tree = va_arg(ap, const struct lyd_node *);
+        if (data_tree) {
+            if (options & LYD_OPT_NOEXTDEPS) {
+                LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree and LYD_OPT_NOEXTDEPS set).",
+                       __func__);
+                goto error;
+            }
+
+            LY_TREE_FOR(data_tree, iter) {
+                if (iter->parent) {
+                    /* a sibling is not top-level */
+                    LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
+                    goto error;
+                }
+            }
+
+            /* move it to the beginning */
+            for (; data_tree->prev->next; data_tree = data_tree->prev);
+
+            /* LYD_OPT_NOSIBLINGS cannot be set in this case */
+            if (options & LYD_OPT_NOSIBLINGS) {
+                LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
+                goto error;
+            }
+        }
+    }
+    if (options & LYD_OPT_DATA_TEMPLATE) {
+        yang_data_name = va_arg(ap, const char *);
+    }
+
+    result = xml_parse_(ctx, root, NULL, options, rpc_act, data_tree, yang_data_name);
+
+error:
+    va_end(ap);
+    return result;
+}
+
+struct lyd_node *
+lyd_parse_xml_mem(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
+                  const struct lyd_node *data_tree, const char *yang_data_name)
+{
+    struct lyd_node *result = NULL;
+    unsigned int len;
+    int r;
+
+    r = lyxml_parse_misc(ctx, data, &len);
+    if (r == -1) {
+        return NULL;
+    } else if (!r && !(options & LYD_OPT_RPCREPLY)) {
+        /* empty tree */
+        if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) {
+            /* error, top level node identify RPC and Notification */
+            LOGERR(ctx, LY_EINVAL, "%s: data identify RPC/Notification so they cannot be empty.", __func__);
+            return NULL;
+        }
+        /* others - no work is needed, just check for missing mandatory nodes */
+        lyd_validate(&result, options, ctx);
+        return result;
+    }
+
+    return xml_parse_(ctx, NULL, data, options, rpc_act, data_tree, yang_data_name);
+}
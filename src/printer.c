@@ -77,80 +77,219 @@ nscmp(const struct lyd_node *node1, const struct lyd_node *node2)
     }
 }
 
+/* write the data directly to LYOUT_FD or LYOUT_CALLBACK output */
+static int
+ly_print_write(struct lyout *out, const char *buf, size_t count)
+{
+    ssize_t r;
+    size_t written = 0;
+
+    while (written < count) {
+        if (out->type == LYOUT_FD) {
+            r = write(out->method.fd, buf + written, count - written);
+        } else {
+            r = out->method.clb.f(out->method.clb.arg, buf + written, count - written);
+        }
+        if (r < 0) {
+            if ((out->type == LYOUT_FD) && (errno == EINTR)) {
+                continue;
+            }
+            return -1;
+        } else if (!r) {
+            /* nothing more can be written */
+            break;
+        }
+        written += r;
+    }
+
+    if (out->type == LYOUT_CALLBACK) {
+        /*
+         * Depending on what the callback function does, errno might
+         * contain non-zero values that are not real "errors" (EAGAIN or
+         * EINTR). Reset errno if the callback returns a zero or positive
+         * value.
+         */
+        errno = 0;
+    }
+    return written;
+}
+
+/* write out the data buffered for LYOUT_FD or LYOUT_CALLBACK output */
+static int
+ly_print_write_buffered(struct lyout *out)
+{
+    int r = 0;
+    size_t len;
+
+    if (out->printed_len) {
+        len = out->printed_len;
+        r = ly_print_write(out, out->printed, len);
+        out->printed_len = 0;
+        if ((r >= 0) && ((size_t)r < len)) {
+            /* short write */
+            r = -1;
+        }
+    }
+
+    return r < 0 ? -1 : 0;
+}
+
+/* make space for count bytes and a terminating zero in the output buffer, returns where to store them */
+static char *
+ly_print_reserve(struct lyout *out, size_t count)
+{
+    char **buf;
+    size_t *len, *size, new_size;
+    void *aux;
+
+    if (out->type == LYOUT_MEMORY) {
+        buf = &out->method.mem.buf;
+        len = &out->method.mem.len;
+        size = &out->method.mem.size;
+    } else {
+        if (out->printed_len && (out->printed_len + count + 1 > LY_PRINT_BUF_SIZE)) {
+            /* the buffer is full, write it out first */
+            if (ly_print_write_buffered(out)) {
+                return NULL;
+            }
+        }
+        buf = &out->printed;
+        len = &out->printed_len;
+        size = &out->printed_size;
+    }
+
+    if (*len + count + 1 > *size) {
+        /* grow geometrically to avoid a reallocation for every printed fragment */
+        new_size = *size ? *size : 128;
+        while (*len + count + 1 > new_size) {
+            new_size *= 2;
+        }
+
+        aux = realloc(*buf, new_size);
+        if (!aux) {
+            LOGMEM(NULL);
+            return NULL;
+        }
+        *buf = aux;
+        *size = new_size;
+    }
+
+    return *buf + *len;
+}
+
+/* count bytes were stored into the output buffer returned by ly_print_reserve() */
+static void
+ly_print_commit(struct lyout *out, size_t count)
+{
+    if (out->type == LYOUT_MEMORY) {
+        out->method.mem.len += count;
+        out->method.mem.buf[out->method.mem.len] = '\0';
+    } else {
+        out->printed_len += count;
+    }
+}
+
 int
 ly_print(struct lyout *out, const char *format, ...)
 {
     int count = 0;
-    char *msg = NULL, *aux;
-    va_list ap;
+    char *msg = NULL, *buf;
+    size_t avail;
+    va_list ap, ap2;
 
     va_start(ap, format);
 
-    switch (out->type) {
-    case LYOUT_FD:
-        count = vdprintf(out->method.fd, format, ap);
-        break;
-    case LYOUT_STREAM:
+    if (out->type == LYOUT_STREAM) {
+        /* FILE streams are buffered on their own */
         count = vfprintf(out->method.f, format, ap);
-        break;
-    case LYOUT_MEMORY:
-        count = vasprintf(&msg, format, ap);
-        if (out->method.mem.len + count + 1 > out->method.mem.size) {
-            aux = ly_realloc(out->method.mem.buf, out->method.mem.len + count + 1);
-            if (!aux) {
-                out->method.mem.buf = NULL;
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM(NULL);
-                va_end(ap);
-                return -1;
-            }
-            out->method.mem.buf = aux;
-            out->method.mem.size = out->method.mem.len + count + 1;
-        }
-        memcpy(&out->method.mem.buf[out->method.mem.len], msg, count);
-        out->method.mem.len += count;
-        out->method.mem.buf[out->method.mem.len] = '\0';
-        free(msg);
-        break;
-    case LYOUT_CALLBACK:
+        va_end(ap);
+        return count;
+    }
+
+    if (out->hole_count) {
+        /* we are buffering data after a hole */
         count = vasprintf(&msg, format, ap);
-        count = out->method.clb.f(out->method.clb.arg, msg, count);
-        if (count >= 0) {
-            /*
-             * Depending on what the callback function does, errno might
-             * contain non-zero values that are not real "errors" (EAGAIN or
-             * EINTR). Reset errno if the callback returns a zero or positive
-             * value.
-             */
-            errno = 0;
+        va_end(ap);
+        if (count < 0) {
+            LOGMEM(NULL);
+            return -1;
         }
+        count = ly_write(out, msg, count);
         free(msg);
-        break;
+        return count;
     }
 
+    /* try to print directly into the free space of the buffer */
+    if (out->type == LYOUT_MEMORY) {
+        buf = out->method.mem.buf ? out->method.mem.buf + out->method.mem.len : NULL;
+        avail = out->method.mem.size - out->method.mem.len;
+    } else {
+        buf = out->printed ? out->printed + out->printed_len : NULL;
+        avail = out->printed_size - out->printed_len;
+    }
+    va_copy(ap2, ap);
+    count = vsnprintf(buf, avail, format, ap);
+    if (count < 0) {
+        LOGINT(NULL);
+    } else if ((size_t)count < avail) {
+        ly_print_commit(out, count);
+    } else {
+        /* not enough space, make it and print again */
+        buf = ly_print_reserve(out, count);
+        if (!buf) {
+            count = -1;
+        } else {
+            vsnprintf(buf, count + 1, format, ap2);
+            ly_print_commit(out, count);
+        }
+    }
+    va_end(ap2);
     va_end(ap);
+
+    if ((count > 0) && (out->type != LYOUT_MEMORY) && (out->printed_len >= LY_PRINT_BUF_SIZE)) {
+        if (ly_print_write_buffered(out)) {
+            return -1;
+        }
+    }
     return count;
 }
 
-void
+int
 ly_print_flush(struct lyout *out)
 {
+    int ret = 0;
+
     switch (out->type) {
     case LYOUT_STREAM:
-        fflush(out->method.f);
+        if (fflush(out->method.f)) {
+            ret = -1;
+        }
         break;
     case LYOUT_FD:
-    case LYOUT_MEMORY:
     case LYOUT_CALLBACK:
+        ret = ly_print_write_buffered(out);
+        free(out->printed);
+        out->printed = NULL;
+        out->printed_size = 0;
+        break;
+    case LYOUT_MEMORY:
         /* nothing to do */
         break;
     }
+
+    if (ret && errno) {
+        LOGERR(NULL, LY_ESYS, "Writing the printed data failed (%s).", strerror(errno));
+    } else if (ret) {
+        LOGERR(NULL, LY_ESYS, "Writing the printed data failed.");
+    }
+    return ret;
 }
 
 int
 ly_write(struct lyout *out, const char *buf, size_t count)
 {
+    char *dst;
+
     if (out->hole_count) {
         /* we are buffering data after a hole */
         if (out->buf_len + count > out->buf_size) {
@@ -170,30 +309,29 @@ ly_write(struct lyout *out, const char *buf, size_t count)
     }
 
     switch (out->type) {
-    case LYOUT_MEMORY:
-        if (out->method.mem.len + count + 1 > out->method.mem.size) {
-            out->method.mem.buf = ly_realloc(out->method.mem.buf, out->method.mem.len + count + 1);
-            if (!out->method.mem.buf) {
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM(NULL);
-                return -1;
-            }
-            out->method.mem.size = out->method.mem.len + count + 1;
-        }
-        memcpy(&out->method.mem.buf[out->method.mem.len], buf, count);
-        out->method.mem.len += count;
-        out->method.mem.buf[out->method.mem.len] = '\0';
-        return count;
-    case LYOUT_FD:
-        return write(out->method.fd, buf, count);
     case LYOUT_STREAM:
         return fwrite(buf, sizeof *buf, count, out->method.f);
+    case LYOUT_FD:
     case LYOUT_CALLBACK:
-        return out->method.clb.f(out->method.clb.arg, buf, count);
+        if (count >= LY_PRINT_BUF_SIZE) {
+            /* too much data to be buffered, write them directly */
+            if (ly_print_write_buffered(out)) {
+                return -1;
+            }
+            return ly_print_write(out, buf, count);
+        }
+        /* fallthrough */
+    case LYOUT_MEMORY:
+        dst = ly_print_reserve(out, count);
+        if (!dst) {
+            return -1;
+        }
+        memcpy(dst, buf, count);
+        ly_print_commit(out, count);
+        break;
     }
 
-    return 0;
+    return count;
 }
 
 int
@@ -201,15 +339,8 @@ ly_write_skip(struct lyout *out, size_t count, size_t *position)
 {
     switch (out->type) {
     case LYOUT_MEMORY:
-        if (out->method.mem.len + count > out->method.mem.size) {
-            out->method.mem.buf = ly_realloc(out->method.mem.buf, out->method.mem.len + count);
-            if (!out->method.mem.buf) {
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM(NULL);
-                return -1;
-            }
-            out->method.mem.size = out->method.mem.len + count;
+        if (!ly_print_reserve(out, count)) {
+            return -1;
         }
 
         /* save the current position */
@@ -429,6 +560,7 @@ lys_print_fd(int fd, const struct lys_module *module, LYS_OUTFORMAT format, cons
              int line_length, int options)
 {
     struct lyout out;
+    int r;
 
     if (fd < 0 || !module) {
         LOGARG;
@@ -440,7 +572,13 @@ lys_print_fd(int fd, const struct lys_module *module, LYS_OUTFORMAT format, cons
     out.type = LYOUT_FD;
     out.method.fd = fd;
 
-    return lys_print_(&out, module, format, target_node, line_length, options);
+    r = lys_print_(&out, module, format, target_node, line_length, options);
+
+    /* write out any data left in the buffer */
+    if (ly_print_flush(&out)) {
+        r = EXIT_FAILURE;
+    }
+    return r;
 }
 
 API int
@@ -470,6 +608,7 @@ lys_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
               LYS_OUTFORMAT format, const char *target_node, int line_length, int options)
 {
     struct lyout out;
+    int r;
 
     if (!writeclb || !module) {
         LOGARG;
@@ -482,7 +621,13 @@ lys_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
     out.method.clb.f = writeclb;
     out.method.clb.arg = arg;
 
-    return lys_print_(&out, module, format, target_node, line_length, options);
+    r = lys_print_(&out, module, format, target_node, line_length, options);
+
+    /* write out any data left in the buffer */
+    if (ly_print_flush(&out)) {
+        r = EXIT_FAILURE;
+    }
+    return r;
 }
 
 int
@@ -704,6 +849,11 @@ lys_print_target(struct lyout *out, const struct lys_module *module, const char
 static int
 lyd_print_(struct lyout *out, const struct lyd_node *root, LYD_FORMAT format, int options)
 {
+    /* print also the nodes not parsed yet */
+    if (lyb_lazy_load_tree(root, options & LYP_WITHSIBLINGS)) {
+        return EXIT_FAILURE;
+    }
+
     switch (format) {
     case LYD_XML:
         return xml_print_data(out, root, options);
@@ -780,6 +930,9 @@ lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int options
 
     r = lyd_print_(&out, root, format, options);
 
+    if (ly_print_flush(&out)) {
+        r = EXIT_FAILURE;
+    }
     free(out.buffered);
     return r;
 }
@@ -826,6 +979,9 @@ lyd_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
 
     r = lyd_print_(&out, root, format, options);
 
+    if (ly_print_flush(&out)) {
+        r = EXIT_FAILURE;
+    }
     free(out.buffered);
     return r;
 }
@@ -49,8 +49,16 @@ struct lyout {
 
     /* hole counter */
     size_t hole_count;
+
+    /* output buffer for LYOUT_FD and LYOUT_CALLBACK, written out when full and on ly_print_flush() */
+    char *printed;
+    size_t printed_len;
+    size_t printed_size;
 };
 
+/* amount of data buffered for LYOUT_FD and LYOUT_CALLBACK before they are written out */
+#define LY_PRINT_BUF_SIZE 16384
+
 struct ext_substmt_info_s {
     const char *name;
     const char *arg;
@@ -69,9 +77,22 @@ extern struct ext_substmt_info_s ext_substmt_info[];
 
 /**
  * @brief Generic printer, replacement for printf() / write() / etc
+ *
+ * Data are printed directly into the output buffer which grows geometrically, LYOUT_FD and LYOUT_CALLBACK
+ * outputs are written out only when LY_PRINT_BUF_SIZE bytes are buffered and in ly_print_flush().
  */
 int ly_print(struct lyout *out, const char *format, ...);
-void ly_print_flush(struct lyout *out);
+
+/**
+ * @brief Write out all the buffered data, must be called when printing is finished.
+ *
+ * @return 0 on success, -1 if the data could not be written (logged).
+ */
+int ly_print_flush(struct lyout *out);
+
+/**
+ * @brief Generic writer, prefer it over ly_print() for strings with a known length since no format is parsed.
+ */
 int ly_write(struct lyout *out, const char *buf, size_t count);
 int ly_write_skip(struct lyout *out, size_t count, size_t *position);
 int ly_write_skipped(struct lyout *out, size_t position, const char *buf, size_t count);
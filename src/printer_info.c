@@ -1044,7 +1044,9 @@ info_print_model(struct lyout *out, const struct lys_module *module, const char
                               info_print_input,
                               info_print_output);
     }
-    ly_print_flush(out);
+    if (ly_print_flush(out)) {
+        rc = EXIT_FAILURE;
+    }
 
     return rc;
 }
@@ -33,25 +33,38 @@ static int json_print_nodes(struct lyout *out, int level, const struct lyd_node
 int
 json_print_string(struct lyout *out, const char *text)
 {
-    unsigned int i, n;
+    size_t i, len, span;
+    unsigned int n;
+    unsigned char ascii;
 
     if (!text) {
         return 0;
     }
 
     ly_write(out, "\"", 1);
-    for (i = n = 0; text[i]; i++) {
-        const unsigned char ascii = text[i];
+    len = strlen(text);
+    for (i = n = 0; i < len; i++) {
+        /* write the characters not needing escaping at once */
+        span = strncspn(&text[i], "\"\\", 1, len - i);
+        if (span) {
+            n += ly_write(out, &text[i], span);
+            i += span;
+            if (i == len) {
+                break;
+            }
+        }
+
+        ascii = text[i];
         if (ascii < 0x20) {
             /* control character */
             n += ly_print(out, "\\u%.4X", ascii);
         } else {
             switch (ascii) {
             case '"':
-                n += ly_print(out, "\\\"");
+                n += ly_write(out, "\\\"", 2);
                 break;
             case '\\':
-                n += ly_print(out, "\\\\");
+                n += ly_write(out, "\\\\", 2);
                 break;
             default:
                 ly_write(out, &text[i], 1);
@@ -124,7 +137,7 @@ json_print_attrs(struct lyout *out, int level, const struct lyd_node *node, cons
             break;
 
         case LY_TYPE_EMPTY:
-            ly_print(out, "[null]");
+            ly_write(out, "[null]", 6);
             break;
 
         default:
@@ -225,7 +238,7 @@ contentprint:
         goto contentprint;
 
     case LY_TYPE_EMPTY:
-        ly_print(out, "[null]");
+        ly_write(out, "[null]", 6);
         break;
 
     default:
@@ -450,21 +463,21 @@ json_print_anydataxml(struct lyout *out, int level, const struct lyd_node *node,
         break;
     case LYD_ANYDATA_JSON:
         if (level) {
-            ly_print(out, "\n");
+            ly_write(out, "\n", 1);
         }
         if (any->value.str) {
-            ly_print(out, "%s", any->value.str);
+            ly_write(out, any->value.str, strlen(any->value.str));
         }
         if (level && (!any->value.str || (any->value.str[strlen(any->value.str) - 1] != '\n'))) {
             /* do not print 2 newlines */
-            ly_print(out, "\n");
+            ly_write(out, "\n", 1);
         }
         break;
     case LYD_ANYDATA_XML:
         lyxml_print_mem(&buf, any->value.xml, (level ? LYXML_PRINT_FORMAT | LYXML_PRINT_NO_LAST_NEWLINE : 0)
                                                | LYXML_PRINT_SIBLINGS);
         if (level) {
-            ly_print(out, " ");
+            ly_write(out, " ", 1);
         }
         json_print_string(out, buf);
         free(buf);
@@ -472,12 +485,12 @@ json_print_anydataxml(struct lyout *out, int level, const struct lyd_node *node,
     case LYD_ANYDATA_CONSTSTRING:
     case LYD_ANYDATA_SXML:
         if (level) {
-            ly_print(out, " ");
+            ly_write(out, " ", 1);
         }
         if (any->value.str) {
             json_print_string(out, any->value.str);
         } else {
-            ly_print(out, "\"\"");
+            ly_write(out, "\"\"", 2);
         }
         break;
     case LYD_ANYDATA_STRING:
@@ -595,7 +608,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         }
     }
     if (root && level) {
-        ly_print(out, "\n");
+        ly_write(out, "\n", 1);
     }
 
     LY_PRINT_RET(root ? root->schema->module->ctx : NULL);
@@ -661,6 +674,8 @@ json_print_data(struct lyout *out, const struct lyd_node *root, int options)
     /* end */
     ly_print(out, "}%s", (level ? "\n" : ""));
 
-    ly_print_flush(out);
+    if (ly_print_flush(out)) {
+        return EXIT_FAILURE;
+    }
     LY_PRINT_RET(NULL);
 }
@@ -1312,7 +1312,9 @@ jsons_print_model(struct lyout *out, const struct lys_module *module, const char
                               jsons_print_output);
         ly_print(out, "}");
     }
-    ly_print_flush(out);
+    if (ly_print_flush(out)) {
+        rc = EXIT_FAILURE;
+    }
 
     return rc;
 }
@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include "common.h"
+#include "parser.h"
 #include "printer.h"
 #include "tree_schema.h"
 #include "tree_data.h"
@@ -298,134 +299,104 @@ lyb_hash_find(struct hash_table *ht, struct lys_node *node)
     return hash;
 }
 
-/* writing function handles writing size information */
+/* writing function, only counts the bytes when measuring subtree sizes */
 static int
 lyb_write(struct lyout *out, const uint8_t *buf, size_t count, struct lyb_state *lybs)
 {
-    int ret = 0, i, full_chunk_i;
-    size_t r, to_write;
-    uint8_t meta_buf[LYB_META_BYTES];
+    int r;
 
     assert(out && lybs);
 
-    while (1) {
-        /* check for full data chunks */
-        to_write = count;
-        full_chunk_i = -1;
-        for (i = 0; i < lybs->used; ++i) {
-            /* we want the innermost chunks resolved first, so replace previous full chunks */
-            if (lybs->written[i] + to_write >= LYB_SIZE_MAX) {
-                /* full chunk, do not write more than allowed */
-                to_write = LYB_SIZE_MAX - lybs->written[i];
-                full_chunk_i = i;
-            }
-        }
-
-        if ((full_chunk_i == -1) && !count) {
-            break;
-        }
-
-        /* we are actually writing some data, not just finishing another chunk */
-        if (to_write) {
-            r = ly_write(out, (char *)buf, to_write);
-            if (r < to_write) {
-                return -1;
-            }
-
-            for (i = 0; i < lybs->used; ++i) {
-                /* increase all written counters */
-                lybs->written[i] += r;
-                assert(lybs->written[i] <= LYB_SIZE_MAX);
-            }
-            /* decrease count/buf */
-            count -= r;
-            buf += r;
+    if (lybs->measure) {
+        lybs->offset += count;
+        return count;
+    }
 
-            ret += r;
-        }
+    r = ly_write(out, (char *)buf, count);
+    if (r < (signed)count) {
+        return -1;
+    }
 
-        if (full_chunk_i > -1) {
-            /* write the meta information (inner chunk count and chunk size) */
-            meta_buf[0] = lybs->written[full_chunk_i] & 0xFF;
-            meta_buf[1] = lybs->inner_chunks[full_chunk_i] & 0xFF;
+    return r;
+}
 
-            r = ly_write_skipped(out, lybs->position[full_chunk_i], (char *)meta_buf, LYB_META_BYTES);
-            if (r < LYB_META_BYTES) {
-                return -1;
-            }
+static size_t
+lyb_varint_bytes(size_t num)
+{
+    size_t bytes = 1;
 
-            /* zero written and inner chunks */
-            lybs->written[full_chunk_i] = 0;
-            lybs->inner_chunks[full_chunk_i] = 0;
+    while (num >>= 7) {
+        ++bytes;
+    }
 
-            /* skip space for another chunk size */
-            r = ly_write_skip(out, LYB_META_BYTES, &lybs->position[full_chunk_i]);
-            if (r < LYB_META_BYTES) {
-                return -1;
-            }
+    return bytes;
+}
 
-            ret += r;
+static int
+lyb_write_varint(size_t num, struct lyout *out, struct lyb_state *lybs)
+{
+    uint8_t buf[LYB_VARINT_MAX_BYTES];
+    int len = 0;
 
-            /* increase inner chunk count */
-            for (i = 0; i < full_chunk_i; ++i) {
-                if (lybs->inner_chunks[i] == LYB_INCHUNK_MAX) {
-                    LOGINT(lybs->ctx);
-                    return -1;
-                }
-                ++lybs->inner_chunks[i];
-            }
+    /* 7 bits in every byte, the highest bit set if more follow */
+    do {
+        buf[len] = num & 0x7f;
+        num >>= 7;
+        if (num) {
+            buf[len] |= 0x80;
         }
-    }
+        ++len;
+    } while (num);
 
-    return ret;
+    return lyb_write(out, buf, len, lybs);
 }
 
 static int
 lyb_write_stop_subtree(struct lyout *out, struct lyb_state *lybs)
 {
-    int r;
-    uint8_t meta_buf[LYB_META_BYTES];
-
-    /* write the meta chunk information */
-    meta_buf[0] = lybs->written[lybs->used - 1] & 0xFF;
-    meta_buf[1] = lybs->inner_chunks[lybs->used - 1] & 0xFF;
+    size_t size;
 
-    r = ly_write_skipped(out, lybs->position[lybs->used - 1], (char *)&meta_buf, LYB_META_BYTES);
-    if (r < LYB_META_BYTES) {
-        return -1;
+    if (!lybs->measure) {
+        /* size already printed */
+        return 0;
     }
 
+    /* the subtree is measured, it will be preceded by its size */
+    size = lybs->offset - lybs->position[lybs->used - 1];
+    lybs->sizes[lybs->written[lybs->used - 1]] = size;
     --lybs->used;
-    return 0;
+
+    return lyb_write_varint(size, out, lybs);
 }
 
 static int
 lyb_write_start_subtree(struct lyout *out, struct lyb_state *lybs)
 {
-    int i;
+    if (!lybs->measure) {
+        /* print the measured size */
+        assert(lybs->size_idx < lybs->size_count);
+        return lyb_write_varint(lybs->sizes[lybs->size_idx++], out, lybs);
+    }
 
     if (lybs->used == lybs->size) {
         lybs->size += LYB_STATE_STEP;
         lybs->written = ly_realloc(lybs->written, lybs->size * sizeof *lybs->written);
         lybs->position = ly_realloc(lybs->position, lybs->size * sizeof *lybs->position);
-        lybs->inner_chunks = ly_realloc(lybs->inner_chunks, lybs->size * sizeof *lybs->inner_chunks);
-        LY_CHECK_ERR_RETURN(!lybs->written || !lybs->position || !lybs->inner_chunks, LOGMEM(lybs->ctx), -1);
+        LY_CHECK_ERR_RETURN(!lybs->written || !lybs->position, LOGMEM(lybs->ctx), -1);
+    }
+    if (lybs->size_count == lybs->size_alloc) {
+        lybs->size_alloc = lybs->size_alloc ? lybs->size_alloc * 2 : 64;
+        lybs->sizes = ly_realloc(lybs->sizes, lybs->size_alloc * sizeof *lybs->sizes);
+        lybs->hashes = ly_realloc(lybs->hashes, lybs->size_alloc * sizeof *lybs->hashes);
+        LY_CHECK_ERR_RETURN(!lybs->sizes || !lybs->hashes, LOGMEM(lybs->ctx), -1);
     }
 
+    /* remember the subtree start and where to store its size */
     ++lybs->used;
-    lybs->written[lybs->used - 1] = 0;
-    lybs->inner_chunks[lybs->used - 1] = 0;
+    lybs->position[lybs->used - 1] = lybs->offset;
+    lybs->written[lybs->used - 1] = lybs->size_count++;
 
-    /* another inner chunk */
-    for (i = 0; i < lybs->used - 1; ++i) {
-        if (lybs->inner_chunks[i] == LYB_INCHUNK_MAX) {
-            LOGINT(lybs->ctx);
-            return -1;
-        }
-        ++lybs->inner_chunks[i];
-    }
-
-    return ly_write_skip(out, LYB_META_BYTES, &lybs->position[lybs->used - 1]);
+    return 0;
 }
 
 static int
@@ -634,17 +605,46 @@ lyb_print_magic_number(struct lyout *out)
 }
 
 static int
-lyb_print_header(struct lyout *out)
+lyb_print_header(struct lyout *out, int offsets)
 {
     int ret = 0;
-    uint8_t byte = 0;
+    uint8_t byte = LYB_VERSION;
 
-    /* TODO version, some other flags? */
+    if (offsets) {
+        byte |= LYB_HEADER_OFFSETS;
+    }
     ret += ly_write(out, (char *)&byte, sizeof byte);
 
     return ret;
 }
 
+static int
+lyb_print_offsets(struct lyout *out, const uint32_t *top_idx, uint32_t top_count, struct lyb_state *lybs)
+{
+    int r, ret = 0;
+    uint32_t i;
+    size_t offset = 0;
+
+    /* subtree count */
+    ret += (r = lyb_write_varint(top_count, out, lybs));
+    if (r < 0) {
+        return -1;
+    }
+
+    /* offset of each subtree, the first one is 0 */
+    for (i = 0; i < top_count; ++i) {
+        ret += (r = lyb_write_varint(offset, out, lybs));
+        if (r < 0) {
+            return -1;
+        }
+
+        /* size with its varint */
+        offset += lyb_varint_bytes(lybs->sizes[top_idx[i]]) + lybs->sizes[top_idx[i]];
+    }
+
+    return ret;
+}
+
 static int
 lyb_print_anydata(struct lyd_node_anydata *anydata, struct lyout *out, struct lyb_state *lybs)
 {
@@ -689,14 +689,124 @@ lyb_print_anydata(struct lyd_node_anydata *anydata, struct lyout *out, struct ly
     return ret;
 }
 
+/* does not log, cannot fail */
+static int
+lyb_ident_derived(const struct lys_ident *ident, const struct lys_ident *base)
+{
+    uint8_t i;
+
+    for (i = 0; i < ident->base_size; ++i) {
+        if ((ident->base[i] == base) || lyb_ident_derived(ident->base[i], base)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* does not log, cannot fail */
+static int
+lyb_bits_match(const struct lys_type *type, const char *value_str)
+{
+    const char *ptr;
+    size_t len;
+    unsigned int i;
+
+    for (ptr = value_str; *ptr; ptr += len) {
+        while (*ptr == ' ') {
+            ++ptr;
+        }
+        if (!*ptr) {
+            break;
+        }
+        len = strcspn(ptr, " ");
+
+        for (i = 0; i < type->info.bits.count; ++i) {
+            if (!strncmp(type->info.bits.bit[i].name, ptr, len) && !type->info.bits.bit[i].name[len]) {
+                break;
+            }
+        }
+        if (i == type->info.bits.count) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Learn the union member type a value was resolved to. It is the first member
+ * the value is valid for, the same one resolve_union() would choose.
+ *
+ * @param[in] type Union type.
+ * @param[in] value_str Canonical value string.
+ * @param[in] value Resolved value.
+ * @param[in] value_type Resolved value type.
+ * @param[out] idx Index of the member in the order of lyp_get_next_union_type().
+ * @return Member type, NULL if not found.
+ */
+static struct lys_type *
+lyb_union_member(const struct lys_type *type, const char *value_str, lyd_val value, LY_DATA_TYPE value_type, size_t *idx)
+{
+    struct lys_type *member = NULL, *rtype;
+    char num_str[22];
+    int found = 0;
+    uint8_t i;
+
+    for (*idx = 0; (member = lyp_get_next_union_type((struct lys_type *)type, member, &found)); ++*idx) {
+        found = 0;
+        if (member->base != value_type) {
+            continue;
+        }
+
+        switch (value_type) {
+        case LY_TYPE_BITS:
+            for (rtype = member; !rtype->info.bits.count; rtype = &rtype->der->type);
+            if (lyb_bits_match(rtype, value_str)) {
+                return member;
+            }
+            break;
+        case LY_TYPE_ENUM:
+            for (rtype = member; !rtype->info.enums.count; rtype = &rtype->der->type);
+            if ((value.enm >= rtype->info.enums.enm) && (value.enm < rtype->info.enums.enm + rtype->info.enums.count)) {
+                return member;
+            }
+            break;
+        case LY_TYPE_IDENT:
+            for (rtype = member; !rtype->info.ident.count; rtype = &rtype->der->type);
+            for (i = 0; i < rtype->info.ident.count; ++i) {
+                if (!lyb_ident_derived(value.ident, rtype->info.ident.ref[i])) {
+                    break;
+                }
+            }
+            if (i == rtype->info.ident.count) {
+                return member;
+            }
+            break;
+        case LY_TYPE_DEC64:
+            dec64_to_str(value.dec64, member->info.dec64.dig, num_str, sizeof num_str);
+            if (!strcmp(num_str, value_str)) {
+                return member;
+            }
+            break;
+        default:
+            /* the value is the same for all the members of this type */
+            return member;
+        }
+    }
+
+    return NULL;
+}
+
 static int
 lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val value, LY_DATA_TYPE value_type,
                 uint8_t value_flags, uint8_t dflt, struct lyout *out, struct lyb_state *lybs)
 {
     int ret = 0;
     uint8_t byte = 0;
-    size_t count, i, bits_i;
+    size_t count, i, bits_i, member_idx;
     LY_DATA_TYPE dtype;
+    struct lys_type *member;
 
     /* value type byte - ABCD DDDD
      *
@@ -718,19 +828,32 @@ lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val valu
     /* we have only 5b available, must be enough */
     assert((value_type & 0x1f) == value_type);
 
-    /* find actual type */
-    while (type->base == LY_TYPE_LEAFREF) {
-        type = &type->info.lref.target->type;
-    }
+    member = NULL;
+    if ((type->base == LY_TYPE_UNION) && !type->info.uni.has_ptr_type && !(value_flags & LY_VALUE_USER)) {
+        /* store the value as the member type it was resolved to, otherwise as a string to be resolved again */
+        if (value_type != LY_TYPE_UNION) {
+            member = lyb_union_member(type, value_str, value, value_type, &member_idx);
+        }
+        if (member) {
+            type = member;
+        } else {
+            value_type = LY_TYPE_UNION;
+        }
+    } else {
+        /* find actual type */
+        while (type->base == LY_TYPE_LEAFREF) {
+            type = &type->info.lref.target->type;
+        }
 
-    if ((value_flags & LY_VALUE_USER) || (type->base == LY_TYPE_UNION)) {
-        value_type = LY_TYPE_STRING;
-    } else while (value_type == LY_TYPE_LEAFREF) {
-        assert(!(value_flags & LY_VALUE_UNRES));
+        if ((value_flags & LY_VALUE_USER) || (type->base == LY_TYPE_UNION)) {
+            value_type = LY_TYPE_STRING;
+        } else while (value_type == LY_TYPE_LEAFREF) {
+            assert(!(value_flags & LY_VALUE_UNRES));
 
-        /* update value_type and value to that of the target */
-        value_type = ((struct lyd_node_leaf_list *)value.leafref)->value_type;
-        value = ((struct lyd_node_leaf_list *)value.leafref)->value;
+            /* update value_type and value to that of the target */
+            value_type = ((struct lyd_node_leaf_list *)value.leafref)->value_type;
+            value = ((struct lyd_node_leaf_list *)value.leafref)->value;
+        }
     }
 
     /* store the value type */
@@ -739,6 +862,11 @@ lyb_print_value(const struct lys_type *type, const char *value_str, lyd_val valu
     /* write value type byte */
     ret += lyb_write(out, &byte, sizeof byte, lybs);
 
+    if (member) {
+        /* write the member index */
+        ret += lyb_write_varint(member_idx, out, lybs);
+    }
+
     /* print value itself */
     if (value_flags & LY_VALUE_USER) {
         dtype = LY_TYPE_STRING;
@@ -899,6 +1027,12 @@ lyb_print_schema_hash(struct lyout *out, struct lys_node *schema, struct hash_ta
     LYB_HASH hash;
     struct lys_node *first_sibling, *parent;
 
+    if (!lybs->measure) {
+        /* found when measuring */
+        hash = lybs->hashes[lybs->size_idx - 1];
+        goto write_hash;
+    }
+
     /* create whole sibling HT if not already created and saved */
     if (!*sibling_ht) {
         /* get first schema data sibling (or input/output) */
@@ -938,7 +1072,9 @@ lyb_print_schema_hash(struct lyout *out, struct lys_node *schema, struct hash_ta
     if (!hash) {
         return -1;
     }
+    lybs->hashes[lybs->size_count - 1] = hash;
 
+write_hash:
     /* write the hash */
     ret += (r = lyb_write(out, &hash, sizeof hash, lybs));
     if (r < 0) {
@@ -1061,12 +1197,15 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
 {
     int r, ret = 0, rc = EXIT_SUCCESS;
     uint8_t zero = 0;
+    uint32_t *top_idx = NULL, top_count = 0, i;
     struct hash_table *top_sibling_ht = NULL;
     const struct lys_module *prev_mod = NULL;
+    const struct lyd_node *iter;
     struct lys_node *parent;
     struct lyb_state lybs;
 
     memset(&lybs, 0, sizeof lybs);
+    lybs.version = LYB_VERSION;
 
     if (root) {
         lybs.ctx = lyd_node_module(root)->ctx;
@@ -1078,6 +1217,41 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
         }
     }
 
+    /* measure all the subtrees first so that each can be preceded by its size */
+    LY_TREE_FOR(root, iter) {
+        ++top_count;
+        if (!(options & LYP_WITHSIBLINGS)) {
+            break;
+        }
+    }
+    if (top_count) {
+        top_idx = malloc(top_count * sizeof *top_idx);
+        LY_CHECK_ERR_RETURN(!top_idx, LOGMEM(lybs.ctx), EXIT_FAILURE);
+    }
+
+    lybs.measure = 1;
+    i = 0;
+    LY_TREE_FOR(root, iter) {
+        /* do not reuse sibling hash tables from different modules */
+        if (lyd_node_module(iter) != prev_mod) {
+            top_sibling_ht = NULL;
+            prev_mod = lyd_node_module(iter);
+        }
+
+        top_idx[i++] = lybs.size_count;
+
+        if (lyb_print_subtree(out, iter, &top_sibling_ht, &lybs, 1) < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+
+        if (!(options & LYP_WITHSIBLINGS)) {
+            break;
+        }
+    }
+    lybs.measure = 0;
+    assert(!lybs.used);
+
     /* LYB magic number */
     ret += (r = lyb_print_magic_number(out));
     if (r < 0) {
@@ -1085,8 +1259,8 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
         goto finish;
     }
 
-    /* LYB header */
-    ret += (r = lyb_print_header(out));
+    /* LYB header, offsets are useful only for more subtrees */
+    ret += (r = lyb_print_header(out, top_count > 1));
     if (r < 0) {
         rc = EXIT_FAILURE;
         goto finish;
@@ -1099,8 +1273,17 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
         goto finish;
     }
 
+    if (top_count > 1) {
+        /* top-level subtree offsets */
+        ret += (r = lyb_print_offsets(out, top_idx, top_count, &lybs));
+        if (r < 0) {
+            rc = EXIT_FAILURE;
+            goto finish;
+        }
+    }
+
+    prev_mod = NULL;
     LY_TREE_FOR(root, root) {
-        /* do not reuse sibling hash tables from different modules */
         if (lyd_node_module(root) != prev_mod) {
             top_sibling_ht = NULL;
             prev_mod = lyd_node_module(root);
@@ -1116,6 +1299,7 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
             break;
         }
     }
+    assert(lybs.size_idx == lybs.size_count);
 
     /* ending zero byte */
     ret += (r = lyb_write(out, &zero, sizeof zero, &lybs));
@@ -1126,7 +1310,9 @@ lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
 finish:
     free(lybs.written);
     free(lybs.position);
-    free(lybs.inner_chunks);
+    free(lybs.sizes);
+    free(lybs.hashes);
+    free(top_idx);
     for (r = 0; r < lybs.sib_ht_count; ++r) {
         lyht_free(lybs.sib_ht[r].ht);
     }
@@ -420,12 +420,9 @@ tree_print_features(struct lyout *out, struct lys_iffeature *iff1, uint8_t iff1_
     }
 
     if (out_str) {
-        o = malloc(sizeof *o);
+        o = calloc(1, sizeof *o);
         LY_CHECK_ERR_RETURN(!o, LOGMEM(NULL), 0);
         o->type = LYOUT_MEMORY;
-        o->method.mem.buf = NULL;
-        o->method.mem.len = 0;
-        o->method.mem.size = 0;
     } else {
         o = out;
     }
@@ -464,12 +461,9 @@ tree_print_keys(struct lyout *out, struct lys_node_leaf **keys, uint8_t keys_siz
     }
 
     if (out_str) {
-        o = malloc(sizeof *o);
+        o = calloc(1, sizeof *o);
         LY_CHECK_ERR_RETURN(!o, LOGMEM(NULL), 0);
         o->type = LYOUT_MEMORY;
-        o->method.mem.buf = NULL;
-        o->method.mem.len = 0;
-        o->method.mem.size = 0;
     } else {
         o = out;
     }
@@ -1019,7 +1013,9 @@ tree_print_model(struct lyout *out, const struct lys_module *module, const char
         }
     }
 
-    ly_print_flush(out);
+    if (ly_print_flush(out)) {
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -287,7 +287,7 @@ normal_print:
             return EXIT_FAILURE;
         }
 
-        ly_print(out, "\"");
+        ly_write(out, "\"", 1);
 
         if (xml_expr) {
             lydict_remove(node->schema->module->ctx, xml_expr);
@@ -367,9 +367,9 @@ printvalue:
     case LY_TYPE_UINT32:
     case LY_TYPE_UINT64:
         if (!leaf->value_str || !leaf->value_str[0]) {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
         } else {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, leaf->value_str, LYXML_DATA_ELEM);
             ly_print(out, "</%s>", node->schema->name);
         }
@@ -377,7 +377,7 @@ printvalue:
 
     case LY_TYPE_IDENT:
         if (!leaf->value_str || !leaf->value_str[0]) {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
             break;
         }
         p = strchr(leaf->value_str, ':');
@@ -385,7 +385,7 @@ printvalue:
         len = p - leaf->value_str;
         mod_name = leaf->schema->module->name;
         if (!strncmp(leaf->value_str, mod_name, len) && !mod_name[len]) {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, ++p, LYXML_DATA_ELEM);
             ly_print(out, "</%s>", node->schema->name);
         } else {
@@ -409,11 +409,11 @@ printvalue:
         free(nss);
 
         if (xml_expr[0]) {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, xml_expr, LYXML_DATA_ELEM);
             ly_print(out, "</%s>", node->schema->name);
         } else {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
         }
         lydict_remove(node->schema->module->ctx, xml_expr);
         break;
@@ -439,7 +439,7 @@ printvalue:
     case LY_TYPE_EMPTY:
     case LY_TYPE_UNKNOWN:
         /* treat <edit-config> node without value as empty */
-        ly_print(out, "/>");
+        ly_write(out, "/>", 2);
         break;
 
     default:
@@ -449,7 +449,7 @@ printvalue:
     }
 
     if (level) {
-        ly_print(out, "\n");
+        ly_write(out, "\n", 1);
     }
 
     LY_PRINT_RET(node->schema->module->ctx);
@@ -596,7 +596,7 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
             }
         }
         /* close opening tag ... */
-        ly_print(out, ">");
+        ly_write(out, ">", 1);
         free_mlist(&mlist);
         /* ... and print anydata content */
         switch (any->value_type) {
@@ -606,7 +606,7 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
         case LYD_ANYDATA_DATATREE:
             if (any->value.tree) {
                 if (level) {
-                    ly_print(out, "\n");
+                    ly_write(out, "\n", 1);
                 }
                 LY_TREE_FOR(any->value.tree, iter) {
                     if (xml_print_node(out, level ? level + 1 : 0, iter, 0, (options & ~(LYP_WITHSIBLINGS | LYP_NETCONF)))) {
@@ -623,7 +623,7 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
             break;
         case LYD_ANYDATA_SXML:
             /* print without escaping special characters */
-            ly_print(out, "%s", any->value.str);
+            ly_write(out, any->value.str, strlen(any->value.str));
             break;
         case LYD_ANYDATA_JSON:
         case LYD_ANYDATA_LYB:
@@ -755,7 +755,9 @@ xml_print_data(struct lyout *out, const struct lyd_node *root, int options)
     }
 
 finish:
-    ly_print_flush(out);
+    if (ly_print_flush(out)) {
+        return EXIT_FAILURE;
+    }
 
     LY_PRINT_RET(NULL);
 }
@@ -19,6 +19,8 @@
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "libyang.h"
 #include "resolve.h"
@@ -2568,6 +2570,9 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
 
     if (is_relative) {
         prev_mod = lyd_node_module(start);
+        if (start->lazy && lyb_lazy_load(start)) {
+            goto error;
+        }
         start = (start->schema->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_RPC | LYS_ACTION | LYS_NOTIF)) ? start->child : NULL;
     } else {
         for (; start->parent; start = start->parent);
@@ -2765,6 +2770,8 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
             /* there can be no children even through expected, error */
             LOGVAL(ctx, LYE_PATH_INCHAR, LY_VLOG_NONE, NULL, id[0], id);
             goto error;
+        } else if (sibling->lazy && lyb_lazy_load(sibling)) {
+            goto error;
         } else if (!sibling->child) {
             /* there could be some children, but are not, return what we found so far */
             free(pp.pred);
@@ -6200,6 +6207,33 @@ resolve_list_keys(struct lys_node_list *list, const char *keys_str)
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Evaluate a must or when condition using its cached parsed form.
+ * Logs directly.
+ *
+ * @param[in] cond Condition XPath expression.
+ * @param[in] cur_node Context data node.
+ * @param[in] cur_node_type Context data node type.
+ * @param[in] local_mod Module of the condition.
+ * @param[out] set Result set.
+ * @param[in] options Evaluation options.
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when dependency, -1 on error.
+ */
+static int
+resolve_cond_eval(const char *cond, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                  const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    struct lyxp_expr *exp;
+
+    exp = lyxp_expr_cached(local_mod->ctx, cond);
+    if (!exp) {
+        return -1;
+    }
+
+    return lyxp_eval_expr(exp, cur_node, cur_node_type, local_mod, set, options);
+}
+
 /**
  * @brief Resolve (check) all must conditions of \p node.
  * Logs directly.
@@ -6272,7 +6306,7 @@ resolve_must(struct lyd_node *node, int inout_parent, int ignore_fail)
     }
 
     for (i = 0; i < must_size; ++i) {
-        if (lyxp_eval(must[i].expr, node, LYXP_NODE_ELEM, lyd_node_module(node), &set, LYXP_MUST)) {
+        if (resolve_cond_eval(must[i].expr, node, LYXP_NODE_ELEM, lyd_node_module(node), &set, LYXP_MUST)) {
             return -1;
         }
 
@@ -6681,8 +6715,8 @@ resolve_when(struct lyd_node *node, int ignore_fail, struct lys_when **failed_wh
     if (!(node->schema->nodetype & (LYS_NOTIF | LYS_RPC | LYS_ACTION)) && snode_get_when(node->schema)) {
         /* make the node dummy for the evaluation */
         node->validity |= LYD_VAL_INUSE;
-        rc = lyxp_eval(snode_get_when(node->schema)->cond, node, LYXP_NODE_ELEM, lyd_node_module(node),
-                       &set, LYXP_WHEN);
+        rc = resolve_cond_eval(snode_get_when(node->schema)->cond, node, LYXP_NODE_ELEM, lyd_node_module(node),
+                               &set, LYXP_WHEN);
         node->validity &= ~LYD_VAL_INUSE;
         if (rc) {
             if (rc == 1) {
@@ -6733,8 +6767,8 @@ resolve_when(struct lyd_node *node, int ignore_fail, struct lys_when **failed_wh
                 goto cleanup;
             }
 
-            rc = lyxp_eval(snode_get_when(sparent)->cond, ctx_node, ctx_node_type, lys_node_module(sparent),
-                           &set, LYXP_WHEN);
+            rc = resolve_cond_eval(snode_get_when(sparent)->cond, ctx_node, ctx_node_type, lys_node_module(sparent),
+                                   &set, LYXP_WHEN);
 
             if (unlinked_nodes && ctx_node) {
                 if (resolve_when_relink_nodes(ctx_node, unlinked_nodes, ctx_node_type)) {
@@ -6786,8 +6820,8 @@ check_augment:
                 goto cleanup;
             }
 
-            rc = lyxp_eval(snode_get_when(sparent->parent)->cond, ctx_node, ctx_node_type,
-                           lys_node_module(sparent->parent), &set, LYXP_WHEN);
+            rc = resolve_cond_eval(snode_get_when(sparent->parent)->cond, ctx_node, ctx_node_type,
+                                   lys_node_module(sparent->parent), &set, LYXP_WHEN);
 
             /* reconnect nodes, if ctx_node is NULL then all the nodes were unlinked, but linked together,
              * so the tree did not actually change and there is nothing for us to do
@@ -7964,17 +7998,224 @@ error:
     return -1;
 }
 
+/**
+ * @brief Maximum number of descendant steps of a leafref path resolved by resolve_leafref_hash().
+ */
+#define LY_LREF_HASH_MAX_STEPS 16
+
+/**
+ * @brief Get the data parent of a schema node, skipping the nodes not instantiated in data trees.
+ */
+static const struct lys_node *
+resolve_leafref_data_parent(const struct lys_node *snode)
+{
+    do {
+        snode = lys_parent(snode);
+    } while (snode && (snode->nodetype & (LYS_USES | LYS_CHOICE | LYS_CASE | LYS_INPUT | LYS_OUTPUT)));
+
+    return snode;
+}
+
+/**
+ * @brief Check that a leafref path step (in JSON format) refers to the schema node.
+ */
+static int
+resolve_leafref_step_match(const char *step, int len, const struct lys_node *snode)
+{
+    const char *name;
+    int mod_len;
+
+    name = memchr(step, ':', len);
+    if (name) {
+        mod_len = name - step;
+        if (strncmp(step, lys_node_module(snode)->name, mod_len) || lys_node_module(snode)->name[mod_len]) {
+            return 0;
+        }
+        ++name;
+        len -= mod_len + 1;
+    } else {
+        name = step;
+    }
+
+    return !strncmp(name, snode->name, len) && !snode->name[len];
+}
+
+/**
+ * @brief Try to resolve a leafref without evaluating its path as an XPath expression. Instead, the path
+ * is followed in the data tree and the target is looked up by its value (in the data node hash tables,
+ * if available). Only paths without predicates whose only multiple-instance node is the target leaf-list
+ * or the list with the target as its only key are supported.
+ *
+ * @param[in] leaf Leafref data node.
+ * @param[in] type Leafref type.
+ * @param[out] ret Target data node or NULL if there is none.
+ *
+ * @return 0 if resolved (even if the target does not exist), 1 if the path is not supported.
+ */
+static int
+resolve_leafref_hash(struct lyd_node_leaf_list *leaf, const struct lys_type *type, struct lyd_node **ret)
+{
+    const struct lys_node *snodes[LY_LREF_HASH_MAX_STEPS], *snode;
+    const struct lyd_node *ctx_node, *siblings;
+    struct lyd_node_leaf_list dummy_leaf;
+    struct lyd_node dummy_node, *match;
+    const char *path, *step;
+    int root, steps, i, len;
+
+    path = type->info.lref.path;
+    if (!type->info.lref.target || strpbrk(path, "[ \t\n")) {
+        /* unresolved schema target or predicates */
+        return 1;
+    }
+
+    /* move to the context node of the first descendant step */
+    ctx_node = (struct lyd_node *)leaf;
+    root = 0;
+    if (path[0] == '/') {
+        root = 1;
+    } else {
+        while (!strncmp(path, "../", 3)) {
+            if (root) {
+                /* parent of the root */
+                return 1;
+            }
+            ctx_node = ctx_node->parent;
+            if (!ctx_node) {
+                root = 1;
+            }
+            path += 3;
+        }
+        if (path == type->info.lref.path) {
+            /* no parent step, should not happen */
+            return 1;
+        }
+        --path;
+    }
+
+    /* learn the schema nodes of all the descendant steps from the target */
+    for (steps = 0, step = path; step; step = strchr(step + 1, '/')) {
+        ++steps;
+    }
+    if (steps > LY_LREF_HASH_MAX_STEPS) {
+        return 1;
+    }
+    snode = (struct lys_node *)type->info.lref.target;
+    for (i = steps - 1; i > -1; --i) {
+        if (!snode) {
+            return 1;
+        }
+        snodes[i] = snode;
+        snode = resolve_leafref_data_parent(snode);
+    }
+
+    if (root) {
+        /* any top-level sibling */
+        for (siblings = (struct lyd_node *)leaf; siblings->parent; siblings = siblings->parent);
+    } else {
+        siblings = ctx_node->child;
+    }
+
+    *ret = NULL;
+    memset(&dummy_node, 0, sizeof dummy_node);
+    memset(&dummy_leaf, 0, sizeof dummy_leaf);
+    for (i = 0, step = path + 1; i < steps; ++i, step += len + 1) {
+        len = strchr(step, '/') ? strchr(step, '/') - step : (int)strlen(step);
+        if (!resolve_leafref_step_match(step, len, snodes[i])) {
+            return 1;
+        }
+
+        if ((i == steps - 2) && (snodes[i]->nodetype == LYS_LIST) && (((struct lys_node_list *)snodes[i])->keys_size == 1)
+                && (((struct lys_node_list *)snodes[i])->keys[0] == (struct lys_node_leaf *)snodes[i + 1])) {
+            /* list with the target as its only key */
+            dummy_leaf.schema = (struct lys_node *)snodes[i + 1];
+            dummy_leaf.value_str = leaf->value_str;
+            dummy_leaf.prev = (struct lyd_node *)&dummy_leaf;
+            dummy_leaf.parent = &dummy_node;
+            dummy_node.schema = (struct lys_node *)snodes[i];
+            dummy_node.child = (struct lyd_node *)&dummy_leaf;
+            dummy_node.prev = &dummy_node;
+#ifdef LY_ENABLED_CACHE
+            lyd_hash(&dummy_node);
+#endif
+            if (lyd_find_sibling(siblings, &dummy_node, &match)) {
+                return -1;
+            }
+            /* keys are always the first children */
+            *ret = match ? match->child : NULL;
+            return 0;
+        }
+
+        if ((i == steps - 1) && (snodes[i]->nodetype == LYS_LEAFLIST) && (snodes[i]->flags & LYS_CONFIG_W)) {
+            /* target leaf-list instance */
+            dummy_leaf.schema = (struct lys_node *)snodes[i];
+            dummy_leaf.value_str = leaf->value_str;
+            dummy_leaf.prev = (struct lyd_node *)&dummy_leaf;
+#ifdef LY_ENABLED_CACHE
+            lyd_hash((struct lyd_node *)&dummy_leaf);
+#endif
+            if (lyd_find_sibling(siblings, (struct lyd_node *)&dummy_leaf, ret)) {
+                return -1;
+            }
+            return 0;
+        }
+
+        if (!(snodes[i]->nodetype & (LYS_CONTAINER | LYS_LEAF))) {
+            /* there can be several instances */
+            return 1;
+        }
+
+        /* the only instance */
+        dummy_node.schema = (struct lys_node *)snodes[i];
+        dummy_node.prev = &dummy_node;
+#ifdef LY_ENABLED_CACHE
+        lyd_hash(&dummy_node);
+#endif
+        if (lyd_find_sibling(siblings, &dummy_node, &match)) {
+            return -1;
+        }
+        if (!match) {
+            return 0;
+        }
+
+        if (i == steps - 1) {
+            /* target leaf */
+            if ((match->schema->nodetype == LYS_LEAF)
+                    && ly_strequal(leaf->value_str, ((struct lyd_node_leaf_list *)match)->value_str, 1)) {
+                *ret = match;
+            }
+            return 0;
+        }
+        siblings = match->child;
+    }
+
+    /* unreachable */
+    return 1;
+}
+
 int
-resolve_leafref(struct lyd_node_leaf_list *leaf, const char *path, int req_inst, struct lyd_node **ret)
+resolve_leafref(struct lyd_node_leaf_list *leaf, const struct lys_type *type, int req_inst, struct lyd_node **ret)
 {
+    struct lyxp_expr *exp;
     struct lyxp_set xp_set;
+    const char *path = type->info.lref.path;
     uint32_t i;
+    int rc;
 
     memset(&xp_set, 0, sizeof xp_set);
     *ret = NULL;
 
+    /* most leafrefs refer to a leaf-list or a list key that can be found directly */
+    rc = resolve_leafref_hash(leaf, type, ret);
+    if (rc == -1) {
+        return -1;
+    } else if (!rc) {
+        goto finish;
+    }
+
     /* syntax was already checked, so just evaluate the path using standard XPath */
-    if (lyxp_eval(path, (struct lyd_node *)leaf, LYXP_NODE_ELEM, lyd_node_module((struct lyd_node *)leaf), &xp_set, 0) != EXIT_SUCCESS) {
+    exp = lyxp_expr_cached(leaf->schema->module->ctx, path);
+    if (!exp || (lyxp_eval_expr(exp, (struct lyd_node *)leaf, LYXP_NODE_ELEM, lyd_node_module((struct lyd_node *)leaf),
+                                &xp_set, 0) != EXIT_SUCCESS)) {
         return -1;
     }
 
@@ -7996,6 +8237,7 @@ resolve_leafref(struct lyd_node_leaf_list *leaf, const char *path, int req_inst,
 
     lyxp_set_cast(&xp_set, LYXP_SET_EMPTY, (struct lyd_node *)leaf, NULL, 0);
 
+finish:
     if (!*ret) {
         /* reference not found */
         if (req_inst > -1) {
@@ -8050,7 +8292,7 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
                 req_inst = t->info.lref.req;
             }
 
-            if (!resolve_leafref(leaf, t->info.lref.path, req_inst, &ret)) {
+            if (!resolve_leafref(leaf, t, req_inst, &ret)) {
                 if (store) {
                     if (ret && !(leaf->schema->flags & LYS_LEAFREF_DEP)) {
                         /* valid resolved */
@@ -8185,7 +8427,7 @@ resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_
             rc = 0;
             ret = NULL;
         } else {
-            rc = resolve_leafref(leaf, sleaf->type.info.lref.path, req_inst, &ret);
+            rc = resolve_leafref(leaf, &sleaf->type, req_inst, &ret);
         }
         if (!rc) {
             if (ret && !(leaf->schema->flags & LYS_LEAFREF_DEP)) {
@@ -8362,6 +8604,109 @@ resolve_unres_data_autodel_diff(struct unres_data *unres, uint32_t unres_i)
     unres->node[unres_i] = NULL;
 }
 
+/* number of unres items a validation thread takes at once, neighboring items are mostly in the same subtree */
+#define UNRES_DATA_THREAD_CHUNK 64
+
+struct unres_data_threads {
+    struct unres_data *unres;
+    uint32_t next;              /* first item not taken by any thread yet */
+    pthread_mutex_t lock;
+};
+
+static void *
+resolve_unres_data_must_thread(void *arg)
+{
+    struct unres_data_threads *thr = (struct unres_data_threads *)arg;
+    struct unres_data *unres = thr->unres;
+    enum int_log_opts prev_ilo;
+    uint32_t i, end;
+
+    /* failed items are left unresolved and evaluated again in order by the caller, which logs the error
+     * or the ignored failure, so they are never ignored here */
+    ly_ilo_change(NULL, ILO_IGNORE, &prev_ilo, NULL);
+    lyxp_doc_pos_hold();
+
+    while (1) {
+        pthread_mutex_lock(&thr->lock);
+        i = thr->next;
+        end = (unres->count - i > UNRES_DATA_THREAD_CHUNK) ? i + UNRES_DATA_THREAD_CHUNK : unres->count;
+        thr->next = end;
+        pthread_mutex_unlock(&thr->lock);
+
+        if (i == end) {
+            break;
+        }
+
+        for (; i < end; ++i) {
+            if (((unres->type[i] == UNRES_MUST) || (unres->type[i] == UNRES_MUST_INOUT))
+                    && !resolve_unres_data_item(unres->node[i], unres->type[i], 0, NULL)) {
+                unres->type[i] = UNRES_RESOLVED;
+            }
+        }
+    }
+
+    lyxp_doc_pos_release();
+    ly_ilo_restore(NULL, prev_ilo, NULL, 0);
+    return NULL;
+}
+
+/**
+ * @brief Evaluate must conditions of the unres data items in several threads, see #LYD_OPT_VAL_PARALLEL.
+ *
+ * Evaluating the conditions does not modify the data tree, so once all the other changes are done,
+ * the items can be evaluated in any order. Only the satisfied items are resolved, the rest (including
+ * the failures that may be ignored) is left for the caller.
+ *
+ * @param[in] ctx Context used.
+ * @param[in] unres Unres data structure to use.
+ */
+static void
+resolve_unres_data_must_parallel(struct ly_ctx *ctx, struct unres_data *unres)
+{
+    struct unres_data_threads thr;
+    pthread_t *threads;
+    uint32_t i, must_count = 0;
+    long thread_count;
+
+    for (i = 0; i < unres->count; ++i) {
+        if ((unres->type[i] == UNRES_MUST) || (unres->type[i] == UNRES_MUST_INOUT)) {
+            ++must_count;
+        }
+    }
+
+    thread_count = ctx->val_threads ? ctx->val_threads : sysconf(_SC_NPROCESSORS_ONLN);
+    if (thread_count > must_count / UNRES_DATA_THREAD_CHUNK) {
+        /* not worth it for few items */
+        thread_count = must_count / UNRES_DATA_THREAD_CHUNK;
+    }
+    if (thread_count < 2) {
+        return;
+    }
+
+    threads = malloc((thread_count - 1) * sizeof *threads);
+    LY_CHECK_ERR_RETURN(!threads, LOGMEM(ctx), );
+
+    thr.unres = unres;
+    thr.next = 0;
+    pthread_mutex_init(&thr.lock, NULL);
+
+    for (i = 0; i < thread_count - 1; ++i) {
+        if (pthread_create(&threads[i], NULL, resolve_unres_data_must_thread, &thr)) {
+            /* fine, just fewer threads */
+            break;
+        }
+    }
+
+    /* the calling thread works, too */
+    resolve_unres_data_must_thread(&thr);
+
+    while (i) {
+        pthread_join(threads[--i], NULL);
+    }
+    pthread_mutex_destroy(&thr.lock);
+    free(threads);
+}
+
 /**
  * @brief Resolve every unres data item in the structure. Logs directly.
  *
@@ -8371,6 +8716,8 @@ resolve_unres_data_autodel_diff(struct unres_data *unres, uint32_t unres_i)
  *
  * If options includes #LYD_OPT_WHENAUTODEL, the non-default nodes with false when conditions are auto-deleted.
  *
+ * If options includes #LYD_OPT_VAL_PARALLEL, the must conditions are evaluated in several threads.
+ *
  * @param[in] ctx Context used.
  * @param[in] unres Unres data structure to use.
  * @param[in,out] root Root node of the data tree, can be changed due to autodeletion.
@@ -8602,6 +8949,11 @@ resolve_unres_data(struct ly_ctx *ctx, struct unres_data *unres, struct lyd_node
     /*
      * rest
      */
+    /* the tree is not modified anymore, document positions can be reused by all the XPath evaluations */
+    lyxp_doc_pos_hold();
+    if ((options & LYD_OPT_VAL_PARALLEL) && !(options & LYD_OPT_TRUSTED)) {
+        resolve_unres_data_must_parallel(ctx, unres);
+    }
     for (i = 0; i < unres->count; ++i) {
         if (unres->type[i] == UNRES_RESOLVED) {
             continue;
@@ -8611,11 +8963,13 @@ resolve_unres_data(struct ly_ctx *ctx, struct unres_data *unres, struct lyd_node
         rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, NULL);
         if (rc) {
             /* since when was already resolved, a forward reference is an error */
+            lyxp_doc_pos_release();
             return -1;
         }
 
         unres->type[i] = UNRES_RESOLVED;
     }
+    lyxp_doc_pos_release();
 
     LOGVRB("All data nodes and constraints resolved.");
     unres->count = 0;
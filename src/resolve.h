@@ -98,6 +98,8 @@ struct unres_data {
     struct lyd_difflist *diff;
     unsigned int diff_size;
     unsigned int diff_idx;
+
+    struct ly_arena *arena;     /* arena to allocate the parsed data nodes from, if any */
 };
 
 /**
@@ -244,7 +246,18 @@ void unres_schema_free(struct lys_module *module, struct unres_schema **unres, i
  */
 int resolve_instid(struct lyd_node *data, const char *path, int req_inst, struct lyd_node **ret);
 
-int resolve_leafref(struct lyd_node_leaf_list *leaf, const char *path, int req_inst, struct lyd_node **ret);
+/**
+ * @brief Resolve a leafref data node value. Logs directly.
+ *
+ * @param[in] leaf Leafref data node.
+ * @param[in] type Leafref type of \p leaf (it may be a union member).
+ * @param[in] req_inst Whether the target must exist (-1 - no, 0/1 - yes).
+ * @param[out] ret Target data node or NULL.
+ *
+ * @return EXIT_SUCCESS on success (even if unresolved and \p ret is NULL), EXIT_FAILURE if the
+ * target does not exist and is required, -1 on error.
+ */
+int resolve_leafref(struct lyd_node_leaf_list *leaf, const struct lys_type *type, int req_inst, struct lyd_node **ret);
 
 int resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store, int ignore_fail,
                   struct lys_type **resolved_type);
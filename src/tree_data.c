@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include "libyang.h"
 #include "common.h"
@@ -45,6 +46,12 @@ static struct lyd_node *lyd_dup_withsiblings_to_ctx(const struct lyd_node *node,
 static struct lyd_node *lyd_new_dummy(struct lyd_node *root, struct lyd_node *parent, const struct lys_node *schema,
                                       const char *value, int dflt);
 
+static int lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct lyd_node *subroot,
+                              struct lys_node *schema, int toplevel, int options, struct unres_data *unres, int shallow);
+
+static int lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module **modules, int mod_count,
+                      struct unres_data *unres, int options, int shallow);
+
 static int
 lyd_anydata_equal(struct lyd_node *first, struct lyd_node *second)
 {
@@ -694,11 +701,12 @@ lyd_check_mandatory_data(struct lyd_node *root, struct lyd_node *last_parent,
  * @param[in] schema The schema node being checked for mandatory nodes
  * @param[in] toplevel, see the \p root parameter description
  * @param[in] options @ref parseroptions to specify the type of the data tree.
+ * @param[in] shallow Flag to not go recursively into the existing list and container instances.
  * @return EXIT_SUCCESS or EXIT_FAILURE if there are missing mandatory nodes
  */
 static int
 lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, struct lyd_node *last_parent,
-                            struct lys_node *schema, int toplevel, int options)
+                            struct lys_node *schema, int toplevel, int options, int shallow)
 {
     struct lys_node *siter, *siter_prev;
     struct lyd_node *iter;
@@ -744,9 +752,9 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
         }
 
         /* go recursively */
-        for (u = 0; u < present->number; u++) {
+        for (u = 0; !shallow && (u < present->number); u++) {
             LY_TREE_FOR(schema->child, siter) {
-                if (lyd_check_mandatory_subtree(tree, present->set.d[u], present->set.d[u], siter, 0, options)) {
+                if (lyd_check_mandatory_subtree(tree, present->set.d[u], present->set.d[u], siter, 0, options, shallow)) {
                     goto error;
                 }
             }
@@ -754,12 +762,12 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
         break;
 
     case LYS_CONTAINER:
-        if (present->number || !((struct lys_node_container *)schema)->presence) {
+        if (present->number ? !shallow : !((struct lys_node_container *)schema)->presence) {
             /* if we have existing or non-presence container, go recursively */
             LY_TREE_FOR(schema->child, siter) {
                 if (lyd_check_mandatory_subtree(tree, present->number ? present->set.d[0] : NULL,
                                                 present->number ? present->set.d[0] : last_parent,
-                                                siter, 0, options)) {
+                                                siter, 0, options, shallow)) {
                     goto error;
                 }
             }
@@ -795,7 +803,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
             if (((struct lys_node_choice *)schema)->dflt) {
                 /* there is a default case */
                 if (lyd_check_mandatory_subtree(tree, subtree, last_parent, ((struct lys_node_choice *)schema)->dflt,
-                                                toplevel, options)) {
+                                                toplevel, options, shallow)) {
                     goto error;
                 }
             } else if (schema->flags & LYS_MAND_TRUE) {
@@ -808,7 +816,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
             /* since iter != NULL, siter must be also != NULL and we also know siter_prev
              * which points to the child of schema leading towards the instantiated data */
             assert(siter && siter_prev);
-            if (lyd_check_mandatory_subtree(tree, subtree, last_parent, siter_prev, toplevel, options)) {
+            if (lyd_check_mandatory_subtree(tree, subtree, last_parent, siter_prev, toplevel, options, shallow)) {
                 goto error;
             }
         }
@@ -825,7 +833,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
     case LYS_OUTPUT:
         /* go recursively */
         LY_TREE_FOR(schema->child, siter) {
-            if (lyd_check_mandatory_subtree(tree, subtree, last_parent, siter, toplevel, options)) {
+            if (lyd_check_mandatory_subtree(tree, subtree, last_parent, siter, toplevel, options, shallow)) {
                 goto error;
             }
         }
@@ -842,9 +850,9 @@ error:
     return ret;
 }
 
-int
-lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct lys_module **modules, int mod_count,
-                         int options)
+static int
+_lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct lys_module **modules, int mod_count,
+                          int options, int shallow)
 {
     struct lys_node *siter;
     int i;
@@ -864,14 +872,14 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct
 
     if (!(options & LYD_OPT_TYPEMASK) || (options & LYD_OPT_CONFIG)) {
         if (options & LYD_OPT_NOSIBLINGS) {
-            if (root && lyd_check_mandatory_subtree(root, NULL, NULL, root->schema, 1, options)) {
+            if (root && lyd_check_mandatory_subtree(root, NULL, NULL, root->schema, 1, options, shallow)) {
                 return EXIT_FAILURE;
             }
         } else if (modules && mod_count) {
             for (i = 0; i < mod_count; ++i) {
                 LY_TREE_FOR(modules[i]->data, siter) {
                     if (!(siter->nodetype & (LYS_RPC | LYS_NOTIF)) &&
-                            lyd_check_mandatory_subtree(root, NULL, NULL, siter, 1, options)) {
+                            lyd_check_mandatory_subtree(root, NULL, NULL, siter, 1, options, shallow)) {
                         return EXIT_FAILURE;
                     }
                 }
@@ -888,7 +896,7 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct
                 }
                 LY_TREE_FOR(ctx->models.list[i]->data, siter) {
                     if (!(siter->nodetype & (LYS_RPC | LYS_NOTIF)) &&
-                            lyd_check_mandatory_subtree(root, NULL, NULL, siter, 1, options)) {
+                            lyd_check_mandatory_subtree(root, NULL, NULL, siter, 1, options, shallow)) {
                         return EXIT_FAILURE;
                     }
                 }
@@ -899,7 +907,7 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct
             LOGERR(ctx, LY_EINVAL, "Subtree is not a single notification.");
             return EXIT_FAILURE;
         }
-        if (root->schema->child && lyd_check_mandatory_subtree(root, root, root, root->schema, 0, options)) {
+        if (root->schema->child && lyd_check_mandatory_subtree(root, root, root, root->schema, 0, options, shallow)) {
             return EXIT_FAILURE;
         }
     } else if (options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY)) {
@@ -912,11 +920,11 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct
         } else { /* LYD_OPT_RPCREPLY */
             for (siter = root->schema->child; siter && siter->nodetype != LYS_OUTPUT; siter = siter->next);
         }
-        if (siter && lyd_check_mandatory_subtree(root, root, root, siter, 0, options)) {
+        if (siter && lyd_check_mandatory_subtree(root, root, root, siter, 0, options, shallow)) {
             return EXIT_FAILURE;
         }
     } else if (options & LYD_OPT_DATA_TEMPLATE) {
-        if (root && lyd_check_mandatory_subtree(root, NULL, NULL, root->schema, 1, options)) {
+        if (root && lyd_check_mandatory_subtree(root, NULL, NULL, root->schema, 1, options, shallow)) {
             return EXIT_FAILURE;
         }
     } else {
@@ -927,41 +935,29 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct
     return EXIT_SUCCESS;
 }
 
+int
+lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, const struct lys_module **modules, int mod_count,
+                         int options)
+{
+    return _lyd_check_mandatory_tree(root, ctx, modules, mod_count, options, 0);
+}
+
 static struct lyd_node *
 lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data, LYD_FORMAT format, int options,
            const struct lyd_node *data_tree, const char *yang_data_name)
 {
-    struct lyxml_elem *xml;
     struct lyd_node *result = NULL;
-    int xmlopt = LYXML_PARSE_MULTIROOT;
 
     if (!ctx || !data) {
         LOGARG;
         return NULL;
     }
 
-    if (options & LYD_OPT_NOSIBLINGS) {
-        xmlopt = 0;
-    }
-
     /* we must free all the errors, otherwise we are unable to properly check returned ly_errno :-/ */
     ly_errno = LY_SUCCESS;
     switch (format) {
     case LYD_XML:
-        xml = lyxml_parse_mem(ctx, data, xmlopt);
-        if (ly_errno) {
-            break;
-        }
-        if (options & LYD_OPT_RPCREPLY) {
-            result = lyd_parse_xml(ctx, &xml, options, rpc_act, data_tree);
-        } else if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) {
-            result = lyd_parse_xml(ctx, &xml, options, data_tree);
-        } else if (options & LYD_OPT_DATA_TEMPLATE) {
-            result = lyd_parse_xml(ctx, &xml, options, yang_data_name);
-        } else {
-            result = lyd_parse_xml(ctx, &xml, options);
-        }
-        lyxml_free_withsiblings(ctx, xml);
+        result = lyd_parse_xml_mem(ctx, data, options, rpc_act, data_tree, yang_data_name);
         break;
     case LYD_JSON:
         result = lyd_parse_json(ctx, data, options, rpc_act, data_tree, yang_data_name);
@@ -988,52 +984,68 @@ lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data,
     return result;
 }
 
-static struct lyd_node *
-lyd_parse_data_(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, va_list ap)
+static int
+lyd_parse_args(struct ly_ctx *ctx, int options, va_list ap, const struct lyd_node **rpc_act,
+               const struct lyd_node **data_tree, const char **yang_data_name, const char *func)
 {
-    const struct lyd_node *rpc_act = NULL, *data_tree = NULL, *iter;
-    const char *yang_data_name = NULL;
+    const struct lyd_node *iter;
 
-    if (lyp_data_check_options(ctx, options, __func__)) {
-        return NULL;
+    *rpc_act = *data_tree = NULL;
+    *yang_data_name = NULL;
+
+    if (lyp_data_check_options(ctx, options, func)) {
+        return EXIT_FAILURE;
     }
 
     if (options & LYD_OPT_RPCREPLY) {
-        rpc_act = va_arg(ap, const struct lyd_node *);
-        if (!rpc_act || rpc_act->parent || !(rpc_act->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
-            LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-            return NULL;
+        *rpc_act = va_arg(ap, const struct lyd_node *);
+        if (!*rpc_act || (*rpc_act)->parent || !((*rpc_act)->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
+            LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", func);
+            return EXIT_FAILURE;
         }
     }
     if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF | LYD_OPT_RPCREPLY)) {
-        data_tree = va_arg(ap, const struct lyd_node *);
-        if (data_tree) {
+        *data_tree = va_arg(ap, const struct lyd_node *);
+        if (*data_tree) {
             if (options & LYD_OPT_NOEXTDEPS) {
                 LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree and LYD_OPT_NOEXTDEPS set).",
-                       __func__);
-                return NULL;
+                       func);
+                return EXIT_FAILURE;
             }
 
-            LY_TREE_FOR(data_tree, iter) {
+            LY_TREE_FOR(*data_tree, iter) {
                 if (iter->parent) {
                     /* a sibling is not top-level */
-                    LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
-                    return NULL;
+                    LOGERR(ctx, LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", func);
+                    return EXIT_FAILURE;
                 }
             }
 
             /* move it to the beginning */
-            for (; data_tree->prev->next; data_tree = data_tree->prev);
+            for (; (*data_tree)->prev->next; *data_tree = (*data_tree)->prev);
 
             /* LYD_OPT_NOSIBLINGS cannot be set in this case */
             if (options & LYD_OPT_NOSIBLINGS) {
-                LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
-                return NULL;
+                LOGERR(ctx, LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", func);
+                return EXIT_FAILURE;
             }
         }
     }
     if (options & LYD_OPT_DATA_TEMPLATE) {
-        yang_data_name = va_arg(ap, const char *);
+        *yang_data_name = va_arg(ap, const char *);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static struct lyd_node *
+lyd_parse_data_(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, va_list ap)
+{
+    const struct lyd_node *rpc_act, *data_tree;
+    const char *yang_data_name;
+
+    if (lyd_parse_args(ctx, options, ap, &rpc_act, &data_tree, &yang_data_name, __func__)) {
+        return NULL;
     }
 
     return lyd_parse_(ctx, rpc_act, data, format, options, data_tree, yang_data_name);
@@ -1054,6 +1066,31 @@ lyd_parse_mem(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int optio
     return result;
 }
 
+API struct lyd_json_stream *
+lyd_json_stream_new(struct ly_ctx *ctx, int options, ...)
+{
+    FUN_IN;
+
+    va_list ap;
+    const struct lyd_node *rpc_act, *data_tree;
+    const char *yang_data_name;
+    int r;
+
+    if (!ctx) {
+        LOGARG;
+        return NULL;
+    }
+
+    va_start(ap, options);
+    r = lyd_parse_args(ctx, options, ap, &rpc_act, &data_tree, &yang_data_name, __func__);
+    va_end(ap);
+    if (r) {
+        return NULL;
+    }
+
+    return lyd_json_stream_create(ctx, options, rpc_act, data_tree, yang_data_name);
+}
+
 static struct lyd_node *
 lyd_parse_fd_(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_list ap)
 {
@@ -1073,6 +1110,12 @@ lyd_parse_fd_(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_lis
         return NULL;
     }
 
+    if (format == LYD_LYB) {
+        /* LYB strings are inserted into the dictionary right from the mapped image, so parsing it
+         * is mostly about faulting the pages in, let the kernel read ahead aggressively */
+        madvise(data, length, MADV_SEQUENTIAL);
+    }
+
     ret = lyd_parse_data_(ctx, data, format, options, ap);
 
     lyp_munmap(data, length);
@@ -1147,6 +1190,29 @@ lyd_new_find_schema(struct lyd_node *parent, const struct lys_module *module, in
     return siblings;
 }
 
+struct lyd_node *
+lyd_node_calloc(size_t size, struct ly_arena *arena)
+{
+    struct lyd_node *node;
+
+    if (arena && (node = ly_arena_calloc(arena, size))) {
+        node->arena = 1;
+        return node;
+    }
+
+    return calloc(1, size);
+}
+
+void
+lyd_node_free_mem(struct lyd_node *node)
+{
+    if (node && node->arena) {
+        ly_arena_free(node);
+    } else {
+        free(node);
+    }
+}
+
 struct lyd_node *
 _lyd_new(struct lyd_node *parent, const struct lys_node *schema, int dflt)
 {
@@ -1329,6 +1395,15 @@ lyd_wd_update_parents(struct lyd_node *node)
     }
 }
 
+/* note the change of a node in all its parents for the incremental validation */
+static void
+lyd_val_changed_parents(struct lyd_node *parent)
+{
+    for (; parent && !(parent->validity & LYD_VAL_INSUB); parent = parent->parent) {
+        parent->validity |= LYD_VAL_INSUB;
+    }
+}
+
 API int
 lyd_change_leaf(struct lyd_node_leaf_list *leaf, const char *val_str)
 {
@@ -1376,6 +1451,7 @@ lyd_change_leaf(struct lyd_node_leaf_list *leaf, const char *val_str)
     if (val_change) {
         /* make the node non-validated */
         leaf->validity = ly_new_node_validity(leaf->schema);
+        lyd_val_changed_parents(leaf->parent);
 
         /* set unique validation flag for parent list */
         if (leaf->schema->flags & LYS_UNIQUE) {
@@ -2939,6 +3015,13 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
     }
     target = *trg;
 
+    /* the nodes not parsed yet are merged, too */
+    for (node = target; node->parent; node = node->parent);
+    if (lyb_lazy_load_tree(node, 1) || lyb_lazy_load_tree(src, !(options & LYD_OPT_NOSIBLINGS))) {
+        return -1;
+    }
+    node = NULL;
+
     parent = lys_parent(target->schema);
 
     /* go up all uses */
@@ -3218,7 +3301,7 @@ lyd_difflist_add(struct lyd_difflist *diff, unsigned int *size, unsigned int ind
 
     if (index + 1 == *size) {
         /* it's time to enlarge */
-        *size = *size + 16;
+        *size = *size * 2;
         new = realloc(diff->type, *size * sizeof *diff->type);
         LY_CHECK_ERR_RETURN(!new, LOGMEM(ctx), EXIT_FAILURE);
         diff->type = new;
@@ -3246,46 +3329,70 @@ lyd_difflist_add(struct lyd_difflist *diff, unsigned int *size, unsigned int ind
     return EXIT_SUCCESS;
 }
 
-struct diff_ordered_dist {
-    struct diff_ordered_dist *next;
-    int dist;
-};
 struct diff_ordered_item {
     struct lyd_node *first;
     struct lyd_node *second;
-    struct diff_ordered_dist *dist;
+    uint32_t pos;                       /* position of first among the matched instances in the first tree */
 };
 struct diff_ordered {
     struct lys_node *schema;
-    struct lyd_node *parent;
-    unsigned int count;
-    struct diff_ordered_item *items; /* array */
-    struct diff_ordered_dist *dist;  /* linked list (1-way, ring) */
-    struct diff_ordered_dist *dist_last;  /* aux pointer for faster insertion sort */
+    struct lyd_node *parent;            /* parent in the first tree */
+    unsigned int count;                 /* number of the matched instances */
+    unsigned int used;                  /* number of filled items */
+    struct diff_ordered_item *items;    /* array in the order of the second tree */
 };
 
 static int
-diff_ordset_insert(struct lyd_node *node, struct ly_set *ordset)
+diff_ordered_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
 {
-    unsigned int i;
-    struct diff_ordered *new_ordered, *iter;
+    struct diff_ordered *ord1 = *(struct diff_ordered **)val1_p, *ord2 = *(struct diff_ordered **)val2_p;
 
-    for (i = 0; i < ordset->number; i++) {
-        iter = (struct diff_ordered *)ordset->set.g[i];
-        if (iter->schema == node->schema && iter->parent == node->parent) {
-            break;
-        }
+    return (ord1->schema == ord2->schema) && (ord1->parent == ord2->parent);
+}
+
+static uint32_t
+diff_ordered_hash(struct lys_node *schema, struct lyd_node *parent)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&schema, sizeof schema);
+    hash = dict_hash_multi(hash, (const char *)&parent, sizeof parent);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static struct diff_ordered *
+diff_ordset_find(struct hash_table *ordht, struct lys_node *schema, struct lyd_node *parent)
+{
+    struct diff_ordered key, *key_p = &key, **match;
+
+    key.schema = schema;
+    key.parent = parent;
+    if (lyht_find(ordht, &key_p, diff_ordered_hash(schema, parent), (void **)&match)) {
+        return NULL;
     }
-    if (i == ordset->number) {
-        /* not seen user-ordered list */
-        new_ordered = calloc(1, sizeof *new_ordered);
-        LY_CHECK_ERR_RETURN(!new_ordered, LOGMEM(node->schema->module->ctx), EXIT_FAILURE);
-        new_ordered->schema = node->schema;
-        new_ordered->parent = node->parent;
+    return *match;
+}
+
+static int
+diff_ordset_insert(struct lyd_node *node, struct ly_set *ordset, struct hash_table *ordht)
+{
+    struct diff_ordered *ordered;
 
-        ly_set_add(ordset, new_ordered, LY_SET_OPT_USEASLIST);
+    ordered = diff_ordset_find(ordht, node->schema, node->parent);
+    if (!ordered) {
+        /* not seen user-ordered list */
+        ordered = calloc(1, sizeof *ordered);
+        LY_CHECK_ERR_RETURN(!ordered, LOGMEM(node->schema->module->ctx), EXIT_FAILURE);
+        ordered->schema = node->schema;
+        ordered->parent = node->parent;
+
+        if ((ly_set_add(ordset, ordered, LY_SET_OPT_USEASLIST) == -1)
+                || lyht_insert(ordht, &ordered, diff_ordered_hash(ordered->schema, ordered->parent), NULL)) {
+            free(ordered);
+            return EXIT_FAILURE;
+        }
     }
-    ((struct diff_ordered *)ordset->set.g[i])->count++;
+    ordered->count++;
 
     return EXIT_SUCCESS;
 }
@@ -3293,7 +3400,7 @@ diff_ordset_insert(struct lyd_node *node, struct ly_set *ordset)
 static void
 diff_ordset_free(struct ly_set *set)
 {
-    unsigned int i, j;
+    unsigned int i;
     struct diff_ordered *ord;
 
     if (!set) {
@@ -3302,9 +3409,6 @@ diff_ordset_free(struct ly_set *set)
 
     for (i = 0; i < set->number; i++) {
         ord = (struct diff_ordered *)set->set.g[i];
-        for (j = 0; j < ord->count; j++) {
-            free(ord->items[j].dist);
-        }
         free(ord->items);
         free(ord);
     }
@@ -3354,14 +3458,14 @@ lyd_diff_compare(struct lyd_node *first, struct lyd_node *second, int options)
  */
 static int
 lyd_diff_match(struct lyd_node *first, struct lyd_node *second, struct lyd_difflist *diff, unsigned int *size,
-               unsigned int *i, struct ly_set *matchset, struct ly_set *ordset, int options)
+               unsigned int *i, struct ly_set *matchset, struct ly_set *ordset, struct hash_table *ordht, int options)
 {
     switch (first->schema->nodetype) {
     case LYS_LEAFLIST:
     case LYS_LIST:
         /* additional work for future move matching in case of user ordered lists */
-        if (first->schema->flags & LYS_USERORDERED) {
-            diff_ordset_insert(first, ordset);
+        if ((first->schema->flags & LYS_USERORDERED) && diff_ordset_insert(first, ordset, ordht)) {
+            return -1;
         }
 
         /* falls through */
@@ -3404,125 +3508,244 @@ lyd_diff_match(struct lyd_node *first, struct lyd_node *second, struct lyd_diffl
     return 0;
 }
 
-/* @brief compare if the nodes are equivalent including checking the list's keys
- * Go through the nodes and their parents and in the case of list, compare its keys.
- *
- * @return 0 different, 1 equivalent
- */
 static int
-lyd_diff_equivnode(struct lyd_node *first, struct lyd_node *second)
+lyd_diff_move_preprocess(struct hash_table *ordht, struct lyd_node *first, struct lyd_node *second)
 {
-    struct lyd_node *iter1, *iter2;
+    struct ly_ctx *ctx = first->schema->module->ctx;
+    struct diff_ordered *ordered;
 
-    for (iter1 = first, iter2 = second; iter1 && iter2; iter1 = iter1->parent, iter2 = iter2->parent) {
-        if (iter1->schema->module->ctx == iter2->schema->module->ctx) {
-            if (iter1->schema != iter2->schema) {
-                return 0;
-            }
-        } else {
-            if (!ly_strequal(iter1->schema->name, iter2->schema->name, 0)) {
-                /* comparing the names is fine, even if they are, in fact, 2 different nodes
-                 * with equal names, some of their parents will differ */
-                return 0;
-            }
-        }
-        if (iter1->schema->nodetype == LYS_LIST) {
-            /* compare keys */
-            if (lyd_list_equal(iter1, iter2, 0) != 1) {
-                return 0;
-            }
-        }
+    ordered = diff_ordset_find(ordht, first->schema, first->parent);
+    if (!ordered) {
+        /* not a matched instance of a user-ordered list */
+        return 0;
     }
 
-    if (iter1 != iter2) {
-        /* we are supposed to be in root (NULL) in both trees */
-        return 0;
+    if (!ordered->items) {
+        ordered->items = malloc(ordered->count * sizeof *ordered->items);
+        LY_CHECK_ERR_RETURN(!ordered->items, LOGMEM(ctx), -1);
     }
+    LY_CHECK_ERR_RETURN(ordered->used == ordered->count, LOGINT(ctx), -1);
 
-    return 1;
+    /* store the instances in the order of the second tree, their positions in the first tree are
+     * learned only once all of them are matched */
+    ordered->items[ordered->used].first = first;
+    ordered->items[ordered->used].second = second;
+    ordered->used++;
+
+    return 0;
+}
+
+struct diff_ordered_pos {
+    struct lyd_node *node;
+    uint32_t idx;
+};
+
+static int
+diff_ordered_pos_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct diff_ordered_pos *)val1_p)->node == ((struct diff_ordered_pos *)val2_p)->node;
+}
+
+static uint32_t
+diff_ordered_pos_hash(struct lyd_node *node)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&node, sizeof node), NULL, 0);
 }
 
+/* must be called while the matched nodes in the first tree are still marked with LYD_VAL_INUSE */
 static int
-lyd_diff_move_preprocess(struct diff_ordered *ordered, struct lyd_node *first, struct lyd_node *second)
+lyd_diff_move_positions(struct diff_ordered *ordered, struct lyd_node *first)
 {
-    struct ly_ctx *ctx = first->schema->module->ctx;
+    struct ly_ctx *ctx = ordered->schema->module->ctx;
+    struct hash_table *ht;
+    struct diff_ordered_pos rec, *match;
     struct lyd_node *iter;
-    unsigned int pos = 0;
-    int abs_dist;
-    struct diff_ordered_dist *dist_aux;
-    struct diff_ordered_dist *dist_iter, *dist_last;
-    char *str = NULL;
+    uint32_t i, pos = 0;
+    int ret = -1;
 
-    /* ordered->count was zeroed and now it is incremented with each added
-     * item's information, so it is actually position of the second node
-     */
+    ht = lyht_new(1, sizeof rec, diff_ordered_pos_equal, NULL, 1);
+    LY_CHECK_ERR_RETURN(!ht, LOGMEM(ctx), -1);
 
-    /* get the position of the first node */
-    for (iter = first->prev; iter->next; iter = iter->prev) {
-        if (!(iter->validity & LYD_VAL_INUSE)) {
-            /* skip deleted nodes */
+    for (i = 0; i < ordered->used; ++i) {
+        rec.node = ordered->items[i].first;
+        rec.idx = i;
+        LY_CHECK_ERR_GOTO(lyht_insert(ht, &rec, diff_ordered_pos_hash(rec.node), NULL), LOGINT(ctx), cleanup);
+    }
+
+    /* count only the instances not deleted in the second tree */
+    for (iter = (ordered->parent ? ordered->parent->child : first); iter; iter = iter->next) {
+        if ((iter->schema != ordered->schema) || !(iter->validity & LYD_VAL_INUSE)) {
             continue;
         }
-        if (iter->schema == first->schema) {
-            pos++;
+
+        rec.node = iter;
+        if (!lyht_find(ht, &rec, diff_ordered_pos_hash(rec.node), (void **)&match)) {
+            ordered->items[match->idx].pos = pos;
         }
+        ++pos;
     }
-    if (pos != ordered->count) {
-        LOGDBG(LY_LDGDIFF, "detected moved element \"%s\" from %d to %d (distance %d)",
-               str = lyd_path(first), pos, ordered->count, ordered->count - pos);
-        free(str);
+    LY_CHECK_ERR_GOTO(pos != ordered->count, LOGINT(ctx), cleanup);
+
+    ret = 0;
+
+cleanup:
+    lyht_free(ht);
+    return ret;
+}
+
+struct diff_ordered_chain {
+    uint32_t len;               /* length of the increasing subsequence ending with this item */
+    int64_t weight;             /* minus the sum of the position changes of its items */
+    int32_t prev;               /* previous item of the subsequence */
+    int32_t next_first;         /* next item in the first tree as the moves are applied */
+    int32_t prev_first;         /* previous item in the first tree as the moves are applied */
+    uint8_t keep;               /* the item is not moved */
+};
+
+/* whether the subsequence ending with a is better than the one ending with b */
+static int
+diff_ordered_chain_better(struct diff_ordered_chain *chain, int32_t a, int32_t b)
+{
+    if (b == -1) {
+        return 1;
+    } else if (a == -1) {
+        return 0;
     }
 
-    /* store information, count distance */
-    ordered->items[pos].dist = dist_aux = calloc(1, sizeof *dist_aux);
-    LY_CHECK_ERR_RETURN(!dist_aux, LOGMEM(ctx), EXIT_FAILURE);
-    ordered->items[pos].dist->dist = ordered->count - pos;
-    abs_dist = abs(ordered->items[pos].dist->dist);
-    ordered->items[pos].first = first;
-    ordered->items[pos].second = second;
-    ordered->count++;
+    if (chain[a].len != chain[b].len) {
+        return chain[a].len > chain[b].len;
+    }
+    if (chain[a].weight != chain[b].weight) {
+        return chain[a].weight > chain[b].weight;
+    }
+    return a < b;
+}
+
+/*
+ * The instances that stay are the longest subsequence of the second tree order whose positions in the first tree
+ * increase, preferring the instances that change their position the least. The other instances are moved, from the
+ * last one in the second tree, each one just before its successor in the second tree.
+ */
+static int
+lyd_diff_move(struct diff_ordered *ordered, struct lyd_difflist *diff, unsigned int *size, unsigned int *index)
+{
+    struct ly_ctx *ctx = ordered->schema->module->ctx;
+    struct diff_ordered_chain *chain = NULL;
+    int32_t *tree = NULL, *by_pos = NULL, best, i, j, n = ordered->used, tail, after;
+    char *str = NULL;
+    int ret = -1;
+
+    if (n < 2) {
+        return 0;
+    }
+
+    chain = malloc(n * sizeof *chain);
+    tree = malloc((ordered->count + 1) * sizeof *tree);
+    by_pos = malloc(ordered->count * sizeof *by_pos);
+    LY_CHECK_ERR_GOTO(!chain || !tree || !by_pos, LOGMEM(ctx), cleanup);
+    for (i = 0; i <= (signed)ordered->count; ++i) {
+        tree[i] = -1;
+    }
+    for (i = 0; i < (signed)ordered->count; ++i) {
+        by_pos[i] = -1;
+    }
 
-    /* insert sort of distances, higher first */
-    for (dist_iter = ordered->dist, dist_last = NULL;
-            dist_iter;
-            dist_last = dist_iter, dist_iter = dist_iter->next) {
-        if (abs_dist >= abs(dist_iter->dist)) {
-            /* found correct place */
-            dist_aux->next = dist_iter;
-            if (dist_last) {
-                dist_last->next = dist_aux;
+    /* the best subsequences, the (Fenwick) tree holds the best one ending at a position range in the first tree */
+    best = -1;
+    for (i = 0; i < n; ++i) {
+        chain[i].prev = -1;
+        for (j = ordered->items[i].pos; j > 0; j -= j & -j) {
+            if (diff_ordered_chain_better(chain, tree[j], chain[i].prev)) {
+                chain[i].prev = tree[j];
             }
-            break;
-        } else if (dist_iter->next == ordered->dist) {
-            /* last item */
-            dist_aux->next = ordered->dist; /* ring list */
-            ordered->dist_last = dist_aux;
-            break;
         }
-    }
-    if (dist_aux->next == ordered->dist) {
-        if (ordered->dist_last == dist_aux) {
-            /* last item */
-            if (!ordered->dist) {
-                /* the only item */
-                dist_aux->next = dist_aux;
-                ordered->dist = ordered->dist_last = dist_aux;
+        chain[i].len = (chain[i].prev == -1) ? 1 : chain[chain[i].prev].len + 1;
+        chain[i].weight = (chain[i].prev == -1) ? 0 : chain[chain[i].prev].weight;
+        chain[i].weight -= llabs((int64_t)ordered->items[i].pos - i);
+        chain[i].keep = 0;
+
+        for (j = ordered->items[i].pos + 1; j <= (signed)ordered->count; j += j & -j) {
+            if (diff_ordered_chain_better(chain, i, tree[j])) {
+                tree[j] = i;
             }
+        }
+        if (diff_ordered_chain_better(chain, i, best)) {
+            best = i;
+        }
+        by_pos[ordered->items[i].pos] = i;
+    }
+    if (chain[best].len == (unsigned)n) {
+        /* nothing moved */
+        ret = 0;
+        goto cleanup;
+    }
+    for (i = best; i != -1; i = chain[i].prev) {
+        chain[i].keep = 1;
+    }
+
+    /* the first tree order */
+    tail = -1;
+    for (j = 0; j < (signed)ordered->count; ++j) {
+        i = by_pos[j];
+        if (i == -1) {
+            continue;
+        }
+        chain[i].prev_first = tail;
+        chain[i].next_first = -1;
+        if (tail != -1) {
+            chain[tail].next_first = i;
+        }
+        tail = i;
+    }
+
+    for (i = n - 1; i >= 0; --i) {
+        if (chain[i].keep) {
+            continue;
+        }
+
+        /* unlink */
+        if (chain[i].prev_first != -1) {
+            chain[chain[i].prev_first].next_first = chain[i].next_first;
+        }
+        if (chain[i].next_first == -1) {
+            tail = chain[i].prev_first;
         } else {
-            /* first item */
-            ordered->dist = dist_aux;
-            if (dist_aux->next) {
-                /* more than one item, update the last one's next */
-                ordered->dist_last->next = dist_aux;
-            } else {
-                /* the only item */
-                ordered->dist_last = dist_aux;
-                dist_aux->next = dist_aux; /* ring list */
-            }
+            chain[chain[i].next_first].prev_first = chain[i].prev_first;
+        }
+
+        /* link before its successor in the second tree or at the end */
+        if (i == n - 1) {
+            after = tail;
+            chain[i].next_first = -1;
+        } else {
+            after = chain[i + 1].prev_first;
+            chain[i].next_first = i + 1;
+        }
+        chain[i].prev_first = after;
+        if (after != -1) {
+            chain[after].next_first = i;
+        }
+        if (chain[i].next_first == -1) {
+            tail = i;
+        } else {
+            chain[chain[i].next_first].prev_first = i;
+        }
+
+        LOGDBG(LY_LDGDIFF, "detected moved element \"%s\" from %u to %d",
+               str = lyd_path(ordered->items[i].first), ordered->items[i].pos, i);
+        free(str);
+        if (lyd_difflist_add(diff, size, (*index)++, LYD_DIFF_MOVEDAFTER1, ordered->items[i].first,
+                             (after == -1) ? NULL : ordered->items[after].first)) {
+            goto cleanup;
         }
     }
+    ret = 0;
 
-    return 0;
+cleanup:
+    free(chain);
+    free(tree);
+    free(by_pos);
+    return ret;
 }
 
 static struct lyd_difflist *
@@ -3560,16 +3783,24 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
     struct lyd_node *elem1, *elem2, *iter, *aux, *parent = NULL, *next1, *next2;
     struct lyd_difflist *result, *result2 = NULL;
     void *new;
-    unsigned int size, size2, index = 0, index2 = 0, i, j, k;
+    unsigned int size, size2, index = 0, index2 = 0, i;
     struct matchlist_s {
         struct matchlist_s *prev;
         struct ly_set *match;
         unsigned int i;
     } *matchlist = NULL, *mlaux;
     struct ly_set *ordset = NULL;
-    struct diff_ordered *ordered;
-    struct diff_ordered_dist *dist_aux, *dist_iter;
-    struct diff_ordered_item item_aux;
+    struct hash_table *ordht = NULL;
+#ifdef LY_ENABLED_CACHE
+    struct hash_table *top_ht = NULL;
+    struct lyd_node **iter_p;
+#endif
+
+    /* the nodes not parsed yet are compared, too */
+    if (lyb_lazy_load_tree(first, !(options & LYD_DIFFOPT_NOSIBLINGS))
+            || lyb_lazy_load_tree(second, !(options & LYD_DIFFOPT_NOSIBLINGS))) {
+        return NULL;
+    }
 
     if (!first) {
         /* all nodes in second were created,
@@ -3666,6 +3897,30 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
 
     ordset = ly_set_new();
     LY_CHECK_ERR_GOTO(!ordset, , error);
+    ordht = lyht_new(1, sizeof(struct diff_ordered *), diff_ordered_equal, NULL, 1);
+    LY_CHECK_ERR_GOTO(!ordht, LOGMEM(ctx), error);
+
+#ifdef LY_ENABLED_CACHE
+    if (!first->parent) {
+        /* top-level siblings have no parent with the children hash table, so build one
+         * for them the same way so that they are not searched for each node of the second tree */
+        for (i = 0, iter = first; iter && (i < LY_CACHE_HT_MIN_CHILDREN); iter = iter->next, ++i);
+        if (i == LY_CACHE_HT_MIN_CHILDREN) {
+            top_ht = lyht_new(1, sizeof(struct lyd_node *), lyd_hash_table_val_equal, NULL, 1);
+            LY_CHECK_ERR_GOTO(!top_ht, LOGMEM(ctx), error);
+            LY_TREE_FOR(first, iter) {
+                if ((iter->schema->nodetype == LYS_LIST) && !lyd_list_has_keys(iter)) {
+                    /* not hashed, the same as in the children hash table */
+                    continue;
+                }
+                if (lyht_insert(top_ht, &iter, iter->hash, NULL)) {
+                    LOGINT(ctx);
+                    goto error;
+                }
+            }
+        }
+    }
+#endif
 
     /*
      * compare trees
@@ -3682,11 +3937,12 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
         }
 
 #ifdef LY_ENABLED_CACHE
-        struct lyd_node **iter_p;
+        struct hash_table *ht;
 
-        if (elem1 && elem1->parent && elem1->parent->ht) {
+        ht = elem1 ? (elem1->parent ? elem1->parent->ht : top_ht) : NULL;
+        if (ht) {
             iter = NULL;
-            if (!lyht_find(elem1->parent->ht, &elem2, elem2->hash, (void **)&iter_p)) {
+            if (!lyht_find(ht, &elem2, elem2->hash, (void **)&iter_p)) {
                 iter = *iter_p;
                 /* we found a match */
                 if (iter->dflt && !(options & LYD_DIFFOPT_WITHDEFAULTS)) {
@@ -3697,7 +3953,7 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
                 while (iter && (iter->validity & LYD_VAL_INUSE)) {
                     /* state lists, find one not-already-found */
                     assert((iter->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) && (iter->schema->flags & LYS_CONFIG_R));
-                    if (lyht_find_next(elem1->parent->ht, &iter, iter->hash, (void **)&iter_p)) {
+                    if (lyht_find_next(ht, &iter, iter->hash, (void **)&iter_p)) {
                         iter = NULL;
                     } else {
                         iter = *iter_p;
@@ -3724,7 +3980,7 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
             }
         }
         /* we have a match */
-        if (iter && lyd_diff_match(iter, elem2, result, &size, &index, matchlist->match, ordset, options)) {
+        if (iter && lyd_diff_match(iter, elem2, result, &size, &index, matchlist->match, ordset, ordht, options)) {
             goto error;
         }
 
@@ -3768,21 +4024,6 @@ cmp_continue:
         if (!next2) {
             /* children */
 
-            /* first pass of the siblings done, some additional work for future
-             * detection of move may be needed */
-            for (i = ordset->number; i > 0; i--) {
-                ordered = (struct diff_ordered *)ordset->set.g[i - 1];
-                if (ordered->items) {
-                    /* already preprocessed ordered structure */
-                    break;
-                }
-                ordered->items = calloc(ordered->count, sizeof *ordered->items);
-                LY_CHECK_ERR_GOTO(!ordered->items, LOGMEM(ctx), error);
-                ordered->dist = NULL;
-                /* zero the count to be used as a node position in lyd_diff_move_preprocess() */
-                ordered->count = 0;
-            }
-
             /* first, get the first sibling */
             if (elem2->parent == second->parent) {
                 elem2 = second;
@@ -3811,17 +4052,10 @@ cmp_continue:
                 }
 
                 iter->validity &= ~LYD_VAL_INUSE;
-                if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)) {
-                    for (j = ordset->number; j > 0; j--) {
-                        ordered = (struct diff_ordered *)ordset->set.g[j - 1];
-                        if (ordered->schema != iter->schema || !lyd_diff_equivnode(ordered->parent, iter->parent)) {
-                            continue;
-                        }
-
-                        /* store necessary information for move detection */
-                        lyd_diff_move_preprocess(ordered, matchlist->match->set.d[matchlist->i], iter);
-                        break;
-                    }
+                if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)
+                        && lyd_diff_move_preprocess(ordht, matchlist->match->set.d[matchlist->i], iter)) {
+                    /* store necessary information for move detection */
+                    goto error;
                 }
 
                 if (((iter->schema->nodetype == LYS_CONTAINER) || ((iter->schema->nodetype == LYS_LIST)
@@ -3890,18 +4124,11 @@ cmp_continue:
                 }
 
                 iter->validity &= ~LYD_VAL_INUSE;
-                if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)) {
-                    for (j = ordset->number ; j > 0; j--) {
-                        ordered = (struct diff_ordered *)ordset->set.g[j - 1];
-                        if (ordered->schema != iter->schema || !lyd_diff_equivnode(ordered->parent, iter->parent)) {
-                            continue;
-                        }
-
-                        /* store necessary information for move detection */
-                        lyd_diff_move_preprocess(ordered, mlaux->match->set.d[mlaux->i], iter);
-                        break;
-                    }
-                }
+                if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)
+                        && lyd_diff_move_preprocess(ordht, mlaux->match->set.d[mlaux->i], iter)) {
+                    /* store necessary information for move detection */
+                    goto error;
+                }
 
                 if (((iter->schema->nodetype == LYS_CONTAINER) || ((iter->schema->nodetype == LYS_LIST)
                         && ((struct lys_node_list *)iter->schema)->keys_size)) && iter->child) {
@@ -3946,6 +4173,13 @@ cmp_continue:
     free(matchlist);
     matchlist = NULL;
 
+    /* positions of the matched user-ordered instances in the first tree, still marked by LYD_VAL_INUSE */
+    for (i = 0; i < ordset->number; i++) {
+        if (lyd_diff_move_positions((struct diff_ordered *)ordset->set.g[i], first)) {
+            goto error;
+        }
+    }
+
     /* 2) deleted nodes */
     LY_TREE_DFS_BEGIN(first, next1, elem1) {
         /* search for elem1s deleted in the second */
@@ -3990,83 +4224,19 @@ dfs_nextsibling:
 
     /* 3) moved nodes (when user-ordered) */
     for (i = 0; i < ordset->number; i++) {
-        ordered = (struct diff_ordered *)ordset->set.g[i];
-        if (!ordered->dist->dist) {
-            /* the dist list is sorted here, but the biggest dist is 0,
-             * so nothing changed in order of these items between first
-             * and second. We can continue with another user-ordered list.
-             */
-            continue;
-        }
-
-        /* get needed movements
-         * - from the biggest distances try to apply node movements
-         * on first tree node until they will be ordered as in the
-         * second tree - i.e. until there will be no position difference
-         */
-
-        for (dist_iter = ordered->dist; ; dist_iter = dist_iter->next) {
-            /* dist list is sorted at the beginning, since applying a move causes
-             * just a small change in other distances, we assume that the biggest
-             * dist is the next one (note that dist list is implemented as ring
-             * list). This way we avoid sorting distances after each move. The loop
-             * stops when all distances are zero.
-             */
-            dist_aux = dist_iter;
-            while (!dist_iter->dist) {
-                /* no dist, so no move. Try another, but when
-                 * there is no dist at all, stop the loop
-                 */
-                dist_iter = dist_iter->next;
-                if (dist_iter == dist_aux) {
-                    /* all dist we zeroed */
-                    goto movedone;
-                }
-            }
-            /* something to move */
-
-            /* get the item to move */
-            for (k = 0; k < ordered->count; k++) {
-                if (ordered->items[k].dist == dist_iter) {
-                    break;
-                }
-            }
-
-            /* apply the move (distance) */
-            memcpy(&item_aux, &ordered->items[k], sizeof item_aux);
-            if (dist_iter->dist > 0) {
-                /* move to right (other move to left) */
-                while (dist_iter->dist) {
-                    memcpy(&ordered->items[k], &ordered->items[k + 1], sizeof *ordered->items);
-                    ordered->items[k].dist->dist++; /* update moved item distance */
-                    dist_iter->dist--;
-                    k++;
-                }
-            } else {
-                /* move to left (other move to right) */
-                while (dist_iter->dist) {
-                    memcpy(&ordered->items[k], &ordered->items[k - 1], sizeof *ordered->items);
-                    ordered->items[k].dist->dist--; /* update moved item distance */
-                    dist_iter->dist++;
-                    k--;
-                }
-            }
-            memcpy(&ordered->items[k], &item_aux, sizeof *ordered->items);
-
-            /* store the transaction into the difflist */
-            if (lyd_difflist_add(result, &size, index++, LYD_DIFF_MOVEDAFTER1, item_aux.first,
-                                 (k > 0) ? ordered->items[k - 1].first : NULL)) {
-                goto error;
-            }
-            continue;
-
-movedone:
-            break;
+        if (lyd_diff_move((struct diff_ordered *)ordset->set.g[i], result, &size, &index)) {
+            goto error;
         }
     }
 
     diff_ordset_free(ordset);
     ordset = NULL;
+    lyht_free(ordht);
+    ordht = NULL;
+#ifdef LY_ENABLED_CACHE
+    lyht_free(top_ht);
+    top_ht = NULL;
+#endif
 
     if (index2) {
         /* append result2 with newly created
@@ -4105,6 +4275,10 @@ error:
 
     }
     diff_ordset_free(ordset);
+    lyht_free(ordht);
+#ifdef LY_ENABLED_CACHE
+    lyht_free(top_ht);
+#endif
 
     lyd_free_diff(result);
     lyd_free_diff(result2);
@@ -4119,8 +4293,12 @@ lyd_insert_setinvalid(struct lyd_node *node)
 
     assert(node);
 
-    /* overall validity of the node itself */
-    node->validity = ly_new_node_validity(node->schema);
+    /* overall validity of the node itself and its subtree, which is now in a new context */
+    LY_TREE_DFS_BEGIN(node, next, elem) {
+        elem->validity = ly_new_node_validity(elem->schema);
+        LY_TREE_DFS_END(node, next, elem);
+    }
+    lyd_val_changed_parents(node->parent);
 
     /* explore changed unique leaves */
     /* first, get know if there is a list in parents chain */
@@ -4266,6 +4444,11 @@ lyd_insert_common(struct lyd_node *parent, struct lyd_node **sibling, struct lyd
 
     assert(parent || sibling);
 
+    /* the instances already in the parent are checked */
+    if (parent && parent->lazy && lyb_lazy_load(parent)) {
+        return EXIT_FAILURE;
+    }
+
     /* get first sibling */
     if (parent) {
         start = parent->child;
@@ -4543,6 +4726,11 @@ lyd_insert_nextto(struct lyd_node *sibling, struct lyd_node *node, int before, i
         return EXIT_SUCCESS;
     }
 
+    /* the instances already in the parent are checked */
+    if (sibling->parent && sibling->parent->lazy && lyb_lazy_load(sibling->parent)) {
+        return EXIT_FAILURE;
+    }
+
     /* check placing the node to the appropriate place according to the schema */
     for (par1 = lys_parent(sibling->schema);
          par1 && !(par1->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_INPUT | LYS_OUTPUT | LYS_ACTION | LYS_NOTIF));
@@ -4744,69 +4932,17 @@ lyd_insert_after(struct lyd_node *sibling, struct lyd_node *node)
     return lyd_insert_nextto(sibling, node, 0, 1);
 }
 
-static uint32_t
-lys_module_pos(struct lys_module *module)
-{
-    int i;
-    uint32_t pos = 1;
-
-    for (i = 0; i < module->ctx->models.used; ++i) {
-        if (module->ctx->models.list[i] == module) {
-            return pos;
-        }
-        ++pos;
-    }
-
-    LOGINT(module->ctx);
-    return 0;
-}
-
-static int
-lys_module_node_pos_r(struct lys_node *first_sibling, struct lys_node *target, uint32_t *pos)
-{
-    const struct lys_node *next = NULL;
-
-    /* the schema nodes are actually from data, lys_getnext skips non-data schema nodes for us (we know the parent will not be uses) */
-    while ((next = lys_getnext(next, lys_parent(first_sibling), lys_node_module(first_sibling), LYS_GETNEXT_NOSTATECHECK))) {
-        ++(*pos);
-        if (target == next) {
-            return 0;
-        }
-    }
-
-    LOGINT(first_sibling->module->ctx);
-    return 1;
-}
-
 static int
 lyd_node_pos_cmp(const void *item1, const void *item2)
 {
-    uint32_t mpos1, mpos2;
-    struct lyd_node_pos *np1, *np2;
+    const struct lyd_node_pos *np1 = item1, *np2 = item2;
 
-    np1 = (struct lyd_node_pos *)item1;
-    np2 = (struct lyd_node_pos *)item2;
-
-    /* different modules? */
-    if (lys_node_module(np1->node->schema) != lys_node_module(np2->node->schema)) {
-        mpos1 = lys_module_pos(lys_node_module(np1->node->schema));
-        mpos2 = lys_module_pos(lys_node_module(np2->node->schema));
-        /* if lys_module_pos failed, there is nothing we can do anyway,
-         * at least internal error will be printed */
-
-        if (mpos1 > mpos2) {
-            return 1;
-        } else {
-            return -1;
-        }
+    if (np1->pos != np2->pos) {
+        return (np1->pos > np2->pos) ? 1 : -1;
     }
 
-    if (np1->pos > np2->pos) {
-        return 1;
-    } else if (np1->pos < np2->pos) {
-        return -1;
-    }
-    return 0;
+    /* instances of the same schema node keep their order */
+    return (np1->idx > np2->idx) ? 1 : -1;
 }
 
 API int
@@ -4816,7 +4952,6 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
 
     uint32_t len, i;
     struct lyd_node *node;
-    struct lys_node *first_ssibling = NULL;
     struct lyd_node_pos *array;
 
     if (!sibling) {
@@ -4824,6 +4959,12 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
         return -1;
     }
 
+    /* sort all the siblings, including the nodes not parsed yet */
+    if ((sibling->parent && sibling->parent->lazy && lyb_lazy_load(sibling->parent))
+            || (recursive && lyb_lazy_load_tree(sibling, 1))) {
+        return -1;
+    }
+
     /* something actually to sort */
     if (sibling->prev != sibling) {
 
@@ -4841,33 +4982,12 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
 
         /* fill arrays with positions and corresponding nodes */
         for (i = 0, node = sibling; i < len; ++i, node = node->next) {
-            array[i].pos = 0;
-
-            /* we need to repeat this for every module */
-            if (!first_ssibling || (lyd_node_module(node) != lys_node_module(first_ssibling))) {
-                /* find the data node schema parent */
-                first_ssibling = node->schema;
-                while (lys_parent(first_ssibling)
-                        && (lys_parent(first_ssibling)->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES))) {
-                    first_ssibling = lys_parent(first_ssibling);
-                }
-
-                /* find the beginning */
-                if (lys_parent(first_ssibling)) {
-                    first_ssibling = lys_parent(first_ssibling)->child;
-                } else {
-                    while (first_ssibling->prev->next) {
-                        first_ssibling = first_ssibling->prev;
-                    }
-                }
-            }
-
-            if (lys_module_node_pos_r(first_ssibling, node->schema, &array[i].pos)) {
+            if (lys_data_order(node->schema, &array[i].pos)) {
                 free(array);
                 return -1;
             }
-
             array[i].node = node;
+            array[i].idx = i;
         }
 
         /* sort the arrays */
@@ -4914,18 +5034,284 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
     return EXIT_SUCCESS;
 }
 
+/* the node itself was changed or there are some changes in its subtree */
+#define LYD_VAL_CHANGED (LYD_VAL_DUP | LYD_VAL_UNIQUE | LYD_VAL_MAND | LYD_VAL_INSUB)
+
+static int
+lyd_val_incr_match(const struct lyd_node *node, const struct ly_set_idx *snodes)
+{
+    if (snodes) {
+        return ly_set_idx_contains(snodes, node->schema) > -1;
+    }
+    return node->validity & LYD_VAL_CHANGED;
+}
+
+static struct lyd_node *
+lyd_val_incr_sibling(struct lyd_node *node, const struct ly_set_idx *snodes)
+{
+    for (; node && !lyd_val_incr_match(node, snodes); node = node->next);
+    return node;
+}
+
+/**
+ * @brief Get the next node in the DFS order skipping all the subtrees that are not interesting for the incremental
+ * validation.
+ *
+ * @param[in] elem Current node.
+ * @param[in] snodes Schema nodes of the data nodes to visit, NULL to visit the changed nodes.
+ * @return Next node to visit, NULL if there are no more.
+ */
+static struct lyd_node *
+lyd_val_incr_next(struct lyd_node *elem, const struct ly_set_idx *snodes)
+{
+    struct lyd_node *next = NULL;
+
+    if (!(elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+        next = lyd_val_incr_sibling(elem->child, snodes);
+    }
+    while (!next && elem) {
+        next = lyd_val_incr_sibling(elem->next, snodes);
+        elem = elem->parent;
+    }
+
+    return next;
+}
+
+/* check the instances of a changed inner list/leaflist node whose parent was not changed */
+static int
+lyd_val_incr_dup(struct lyd_node *node)
+{
+#ifdef LY_ENABLED_CACHE
+    struct lyd_node **match_p;
+
+    if (node->parent->ht && node->hash) {
+        if (!lyht_find(node->parent->ht, &node, node->hash, (void **)&match_p)) {
+            do {
+                if (*match_p != node) {
+                    /* check them properly to log the error */
+                    return lyv_data_dup(node, node->parent->child);
+                }
+            } while (!lyht_find_next(node->parent->ht, match_p, node->hash, (void **)&match_p));
+        }
+
+        node->validity &= ~LYD_VAL_DUP;
+        return 0;
+    }
+#endif
+
+    return lyv_data_dup(node, node->parent->child);
+}
+
+/**
+ * @brief Validate the changed nodes, the first pass of the incremental validation.
+ *
+ * The changed container and list nodes and the parents of all the changed nodes keep #LYD_VAL_MAND
+ * so that their default and mandatory children are checked later.
+ *
+ * @param[in] root First top-level node.
+ * @param[in] options Validation options.
+ * @param[in] unres Unres data structure to add the conditions and references into.
+ * @param[in,out] changes Set of the changed data nodes.
+ * @param[in,out] snodes Set of the schema nodes of the changed data nodes.
+ * @param[out] toplevel Set if some top-level node was changed.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyd_val_incr_changes(struct lyd_node *root, int options, struct unres_data *unres, struct ly_set_idx *changes,
+                     struct ly_set_idx *snodes, int *toplevel)
+{
+    struct lyd_node *elem;
+    struct ly_ctx *ctx = root->schema->module->ctx;
+    int mand;
+
+    for (elem = lyd_val_incr_sibling(root, NULL); elem; elem = lyd_val_incr_next(elem, NULL)) {
+        if (!(elem->validity & (LYD_VAL_DUP | LYD_VAL_UNIQUE | LYD_VAL_MAND))) {
+            /* only some of its descendants were changed */
+            continue;
+        }
+
+        if (elem->parent && (elem->schema->nodetype & (LYS_ACTION | LYS_NOTIF))) {
+            LOGVAL(ctx, LYE_INELEM, LY_VLOG_LYD, elem, elem->schema->name);
+            LOGVAL(ctx, LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected %s node \"%s\".",
+                   (elem->schema->nodetype == LYS_ACTION ? "action" : "notification"), elem->schema->name);
+            return EXIT_FAILURE;
+        }
+
+        if ((elem->validity & LYD_VAL_DUP) && elem->parent) {
+            /* the parent was not changed so the instances were not checked by it */
+            if (options & LYD_OPT_TRUSTED) {
+                elem->validity &= ~LYD_VAL_DUP;
+            } else if (lyd_val_incr_dup(elem)) {
+                return EXIT_FAILURE;
+            }
+        }
+
+        mand = elem->validity & LYD_VAL_MAND;
+        if (lyv_data_context(elem, options, unres) || lyv_data_content(elem, options, unres)) {
+            return EXIT_FAILURE;
+        }
+
+        /* empty non-default, non-presence container without attributes, make it default */
+        if (!elem->dflt && (elem->schema->nodetype == LYS_CONTAINER) && !elem->child
+                    && !((struct lys_node_container *)elem->schema)->presence && !elem->attr) {
+            elem->dflt = 1;
+        }
+
+        if ((ly_set_idx_add(changes, elem) == -1) || (ly_set_idx_add(snodes, elem->schema) == -1)) {
+            return EXIT_FAILURE;
+        }
+
+        /* default and mandatory children are checked at the end */
+        if (mand && (elem->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+            elem->validity |= LYD_VAL_MAND;
+        }
+        if (elem->parent) {
+            elem->parent->validity |= LYD_VAL_MAND;
+        } else {
+            *toplevel = 1;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Add the conditions and references of all the unchanged nodes that depend on the changed nodes
+ * into unres, the second pass of the incremental validation.
+ *
+ * @param[in] root First top-level node.
+ * @param[in] options Validation options.
+ * @param[in] unres Unres data structure to add the conditions and references into.
+ * @param[in] changes Set of the changed data nodes, already validated.
+ * @param[in] snodes Set of the schema nodes of the changed data nodes.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyd_val_incr_deps(struct lyd_node *root, int options, struct unres_data *unres, struct ly_set_idx *changes,
+                  struct ly_set_idx *snodes)
+{
+    struct ly_set_idx affected, parents;
+    struct lys_node *siter;
+    struct lyd_node *elem;
+    unsigned int u;
+    int ret = EXIT_FAILURE;
+
+    memset(&affected, 0, sizeof affected);
+    memset(&parents, 0, sizeof parents);
+
+    if (lyv_data_deps_affected(root->schema->module->ctx, snodes, &affected)) {
+        goto cleanup;
+    }
+
+    /* only the subtrees with some affected nodes are searched */
+    for (u = 0; u < affected.set.number; ++u) {
+        for (siter = affected.set.set.s[u]; siter && (ly_set_idx_contains(&parents, siter) == -1); siter = lys_parent(siter)) {
+            if (ly_set_idx_add(&parents, siter) == -1) {
+                goto cleanup;
+            }
+        }
+    }
+
+    for (elem = lyd_val_incr_sibling(root, &parents); elem; elem = lyd_val_incr_next(elem, &parents)) {
+        if ((ly_set_idx_contains(&affected, elem->schema) > -1) && (ly_set_idx_contains(changes, elem) == -1)
+                && (lyv_data_context(elem, options, unres) || lyv_data_content(elem, options, unres))) {
+            goto cleanup;
+        }
+    }
+
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    ly_set_idx_free(&affected);
+    ly_set_idx_free(&parents);
+    return ret;
+}
+
+/* add default nodes into the changed nodes, the third pass of the incremental validation */
+static int
+lyd_val_incr_defaults(struct lyd_node **root, int options, struct unres_data *unres, int toplevel)
+{
+    struct lyd_node *elem;
+
+    if (toplevel && lyd_wd_add(root, NULL, NULL, 0, unres, options, 1)) {
+        return EXIT_FAILURE;
+    }
+
+    for (elem = lyd_val_incr_sibling(*root, NULL); elem; elem = lyd_val_incr_next(elem, NULL)) {
+        if ((elem->validity & LYD_VAL_MAND) && (elem->schema->nodetype & (LYS_CONTAINER | LYS_LIST))
+                && lyd_wd_add_subtree(root, elem, elem, elem->schema, 0, options, unres, 1)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* check mandatory nodes in the changed nodes and clear all the flags, the last pass of the incremental validation */
+static int
+lyd_val_incr_mandatory(struct lyd_node *root, int options, int toplevel)
+{
+    struct lyd_node *elem;
+    struct lys_node *siter;
+
+    if (toplevel && _lyd_check_mandatory_tree(root, NULL, NULL, 0, options, 1)) {
+        return EXIT_FAILURE;
+    }
+
+    for (elem = lyd_val_incr_sibling(root, NULL); elem; elem = lyd_val_incr_next(elem, NULL)) {
+        if (!(options & LYD_OPT_TRUSTED) && (elem->validity & LYD_VAL_MAND)
+                && (elem->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+            LY_TREE_FOR(elem->schema->child, siter) {
+                if (lyd_check_mandatory_subtree(root, elem, elem, siter, 0, options, 1)) {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        elem->validity &= ~(LYD_VAL_MAND | LYD_VAL_INSUB);
+    }
+
+    return EXIT_SUCCESS;
+}
+
 static int
 _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx *ctx, const struct lys_module **modules,
               int mod_count, struct lyd_difflist **diff, int options)
 {
     struct lyd_node *root, *next1, *next2, *iter, *act_notif = NULL;
-    int ret = EXIT_FAILURE;
+    int ret = EXIT_FAILURE, incremental = 0, toplevel = 0;
     unsigned int i;
     struct unres_data *unres = NULL;
+    struct ly_set_idx changes, snodes;
     const struct lys_module *yanglib_mod;
 
+    /* the whole tree is validated, including the nodes not parsed yet */
+    if (lyb_lazy_load_tree(*node, !(options & LYD_OPT_NOSIBLINGS)) || lyb_lazy_load_tree(data_tree, 1)) {
+        return EXIT_FAILURE;
+    }
+
     unres = calloc(1, sizeof *unres);
     LY_CHECK_ERR_RETURN(!unres, LOGMEM(NULL), EXIT_FAILURE);
+    memset(&changes, 0, sizeof changes);
+    memset(&snodes, 0, sizeof snodes);
+
+    if ((options & LYD_OPT_VAL_INCREMENTAL)
+            && (!(options & LYD_OPT_TYPEMASK) || (options & LYD_OPT_CONFIG)) && !modules
+            && !(options & (LYD_OPT_NOSIBLINGS | LYD_OPT_DATA_ADD_YANGLIB)) && *node && !(*node)->parent) {
+        /* the changes must be tracked in the whole tree */
+        incremental = 1;
+        LY_TREE_FOR(*node, root) {
+            if (root->validity & LYD_VAL_FULL) {
+                incremental = 0;
+                break;
+            }
+        }
+    }
+    if (incremental) {
+        if (lyd_val_incr_changes(*node, options, unres, &changes, &snodes, &toplevel)
+                || lyd_val_incr_deps(*node, options, unres, &changes, &snodes)) {
+            goto cleanup;
+        }
+    }
 
     if (diff) {
         unres->store_diff = 1;
@@ -4939,7 +5325,8 @@ _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx
         options |= LYD_OPT_ACT_NOTIF;
     }
 
-    LY_TREE_FOR_SAFE(*node, next1, root) {
+    /* validate the whole tree unless only the changes were validated */
+    LY_TREE_FOR_SAFE(incremental ? NULL : *node, next1, root) {
         if (modules) {
             for (i = 0; i < (unsigned)mod_count; ++i) {
                 if (lyd_node_module(root) == modules[i]) {
@@ -4972,6 +5359,7 @@ _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx
                         && !((struct lys_node_container *)iter->schema)->presence && !iter->attr) {
                 iter->dflt = 1;
             }
+            iter->validity &= ~(LYD_VAL_INSUB | LYD_VAL_FULL);
 
             LY_TREE_DFS_END(root, next2, iter);
         }
@@ -5026,6 +5414,17 @@ _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx
         }
     }
 
+    if (incremental) {
+        /* add default values only into the changed nodes, resolve unres and check for mandatory nodes
+         * only in the changed nodes */
+        if (lyd_val_incr_defaults(node, options, unres, toplevel)
+                || lyd_defaults_add_unres(node, options, ctx, NULL, 0, data_tree, NULL, unres, 0)
+                || lyd_val_incr_mandatory(*node, options, toplevel)) {
+            goto cleanup;
+        }
+        goto success;
+    }
+
     /* add default values, resolve unres and check for mandatory nodes in final tree */
     if (lyd_defaults_add_unres(node, options, ctx, modules, mod_count, data_tree, act_notif, unres, 1)) {
         goto cleanup;
@@ -5045,6 +5444,7 @@ _lyd_validate(struct lyd_node **node, struct lyd_node *data_tree, struct ly_ctx
         goto cleanup;
     }
 
+success:
     /* consolidate diff if created */
     if (diff) {
         assert(unres->store_diff);
@@ -5078,6 +5478,14 @@ cleanup:
         lyd_free_diff(unres->diff);
         free(unres);
     }
+    ly_set_idx_free(&changes);
+    ly_set_idx_free(&snodes);
+
+    if (ret && *node) {
+        /* the tree may be only partially validated, the next incremental validation cannot be trusted */
+        for (root = *node; root->parent; root = root->parent);
+        root->validity |= LYD_VAL_FULL;
+    }
 
     return ret;
 }
@@ -5337,13 +5745,24 @@ int
 lyd_unlink_internal(struct lyd_node *node, int permanent)
 {
     struct lyd_node *iter;
-    (void)permanent;
 
     if (!node) {
         LOGARG;
         return EXIT_FAILURE;
     }
 
+    if (permanent == 1) {
+        /* the removed node may have been mandatory or referenced */
+        if (node->parent) {
+            node->parent->validity |= LYD_VAL_MAND;
+            lyd_val_changed_parents(node->parent);
+        } else if (node->prev != node) {
+            /* nowhere to note the change */
+            iter = node->next ? node->next : node->prev;
+            iter->validity |= LYD_VAL_FULL;
+        }
+    }
+
     /* unlink from siblings */
     if (node->prev->next) {
         node->prev->next = node->next;
@@ -5727,6 +6146,9 @@ lyd_dup_to_ctx(const struct lyd_node *node, int options, struct ly_ctx *ctx)
         if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
             next = NULL;
         } else {
+            if (elem->lazy && lyb_lazy_load((struct lyd_node *)elem)) {
+                goto error;
+            }
             next = elem->child;
         }
         if (!next) {
@@ -6130,6 +6552,10 @@ _lyd_free_node(struct lyd_node *node)
         /* it should be empty because all the children are freed already (only if in debug mode) */
         lyht_free(node->ht);
 #endif
+        if (node->lazy) {
+            /* the children were never parsed */
+            lyb_lazy_free(node);
+        }
         break;
     case LYS_ANYDATA:
     case LYS_ANYXML:
@@ -6169,7 +6595,7 @@ _lyd_free_node(struct lyd_node *node)
     }
 
     lyd_free_attr(node->schema->module->ctx, node, node->attr, 1);
-    free(node);
+    lyd_node_free_mem(node);
 }
 
 static void
@@ -6559,6 +6985,10 @@ lyd_find_instance(const struct lyd_node *data, const struct lys_node *schema)
             goto error;
         }
         for (j = 0; j < ret->number; j++) {
+            if (ret->set.d[j]->lazy && lyb_lazy_load(ret->set.d[j])) {
+                ly_set_free(ret_aux);
+                goto error;
+            }
             LY_TREE_FOR(ret->set.d[j]->child, iter) {
                 if (iter->schema == spath->set.s[i - 1]) {
                     ly_set_add(ret_aux, iter, LY_SET_OPT_USEASLIST);
@@ -6609,6 +7039,9 @@ lyd_find_sibling(const struct lyd_node *siblings, const struct lyd_node *target,
 
     /* find first sibling */
     if (siblings->parent) {
+        if (siblings->parent->lazy && lyb_lazy_load(siblings->parent)) {
+            return -1;
+        }
         siblings = siblings->parent->child;
     } else {
         while (siblings->prev->next) {
@@ -6675,6 +7108,11 @@ lyd_find_sibling_set(const struct lyd_node *siblings, const struct lyd_node *tar
 
     /* find first sibling */
     if (siblings->parent) {
+        if (siblings->parent->lazy && lyb_lazy_load(siblings->parent)) {
+            ly_set_free(*set);
+            *set = NULL;
+            return -1;
+        }
         siblings = siblings->parent->child;
     } else {
         while (siblings->prev->next) {
@@ -6946,6 +7384,136 @@ lyd_first_sibling(struct lyd_node *node)
     return start;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Record of a set hash table index.
+ */
+struct ly_set_ht_rec {
+    void *obj;
+    unsigned int index;
+};
+
+static int
+ly_set_ht_val_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct ly_set_ht_rec *)val1_p)->obj == ((struct ly_set_ht_rec *)val2_p)->obj;
+}
+
+static uint32_t
+ly_set_ht_hash(const void *obj)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&obj, sizeof obj);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Create a hash table index of the objects of a set.
+ *
+ * @param[in] set Set to index, only the first instance of a duplicate object is indexed.
+ * @return Index of the set objects, NULL on error.
+ */
+static struct hash_table *
+ly_set_ht_new(const struct ly_set *set)
+{
+    struct hash_table *ht;
+    struct ly_set_ht_rec rec;
+    uint32_t size;
+
+    for (size = LY_CACHE_SET_MIN_ITEMS; size < set->number * 2; size <<= 1);
+    ht = lyht_new(size, sizeof rec, ly_set_ht_val_equal, NULL, 1);
+    LY_CHECK_ERR_RETURN(!ht, LOGMEM(NULL), NULL);
+
+    for (rec.index = 0; rec.index < set->number; ++rec.index) {
+        rec.obj = set->set.g[rec.index];
+        if (lyht_insert(ht, &rec, ly_set_ht_hash(rec.obj), NULL) == -1) {
+            lyht_free(ht);
+            return NULL;
+        }
+    }
+
+    return ht;
+}
+
+/**
+ * @brief Find an object in a set hash table index.
+ *
+ * @param[in] ht Index of the set objects.
+ * @param[in] obj Object to find.
+ * @return Index of the object in the set, -1 if not found.
+ */
+static int
+ly_set_ht_find(struct hash_table *ht, void *obj)
+{
+    struct ly_set_ht_rec rec, *match;
+
+    rec.obj = obj;
+    if (lyht_find(ht, &rec, ly_set_ht_hash(obj), (void **)&match)) {
+        return -1;
+    }
+    return match->index;
+}
+
+#endif
+
+int
+ly_set_idx_add(struct ly_set_idx *idx, void *obj)
+{
+#ifdef LY_ENABLED_CACHE
+    struct ly_set_ht_rec rec;
+    int i;
+
+    i = idx->ht ? ly_set_ht_find(idx->ht, obj) : ly_set_contains(&idx->set, obj);
+    if (i > -1) {
+        /* already in set */
+        return i;
+    }
+
+    i = ly_set_add(&idx->set, obj, LY_SET_OPT_USEASLIST);
+    if (i == -1) {
+        return -1;
+    }
+
+    if (idx->ht) {
+        rec.obj = obj;
+        rec.index = i;
+        LY_CHECK_ERR_RETURN(lyht_insert(idx->ht, &rec, ly_set_ht_hash(obj), NULL), LOGINT(NULL), -1);
+    } else if (idx->set.number == LY_CACHE_SET_MIN_ITEMS) {
+        /* the set is large enough to be indexed */
+        idx->ht = ly_set_ht_new(&idx->set);
+        LY_CHECK_RETURN(!idx->ht, -1);
+    }
+
+    return i;
+#else
+    return ly_set_add(&idx->set, obj, 0);
+#endif
+}
+
+int
+ly_set_idx_contains(const struct ly_set_idx *idx, void *obj)
+{
+#ifdef LY_ENABLED_CACHE
+    if (idx->ht) {
+        return ly_set_ht_find(idx->ht, obj);
+    }
+#endif
+    return ly_set_contains(&idx->set, obj);
+}
+
+void
+ly_set_idx_free(struct ly_set_idx *idx)
+{
+#ifdef LY_ENABLED_CACHE
+    lyht_free(idx->ht);
+    idx->ht = NULL;
+#endif
+    free(idx->set.set.g);
+    memset(&idx->set, 0, sizeof idx->set);
+}
+
 API struct ly_set *
 ly_set_new(void)
 {
@@ -7056,7 +7624,11 @@ ly_set_merge(struct ly_set *trg, struct ly_set *src, int options)
     FUN_IN;
 
     unsigned int i, ret;
+    int found;
     void **new;
+#ifdef LY_ENABLED_CACHE
+    struct hash_table *ht = NULL;
+#endif
 
     if (!trg) {
         LOGARG;
@@ -7068,15 +7640,31 @@ ly_set_merge(struct ly_set *trg, struct ly_set *src, int options)
     }
 
     if (!(options & LY_SET_OPT_USEASLIST)) {
+#ifdef LY_ENABLED_CACHE
+        if ((trg->number >= LY_CACHE_SET_MIN_ITEMS) && (src->number > 1)) {
+            /* index trg just for this merge, searching it for every src object would be quadratic */
+            ht = ly_set_ht_new(trg);
+        }
+#endif
+
         /* remove duplicates */
         i = 0;
         while (i < src->number) {
-            if (ly_set_contains(trg, src->set.g[i]) > -1) {
+#ifdef LY_ENABLED_CACHE
+            found = ht ? ly_set_ht_find(ht, src->set.g[i]) : ly_set_contains(trg, src->set.g[i]);
+#else
+            found = ly_set_contains(trg, src->set.g[i]);
+#endif
+            if (found > -1) {
                 ly_set_rm_index(src, i);
             } else {
                 ++i;
             }
         }
+
+#ifdef LY_ENABLED_CACHE
+        lyht_free(ht);
+#endif
     }
 
     /* allocate more memory if needed */
@@ -7591,11 +8179,12 @@ lyd_wd_leaflist_cleanup(struct ly_set *set, struct unres_data *unres)
  *                     unknown
  * @param[in] options  Parser options to know the data tree type, see @ref parseroptions.
  * @param[in] unres    Unresolved data list, the newly added default nodes may need to add some unresolved items
+ * @param[in] shallow  Flag to not go recursively into the existing list and container instances.
  * @return EXIT_SUCCESS or EXIT_FAILURE
  */
 static int
 lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct lyd_node *subroot,
-                   struct lys_node *schema, int toplevel, int options, struct unres_data *unres)
+                   struct lys_node *schema, int toplevel, int options, struct unres_data *unres, int shallow)
 {
     struct ly_set *present = NULL;
     struct lys_node *siter, *siter_prev;
@@ -7628,15 +8217,15 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             for (i = 0; i < (signed)present->number; i++) {
                 if (schema->nodetype & LYS_LEAFLIST) {
                     lyd_wd_leaflist_cleanup(present, unres);
-                } else if (schema->nodetype != LYS_LEAF) {
-                    if (lyd_wd_add_subtree(root, present->set.d[i], present->set.d[i], schema, 0, options, unres)) {
+                } else if ((schema->nodetype != LYS_LEAF) && !shallow) {
+                    if (lyd_wd_add_subtree(root, present->set.d[i], present->set.d[i], schema, 0, options, unres, shallow)) {
                         goto error;
                     }
                 } /* else LYS_LEAF - nothing to do */
             }
         } else {
             /* no instance */
-            if (lyd_wd_add_subtree(root, last_parent, NULL, schema, 0, options, unres)) {
+            if (lyd_wd_add_subtree(root, last_parent, NULL, schema, 0, options, unres, shallow)) {
                 goto error;
             }
         }
@@ -7747,7 +8336,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
         LY_TREE_FOR(schema->child, siter) {
             if (siter->nodetype & (LYS_CHOICE | LYS_USES)) {
                 /* go into without searching for data instance */
-                if (lyd_wd_add_subtree(root, last_parent, subroot, siter, toplevel, options, unres)) {
+                if (lyd_wd_add_subtree(root, last_parent, subroot, siter, toplevel, options, unres, shallow)) {
                     goto error;
                 }
             } else if (siter->nodetype & (LYS_CONTAINER | LYS_LEAF | LYS_LEAFLIST | LYS_LIST | LYS_ANYDATA)) {
@@ -7758,11 +8347,11 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
                         /* already have some leaflists, check that they are all
                          * default, if not, remove the default leaflists */
                         lyd_wd_leaflist_cleanup(present, unres);
-                    } else if (siter->nodetype != LYS_LEAF) {
+                    } else if ((siter->nodetype != LYS_LEAF) && !shallow) {
                         /* recursion */
                         for (i = 0; i < (signed)present->number; i++) {
                             if (lyd_wd_add_subtree(root, present->set.d[i], present->set.d[i], siter, toplevel, options,
-                                                   unres)) {
+                                                   unres, shallow)) {
                                 goto error;
                             }
                         }
@@ -7783,7 +8372,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
                     ly_set_clean(present);
                 } else {
                     /* no instance */
-                    if (lyd_wd_add_subtree(root, last_parent, NULL, siter, toplevel, options, unres)) {
+                    if (lyd_wd_add_subtree(root, last_parent, NULL, siter, toplevel, options, unres, shallow)) {
                         goto error;
                     }
                 }
@@ -7855,7 +8444,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             if (((struct lys_node_choice *)schema)->dflt) {
                 /* there is a default case */
                 if (lyd_wd_add_subtree(root, last_parent, subroot, ((struct lys_node_choice *)schema)->dflt,
-                                       toplevel, options, unres)) {
+                                       toplevel, options, unres, shallow)) {
                     goto error;
                 }
             }
@@ -7864,7 +8453,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             /* since iter != NULL, siter must be also != NULL and we also know siter_prev
              * which points to the child of schema leading towards the instantiated data */
             assert(siter && siter_prev);
-            if (lyd_wd_add_subtree(root, last_parent, subroot, siter_prev, toplevel, options, unres)) {
+            if (lyd_wd_add_subtree(root, last_parent, subroot, siter_prev, toplevel, options, unres, shallow)) {
                 goto error;
             }
         }
@@ -7893,7 +8482,7 @@ error:
  */
 static int
 lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module **modules, int mod_count,
-           struct unres_data *unres, int options)
+           struct unres_data *unres, int options, int shallow)
 {
     struct lys_node *siter;
     int i;
@@ -7913,7 +8502,7 @@ lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module *
 
     if (!(options & LYD_OPT_TYPEMASK) || (options & LYD_OPT_CONFIG)) {
         if (options & LYD_OPT_NOSIBLINGS) {
-            if (lyd_wd_add_subtree(root, NULL, NULL, (*root)->schema, 1, options, unres)) {
+            if (lyd_wd_add_subtree(root, NULL, NULL, (*root)->schema, 1, options, unres, shallow)) {
                 return EXIT_FAILURE;
             }
         } else if (modules && mod_count) {
@@ -7923,7 +8512,7 @@ lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module *
                                              LYS_USES))) {
                         continue;
                     }
-                    if (lyd_wd_add_subtree(root, NULL, NULL, siter, 1, options, unres)) {
+                    if (lyd_wd_add_subtree(root, NULL, NULL, siter, 1, options, unres, shallow)) {
                         return EXIT_FAILURE;
                     }
                 }
@@ -7939,7 +8528,7 @@ lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module *
                                              LYS_USES))) {
                         continue;
                     }
-                    if (lyd_wd_add_subtree(root, NULL, NULL, siter, 1, options, unres)) {
+                    if (lyd_wd_add_subtree(root, NULL, NULL, siter, 1, options, unres, shallow)) {
                         return EXIT_FAILURE;
                     }
                 }
@@ -7950,7 +8539,7 @@ lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module *
             LOGERR(ctx, LY_EINVAL, "Subtree is not a single notification.");
             return EXIT_FAILURE;
         }
-        if (lyd_wd_add_subtree(root, *root, *root, (*root)->schema, 0, options, unres)) {
+        if (lyd_wd_add_subtree(root, *root, *root, (*root)->schema, 0, options, unres, shallow)) {
             return EXIT_FAILURE;
         }
     } else if (options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY)) {
@@ -7964,12 +8553,12 @@ lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, const struct lys_module *
             for (siter = (*root)->schema->child; siter && siter->nodetype != LYS_OUTPUT; siter = siter->next);
         }
         if (siter) {
-            if (lyd_wd_add_subtree(root, *root, *root, siter, 0, options, unres)) {
+            if (lyd_wd_add_subtree(root, *root, *root, siter, 0, options, unres, shallow)) {
                 return EXIT_FAILURE;
             }
         }
     } else if (options & LYD_OPT_DATA_TEMPLATE) {
-        if (lyd_wd_add_subtree(root, NULL, NULL, (*root)->schema, 1, options, unres)) {
+        if (lyd_wd_add_subtree(root, NULL, NULL, (*root)->schema, 1, options, unres, shallow)) {
             return EXIT_FAILURE;
         }
     } else {
@@ -7985,7 +8574,7 @@ lyd_defaults_add_unres(struct lyd_node **root, int options, struct ly_ctx *ctx,
                        int mod_count, const struct lyd_node *data_tree, struct lyd_node *act_notif,
                        struct unres_data *unres, int wd)
 {
-    struct lyd_node *msg_sibling = NULL, *msg_parent = NULL, *data_tree_sibling, *data_tree_parent;
+    struct lyd_node *msg_sibling = NULL, *msg_parent = NULL, *data_tree_sibling, *data_tree_parent, *iter;
     struct lys_node *msg_op = NULL;
     struct ly_set *set;
     int ret = EXIT_FAILURE;
@@ -7996,6 +8585,11 @@ lyd_defaults_add_unres(struct lyd_node **root, int options, struct ly_ctx *ctx,
         ctx = (*root)->schema->module->ctx;
     }
 
+    /* defaults are added and the conditions evaluated in the complete trees */
+    if (lyb_lazy_load_tree(*root, !(options & LYD_OPT_NOSIBLINGS)) || lyb_lazy_load_tree(data_tree, 1)) {
+        return EXIT_FAILURE;
+    }
+
     if ((options & LYD_OPT_NOSIBLINGS) && !(*root)) {
         LOGERR(ctx, LY_EINVAL, "Cannot add default values for one module (LYD_OPT_NOSIBLINGS) without any data.");
         return EXIT_FAILURE;
@@ -8029,8 +8623,17 @@ lyd_defaults_add_unres(struct lyd_node **root, int options, struct ly_ctx *ctx,
     }
 
     /* add missing default nodes */
-    if (wd && lyd_wd_add((act_notif ? &act_notif : root), ctx, modules, mod_count, unres, options)) {
-        return EXIT_FAILURE;
+    if (wd) {
+        if (lyd_wd_add((act_notif ? &act_notif : root), ctx, modules, mod_count, unres, options, 0)) {
+            return EXIT_FAILURE;
+        }
+
+        /* inserting the default nodes marked their parents as changed */
+        if (*root && !(*root)->parent) {
+            for (iter = lyd_val_incr_sibling(*root, NULL); iter; iter = lyd_val_incr_next(iter, NULL)) {
+                iter->validity &= ~LYD_VAL_INSUB;
+            }
+        }
     }
 
     /* check leafrefs and/or instids if any */
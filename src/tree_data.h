@@ -154,6 +154,11 @@ struct lyd_attr {
                                       except ::lys_node_leaflist, it means checking that data node for duplicities.
                                       Additionally, it can be set on truly any node type and then status references
                                       are checked for this node if flag #LYD_OPT_OBSOLETE is used. */
+#define LYD_VAL_INSUB    0x08    /**< Some node in the subtree was changed (created, removed, or its value modified), it is
+                                      needed to descend into it during the #LYD_OPT_VAL_INCREMENTAL validation */
+#define LYD_VAL_FULL     0x10    /**< Changes of the data tree cannot be tracked (a top-level sibling was removed or the
+                                      previous validation failed) so the whole tree must be validated again, applicable
+                                      only to top-level data nodes */
 #define LYD_VAL_INUSE    0x80    /**< Internal flag for note about various processing on data, should be used only
                                       internally and removed before libyang returns the node to the caller */
 /**
@@ -179,6 +184,10 @@ struct lyd_node {
     uint8_t dflt:1;                  /**< flag for implicit default node */
     uint8_t when_status:3;           /**< bit for checking if the when-stmt condition is resolved - internal use only,
                                           do not use this value! */
+    uint8_t arena:1;                 /**< flag for a node allocated in a memory arena (#LYD_OPT_ARENA) - internal use
+                                          only, do not use this value! */
+    uint8_t lazy:1;                  /**< flag for a node with not yet parsed children (#LYD_OPT_LYB_LAZY) - internal
+                                          use only, do not use this value! */
 
     struct lyd_attr *attr;           /**< pointer to the list of attributes of this node */
     struct lyd_node *next;           /**< pointer to the next sibling node (NULL if there is no one) */
@@ -221,6 +230,10 @@ struct lyd_node_leaf_list {
     uint8_t dflt:1;                  /**< flag for implicit default node */
     uint8_t when_status:3;           /**< bit for checking if the when-stmt condition is resolved - internal use only,
                                           do not use this value! */
+    uint8_t arena:1;                 /**< flag for a node allocated in a memory arena (#LYD_OPT_ARENA) - internal use
+                                          only, do not use this value! */
+    uint8_t lazy:1;                  /**< flag for a node with not yet parsed children (#LYD_OPT_LYB_LAZY) - internal
+                                          use only, do not use this value! */
 
     struct lyd_attr *attr;           /**< pointer to the list of attributes of this node */
     struct lyd_node *next;           /**< pointer to the next sibling node (NULL if there is no one) */
@@ -282,6 +295,10 @@ struct lyd_node_anydata {
     uint8_t dflt:1;                  /**< flag for implicit default node */
     uint8_t when_status:3;           /**< bit for checking if the when-stmt condition is resolved - internal use only,
                                           do not use this value! */
+    uint8_t arena:1;                 /**< flag for a node allocated in a memory arena (#LYD_OPT_ARENA) - internal use
+                                          only, do not use this value! */
+    uint8_t lazy:1;                  /**< flag for a node with not yet parsed children (#LYD_OPT_LYB_LAZY) - internal
+                                          use only, do not use this value! */
 
     struct lyd_attr *attr;           /**< pointer to the list of attributes of this node */
     struct lyd_node *next;           /**< pointer to the next sibling node (NULL if there is no one) */
@@ -537,6 +554,33 @@ char *lyd_path(const struct lyd_node *node);
 #define LYD_OPT_VAL_DIFF 0x40000 /**< Flag only for validation, store all the data node changes performed by the validation
                                       in a diff structure. */
 #define LYD_OPT_LYB_MOD_UPDATE 0x80000 /**< Allow to parse data using an updated revision of a module, relevant only for LYB format. */
+#define LYD_OPT_VAL_INCREMENTAL 0x100000 /**< Flag only for lyd_validate() of #LYD_OPT_DATA and #LYD_OPT_CONFIG data trees,
+                                              revalidate only the changes (see @ref validityflags) performed on the
+                                              data tree since its last successful validation and the nodes whose when,
+                                              must, or leafref depend on the changed nodes. The changes must be done
+                                              using libyang functions (lyd_new*(), lyd_insert*(), lyd_change_leaf(),
+                                              lyd_unlink(), lyd_free(), ...). If the changes cannot be tracked,
+                                              the whole data tree is validated. */
+#define LYD_OPT_ARENA    0x200000 /**< Flag only for parsing, allocate the data nodes from large memory chunks shared by
+                                      the whole parsed data tree instead of allocating every node separately. The chunks
+                                      are freed together with their last node. Useful for large data trees that are
+                                      usually freed as a whole. */
+#define LYD_OPT_VAL_PARALLEL 0x400000 /**< Flag for parsing and validation, evaluate the must conditions in several threads
+                                          (see ly_ctx_set_val_threads()). The conditions are evaluated after all the other
+                                          changes of the data tree (when conditions, leafrefs, default nodes) so they can
+                                          be evaluated independently of each other. The reported error is always the same
+                                          as without this flag. */
+#define LYD_OPT_LYB_LAZY 0x800000 /**< Flag only for parsing LYB data, parse only the top-level nodes (and list keys)
+                                      and the children of every other node only once the library accesses them. XPath
+                                      evaluation (lyd_find_path(), ...), lyd_new*(), lyd_insert*(), lyd_find_sibling*(),
+                                      lyd_find_instance() and lyd_schema_sort() parse the children of the nodes they
+                                      use, validation, printers, lyd_merge(), lyd_diff() and lyd_dup() parse whole
+                                      subtrees they process. Only the direct access of the node members (::lyd_node#child)
+                                      sees just the nodes parsed so far, use lyd_lyb_load() on the subtree first then.
+                                      Reading the tree can parse new nodes, so it must not be accessed from several
+                                      threads at once until it is parsed whole by lyd_lyb_load(). The input is copied so
+                                      it can be freed right after parsing. Data printed in the older LYB format are
+                                      always parsed whole. */
 #define LYD_OPT_DATA_TEMPLATE 0x1000000 /**< Data represents YANG data template. */
 
 /**@} parseroptions */
@@ -705,6 +749,58 @@ struct lyd_node *lyd_parse_path(struct ly_ctx *ctx, const char *path, LYD_FORMAT
  */
 struct lyd_node *lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options,...);
 
+/**
+ * @brief Opaque structure of a JSON data parser fed with the input data in chunks, see lyd_json_stream_new().
+ */
+struct lyd_json_stream;
+
+/**
+ * @brief Create a parser of JSON data that are provided in chunks as they come, for example from a socket.
+ *
+ * The data tree is built while feeding the data with lyd_json_stream_feed() and finished (validated) with
+ * lyd_json_stream_finish(). Only the input that could not be parsed yet is kept in the parser, which is at most
+ * a single leaf, leaf-list, anydata, or attribute member of the JSON data (and a part of the next chunk), the
+ * members of containers and lists are parsed as they come and the values of unknown nodes are skipped right away.
+ *
+ * @param[in] ctx Context to connect with the data tree being built here.
+ * @param[in] options Parser options, see @ref parseroptions.
+ * @param[in] ... Variable arguments depend on \p options, they are the same as for lyd_parse_mem().
+ * @return Created JSON parser to be freed by lyd_json_stream_free(), NULL on error.
+ */
+struct lyd_json_stream *lyd_json_stream_new(struct ly_ctx *ctx, int options, ...);
+
+/**
+ * @brief Parse another chunk of the JSON data.
+ *
+ * The chunk does not have to be NUL-terminated and can end anywhere in the data.
+ *
+ * @param[in] stream JSON parser.
+ * @param[in] data Next chunk of the input data.
+ * @param[in] len Length of \p data.
+ * @return EXIT_SUCCESS if the chunk was parsed (or buffered to be parsed with the next one), EXIT_FAILURE on error,
+ *         in which case all the data parsed so far are freed and the parser cannot be used anymore.
+ */
+int lyd_json_stream_feed(struct lyd_json_stream *stream, const char *data, size_t len);
+
+/**
+ * @brief Finish parsing the JSON data - parse the rest of the input and validate the data tree.
+ *
+ * The parser cannot be fed anymore, it only has to be freed by lyd_json_stream_free().
+ *
+ * @param[in] stream JSON parser.
+ * @return Pointer to the built data tree or NULL in case of empty data. To free the returned structure,
+ *         use lyd_free(). In these cases, the function sets #ly_errno to LY_SUCCESS. In case of error,
+ *         #ly_errno contains appropriate error code (see #LY_ERR).
+ */
+struct lyd_node *lyd_json_stream_finish(struct lyd_json_stream *stream);
+
+/**
+ * @brief Free a JSON parser including the data it parsed if they were not returned by lyd_json_stream_finish().
+ *
+ * @param[in] stream JSON parser to free.
+ */
+void lyd_json_stream_free(struct lyd_json_stream *stream);
+
 /**
  * @brief Create a new container node in a data tree.
  *
@@ -1504,6 +1600,14 @@ double lyd_dec64_to_double(const struct lyd_node *node);
  */
 int lyd_lyb_data_length(const char *data);
 
+/**
+ * @brief Parse all the not yet parsed descendants of a data tree parsed with #LYD_OPT_LYB_LAZY.
+ *
+ * @param[in] node Root of the subtree to parse, its siblings are not affected.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyd_lyb_load(struct lyd_node *node);
+
 #ifdef LY_ENABLED_LYD_PRIV
 
 /**
@@ -17,6 +17,7 @@
 #define LY_TREE_INTERNAL_H_
 
 #include <stdint.h>
+#include <time.h>
 
 #include "libyang.h"
 #include "tree_schema.h"
@@ -61,14 +62,15 @@ extern struct lys_tpdf *ly_types[LY_DATA_TYPE_COUNT];
  */
 struct lyd_node_pos {
     struct lyd_node *node;
-    uint32_t pos;
+    uint64_t pos;               /* see lys_data_order() */
+    uint32_t idx;               /* original position among the siblings */
 };
 
 /**
  * @brief Internal structure for LYB parser/printer.
  */
 struct lyb_state {
-    size_t *written;
+    size_t *written;            /* LYB v1 - bytes left in the current chunk, LYB v2 - subtree end offset (index of its size when printing) */
     size_t *position;
     uint8_t *inner_chunks;
     int used;
@@ -76,6 +78,11 @@ struct lyb_state {
     const struct lys_module **models;
     int mod_count;
     struct ly_ctx *ctx;
+    uint8_t version;            /* LYB format version being read/written */
+    size_t offset;              /* LYB v2 - bytes read/written since the header */
+
+    /* LYB parser only */
+    struct lyb_image *img;      /* image to keep the children of the parsed nodes in, if parsed lazily */
 
     /* LYB printer only */
     struct {
@@ -83,11 +90,66 @@ struct lyb_state {
         struct hash_table *ht;
     } *sib_ht;
     int sib_ht_count;
+    size_t *sizes;              /* sizes of all the subtrees in the order they are printed */
+    uint8_t *hashes;            /* schema hashes of the subtrees, not needed to be found again */
+    uint32_t size_count;
+    uint32_t size_alloc;
+    uint32_t size_idx;          /* next subtree size to print, used when not measuring */
+    int measure;                /* only measuring the subtree sizes, nothing is printed */
+};
+
+/**
+ * @brief LYB data shared by all the nodes with not yet parsed children (#LYD_OPT_LYB_LAZY) of a data tree.
+ */
+struct lyb_image {
+    char *data;                 /* copy of the whole parsed LYB data */
+    const struct lys_module **models;
+    int mod_count;
+    int options;                /* parser options */
+    uint32_t refs;              /* number of nodes referencing the image */
+};
+
+/**
+ * @brief Inner data node with not yet parsed children (::lyd_node#lazy), allocated only by the LYB parser.
+ */
+struct lyd_node_lazy {
+    struct lyd_node node;       /* must be first */
+    struct lyb_image *img;      /* image the children are parsed from */
+    const char *data;           /* LYB v2 subtrees of the children in img */
+    size_t size;                /* size of all the children subtrees */
 };
 
 /* struct lyb_state allocation step */
 #define LYB_STATE_STEP 4
 
+/**
+ * LYB format versions
+ *
+ * Version is stored in the lower bits of the header byte following the magic number, version 1
+ * was written as 0. Every v1 subtree is split into chunks of at most #LYB_SIZE_MAX bytes, each
+ * preceded by its size and the number of chunk meta information inside (#LYB_META_BYTES).
+ * Every v2 subtree is preceded by its whole size encoded as a varint (7 bits in every byte,
+ * least significant first, the highest bit set in all but the last byte) and the data can
+ * be preceded by the offsets of the top-level subtrees (#LYB_HEADER_OFFSETS). Resolved values
+ * of unions without leafref/instance-identifier members are stored in v2 as the member type
+ * followed by the member index (varint) instead of a string to be resolved again.
+ */
+#define LYB_VERSION_1 0x00
+#define LYB_VERSION_2 0x02
+
+/* Current version, the only one printed */
+#define LYB_VERSION LYB_VERSION_2
+
+/* Header byte version mask */
+#define LYB_VERSION_MASK 0x0f
+
+/* Header flag of v2, the models are followed by the top-level subtree count and their offsets (varints)
+ * relative to the end of this table */
+#define LYB_HEADER_OFFSETS 0x10
+
+/* Maximum number of bytes of a varint (enough for size_t) */
+#define LYB_VARINT_MAX_BYTES 10
+
 /**
  * LYB schema hash constants
  *
@@ -160,6 +222,11 @@ int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **mod
  */
 #   define LY_CACHE_HT_MIN_CHILDREN 4
 
+/**
+ * @brief Minimum number of objects in a set to create a hash table index for them.
+ */
+#   define LY_CACHE_SET_MIN_ITEMS 32
+
     int lyd_hash(struct lyd_node *node);
 
     void lyd_insert_hash(struct lyd_node *node);
@@ -167,6 +234,139 @@ int lyb_has_schema_model(struct lys_node *sibling, const struct lys_module **mod
     void lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent);
 #endif
 
+/**
+ * @brief Set without duplicate objects for the internal callers searching large sets.
+ *
+ * Public ::ly_set functions search the set array, this set is indexed in a hash table once it has
+ * #LY_CACHE_SET_MIN_ITEMS objects. The objects can be read from the set member, but the set can be
+ * modified only by ly_set_idx_add(). Initialize it to zeros and free it by ly_set_idx_free().
+ */
+struct ly_set_idx {
+    struct ly_set set;          /**< set objects in the order they were added in */
+#ifdef LY_ENABLED_CACHE
+    struct hash_table *ht;      /**< index of the set objects, NULL for small sets */
+#endif
+};
+
+/**
+ * @brief Add an object into an indexed set, if not already there.
+ *
+ * @param[in] idx Set to modify.
+ * @param[in] obj Object to add.
+ * @return Index of the object in the set, -1 on error.
+ */
+int ly_set_idx_add(struct ly_set_idx *idx, void *obj);
+
+/**
+ * @brief Find an object in an indexed set.
+ *
+ * @param[in] idx Set to search in.
+ * @param[in] obj Object to find.
+ * @return Index of the object in the set, -1 if not found.
+ */
+int ly_set_idx_contains(const struct ly_set_idx *idx, void *obj);
+
+/**
+ * @brief Free the objects and the index of an indexed set, the structure itself is not freed.
+ *
+ * @param[in] idx Set to free.
+ */
+void ly_set_idx_free(struct ly_set_idx *idx);
+
+/**
+ * @brief (Sub)module file found in the search directories.
+ */
+struct lys_searchdir_file {
+    char *path;                 /**< path of the file */
+    const char *name;           /**< name of the file, points into path */
+    uint32_t order;             /**< order in which the file was found */
+    LYS_INFORMAT format;        /**< format according to the file suffix */
+};
+
+/**
+ * @brief Directory scanned for the search directories index.
+ */
+struct lys_searchdir_dir {
+    char *path;                 /**< path of the directory */
+    struct timespec mtime;      /**< modification time when scanned, zero if it could not be accessed */
+};
+
+/**
+ * @brief Index of all the (sub)module files in search directories.
+ *
+ * Built once by lys_searchdir_index_new() so that resolving every import and include does not
+ * need to read all the search directories again.
+ */
+struct lys_searchdir_index {
+    struct lys_searchdir_file *files;   /**< files sorted by their name and order */
+    uint32_t file_count;
+    struct lys_searchdir_dir *dirs;     /**< all the scanned directories */
+    uint32_t dir_count;
+    char **searchpaths;                 /**< NULL-terminated search paths the index was created for, NULL if none */
+    char *cwd;                          /**< current working directory if it was to be scanned, NULL otherwise */
+};
+
+/**
+ * @brief Scan the search directories and create an index of their (sub)module files.
+ *
+ * @param[in] searchpaths NULL-terminated array of paths to be searched (recursively), can be NULL.
+ * @param[in] cwd Whether to implicitly scan also the current working directory (non-recursively).
+ * @return Created index, NULL on error.
+ */
+struct lys_searchdir_index *lys_searchdir_index_new(const char * const *searchpaths, int cwd);
+
+/**
+ * @brief Check whether an index still describes the search directories.
+ *
+ * Any file added to or removed from the directories changes their modification time.
+ *
+ * @param[in] index Index to check.
+ * @param[in] searchpaths NULL-terminated array of paths to be searched, can be NULL.
+ * @param[in] cwd Whether the current working directory is to be searched.
+ * @return 1 if the index is up-to-date, 0 if it needs to be created again.
+ */
+int lys_searchdir_index_valid(const struct lys_searchdir_index *index, const char * const *searchpaths, int cwd);
+
+/**
+ * @brief Find a (sub)module file in an index, see lys_search_localfile().
+ *
+ * @param[in] index Index to search in.
+ * @param[in] name Name of the (sub)module.
+ * @param[in] revision Revision of the (sub)module, NULL for the newest one.
+ * @param[out] localfile Path of the found file, NULL if not found.
+ * @param[out] format Optional format of the found file.
+ * @return EXIT_FAILURE on error, EXIT_SUCCESS otherwise (even if the file is not found).
+ */
+int lys_searchdir_index_find(const struct lys_searchdir_index *index, const char *name, const char *revision,
+                             char **localfile, LYS_INFORMAT *format);
+
+/**
+ * @brief Free a search directories index.
+ *
+ * @param[in] index Index to free.
+ */
+void lys_searchdir_index_free(struct lys_searchdir_index *index);
+
+/**
+ * @brief Get the order of instances of a schema node among their data siblings.
+ *
+ * Instances of nodes from modules earlier in the context come first, the instances of nodes
+ * from the same module are ordered as their schema nodes. The positions are computed once
+ * for all the siblings and cached in the context until its modules change.
+ *
+ * @param[in] snode Schema node of the data node.
+ * @param[out] order Order of \p snode instances, to be compared with other siblings only.
+ * @return EXIT_SUCCESS on success, -1 on error.
+ */
+int lys_data_order(const struct lys_node *snode, uint64_t *order);
+
+/**
+ * @brief Free the cached data order of schema nodes of a context.
+ *
+ * @param[in] ctx Context with the cache.
+ */
+void lys_data_order_free(struct ly_ctx *ctx);
+
 /**
  * @brief Create submodule structure by reading data from memory.
  *
@@ -391,6 +591,49 @@ void lys_node_free(struct lys_node *node, void (*private_destructor)(const struc
 void lys_free(struct lys_module *module, void (*private_destructor)(const struct lys_node *node, void *priv),
               int free_subs, int remove_from_ctx);
 
+/**
+ * @brief Allocate a zeroed data node structure.
+ *
+ * @param[in] size Size of the node structure.
+ * @param[in] arena Memory arena to allocate the node from, NULL to allocate it separately.
+ * @return New node, NULL on error.
+ */
+struct lyd_node *lyd_node_calloc(size_t size, struct ly_arena *arena);
+
+/**
+ * @brief Free a data node structure allocated by lyd_node_calloc(), nothing else is freed.
+ *
+ * @param[in] node Node to free.
+ */
+void lyd_node_free_mem(struct lyd_node *node);
+
+/**
+ * @brief Parse the children of a node with ::lyd_node#lazy set, the node is not lazy afterwards even on error.
+ *
+ * @param[in] node Node to parse the children of.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyb_lazy_load(struct lyd_node *node);
+
+/**
+ * @brief Release the LYB image of a node with ::lyd_node#lazy set, its children are never parsed.
+ *
+ * @param[in] node Node being freed.
+ */
+void lyb_lazy_free(struct lyd_node *node);
+
+/**
+ * @brief Parse all the not yet parsed nodes (#LYD_OPT_LYB_LAZY) of a subtree before it is processed as a whole.
+ *
+ * Validation, printers, merge and diff process complete trees and XPath evaluations that do not modify
+ * the tree (parallel validation, held document positions) rely on it, so they parse everything first.
+ *
+ * @param[in] node Root of the subtree, may be NULL.
+ * @param[in] siblings Whether to parse the subtrees of all the siblings of \p node, too.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyb_lazy_load_tree(const struct lyd_node *node, int siblings);
+
 /**
  * @brief Create a data container knowing it's schema node.
  *
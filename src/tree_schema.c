@@ -416,6 +416,126 @@ repeat:
     }
 }
 
+/* position of a schema node among its data siblings or of a module in its context, see lys_data_order() */
+struct lys_data_pos {
+    const void *item;
+    uint32_t pos;
+};
+
+static int
+lys_data_pos_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct lys_data_pos *)val1_p)->item == ((struct lys_data_pos *)val2_p)->item;
+}
+
+static uint32_t
+lys_data_pos_hash(const void *item)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&item, sizeof item);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+static uint32_t
+lys_data_pos_find(struct hash_table *ht, const void *item)
+{
+    struct lys_data_pos rec, *match;
+
+    rec.item = item;
+    if (lyht_find(ht, &rec, lys_data_pos_hash(item), (void **)&match)) {
+        return 0;
+    }
+    return match->pos;
+}
+
+static int
+lys_data_pos_insert(struct hash_table *ht, const void *item, uint32_t pos)
+{
+    struct lys_data_pos rec, *match;
+    int rc;
+
+    rec.item = item;
+    rec.pos = pos;
+    rc = lyht_insert(ht, &rec, lys_data_pos_hash(item), (void **)&match);
+    if (rc == 1) {
+        /* the siblings are being numbered again */
+        match->pos = pos;
+        rc = 0;
+    }
+    return rc;
+}
+
+int
+lys_data_order(const struct lys_node *snode, uint64_t *order)
+{
+    struct ly_ctx *ctx = snode->module->ctx;
+    const struct lys_module *mod = lys_node_module(snode);
+    const struct lys_node *first, *next = NULL;
+    uint32_t mpos, npos, i;
+    int ret = -1;
+
+    pthread_mutex_lock(&ctx->data_pos_lock);
+
+    if (ctx->data_pos && (ctx->data_pos_set_id != ctx->models.module_set_id)) {
+        /* the context changed, number everything again */
+        lys_data_order_free(ctx);
+    }
+    if (!ctx->data_pos) {
+        ctx->data_pos = lyht_new(256, sizeof(struct lys_data_pos), lys_data_pos_equal, NULL, 1);
+        LY_CHECK_ERR_GOTO(!ctx->data_pos, LOGMEM(ctx), cleanup);
+        ctx->data_pos_set_id = ctx->models.module_set_id;
+    }
+
+    mpos = lys_data_pos_find(ctx->data_pos, mod);
+    if (!mpos) {
+        for (i = 0; i < (unsigned)ctx->models.used; ++i) {
+            LY_CHECK_ERR_GOTO(lys_data_pos_insert(ctx->data_pos, ctx->models.list[i], i + 1), LOGINT(ctx), cleanup);
+        }
+        mpos = lys_data_pos_find(ctx->data_pos, mod);
+    }
+
+    npos = lys_data_pos_find(ctx->data_pos, snode);
+    if (!npos) {
+        /* find the data node schema parent */
+        first = snode;
+        while (lys_parent(first) && (lys_parent(first)->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES))) {
+            first = lys_parent(first);
+        }
+
+        /* find the beginning */
+        if (lys_parent(first)) {
+            first = lys_parent(first)->child;
+        } else {
+            while (first->prev->next) {
+                first = first->prev;
+            }
+        }
+
+        /* number all the siblings at once, lys_getnext() skips non-data schema nodes for us */
+        i = 0;
+        while ((next = lys_getnext(next, lys_parent(first), lys_node_module(first), LYS_GETNEXT_NOSTATECHECK))) {
+            LY_CHECK_ERR_GOTO(lys_data_pos_insert(ctx->data_pos, next, ++i), LOGINT(ctx), cleanup);
+        }
+        npos = lys_data_pos_find(ctx->data_pos, snode);
+    }
+
+    LY_CHECK_ERR_GOTO(!mpos || !npos, LOGINT(ctx), cleanup);
+    *order = ((uint64_t)mpos << 32) | npos;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    pthread_mutex_unlock(&ctx->data_pos_lock);
+    return ret;
+}
+
+void
+lys_data_order_free(struct ly_ctx *ctx)
+{
+    lyht_free(ctx->data_pos);
+    ctx->data_pos = NULL;
+}
+
 void
 lys_node_unlink(struct lys_node *node)
 {
@@ -1321,52 +1441,103 @@ lys_sub_parse_fd(struct lys_module *module, int fd, LYS_INFORMAT format, struct
 
 }
 
-API int
-lys_search_localfile(const char * const *searchpaths, int cwd, const char *name, const char *revision, char **localfile, LYS_INFORMAT *format)
+/* get the modification time of a file */
+static void
+lys_searchdir_mtime(const struct stat *st, struct timespec *mtime)
 {
-    FUN_IN;
+#ifdef __APPLE__
+    *mtime = st->st_mtimespec;
+#else
+    *mtime = st->st_mtim;
+#endif
+}
 
-    size_t len, flen, match_len = 0, dir_len;
-    int i, implicit_cwd = 0, ret = EXIT_FAILURE;
-    char *wd, *wn = NULL;
+/* remember a scanned directory with its modification time */
+static int
+lys_searchdir_index_add_dir(struct lys_searchdir_index *index, char *path, DIR *dir)
+{
+    struct lys_searchdir_dir *dirs;
+    struct stat st;
+
+    dirs = realloc(index->dirs, (index->dir_count + 1) * sizeof *index->dirs);
+    LY_CHECK_ERR_RETURN(!dirs, LOGMEM(NULL), -1);
+    index->dirs = dirs;
+
+    dirs[index->dir_count].path = path;
+    if (dir && !fstat(dirfd(dir), &st)) {
+        lys_searchdir_mtime(&st, &dirs[index->dir_count].mtime);
+    } else {
+        memset(&dirs[index->dir_count].mtime, 0, sizeof dirs[index->dir_count].mtime);
+    }
+    ++index->dir_count;
+
+    return 0;
+}
+
+static int
+lys_searchdir_file_cmp(const void *f1, const void *f2)
+{
+    const struct lys_searchdir_file *file1 = f1, *file2 = f2;
+    int ret;
+
+    ret = strcmp(file1->name, file2->name);
+    if (!ret) {
+        ret = (file1->order > file2->order) - (file1->order < file2->order);
+    }
+    return ret;
+}
+
+struct lys_searchdir_index *
+lys_searchdir_index_new(const char * const *searchpaths, int cwd)
+{
+    size_t flen, dir_len;
+    int i, implicit_cwd = 0;
+    char *wd = NULL, *wn = NULL;
     DIR *dir = NULL;
     struct dirent *file;
-    char *match_name = NULL;
-    LYS_INFORMAT format_aux, match_format = 0;
+    LYS_INFORMAT format_aux;
     unsigned int u;
     struct ly_set *dirs;
     struct stat st;
+    struct lys_searchdir_index *index;
+    struct lys_searchdir_file *files;
+    uint32_t files_size = 0;
 
-    if (!localfile) {
-        LOGARG;
-        return EXIT_FAILURE;
-    }
+    index = calloc(1, sizeof *index);
+    LY_CHECK_ERR_RETURN(!index, LOGMEM(NULL), NULL);
 
     /* start to fill the dir fifo with the context's search path (if set)
      * and the current working directory */
     dirs = ly_set_new();
     if (!dirs) {
         LOGMEM(NULL);
-        return EXIT_FAILURE;
+        free(index);
+        return NULL;
     }
 
-    len = strlen(name);
     if (cwd) {
         wd = get_current_dir_name();
         if (!wd) {
             LOGMEM(NULL);
-            goto cleanup;
+            goto error;
         } else {
             /* add implicit current working directory (./) to be searched,
              * this directory is not searched recursively */
             if (ly_set_add(dirs, wd, 0) == -1) {
-                goto cleanup;
+                goto error;
             }
             implicit_cwd = 1;
         }
     }
     if (searchpaths) {
+        for (i = 0; searchpaths[i]; i++);
+        index->searchpaths = calloc(i + 1, sizeof *index->searchpaths);
+        LY_CHECK_ERR_GOTO(!index->searchpaths, LOGMEM(NULL), error);
+
         for (i = 0; searchpaths[i]; i++) {
+            index->searchpaths[i] = strdup(searchpaths[i]);
+            LY_CHECK_ERR_GOTO(!index->searchpaths[i], LOGMEM(NULL), error);
+
             /* check for duplicities with the implicit current working directory */
             if (implicit_cwd && !strcmp(dirs->set.g[0], searchpaths[i])) {
                 implicit_cwd = 0;
@@ -1375,23 +1546,26 @@ lys_search_localfile(const char * const *searchpaths, int cwd, const char *name,
             wd = strdup(searchpaths[i]);
             if (!wd) {
                 LOGMEM(NULL);
-                goto cleanup;
+                goto error;
             } else if (ly_set_add(dirs, wd, 0) == -1) {
-                goto cleanup;
+                goto error;
             }
         }
     }
+    if (cwd) {
+        index->cwd = strdup(dirs->set.g[0]);
+        LY_CHECK_ERR_GOTO(!index->cwd, LOGMEM(NULL), error);
+    }
     wd = NULL;
 
-    /* start searching */
+    /* start scanning */
     while (dirs->number) {
-        free(wd);
         free(wn); wn = NULL;
 
         dirs->number--;
         wd = (char *)dirs->set.g[dirs->number];
         dirs->set.g[dirs->number] = NULL;
-        LOGVRB("Searching for \"%s\" in %s.", name, wd);
+        LOGVRB("Searching for (sub)modules in %s.", wd);
 
         if (dir) {
             closedir(dir);
@@ -1400,120 +1574,276 @@ lys_search_localfile(const char * const *searchpaths, int cwd, const char *name,
         dir_len = strlen(wd);
         if (!dir) {
             LOGWRN(NULL, "Unable to open directory \"%s\" for searching (sub)modules (%s).", wd, strerror(errno));
-        } else {
-            while ((file = readdir(dir))) {
-                if (!strcmp(".", file->d_name) || !strcmp("..", file->d_name)) {
-                    /* skip . and .. */
-                    continue;
-                }
-                free(wn);
-                if (asprintf(&wn, "%s/%s", wd, file->d_name) == -1) {
-                    LOGMEM(NULL);
-                    goto cleanup;
-                }
-                if (stat(wn, &st) == -1) {
-                    LOGWRN(NULL, "Unable to get information about \"%s\" file in \"%s\" when searching for (sub)modules (%s)",
-                           file->d_name, wd, strerror(errno));
-                    continue;
-                }
-                if (S_ISDIR(st.st_mode) && (dirs->number || !implicit_cwd)) {
-                    /* we have another subdirectory in searchpath to explore,
-                     * subdirectories are not taken into account in current working dir (dirs->set.g[0]) */
-                    if (ly_set_add(dirs, wn, 0) == -1) {
-                        goto cleanup;
-                    }
-                    /* continue with the next item in current directory */
-                    wn = NULL;
-                    continue;
-                } else if (!S_ISREG(st.st_mode)) {
-                    /* not a regular file (note that we see the target of symlinks instead of symlinks */
-                    continue;
-                }
-
-                /* here we know that the item is a file which can contain a module */
-                if (strncmp(name, file->d_name, len) ||
-                        (file->d_name[len] != '.' && file->d_name[len] != '@')) {
-                    /* different filename than the module we search for */
-                    continue;
-                }
+        }
+        if (lys_searchdir_index_add_dir(index, wd, dir)) {
+            goto error;
+        }
+        wd = NULL;
+        if (!dir) {
+            continue;
+        }
 
-                /* get type according to filename suffix */
-                flen = strlen(file->d_name);
-                if (!strcmp(&file->d_name[flen - 4], ".yin")) {
-                    format_aux = LYS_IN_YIN;
-                } else if (!strcmp(&file->d_name[flen - 5], ".yang")) {
-                    format_aux = LYS_IN_YANG;
-                } else {
-                    /* not supportde suffix/file format */
-                    continue;
+        while ((file = readdir(dir))) {
+            if (!strcmp(".", file->d_name) || !strcmp("..", file->d_name)) {
+                /* skip . and .. */
+                continue;
+            }
+            free(wn);
+            if (asprintf(&wn, "%s/%s", index->dirs[index->dir_count - 1].path, file->d_name) == -1) {
+                wn = NULL;
+                LOGMEM(NULL);
+                goto error;
+            }
+            if (stat(wn, &st) == -1) {
+                LOGWRN(NULL, "Unable to get information about \"%s\" file in \"%s\" when searching for (sub)modules (%s)",
+                       file->d_name, index->dirs[index->dir_count - 1].path, strerror(errno));
+                continue;
+            }
+            if (S_ISDIR(st.st_mode) && (dirs->number || !implicit_cwd)) {
+                /* we have another subdirectory in searchpath to explore,
+                 * subdirectories are not taken into account in current working dir (dirs->set.g[0]) */
+                if (ly_set_add(dirs, wn, 0) == -1) {
+                    goto error;
                 }
+                /* continue with the next item in current directory */
+                wn = NULL;
+                continue;
+            } else if (!S_ISREG(st.st_mode)) {
+                /* not a regular file (note that we see the target of symlinks instead of symlinks */
+                continue;
+            }
 
-                if (revision) {
-                    /* we look for the specific revision, try to get it from the filename */
-                    if (file->d_name[len] == '@') {
-                        /* check revision from the filename */
-                        if (strncmp(revision, &file->d_name[len + 1], strlen(revision))) {
-                            /* another revision */
-                            continue;
-                        } else {
-                            /* exact revision */
-                            free(match_name);
-                            match_name = wn;
-                            wn = NULL;
-                            match_len = dir_len + 1 + len;
-                            match_format = format_aux;
-                            goto success;
-                        }
-                    } else {
-                        /* continue trying to find exact revision match, use this only if not found */
-                        free(match_name);
-                        match_name = wn;
-                        wn = NULL;
-                        match_len = dir_len + 1 +len;
-                        match_format = format_aux;
-                        continue;
-                    }
-                } else {
-                    /* remember the revision and try to find the newest one */
-                    if (match_name) {
-                        if (file->d_name[len] != '@' || lyp_check_date(NULL, &file->d_name[len + 1])) {
-                            continue;
-                        } else if (match_name[match_len] == '@' &&
-                                (strncmp(&match_name[match_len + 1], &file->d_name[len + 1], LY_REV_SIZE - 1) >= 0)) {
-                            continue;
-                        }
-                        free(match_name);
-                    }
+            /* get type according to filename suffix */
+            flen = strlen(file->d_name);
+            if ((flen > 4) && !strcmp(&file->d_name[flen - 4], ".yin")) {
+                format_aux = LYS_IN_YIN;
+            } else if ((flen > 5) && !strcmp(&file->d_name[flen - 5], ".yang")) {
+                format_aux = LYS_IN_YANG;
+            } else {
+                /* not supportde suffix/file format */
+                continue;
+            }
 
-                    match_name = wn;
-                    wn = NULL;
-                    match_len = dir_len + 1 + len;
-                    match_format = format_aux;
-                    continue;
-                }
+            /* here we know that the item is a file which can contain a (sub)module */
+            if (index->file_count == files_size) {
+                files_size = files_size ? files_size * 2 : 64;
+                files = realloc(index->files, files_size * sizeof *index->files);
+                LY_CHECK_ERR_GOTO(!files, LOGMEM(NULL), error);
+                index->files = files;
             }
+            index->files[index->file_count].path = wn;
+            index->files[index->file_count].name = wn + dir_len + 1;
+            index->files[index->file_count].order = index->file_count;
+            index->files[index->file_count].format = format_aux;
+            ++index->file_count;
+            wn = NULL;
         }
     }
 
-success:
-    (*localfile) = match_name;
-    match_name = NULL;
-    if (format) {
-        (*format) = match_format;
+    /* sort the files by name, files with the same name stay in the order they were found in */
+    if (index->file_count) {
+        qsort(index->files, index->file_count, sizeof *index->files, lys_searchdir_file_cmp);
     }
-    ret = EXIT_SUCCESS;
 
-cleanup:
+    free(wn);
+    if (dir) {
+        closedir(dir);
+    }
+    ly_set_free(dirs);
+    return index;
+
+error:
     free(wn);
     free(wd);
     if (dir) {
         closedir(dir);
     }
-    free(match_name);
     for (u = 0; u < dirs->number; u++) {
         free(dirs->set.g[u]);
     }
     ly_set_free(dirs);
+    lys_searchdir_index_free(index);
+    return NULL;
+}
+
+int
+lys_searchdir_index_valid(const struct lys_searchdir_index *index, const char * const *searchpaths, int cwd)
+{
+    struct timespec mtime;
+    struct stat st;
+    char *wd;
+    uint32_t u;
+    int ret = 1;
+
+    /* the same search paths */
+    if (!searchpaths != !index->searchpaths) {
+        return 0;
+    }
+    for (u = 0; searchpaths && (searchpaths[u] || index->searchpaths[u]); ++u) {
+        if (!searchpaths[u] || !index->searchpaths[u] || strcmp(searchpaths[u], index->searchpaths[u])) {
+            return 0;
+        }
+    }
+
+    if (!cwd != !index->cwd) {
+        return 0;
+    } else if (cwd) {
+        /* the working directory may have changed */
+        wd = get_current_dir_name();
+        LY_CHECK_ERR_RETURN(!wd, LOGMEM(NULL), 0);
+        ret = !strcmp(index->cwd, wd);
+        free(wd);
+    }
+
+    for (u = 0; ret && (u < index->dir_count); ++u) {
+        if (stat(index->dirs[u].path, &st)) {
+            memset(&mtime, 0, sizeof mtime);
+        } else {
+            lys_searchdir_mtime(&st, &mtime);
+        }
+        if ((mtime.tv_sec != index->dirs[u].mtime.tv_sec) || (mtime.tv_nsec != index->dirs[u].mtime.tv_nsec)) {
+            ret = 0;
+        }
+    }
+
+    return ret;
+}
+
+int
+lys_searchdir_index_find(const struct lys_searchdir_index *index, const char *name, const char *revision,
+                         char **localfile, LYS_INFORMAT *format)
+{
+    const struct lys_searchdir_file *file, *match = NULL, **files;
+    size_t len;
+    uint32_t lo, hi, mid, count, u, v;
+
+    len = strlen(name);
+
+    /* the first file not ordered before name, all the files starting with name follow */
+    lo = 0;
+    hi = index->file_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (strcmp(index->files[mid].name, name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (hi = lo; (hi < index->file_count) && !strncmp(index->files[hi].name, name, len); ++hi);
+
+    /* the files of the (sub)module, in the order they were found in */
+    files = malloc((hi - lo + 1) * sizeof *files);
+    LY_CHECK_ERR_RETURN(!files, LOGMEM(NULL), EXIT_FAILURE);
+    count = 0;
+    for (u = lo; u < hi; ++u) {
+        if ((index->files[u].name[len] != '.') && (index->files[u].name[len] != '@')) {
+            /* different filename than the module we search for */
+            continue;
+        }
+        for (v = count; v && (files[v - 1]->order > index->files[u].order); --v) {
+            files[v] = files[v - 1];
+        }
+        files[v] = &index->files[u];
+        ++count;
+    }
+
+    LOGVRB("Searching for \"%s\" in the search directories.", name);
+    for (u = 0; u < count; ++u) {
+        file = files[u];
+        if (revision) {
+            /* we look for the specific revision, try to get it from the filename */
+            if (file->name[len] == '@') {
+                /* check revision from the filename */
+                if (strncmp(revision, &file->name[len + 1], strlen(revision))) {
+                    /* another revision */
+                    continue;
+                } else {
+                    /* exact revision */
+                    match = file;
+                    break;
+                }
+            } else {
+                /* continue trying to find exact revision match, use this only if not found */
+                match = file;
+                continue;
+            }
+        } else {
+            /* remember the revision and try to find the newest one */
+            if (match) {
+                if (file->name[len] != '@' || lyp_check_date(NULL, &file->name[len + 1])) {
+                    continue;
+                } else if (match->name[len] == '@' &&
+                        (strncmp(&match->name[len + 1], &file->name[len + 1], LY_REV_SIZE - 1) >= 0)) {
+                    continue;
+                }
+            }
+
+            match = file;
+        }
+    }
+    free(files);
+
+    if (match) {
+        *localfile = strdup(match->path);
+        LY_CHECK_ERR_RETURN(!*localfile, LOGMEM(NULL), EXIT_FAILURE);
+        if (format) {
+            *format = match->format;
+        }
+    } else {
+        *localfile = NULL;
+        if (format) {
+            *format = 0;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void
+lys_searchdir_index_free(struct lys_searchdir_index *index)
+{
+    uint32_t u;
+
+    if (!index) {
+        return;
+    }
+
+    for (u = 0; u < index->file_count; ++u) {
+        free(index->files[u].path);
+    }
+    free(index->files);
+    for (u = 0; u < index->dir_count; ++u) {
+        free(index->dirs[u].path);
+    }
+    free(index->dirs);
+    for (u = 0; index->searchpaths && index->searchpaths[u]; ++u) {
+        free(index->searchpaths[u]);
+    }
+    free(index->searchpaths);
+    free(index->cwd);
+    free(index);
+}
+
+API int
+lys_search_localfile(const char * const *searchpaths, int cwd, const char *name, const char *revision, char **localfile, LYS_INFORMAT *format)
+{
+    FUN_IN;
+
+    struct lys_searchdir_index *index;
+    int ret;
+
+    if (!localfile) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    index = lys_searchdir_index_new(searchpaths, cwd);
+    if (!index) {
+        return EXIT_FAILURE;
+    }
+    ret = lys_searchdir_index_find(index, name, revision, localfile, format);
+    lys_searchdir_index_free(index);
 
     return ret;
 }
@@ -3831,6 +4161,7 @@ lys_free(struct lys_module *module, void (*private_destructor)(const struct lys_
                 ctx->models.used--;
                 memmove(&ctx->models.list[i], ctx->models.list[i + 1], (ctx->models.used - i) * sizeof *ctx->models.list);
                 ctx->models.list[ctx->models.used] = NULL;
+                ly_ctx_module_index_rebuild(ctx);
                 /* we are done */
                 break;
             }
@@ -5117,6 +5448,8 @@ lys_set_implemented(const struct lys_module *module)
         goto error;
     }
     unres_schema_free(NULL, &unres, 0);
+    /* augments were applied */
+    module->ctx->models.module_set_id++;
 
     LOGVRB("Module \"%s%s%s\" now implemented.", module->name, (module->rev_size ? "@" : ""),
            (module->rev_size ? module->rev[0].date : ""));
@@ -5130,6 +5463,7 @@ error:
 
     ((struct lys_module *)module)->implemented = 0;
     unres_schema_free((struct lys_module *)module, &unres, 1);
+    module->ctx->models.module_set_id++;
     return EXIT_FAILURE;
 }
 
@@ -13,10 +13,12 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "common.h"
+#include "context.h"
 #include "validation.h"
 #include "libyang.h"
 #include "xpath.h"
@@ -952,3 +954,225 @@ autodelete:
 
     return 0;
 }
+
+/* add all the schema nodes accessed by an XPath expression (set) into atoms */
+static int
+lyv_data_deps_add_atoms(struct lyxp_set *set, struct ly_set *atoms)
+{
+    uint32_t i;
+
+    for (i = 0; i < set->used; ++i) {
+        if ((set->val.snodes[i].type == LYXP_NODE_ELEM) && (ly_set_add(atoms, set->val.snodes[i].snode, 0) == -1)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* 0 - atoms of all the leafrefs in the type added, 1 - the type cannot be tracked, -1 - error */
+static int
+lyv_data_deps_type(const struct lys_node *snode, const struct lys_type *type, struct ly_set *atoms)
+{
+    struct lyxp_set set;
+    unsigned int i;
+    int rc;
+
+    switch (type->base) {
+    case LY_TYPE_LEAFREF:
+        memset(&set, 0, sizeof set);
+        if (lyxp_atomize(type->info.lref.path, snode, LYXP_NODE_ELEM, &set, LYXP_SNODE, NULL)) {
+            free(set.val.snodes);
+            return 1;
+        }
+        rc = lyv_data_deps_add_atoms(&set, atoms);
+        free(set.val.snodes);
+        return rc;
+    case LY_TYPE_INST:
+        /* can refer to anything */
+        return 1;
+    case LY_TYPE_UNION:
+        if (!type->info.uni.has_ptr_type) {
+            return 0;
+        }
+        for (i = 0; i < type->info.uni.count; ++i) {
+            if ((rc = lyv_data_deps_type(snode, &type->info.uni.types[i], atoms))) {
+                return rc;
+            }
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+/* atoms of all the when and must conditions and leafrefs relevant for the data instances of snode,
+ * 0 - success, 1 - the dependencies cannot be tracked, -1 - error */
+static int
+lyv_data_deps_node(const struct lys_node *snode, struct ly_set *atoms)
+{
+    const struct lys_node *siter;
+    struct lyxp_set set;
+    int rc;
+
+    /* the same nodes as in resolve_applies_when() and all the musts of the node itself */
+    siter = snode;
+    do {
+        if (lyxp_node_atomize(siter, &set, 0)) {
+            free(set.val.snodes);
+            return 1;
+        }
+        rc = lyv_data_deps_add_atoms(&set, atoms);
+        free(set.val.snodes);
+        if (rc) {
+            return rc;
+        }
+
+        if (siter->parent && (siter->parent->nodetype == LYS_AUGMENT)) {
+            if (lyxp_node_atomize(siter->parent, &set, 0)) {
+                free(set.val.snodes);
+                return 1;
+            }
+            rc = lyv_data_deps_add_atoms(&set, atoms);
+            free(set.val.snodes);
+            if (rc) {
+                return rc;
+            }
+        }
+
+        siter = lys_parent(siter);
+    } while (siter && (siter->nodetype & (LYS_USES | LYS_CHOICE | LYS_CASE)));
+
+    if (snode->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        return lyv_data_deps_type(snode, &((struct lys_node_leaf *)snode)->type, atoms);
+    }
+    return 0;
+}
+
+static int
+lyv_data_deps_build_r(const struct lys_node *parent, const struct lys_module *module, struct lyv_data_dep **deps,
+                      uint32_t *count)
+{
+    const struct lys_node *snode = NULL;
+    struct lyv_data_dep *dep;
+    struct ly_set *atoms;
+    int rc;
+
+    while ((snode = lys_getnext(snode, parent, module, LYS_GETNEXT_NOSTATECHECK))) {
+        if (snode->nodetype & (LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+            /* not part of data trees */
+            continue;
+        }
+
+        atoms = ly_set_new();
+        LY_CHECK_ERR_RETURN(!atoms, LOGMEM(module->ctx), -1);
+        rc = lyv_data_deps_node(snode, atoms);
+        if (rc == -1) {
+            ly_set_free(atoms);
+            return -1;
+        } else if (rc) {
+            /* revalidate always */
+            ly_set_free(atoms);
+            atoms = NULL;
+        } else if (!atoms->number) {
+            /* no dependencies */
+            ly_set_free(atoms);
+            goto next;
+        }
+
+        dep = realloc(*deps, (*count + 2) * sizeof **deps);
+        LY_CHECK_ERR_RETURN(!dep, LOGMEM(module->ctx); ly_set_free(atoms), -1);
+        *deps = dep;
+        (*deps)[*count].snode = snode;
+        (*deps)[*count].atoms = atoms;
+        ++(*count);
+        (*deps)[*count].snode = NULL;
+
+next:
+        if ((snode->nodetype & (LYS_CONTAINER | LYS_LIST)) && lyv_data_deps_build_r(snode, NULL, deps, count)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void
+lyv_data_deps_free(struct ly_ctx *ctx)
+{
+    struct lyv_data_dep *dep;
+
+    if (!ctx->val_deps) {
+        return;
+    }
+
+    for (dep = ctx->val_deps; dep->snode; ++dep) {
+        ly_set_free(dep->atoms);
+    }
+    free(ctx->val_deps);
+    ctx->val_deps = NULL;
+}
+
+int
+lyv_data_deps_affected(struct ly_ctx *ctx, const struct ly_set_idx *changed, struct ly_set_idx *affected)
+{
+    struct lyv_data_dep *dep;
+    const struct lys_node *siter;
+    enum int_log_opts prev_ilo;
+    uint32_t count = 0;
+    int i, ret = -1;
+    unsigned int u;
+
+    pthread_mutex_lock(&ctx->val_deps_lock);
+
+    if (ctx->val_deps && (ctx->val_deps_set_id != ctx->models.module_set_id)) {
+        /* modules changed */
+        lyv_data_deps_free(ctx);
+    }
+    if (!ctx->val_deps) {
+        ctx->val_deps = calloc(1, sizeof *ctx->val_deps);
+        LY_CHECK_ERR_GOTO(!ctx->val_deps, LOGMEM(ctx), cleanup);
+
+        /* the conditions were already checked when the schemas were parsed */
+        ly_ilo_change(NULL, ILO_IGNORE, &prev_ilo, NULL);
+        for (i = 0; i < ctx->models.used; ++i) {
+            if (!ctx->models.list[i]->implemented || ctx->models.list[i]->disabled) {
+                continue;
+            }
+            if (lyv_data_deps_build_r(NULL, ctx->models.list[i], &ctx->val_deps, &count)) {
+                break;
+            }
+        }
+        ly_ilo_restore(NULL, prev_ilo, NULL, 0);
+        if (i < ctx->models.used) {
+            lyv_data_deps_free(ctx);
+            goto cleanup;
+        }
+        ctx->val_deps_set_id = ctx->models.module_set_id;
+    }
+
+    for (dep = ctx->val_deps; dep->snode; ++dep) {
+        if (dep->atoms) {
+            /* an atom or any of its parents changed (removed children are only known from their parent) */
+            for (u = 0; u < dep->atoms->number; ++u) {
+                for (siter = dep->atoms->set.s[u]; siter && (ly_set_idx_contains(changed, (void *)siter) == -1);
+                     siter = lys_parent(siter));
+                if (siter) {
+                    break;
+                }
+            }
+            if (u == dep->atoms->number) {
+                continue;
+            }
+        }
+
+        if (ly_set_idx_add(affected, (void *)dep->snode) == -1) {
+            goto cleanup;
+        }
+    }
+    ret = 0;
+
+cleanup:
+    pthread_mutex_unlock(&ctx->val_deps_lock);
+    return ret;
+}
@@ -18,6 +18,7 @@
 #include "libyang.h"
 #include "resolve.h"
 #include "tree_data.h"
+#include "tree_internal.h"
 
 /**
  * @brief Check, that the data node of the given schema node can even appear in a data tree.
@@ -85,4 +86,35 @@ int lyv_data_dup(struct lyd_node *node, struct lyd_node *start);
 int lyv_multicases(struct lyd_node *node, struct lys_node *schemanode, struct lyd_node **first_sibling, int autodelete,
                    struct lyd_node *nodel);
 
+/**
+ * @brief Schema node whose data instances have some when or must conditions, or leafrefs (any references) that
+ * may need to be checked again when other data nodes change.
+ */
+struct lyv_data_dep {
+    const struct lys_node *snode;   /**< schema node of the dependent data nodes, NULL terminates the array */
+    struct ly_set *atoms;           /**< schema nodes accessed by the conditions and references, NULL if they
+                                         cannot be determined and the data nodes must be always revalidated */
+};
+
+/**
+ * @brief Get the schema nodes whose data instances must be revalidated because they depend on some changed data.
+ *
+ * The dependencies of all the implemented modules are learned once and cached in the context until
+ * the module set changes.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] changed Schema nodes of all the changed data nodes, the whole subtrees of the nodes are
+ * considered changed.
+ * @param[in,out] affected Set to add the affected schema nodes into.
+ * @return 0 on success, -1 on error.
+ */
+int lyv_data_deps_affected(struct ly_ctx *ctx, const struct ly_set_idx *changed, struct ly_set_idx *affected);
+
+/**
+ * @brief Free the cached validation dependencies of a context.
+ *
+ * @param[in] ctx libyang context.
+ */
+void lyv_data_deps_free(struct ly_ctx *ctx);
+
 #endif /* LY_VALIDATION_H_ */
@@ -938,22 +938,88 @@ error:
     return NULL;
 }
 
+/* logs directly */
+static int
+parse_etag(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem, const char *prefix)
+{
+    const char *c = data, *e, *start;
+    char *str;
+    int uc;
+    unsigned int size;
+
+    /* get name and check it */
+    e = c;
+    uc = lyxml_getutf8(ctx, e, &size);
+    if (!is_xmlnamestartchar(uc)) {
+        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, elem, "NameStartChar of the element");
+        return EXIT_FAILURE;
+    }
+    e += size;
+    uc = lyxml_getutf8(ctx, e, &size);
+    while (is_xmlnamechar(uc)) {
+        if (*e == ':') {
+            /* element in a namespace */
+            start = e + 1;
+
+            /* look for the prefix in namespaces */
+            if (!prefix || memcmp(prefix, c, e - c)) {
+                LOGVAL(ctx, LYE_SPEC, LY_VLOG_XML, elem,
+                       "Invalid (different namespaces) opening (%s) and closing element tags.", elem->name);
+                return EXIT_FAILURE;
+            }
+            c = start;
+        }
+        e += size;
+        uc = lyxml_getutf8(ctx, e, &size);
+    }
+    if (!*e) {
+        LOGVAL(ctx, LYE_EOF, LY_VLOG_NONE, NULL);
+        return EXIT_FAILURE;
+    }
+
+    /* check that it corresponds to opening tag */
+    size = e - c;
+    str = malloc((size + 1) * sizeof *str);
+    LY_CHECK_ERR_RETURN(!str, LOGMEM(ctx), EXIT_FAILURE);
+    memcpy(str, c, e - c);
+    str[e - c] = '\0';
+    if (size != strlen(elem->name) || memcmp(str, elem->name, size)) {
+        LOGVAL(ctx, LYE_SPEC, LY_VLOG_XML, elem,
+               "Invalid (mixed names) opening (%s) and closing (%s) element tags.", elem->name, str);
+        free(str);
+        return EXIT_FAILURE;
+    }
+    free(str);
+    c = e;
+
+    ign_xmlws(c);
+    if (*c != '>') {
+        LOGVAL(ctx, LYE_SPEC, LY_VLOG_XML, elem, "Data after closing element tag \"%s\".", elem->name);
+        return EXIT_FAILURE;
+    }
+    c++;
+
+    *len = c - data;
+    return EXIT_SUCCESS;
+}
+
 /* logs directly */
 struct lyxml_elem *
-lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int options)
+lyxml_parse_elem_start(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent,
+                       char **prefix_p, int *closed)
 {
     const char *c = data, *start, *e;
-    const char *lws;    /* leading white space for handling mixed content */
     int uc;
     char *str;
     char *prefix = NULL;
     unsigned int prefix_len = 0;
-    struct lyxml_elem *elem = NULL, *child;
+    struct lyxml_elem *elem = NULL;
     struct lyxml_attr *attr;
     unsigned int size;
-    int nons_flag = 0, closed_flag = 0;
+    int nons_flag = 0;
 
     *len = 0;
+    *closed = 0;
 
     if (*c != '<') {
         return NULL;
@@ -1017,165 +1083,10 @@ process:
         /* we are done, it was EmptyElemTag */
         c += 2;
         elem->content = lydict_insert(ctx, "", 0);
-        closed_flag = 1;
+        *closed = 1;
     } else if (*c == '>') {
-        /* process element content */
+        /* the element content follows */
         c++;
-        lws = NULL;
-
-        while (*c) {
-            if (!strncmp(c, "</", 2)) {
-                if (lws && !elem->child) {
-                    /* leading white spaces were actually content */
-                    goto store_content;
-                }
-
-                /* Etag */
-                c += 2;
-                /* get name and check it */
-                e = c;
-                uc = lyxml_getutf8(ctx, e, &size);
-                if (!is_xmlnamestartchar(uc)) {
-                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, elem, "NameStartChar of the element");
-                    goto error;
-                }
-                e += size;
-                uc = lyxml_getutf8(ctx, e, &size);
-                while (is_xmlnamechar(uc)) {
-                    if (*e == ':') {
-                        /* element in a namespace */
-                        start = e + 1;
-
-                        /* look for the prefix in namespaces */
-                        if (!prefix || memcmp(prefix, c, e - c)) {
-                            LOGVAL(ctx, LYE_SPEC, LY_VLOG_XML, elem,
-                                   "Invalid (different namespaces) opening (%s) and closing element tags.", elem->name);
-                            goto error;
-                        }
-                        c = start;
-                    }
-                    e += size;
-                    uc = lyxml_getutf8(ctx, e, &size);
-                }
-                if (!*e) {
-                    LOGVAL(ctx, LYE_EOF, LY_VLOG_NONE, NULL);
-                    goto error;
-                }
-
-                /* check that it corresponds to opening tag */
-                size = e - c;
-                str = malloc((size + 1) * sizeof *str);
-                LY_CHECK_ERR_GOTO(!str, LOGMEM(ctx), error);
-                memcpy(str, c, e - c);
-                str[e - c] = '\0';
-                if (size != strlen(elem->name) || memcmp(str, elem->name, size)) {
-                    LOGVAL(ctx, LYE_SPEC, LY_VLOG_XML, elem,
-                           "Invalid (mixed names) opening (%s) and closing (%s) element tags.", elem->name, str);
-                    free(str);
-                    goto error;
-                }
-                free(str);
-                c = e;
-
-                ign_xmlws(c);
-                if (*c != '>') {
-                    LOGVAL(ctx, LYE_SPEC, LY_VLOG_XML, elem, "Data after closing element tag \"%s\".", elem->name);
-                    goto error;
-                }
-                c++;
-                if (!(elem->flags & LYXML_ELEM_MIXED) && !elem->content) {
-                    /* there was no content, but we don't want NULL (only if mixed content) */
-                    elem->content = lydict_insert(ctx, "", 0);
-                }
-                closed_flag = 1;
-                break;
-
-            } else if (!strncmp(c, "<?", 2)) {
-                if (lws) {
-                    /* leading white spaces were only formatting */
-                    lws = NULL;
-                }
-                /* PI - ignore it */
-                c += 2;
-                if (parse_ignore(ctx, c, "?>", &size)) {
-                    goto error;
-                }
-                c += size;
-            } else if (!strncmp(c, "<!--", 4)) {
-                if (lws) {
-                    /* leading white spaces were only formatting */
-                    lws = NULL;
-                }
-                /* Comment - ignore it */
-                c += 4;
-                if (parse_ignore(ctx, c, "-->", &size)) {
-                    goto error;
-                }
-                c += size;
-            } else if (!strncmp(c, "<![CDATA[", 9)) {
-                /* CDSect */
-                goto store_content;
-            } else if (*c == '<') {
-                if (lws) {
-                    if (elem->flags & LYXML_ELEM_MIXED) {
-                        /* we have a mixed content */
-                        goto store_content;
-                    } else {
-                        /* leading white spaces were only formatting */
-                        lws = NULL;
-                    }
-                }
-                if (elem->content) {
-                    /* we have a mixed content */
-                    if (options & LYXML_PARSE_NOMIXEDCONTENT) {
-                        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
-                        goto error;
-                    }
-                    child = calloc(1, sizeof *child);
-                    LY_CHECK_ERR_GOTO(!child, LOGMEM(ctx), error);
-                    child->content = elem->content;
-                    elem->content = NULL;
-                    lyxml_add_child(ctx, elem, child);
-                    elem->flags |= LYXML_ELEM_MIXED;
-                }
-                child = lyxml_parse_elem(ctx, c, &size, elem, options);
-                if (!child) {
-                    goto error;
-                }
-                c += size;      /* move after processed child element */
-            } else if (is_xmlws(*c)) {
-                lws = c;
-                ign_xmlws(c);
-            } else {
-store_content:
-                /* store text content */
-                if (lws) {
-                    /* process content including the leading white spaces */
-                    c = lws;
-                    lws = NULL;
-                }
-                str = parse_text(ctx, c, '<', &size);
-                if (!str && !size) {
-                    goto error;
-                }
-                elem->content = lydict_insert_zc(ctx, str);
-                c += size;      /* move after processed text content */
-
-                if (elem->child) {
-                    /* we have a mixed content */
-                    if (options & LYXML_PARSE_NOMIXEDCONTENT) {
-                        LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
-                        goto error;
-                    }
-                    child = calloc(1, sizeof *child);
-                    LY_CHECK_ERR_GOTO(!child, LOGMEM(ctx), error);
-                    child->content = elem->content;
-                    elem->content = NULL;
-                    lyxml_add_child(ctx, elem, child);
-                    elem->flags |= LYXML_ELEM_MIXED;
-                }
-            }
-        }
     } else {
         /* process attribute */
         attr = parse_attr(ctx, c, &size, elem);
@@ -1206,12 +1117,7 @@ store_content:
 
     *len = c - data;
 
-    if (!closed_flag) {
-        LOGVAL(ctx, LYE_XML_MISS, LY_VLOG_XML, elem, "closing element tag", elem->name);
-        goto error;
-    }
-
-    /* resolve all attribute prefixes */
+    /* resolve all attribute prefixes, all the namespace definitions are known at this point */
     LY_TREE_FOR(elem->attr, attr) {
         if (attr->type == LYXML_ATTR_STD_UNRES) {
             str = (char *)attr->ns;
@@ -1224,7 +1130,7 @@ store_content:
     if (!elem->ns && !nons_flag && parent) {
         elem->ns = lyxml_get_ns(parent, prefix_len ? prefix : NULL);
     }
-    free(prefix);
+    *prefix_p = prefix;
     return elem;
 
 error:
@@ -1234,58 +1140,303 @@ error:
 }
 
 /* logs directly */
-API struct lyxml_elem *
-lyxml_parse_mem(struct ly_ctx *ctx, const char *data, int options)
+int
+lyxml_parse_elem_content(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem,
+                         const char *prefix, int options)
 {
-    FUN_IN;
+    const char *c = data;
+    const char *lws;    /* leading white space for handling mixed content */
+    char *str;
+    struct lyxml_elem *child;
+    unsigned int size;
+    int closed_flag = 0;
+
+    *len = 0;
+    lws = NULL;
+
+    while (*c) {
+        if (!strncmp(c, "</", 2)) {
+            if (lws && !elem->child) {
+                /* leading white spaces were actually content */
+                goto store_content;
+            }
+
+            /* Etag */
+            c += 2;
+            if (parse_etag(ctx, c, &size, elem, prefix)) {
+                return EXIT_FAILURE;
+            }
+            c += size;
+
+            if (!(elem->flags & LYXML_ELEM_MIXED) && !elem->content) {
+                /* there was no content, but we don't want NULL (only if mixed content) */
+                elem->content = lydict_insert(ctx, "", 0);
+            }
+            closed_flag = 1;
+            break;
+
+        } else if (!strncmp(c, "<?", 2)) {
+            if (lws) {
+                /* leading white spaces were only formatting */
+                lws = NULL;
+            }
+            /* PI - ignore it */
+            c += 2;
+            if (parse_ignore(ctx, c, "?>", &size)) {
+                return EXIT_FAILURE;
+            }
+            c += size;
+        } else if (!strncmp(c, "<!--", 4)) {
+            if (lws) {
+                /* leading white spaces were only formatting */
+                lws = NULL;
+            }
+            /* Comment - ignore it */
+            c += 4;
+            if (parse_ignore(ctx, c, "-->", &size)) {
+                return EXIT_FAILURE;
+            }
+            c += size;
+        } else if (!strncmp(c, "<![CDATA[", 9)) {
+            /* CDSect */
+            goto store_content;
+        } else if (*c == '<') {
+            if (lws) {
+                if (elem->flags & LYXML_ELEM_MIXED) {
+                    /* we have a mixed content */
+                    goto store_content;
+                } else {
+                    /* leading white spaces were only formatting */
+                    lws = NULL;
+                }
+            }
+            if (elem->content) {
+                /* we have a mixed content */
+                if (options & LYXML_PARSE_NOMIXEDCONTENT) {
+                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
+                    return EXIT_FAILURE;
+                }
+                child = calloc(1, sizeof *child);
+                LY_CHECK_ERR_RETURN(!child, LOGMEM(ctx), EXIT_FAILURE);
+                child->content = elem->content;
+                elem->content = NULL;
+                lyxml_add_child(ctx, elem, child);
+                elem->flags |= LYXML_ELEM_MIXED;
+            }
+            child = lyxml_parse_elem(ctx, c, &size, elem, options);
+            if (!child) {
+                return EXIT_FAILURE;
+            }
+            c += size;      /* move after processed child element */
+        } else if (is_xmlws(*c)) {
+            lws = c;
+            ign_xmlws(c);
+        } else {
+store_content:
+            /* store text content */
+            if (lws) {
+                /* process content including the leading white spaces */
+                c = lws;
+                lws = NULL;
+            }
+            str = parse_text(ctx, c, '<', &size);
+            if (!str && !size) {
+                return EXIT_FAILURE;
+            }
+            elem->content = lydict_insert_zc(ctx, str);
+            c += size;      /* move after processed text content */
+
+            if (elem->child) {
+                /* we have a mixed content */
+                if (options & LYXML_PARSE_NOMIXEDCONTENT) {
+                    LOGVAL(ctx, LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
+                    return EXIT_FAILURE;
+                }
+                child = calloc(1, sizeof *child);
+                LY_CHECK_ERR_RETURN(!child, LOGMEM(ctx), EXIT_FAILURE);
+                child->content = elem->content;
+                elem->content = NULL;
+                lyxml_add_child(ctx, elem, child);
+                elem->flags |= LYXML_ELEM_MIXED;
+            }
+        }
+    }
 
+    *len = c - data;
+
+    if (!closed_flag) {
+        LOGVAL(ctx, LYE_XML_MISS, LY_VLOG_XML, elem, "closing element tag", elem->name);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* logs directly */
+int
+lyxml_parse_elem_next(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem,
+                      const char *prefix, char **text)
+{
     const char *c = data;
-    unsigned int len;
-    struct lyxml_elem *root, *first = NULL, *next;
+    const char *lws = NULL;
+    unsigned int size;
 
-    if (!ctx) {
-        LOGARG;
+    *len = 0;
+    *text = NULL;
+
+    while (*c) {
+        if (!strncmp(c, "</", 2)) {
+            /* Etag */
+            c += 2;
+            if (parse_etag(ctx, c, &size, elem, prefix)) {
+                return -1;
+            }
+            *len = (c + size) - data;
+            return 0;
+        } else if (!strncmp(c, "<?", 2)) {
+            /* PI - ignore it */
+            c += 2;
+            if (parse_ignore(ctx, c, "?>", &size)) {
+                return -1;
+            }
+            c += size;
+            lws = NULL;
+        } else if (!strncmp(c, "<!--", 4)) {
+            /* Comment - ignore it */
+            c += 4;
+            if (parse_ignore(ctx, c, "-->", &size)) {
+                return -1;
+            }
+            c += size;
+            lws = NULL;
+        } else if (strncmp(c, "<![CDATA[", 9) && (*c == '<')) {
+            /* child element, leading white spaces were only formatting */
+            *len = c - data;
+            return 1;
+        } else if (is_xmlws(*c)) {
+            lws = c;
+            ign_xmlws(c);
+        } else {
+            /* text content (including CDSect), with the leading white spaces */
+            if (lws) {
+                c = lws;
+            }
+            *text = parse_text(ctx, c, '<', &size);
+            if (!*text && !size) {
+                return -1;
+            }
+            *len = (c + size) - data;
+            return 2;
+        }
+    }
+
+    LOGVAL(ctx, LYE_XML_MISS, LY_VLOG_XML, elem, "closing element tag", elem->name);
+    return -1;
+}
+
+/* logs directly */
+struct lyxml_elem *
+lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int options)
+{
+    struct lyxml_elem *elem;
+    char *prefix = NULL;
+    unsigned int size;
+    int closed;
+
+    elem = lyxml_parse_elem_start(ctx, data, len, parent, &prefix, &closed);
+    if (!elem) {
         return NULL;
     }
 
-repeat:
-    /* process document */
+    if (!closed) {
+        if (lyxml_parse_elem_content(ctx, data + *len, &size, elem, prefix, options)) {
+            *len = 0;
+            lyxml_free(ctx, elem);
+            free(prefix);
+            return NULL;
+        }
+        *len += size;
+    }
+
+    free(prefix);
+    return elem;
+}
+
+/* logs directly */
+int
+lyxml_parse_misc(struct ly_ctx *ctx, const char *data, unsigned int *len)
+{
+    const char *c = data;
+    unsigned int size;
+
+    *len = 0;
+
     while (1) {
         if (!*c) {
             /* eof */
-            return first;
+            *len = c - data;
+            return 0;
         } else if (is_xmlws(*c)) {
             /* skip whitespaces */
             ign_xmlws(c);
         } else if (!strncmp(c, "<?", 2)) {
             /* XMLDecl or PI - ignore it */
             c += 2;
-            if (parse_ignore(ctx, c, "?>", &len)) {
-                goto error;
+            if (parse_ignore(ctx, c, "?>", &size)) {
+                return -1;
             }
-            c += len;
+            c += size;
         } else if (!strncmp(c, "<!--", 4)) {
             /* Comment - ignore it */
             c += 2;
-            if (parse_ignore(ctx, c, "-->", &len)) {
-                goto error;
+            if (parse_ignore(ctx, c, "-->", &size)) {
+                return -1;
             }
-            c += len;
+            c += size;
         } else if (!strncmp(c, "<!", 2)) {
             /* DOCTYPE */
             /* TODO - standalone ignore counting < and > */
             LOGERR(ctx, LY_EINVAL, "DOCTYPE not supported in XML documents.");
-            goto error;
+            return -1;
         } else if (*c == '<') {
             /* element - process it in next loop to strictly follow XML
              * format
              */
-            break;
+            *len = c - data;
+            return 1;
         } else {
             LOGVAL(ctx, LYE_XML_INCHAR, LY_VLOG_NONE, NULL, c);
-            goto error;
+            return -1;
         }
     }
+}
+
+/* logs directly */
+API struct lyxml_elem *
+lyxml_parse_mem(struct ly_ctx *ctx, const char *data, int options)
+{
+    FUN_IN;
+
+    const char *c = data;
+    unsigned int len;
+    int r;
+    struct lyxml_elem *root, *first = NULL, *next;
+
+    if (!ctx) {
+        LOGARG;
+        return NULL;
+    }
+
+repeat:
+    /* process document */
+    r = lyxml_parse_misc(ctx, c, &len);
+    if (r == -1) {
+        goto error;
+    } else if (!r) {
+        /* eof */
+        return first;
+    }
+    c += len;
 
     root = lyxml_parse_elem(ctx, c, &len, NULL, options);
     if (!root) {
@@ -1365,27 +1516,39 @@ error:
 int
 lyxml_dump_text(struct lyout *out, const char *text, LYXML_DATA_TYPE type)
 {
-    unsigned int i, n;
+    size_t i, len, span;
+    unsigned int n;
 
     if (!text) {
         return 0;
     }
 
-    for (i = n = 0; text[i]; i++) {
+    len = strlen(text);
+    for (i = n = 0; i < len; i++) {
+        /* write the characters not needing escaping at once */
+        span = strncspn(&text[i], (type == LYXML_DATA_ATTR) ? "&<>\"" : "&<>", 0, len - i);
+        if (span) {
+            n += ly_write(out, &text[i], span);
+            i += span;
+            if (i == len) {
+                break;
+            }
+        }
+
         switch (text[i]) {
         case '&':
-            n += ly_print(out, "&amp;");
+            n += ly_write(out, "&amp;", 5);
             break;
         case '<':
-            n += ly_print(out, "&lt;");
+            n += ly_write(out, "&lt;", 4);
             break;
         case '>':
             /* not needed, just for readability */
-            n += ly_print(out, "&gt;");
+            n += ly_write(out, "&gt;", 4);
             break;
         case '"':
             if (type == LYXML_DATA_ATTR) {
-                n += ly_print(out, "&quot;");
+                n += ly_write(out, "&quot;", 6);
                 break;
             }
             /* falls through */
@@ -1461,7 +1624,7 @@ dump_elem(struct lyout *out, const struct lyxml_elem *e, int level, int options,
         size += ly_print(out, "/>%s", delim);
         return size;
     } else if (options & LYXML_PRINT_OPEN) {
-        ly_print(out, ">");
+        ly_write(out, ">", 1);
         return ++size;
     } else if (options & LYXML_PRINT_ATTRS) {
         return size;
@@ -1471,7 +1634,7 @@ dump_elem(struct lyout *out, const struct lyxml_elem *e, int level, int options,
         size += ly_print(out, "/>%s", delim);
         return size;
     } else if (e->content && e->content[0]) {
-        ly_print(out, ">");
+        ly_write(out, ">", 1);
         size++;
 
         size += lyxml_dump_text(out, e->content, LYXML_DATA_ELEM);
@@ -1557,6 +1720,7 @@ lyxml_print_fd(int fd, const struct lyxml_elem *elem, int options)
     FUN_IN;
 
     struct lyout out;
+    int r;
 
     if (fd < 0 || !elem) {
         return 0;
@@ -1568,10 +1732,15 @@ lyxml_print_fd(int fd, const struct lyxml_elem *elem, int options)
     out.method.fd = fd;
 
     if (options & LYXML_PRINT_SIBLINGS) {
-        return dump_siblings(&out, elem, options);
+        r = dump_siblings(&out, elem, options);
     } else {
-        return dump_elem(&out, elem, 0, options, 1);
+        r = dump_elem(&out, elem, 0, options, 1);
+    }
+
+    if (ly_print_flush(&out)) {
+        r = 0;
     }
+    return r;
 }
 
 API int
@@ -1606,6 +1775,7 @@ lyxml_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), v
     FUN_IN;
 
     struct lyout out;
+    int r;
 
     if (!writeclb || !elem) {
         return 0;
@@ -1618,8 +1788,13 @@ lyxml_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), v
     out.method.clb.arg = arg;
 
     if (options & LYXML_PRINT_SIBLINGS) {
-        return dump_siblings(&out, elem, options);
+        r = dump_siblings(&out, elem, options);
     } else {
-        return dump_elem(&out, elem, 0, options, 1);
+        r = dump_elem(&out, elem, 0, options, 1);
+    }
+
+    if (ly_print_flush(&out)) {
+        r = 0;
     }
+    return r;
 }
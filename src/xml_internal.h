@@ -128,6 +128,80 @@ void lyxml_unlink_elem(struct ly_ctx *ctx, struct lyxml_elem *elem, int copy_ns)
  */
 int lyxml_getutf8(struct ly_ctx *ctx, const char *buf, unsigned int *read);
 
+/*
+ * Parser
+ */
+
+/**
+ * @brief Parse the whole element (including its subtree) starting with '<'.
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Input data, pointing to the element's start tag.
+ * @param[out] len Number of processed bytes.
+ * @param[in] parent Parent element where to add the new element as the last child, if any.
+ * @param[in] options Parser options, see @ref xmlreadoptions.
+ * @return Parsed element, NULL on error.
+ */
+struct lyxml_elem *lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent,
+                                    int options);
+
+/**
+ * @brief Parse only the start tag (or the empty-element tag) of an element including its attributes
+ * and namespace definitions. The element's namespace and the attribute namespaces are resolved.
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Input data, pointing to the element's start tag.
+ * @param[out] len Number of processed bytes.
+ * @param[in] parent Parent element where to add the new element as the last child, if any.
+ * @param[out] prefix Element's prefix needed to check the end tag, the caller is supposed to free it.
+ * @param[out] closed Set if the element was an empty-element tag so there is no content to be parsed.
+ * @return Element with no content, NULL on error.
+ */
+struct lyxml_elem *lyxml_parse_elem_start(struct ly_ctx *ctx, const char *data, unsigned int *len,
+                                          struct lyxml_elem *parent, char **prefix, int *closed);
+
+/**
+ * @brief Parse the content of an element following its start tag, including the end tag.
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Input data, pointing right after the element's start tag.
+ * @param[out] len Number of processed bytes.
+ * @param[in] elem Element returned by lyxml_parse_elem_start().
+ * @param[in] prefix Element's prefix returned by lyxml_parse_elem_start().
+ * @param[in] options Parser options, see @ref xmlreadoptions.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+int lyxml_parse_elem_content(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem,
+                             const char *prefix, int options);
+
+/**
+ * @brief Read the next item of an element content without building the subtree, so the caller can
+ * process the element children one by one directly from the input.
+ *
+ * Comments, PIs and formatting white spaces are skipped.
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Input data inside the element's content.
+ * @param[out] len Number of processed bytes, the start tag of a child element is not processed.
+ * @param[in] elem Element returned by lyxml_parse_elem_start().
+ * @param[in] prefix Element's prefix returned by lyxml_parse_elem_start().
+ * @param[out] text Text content (including leading white spaces), the caller is supposed to free it.
+ * @return 1 if a child element start tag follows, 2 if a text content was read, 0 if the end tag was read,
+ * -1 on error.
+ */
+int lyxml_parse_elem_next(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem,
+                          const char *prefix, char **text);
+
+/**
+ * @brief Skip white spaces, comments and PIs outside of the document elements.
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Input data.
+ * @param[out] len Number of processed bytes.
+ * @return 1 if an element start tag follows, 0 on the end of the input, -1 on error.
+ */
+int lyxml_parse_misc(struct ly_ctx *ctx, const char *data, unsigned int *len);
+
 /**
  * @brief Types of the XML data
  */
@@ -44,6 +44,7 @@
 static const struct lyd_node *moveto_get_root(const struct lyd_node *cur_node, int options,
                                               enum lyxp_node_type *root_type);
 static int reparse_or_expr(struct ly_ctx *ctx, struct lyxp_expr *exp, uint16_t *exp_idx);
+static int node_load_children(const struct lyd_node *node);
 static int set_snode_insert_node(struct lyxp_set *set, const struct lys_node *node, enum lyxp_node_type node_type);
 static int eval_expr_select(struct lyxp_expr *exp, uint16_t *exp_idx, enum lyxp_expr_type etype, struct lyd_node *cur_node,
                             struct lys_module *local_mod, struct lyxp_set *set, int options);
@@ -385,6 +386,9 @@ cast_string_recursive(struct lyd_node *node, struct lys_module *local_mod, int f
         strcpy(*str + (*used - 1), "\n");
         ++(*used);
 
+        if (node_load_children(node)) {
+            return -1;
+        }
         LY_TREE_FOR(node->child, child) {
             if (cast_string_recursive(child, local_mod, 0, root_type, indent + 1, str, used, size)) {
                 return -1;
@@ -1233,118 +1237,191 @@ retry:
     return ret_ctx;
 }
 
+/* position of a data node in the document order, see get_node_pos() */
+struct lyxp_doc_pos {
+    const struct lyd_node *node;
+    uint32_t pos;
+};
+
+/*
+ * Positions of the data nodes of the tree being evaluated, numbered lazily in DFS order as they are needed
+ * and kept while the index is held (see lyxp_doc_pos_hold()), one index for each root type.
+ */
+static THREAD_LOCAL struct {
+    const struct lyd_node *root;    /* first top-level sibling of the numbered tree */
+    struct hash_table *ht;          /* positions of all the numbered nodes */
+    const struct lyd_node *last;    /* last numbered (or skipped) node, NULL if there is none */
+    uint32_t last_pos;              /* last assigned position */
+} doc_pos[2];
+
+static THREAD_LOCAL uint32_t doc_pos_held;
+
+/* number of times the positions were invalidated by parsing new nodes, see node_load_children() */
+static THREAD_LOCAL uint32_t doc_pos_invalid;
+
+static int
+doc_pos_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    return ((struct lyxp_doc_pos *)val1_p)->node == ((struct lyxp_doc_pos *)val2_p)->node;
+}
+
+static uint32_t
+doc_pos_hash(const struct lyd_node *node)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&node, sizeof node);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+void
+lyxp_doc_pos_hold(void)
+{
+    ++doc_pos_held;
+}
+
+void
+lyxp_doc_pos_release(void)
+{
+    int i;
+
+    assert(doc_pos_held);
+    if (--doc_pos_held) {
+        return;
+    }
+
+    for (i = 0; i < 2; ++i) {
+        lyht_free(doc_pos[i].ht);
+        memset(&doc_pos[i], 0, sizeof doc_pos[i]);
+    }
+}
+
+/**
+ * @brief Parse the children of a node parsed lazily from LYB data (#LYD_OPT_LYB_LAZY) before accessing them.
+ *
+ * The positions of all the nodes following the new ones change so the numbering is started over and
+ * the evaluation that may have used the previous positions is repeated (see lyxp_eval_expr()).
+ *
+ * @param[in] node Node whose children are to be accessed.
+ * @return EXIT_SUCCESS on success, -1 on error.
+ */
+static int
+node_load_children(const struct lyd_node *node)
+{
+    int i;
+
+    if (!node->lazy) {
+        return EXIT_SUCCESS;
+    }
+
+    for (i = 0; i < 2; ++i) {
+        if (doc_pos[i].last) {
+            lyht_free(doc_pos[i].ht);
+            memset(&doc_pos[i], 0, sizeof doc_pos[i]);
+            ++doc_pos_invalid;
+        }
+    }
+
+    if (lyb_lazy_load((struct lyd_node *)node)) {
+        return -1;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Get the node following \p elem in DFS, the order positions are assigned in.
+ *
+ * @param[in] elem Current node.
+ * @param[in] root_type Type of the XPath root, state subtrees are skipped for #LYXP_NODE_ROOT_CONFIG.
+ *
+ * @return Next node, NULL if \p elem was the last one.
+ */
+static const struct lyd_node *
+doc_pos_next(const struct lyd_node *elem, enum lyxp_node_type root_type)
+{
+    /* children first, except for lyd_node_leaf, lyd_node_leaflist, and skipped state nodes */
+    if (((root_type != LYXP_NODE_ROOT_CONFIG) || !(elem->schema->flags & LYS_CONFIG_R))
+            && !(elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) && elem->child) {
+        return elem->child;
+    }
+
+    /* then siblings, go back through parents if there are none */
+    for (; elem; elem = elem->parent) {
+        if (elem->next) {
+            return elem->next;
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Get unique \p node position in the data.
  *
+ * Positions are numbered in DFS from \p root only as far as needed and remembered in the document position
+ * index, so every node is visited at most once while the index is held.
+ *
  * @param[in] node Node to find.
  * @param[in] node_type Node type of \p node.
  * @param[in] root Root node.
  * @param[in] root_type Type of the XPath \p root node.
- * @param[in] prev Node that we think is before \p node in DFS from \p root. Can optionally
- * be used to increase efficiency and start the DFS from this node.
- * @param[in] prev_pos Node \p prev position. Optional, but must be set if \p prev is set.
  *
  * @return Node position.
  */
 static uint32_t
 get_node_pos(const struct lyd_node *node, enum lyxp_node_type node_type, const struct lyd_node *root,
-             enum lyxp_node_type root_type, const struct lyd_node **prev, uint32_t *prev_pos)
+             enum lyxp_node_type root_type)
 {
-    const struct lyd_node *next, *elem, *top_sibling;
-    uint32_t pos = 1;
+    struct lyxp_doc_pos rec, *match;
+    const struct lyd_node *elem;
+    int idx;
 
-    assert(prev && prev_pos && !root->prev->next);
+    assert(!root->prev->next);
 
     if ((node_type == LYXP_NODE_ROOT) || (node_type == LYXP_NODE_ROOT_CONFIG)) {
         return 0;
     }
 
-    if (*prev) {
-        /* start from the previous element instead from the root */
-        elem = next = *prev;
-        pos = *prev_pos;
-        for (top_sibling = elem; top_sibling->parent; top_sibling = top_sibling->parent);
-        goto dfs_search;
-    }
-
-    LY_TREE_FOR(root, top_sibling) {
-        /* TREE DFS */
-        LY_TREE_DFS_BEGIN(top_sibling, next, elem) {
-dfs_search:
-            if ((root_type == LYXP_NODE_ROOT_CONFIG) && (elem->schema->flags & LYS_CONFIG_R)) {
-                goto skip_children;
-            }
-
-            if (elem == node) {
-                break;
-            }
-            ++pos;
-
-            /* TREE DFS END */
-            /* select element for the next run - children first,
-             * child exception for lyd_node_leaf and lyd_node_leaflist, but not the root */
-            if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
-                next = NULL;
-            } else {
-                next = elem->child;
-            }
-            if (!next) {
-skip_children:
-                /* no children */
-                if (elem == top_sibling) {
-                    /* we are done, root has no children */
-                    elem = NULL;
-                    break;
-                }
-                /* try siblings */
-                next = elem->next;
-            }
-            while (!next) {
-                /* no siblings, go back through parents */
-                if (elem->parent == top_sibling->parent) {
-                    /* we are done, no next element to process */
-                    elem = NULL;
-                    break;
-                }
-                /* parent is already processed, go to its sibling */
-                elem = elem->parent;
-                next = elem->next;
-            }
+    idx = (root_type == LYXP_NODE_ROOT_CONFIG);
+    if (doc_pos[idx].root != root) {
+        /* another tree, start from the beginning */
+        lyht_free(doc_pos[idx].ht);
+        memset(&doc_pos[idx], 0, sizeof doc_pos[idx]);
+        doc_pos[idx].ht = lyht_new(256, sizeof rec, doc_pos_equal, NULL, 1);
+        LY_CHECK_ERR_RETURN(!doc_pos[idx].ht, LOGMEM(node->schema->module->ctx), 0);
+        doc_pos[idx].root = root;
+    } else {
+        /* already numbered */
+        rec.node = node;
+        if (!lyht_find(doc_pos[idx].ht, &rec, doc_pos_hash(node), (void **)&match)) {
+            return match->pos;
         }
+    }
 
-        /* node found */
-        if (elem) {
-            break;
+    /* continue the DFS until the node is reached */
+    elem = doc_pos[idx].last ? doc_pos_next(doc_pos[idx].last, root_type) : root;
+    for (; elem; elem = doc_pos_next(elem, root_type)) {
+        doc_pos[idx].last = elem;
+        if ((root_type == LYXP_NODE_ROOT_CONFIG) && (elem->schema->flags & LYS_CONFIG_R)) {
+            /* not accessible, no position */
+            continue;
         }
-    }
 
-    if (!elem) {
-        if (!(*prev)) {
-            /* we went from root and failed to find it, cannot be */
+        rec.node = elem;
+        rec.pos = ++doc_pos[idx].last_pos;
+        if (lyht_insert(doc_pos[idx].ht, &rec, doc_pos_hash(elem), NULL)) {
             LOGINT(node->schema->module->ctx);
             return 0;
-        } else {
-            /* node is before prev, we assumed otherwise :( */
-            //LOGDBG(LY_LDGXPATH, "get_node_pos optimalization fail.");
-
-            *prev = NULL;
-            *prev_pos = 0;
+        }
 
-            elem = next = top_sibling = root;
-            pos = 1;
-            goto dfs_search;
+        if (elem == node) {
+            return rec.pos;
         }
     }
 
-    /*if (*prev) {
-        LOGDBG(LY_LDGXPATH, "get_node_pos optimalization success.");
-    }*/
-
-    /* remember the last found node for next time */
-    *prev = node;
-    *prev_pos = pos;
-
-    return pos;
+    /* we went through the whole tree and failed to find it, cannot be */
+    LOGINT(node->schema->module->ctx);
+    return 0;
 }
 
 /**
@@ -1359,8 +1436,12 @@ skip_children:
 static int
 set_assign_pos(struct lyxp_set *set, const struct lyd_node *root, enum lyxp_node_type root_type)
 {
-    const struct lyd_node *prev = NULL, *tmp_node;
-    uint32_t i, tmp_pos = 0;
+    const struct lyd_node *tmp_node;
+    uint32_t i;
+    int ret = 0;
+
+    /* the positions are kept at least for this set */
+    lyxp_doc_pos_hold();
 
     for (i = 0; i < set->used; ++i) {
         if (!set->val.nodes[i].pos) {
@@ -1370,7 +1451,8 @@ set_assign_pos(struct lyxp_set *set, const struct lyd_node *root, enum lyxp_node
                 tmp_node = lyd_attr_parent(root, set->val.attrs[i].attr);
                 if (!tmp_node) {
                     LOGINT(root->schema->module->ctx);
-                    return -1;
+                    ret = -1;
+                    goto cleanup;
                 }
                 /* fallthrough */
             case LYXP_NODE_ELEM:
@@ -1378,7 +1460,7 @@ set_assign_pos(struct lyxp_set *set, const struct lyd_node *root, enum lyxp_node
                 if (!tmp_node) {
                     tmp_node = set->val.nodes[i].node;
                 }
-                set->val.nodes[i].pos = get_node_pos(tmp_node, set->val.nodes[i].type, root, root_type, &prev, &tmp_pos);
+                set->val.nodes[i].pos = get_node_pos(tmp_node, set->val.nodes[i].type, root, root_type);
                 break;
             default:
                 /* all roots have position 0 */
@@ -1387,7 +1469,9 @@ set_assign_pos(struct lyxp_set *set, const struct lyd_node *root, enum lyxp_node
         }
     }
 
-    return 0;
+cleanup:
+    lyxp_doc_pos_release();
+    return ret;
 }
 
 /**
@@ -3661,7 +3745,7 @@ xpath_deref(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_node
             if (leaf->value_flags & LY_VALUE_UNRES) {
                 /* this means that the target may exist except it cannot be stored in the value */
                 if (sleaf->type.base == LY_TYPE_LEAFREF) {
-                    resolve_leafref(leaf, sleaf->type.info.lref.path, -1, &target);
+                    resolve_leafref(leaf, &sleaf->type, -1, &target);
                 } else {
                     resolve_instid((struct lyd_node *)leaf, leaf->value_str, -1, &target);
                 }
@@ -4550,8 +4634,9 @@ xpath_re_match(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_no
                struct lyxp_set *set, int options)
 {
     pcre *precomp;
+    pcre_extra *study;
     struct lys_node_leaf *sleaf;
-    int ret = EXIT_SUCCESS;
+    int ret = EXIT_SUCCESS, cached;
 
     if (options & LYXP_SNODE_ALL) {
         if ((args[0]->type == LYXP_SET_SNODE_SET) && (sleaf = (struct lys_node_leaf *)warn_get_snode_in_ctx(args[0]))) {
@@ -4584,15 +4669,19 @@ xpath_re_match(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_no
         return -1;
     }
 
-    if (lyp_check_pattern(local_mod->ctx, args[1]->val.str, &precomp)) {
+    cached = lyp_pattern_cached(local_mod->ctx, args[1]->val.str, &precomp, &study);
+    if (cached == -1) {
         return -1;
     }
-    if (pcre_exec(precomp, NULL, args[0]->val.str, strlen(args[0]->val.str), 0, 0, NULL, 0)) {
+    if (lyp_exec_pattern(precomp, study, args[0]->val.str)) {
         set_fill_boolean(set, 0);
     } else {
         set_fill_boolean(set, 1);
     }
-    free(precomp);
+    if (cached) {
+        pcre_free(precomp);
+        pcre_free_study(study);
+    }
 
     return EXIT_SUCCESS;
 }
@@ -5647,6 +5736,10 @@ moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname,
         } else if (!(set->val.nodes[i].node->validity & LYD_VAL_INUSE)
                 && !(set->val.nodes[i].node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
 
+            if (node_load_children(set->val.nodes[i].node)) {
+                lydict_remove(ctx, name_dict);
+                return -1;
+            }
             LY_TREE_FOR(set->val.nodes[i].node->child, sub) {
                 ret = moveto_node_check(sub, root_type, name_dict, moveto_mod, options);
                 if (!ret) {
@@ -5674,6 +5767,322 @@ moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname,
     return EXIT_SUCCESS;
 }
 
+#ifdef LY_ENABLED_CACHE
+
+/**
+ * @brief Resolve the module of a NameTest for moveto_node_hash(). Skips the prefix of \p qname.
+ *
+ * @param[in,out] qname Qualified node name.
+ * @param[in,out] qname_len Length of \p qname.
+ * @param[in] cur_node Original context node.
+ *
+ * @return Module of the node, NULL on a wildcard or unknown prefix.
+ */
+static struct lys_module *
+moveto_node_hash_mod(const char **qname, uint16_t *qname_len, struct lyd_node *cur_node)
+{
+    const char *ptr;
+    int pref_len;
+    struct lys_module *mod;
+
+    if ((ptr = strnchr(*qname, ':', *qname_len))) {
+        pref_len = ptr - *qname;
+        mod = moveto_resolve_model(*qname, pref_len, cur_node->schema->module->ctx, NULL, 1, 0);
+        *qname += pref_len + 1;
+        *qname_len -= pref_len + 1;
+    } else {
+        mod = lyd_node_module(cur_node);
+    }
+
+    if ((*qname_len == 1) && ((*qname)[0] == '*')) {
+        return NULL;
+    }
+    return mod;
+}
+
+/**
+ * @brief Check whether a Predicate is a simple equality "[NAME='literal']" or "[.='literal']".
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] exp_idx Position of the Predicate in \p exp.
+ *
+ * @return Index of the literal token, 0 if the Predicate is not such an equality.
+ */
+static uint16_t
+moveto_node_hash_pred(struct lyxp_expr *exp, uint16_t exp_idx)
+{
+    if ((exp->used > exp_idx + 4) && (exp->tokens[exp_idx] == LYXP_TOKEN_BRACK1)
+            && ((exp->tokens[exp_idx + 1] == LYXP_TOKEN_NAMETEST) || (exp->tokens[exp_idx + 1] == LYXP_TOKEN_DOT))
+            && (exp->tokens[exp_idx + 2] == LYXP_TOKEN_OPERATOR_COMP) && (exp->tok_len[exp_idx + 2] == 1)
+            && (exp->expr[exp->expr_pos[exp_idx + 2]] == '=') && (exp->tokens[exp_idx + 3] == LYXP_TOKEN_LITERAL)
+            && (exp->tokens[exp_idx + 4] == LYXP_TOKEN_BRACK2)) {
+        return exp_idx + 3;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the value of a literal as it would be compared with the value of \p snode instances.
+ *
+ * @param[in] snode Leaf or leaf-list schema node.
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] lit Index of the literal token in \p exp.
+ *
+ * @return Value in the dictionary, NULL on error.
+ */
+static const char *
+moveto_node_hash_value(struct lys_node *snode, struct lyxp_expr *exp, uint16_t lit)
+{
+    struct ly_ctx *ctx = snode->module->ctx;
+    enum int_log_opts prev_ilo;
+    const char *str;
+    char *val;
+    int len;
+
+    str = &exp->expr[exp->expr_pos[lit] + 1];
+    len = exp->tok_len[lit] - 2;
+
+    /* canonize the value the same way set_canonize() does, ignore errors */
+    ly_ilo_change(NULL, ILO_IGNORE, &prev_ilo, NULL);
+    val = lyd_make_canonical(snode, str, len);
+    ly_ilo_restore(NULL, prev_ilo, NULL, 0);
+    if (val) {
+        return lydict_insert_zc(ctx, val);
+    }
+
+    return lydict_insert(ctx, len ? str : "", len);
+}
+
+/**
+ * @brief Find the next sibling matching \p target, hash table is not used.
+ *
+ * @param[in] sub First sibling to check.
+ * @param[in] target Dummy node to find.
+ *
+ * @return Matching sibling, NULL if there is none.
+ */
+static struct lyd_node *
+moveto_node_hash_scan(struct lyd_node *sub, struct lyd_node *target)
+{
+    for (; sub; sub = sub->next) {
+        if ((sub->schema == target->schema)
+                && (!(target->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || (lyd_list_equal(target, sub, 0) == 1))) {
+            break;
+        }
+    }
+
+    return sub;
+}
+
+/**
+ * @brief Move context \p set to a node using the hash tables of the context nodes. Handles 'NAME' or 'PREFIX:NAME'
+ *        with the following equality predicates on all the keys of a list or on the value of a leaf-list, which
+ *        are satisfied by the same lookup. All the context nodes must be instances of the same container or list.
+ *        Result is LYXP_SET_NODE_SET (or LYXP_SET_EMPTY). Context position aware.
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[in,out] exp_idx Position of the NameTest in \p exp, moved after the processed predicates.
+ * @param[in] cur_node Original context node.
+ * @param[in,out] set Set to use.
+ * @param[in] options Whether to apply data node access restrictions defined for 'when' and 'must' evaluation.
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when, -1 on error,
+ *         2 if hashes cannot be used and nothing was done.
+ */
+static int
+moveto_node_hash(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_node, struct lyxp_set *set, int options)
+{
+    struct lys_node *parent_snode, *snode = NULL;
+    struct lys_node_list *slist;
+    struct lys_module *moveto_mod, *key_mod;
+    struct lyd_node dummy_node, *target = NULL, *parent, *sub, **match_p;
+    struct lyd_node_leaf_list *dummy_leaves = NULL;
+    struct ly_ctx *ctx;
+    enum lyxp_node_type root_type;
+    const char *qname;
+    uint16_t qname_len, idx, lit;
+    uint32_t i;
+    int j, k, keys_size = 0, replaced, scan, ret = 2;
+
+    if (!set->used) {
+        return 2;
+    }
+
+    /* all the context nodes must be instances of the same schema node with children */
+    parent_snode = set->val.nodes[0].node->schema;
+    if (!(parent_snode->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+        return 2;
+    }
+    for (i = 0; i < set->used; ++i) {
+        if ((set->val.nodes[i].type != LYXP_NODE_ELEM) || (set->val.nodes[i].node->schema != parent_snode)) {
+            return 2;
+        }
+    }
+
+    /* find the schema node of the children */
+    qname = &exp->expr[exp->expr_pos[*exp_idx]];
+    qname_len = exp->tok_len[*exp_idx];
+    if (!(moveto_mod = moveto_node_hash_mod(&qname, &qname_len, cur_node))) {
+        return 2;
+    }
+    while ((snode = (struct lys_node *)lys_getnext(snode, parent_snode, NULL, LYS_GETNEXT_NOSTATECHECK))) {
+        if ((lys_node_module(snode) == moveto_mod) && !strncmp(snode->name, qname, qname_len) && !snode->name[qname_len]) {
+            break;
+        }
+    }
+    if (!snode) {
+        return 2;
+    }
+    ctx = snode->module->ctx;
+
+    /* create the node to look for */
+    memset(&dummy_node, 0, sizeof dummy_node);
+    idx = *exp_idx + 1;
+    switch (snode->nodetype) {
+    case LYS_CONTAINER:
+    case LYS_LEAF:
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        /* schema is enough */
+        target = &dummy_node;
+        break;
+    case LYS_LEAFLIST:
+        if (!(lit = moveto_node_hash_pred(exp, idx)) || (exp->tokens[idx + 1] != LYXP_TOKEN_DOT)) {
+            return 2;
+        }
+        keys_size = 1;
+        dummy_leaves = calloc(1, sizeof *dummy_leaves);
+        LY_CHECK_ERR_RETURN(!dummy_leaves, LOGMEM(ctx), -1);
+        dummy_leaves[0].schema = snode;
+        dummy_leaves[0].prev = (struct lyd_node *)&dummy_leaves[0];
+        dummy_leaves[0].value_str = moveto_node_hash_value(snode, exp, lit);
+        LY_CHECK_ERR_GOTO(!dummy_leaves[0].value_str, ret = -1, cleanup);
+        idx += 5;
+
+        target = (struct lyd_node *)&dummy_leaves[0];
+        break;
+    case LYS_LIST:
+        slist = (struct lys_node_list *)snode;
+        if (!slist->keys_size) {
+            return 2;
+        }
+        keys_size = slist->keys_size;
+        dummy_leaves = calloc(keys_size, sizeof *dummy_leaves);
+        LY_CHECK_ERR_RETURN(!dummy_leaves, LOGMEM(ctx), -1);
+
+        /* every key must be compared in its own predicate, in any order */
+        for (j = 0; j < keys_size; ++j, idx += 5) {
+            if (!(lit = moveto_node_hash_pred(exp, idx)) || (exp->tokens[idx + 1] != LYXP_TOKEN_NAMETEST)) {
+                goto cleanup;
+            }
+            qname = &exp->expr[exp->expr_pos[idx + 1]];
+            qname_len = exp->tok_len[idx + 1];
+            if (!(key_mod = moveto_node_hash_mod(&qname, &qname_len, cur_node))) {
+                goto cleanup;
+            }
+            for (k = 0; k < keys_size; ++k) {
+                if ((lys_node_module((struct lys_node *)slist->keys[k]) == key_mod)
+                        && !strncmp(slist->keys[k]->name, qname, qname_len) && !slist->keys[k]->name[qname_len]) {
+                    break;
+                }
+            }
+            if ((k == keys_size) || dummy_leaves[k].schema) {
+                /* not a key or a repeated one */
+                goto cleanup;
+            }
+
+            dummy_leaves[k].schema = (struct lys_node *)slist->keys[k];
+            dummy_leaves[k].value_str = moveto_node_hash_value(dummy_leaves[k].schema, exp, lit);
+            LY_CHECK_ERR_GOTO(!dummy_leaves[k].value_str, ret = -1, cleanup);
+        }
+
+        /* connect the keys in the schema order */
+        for (k = 0; k < keys_size; ++k) {
+            dummy_leaves[k].parent = &dummy_node;
+            dummy_leaves[k].next = (k + 1 < keys_size) ? (struct lyd_node *)&dummy_leaves[k + 1] : NULL;
+            dummy_leaves[k].prev = (struct lyd_node *)&dummy_leaves[k ? k - 1 : keys_size - 1];
+        }
+        dummy_node.child = (struct lyd_node *)&dummy_leaves[0];
+
+        target = &dummy_node;
+        break;
+    default:
+        return 2;
+    }
+    if (target == &dummy_node) {
+        dummy_node.schema = snode;
+        dummy_node.prev = &dummy_node;
+    }
+    lyd_hash(target);
+
+    LOGDBG(LY_LDGXPATH, "%-27s %s %s[%u] and %d predicate(s) using hashes", __func__, "parsed",
+           print_token(exp->tokens[*exp_idx]), exp->expr_pos[*exp_idx], (idx - *exp_idx - 1) / 5);
+
+    moveto_get_root(cur_node, options, &root_type);
+
+    for (i = 0; i < set->used; ) {
+        replaced = 0;
+        parent = set->val.nodes[i].node;
+
+        /* skip dummy nodes */
+        if (!(parent->validity & LYD_VAL_INUSE)) {
+            if (node_load_children(parent)) {
+                ret = -1;
+                goto cleanup;
+            }
+
+            scan = 1;
+            if (parent->ht) {
+                sub = lyht_find(parent->ht, &target, target->hash, (void **)&match_p) ? NULL : *match_p;
+                if (!sub || lyht_find_next(parent->ht, &sub, sub->hash, (void **)&match_p)) {
+                    /* a single instance or none */
+                    scan = 0;
+                } else {
+                    /* several instances (state leaf-list or non-validated data), keep them in the data order */
+                    sub = moveto_node_hash_scan(parent->child, target);
+                }
+            } else {
+                sub = moveto_node_hash_scan(parent->child, target);
+            }
+
+            while (sub) {
+                ret = moveto_node_check(sub, root_type, snode->name, moveto_mod, options);
+                if (!ret) {
+                    if (!replaced) {
+                        set_replace_node(set, sub, 0, LYXP_NODE_ELEM, i);
+                        replaced = 1;
+                    } else {
+                        set_insert_node(set, sub, 0, LYXP_NODE_ELEM, i);
+                    }
+                    ++i;
+                } else if (ret == EXIT_FAILURE) {
+                    goto cleanup;
+                }
+
+                sub = scan ? moveto_node_hash_scan(sub->next, target) : NULL;
+            }
+        }
+
+        if (!replaced) {
+            /* no match */
+            set_remove_node(set, i);
+        }
+    }
+
+    *exp_idx = idx;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    for (k = 0; k < keys_size; ++k) {
+        lydict_remove(ctx, dummy_leaves[k].value_str);
+    }
+    free(dummy_leaves);
+    return ret;
+}
+
+#endif
+
 static int
 moveto_snode(struct lyxp_set *set, struct lys_node *cur_node, const char *qname, uint16_t qname_len, int options)
 {
@@ -5909,6 +6318,10 @@ moveto_node_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
             if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
                 next = NULL;
             } else {
+                if (node_load_children(elem)) {
+                    set_free_content(&ret_set);
+                    return -1;
+                }
                 next = elem->child;
             }
             if (!next) {
@@ -6359,6 +6772,9 @@ moveto_self_add_children_r(const struct lyd_node *parent, uint32_t parent_pos, e
     case LYXP_NODE_ELEM:
         /* add all the children ... */
         if (!(parent->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
+            if (node_load_children(parent)) {
+                return -1;
+            }
             LY_TREE_FOR(parent->child, sub) {
                 /* context check */
                 if ((root_type == LYXP_NODE_ROOT_CONFIG) && (sub->schema->flags & LYS_CONFIG_R)) {
@@ -7470,7 +7886,17 @@ step:
             /* fall through */
         case LYXP_TOKEN_NAMETEST:
         case LYXP_TOKEN_NODETYPE:
-            ret = eval_node_test(exp, exp_idx, cur_node, local_mod, attr_axis, all_desc, set, options);
+            ret = 2;
+#ifdef LY_ENABLED_CACHE
+            if (!attr_axis && !all_desc && set && (set->type == LYXP_SET_NODE_SET)
+                    && (exp->tokens[*exp_idx] == LYXP_TOKEN_NAMETEST)) {
+                /* try to find the children (and evaluate key predicates) using hashes */
+                ret = moveto_node_hash(exp, exp_idx, cur_node, set, options);
+            }
+#endif
+            if (ret == 2) {
+                ret = eval_node_test(exp, exp_idx, cur_node, local_mod, attr_axis, all_desc, set, options);
+            }
             if (ret) {
                 return ret;
             }
@@ -8662,58 +9088,173 @@ eval_expr_select(struct lyxp_expr *exp, uint16_t *exp_idx, enum lyxp_expr_type e
     return ret;
 }
 
-int
-lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
-          const struct lys_module *local_mod, struct lyxp_set *set, int options)
+/**
+ * @brief Parse and reparse an XPath expression so that it can be evaluated.
+ *        Logs directly.
+ *
+ * @param[in] ctx Context for errors.
+ * @param[in] expr XPath expression to compile.
+ *
+ * @return Compiled expression, NULL on error.
+ */
+static struct lyxp_expr *
+lyxp_expr_compile(struct ly_ctx *ctx, const char *expr)
 {
-    struct ly_ctx *ctx;
     struct lyxp_expr *exp;
     uint16_t exp_idx = 0;
-    int rc = -1;
-
-    if (!expr || !local_mod || !set) {
-        LOGARG;
-        return EXIT_FAILURE;
-    }
-
-    ctx = local_mod->ctx;
 
     exp = lyxp_parse_expr(ctx, expr);
     if (!exp) {
-        rc = -1;
-        goto finish;
+        return NULL;
     }
 
-    rc = reparse_or_expr(ctx, exp, &exp_idx);
-    if (rc) {
-        goto finish;
+    if (reparse_or_expr(ctx, exp, &exp_idx)) {
+        goto error;
     } else if (exp->used > exp_idx) {
         LOGVAL(ctx, LYE_XPATH_INTOK, LY_VLOG_NONE, NULL, "Unknown", &exp->expr[exp->expr_pos[exp_idx]]);
         LOGVAL(ctx, LYE_SPEC, LY_VLOG_NONE, NULL, "Unparsed characters \"%s\" left at the end of an XPath expression.",
                &exp->expr[exp->expr_pos[exp_idx]]);
-        rc = -1;
-        goto finish;
+        goto error;
     }
 
     print_expr_struct_debug(exp);
+    return exp;
 
-    exp_idx = 0;
-    memset(set, 0, sizeof *set);
-    set->type = LYXP_SET_EMPTY;
-    if (cur_node) {
-        set_insert_node(set, (struct lyd_node *)cur_node, 0, cur_node_type, 0);
+error:
+    lyxp_expr_free(exp);
+    return NULL;
+}
+
+static int
+lyxp_expr_cache_equal(void *val1_p, void *val2_p, int UNUSED(mod), void *UNUSED(cb_data))
+{
+    struct lyxp_expr *exp1 = *(struct lyxp_expr **)val1_p, *exp2 = *(struct lyxp_expr **)val2_p;
+
+    return !strcmp(exp1->expr, exp2->expr);
+}
+
+struct lyxp_expr *
+lyxp_expr_cached(struct ly_ctx *ctx, const char *expr)
+{
+    struct lyxp_expr key, *exp_p = &key, **match;
+    uint32_t hash;
+
+    key.expr = (char *)expr;
+    hash = dict_hash_multi(0, expr, strlen(expr));
+    hash = dict_hash_multi(hash, NULL, 0);
+
+    pthread_mutex_lock(&ctx->xpath_cache_lock);
+
+    if (ctx->xpath_cache && (ctx->xpath_cache_set_id != ctx->models.module_set_id)) {
+        /* the context changed, drop all the expressions compiled so far */
+        lyxp_expr_cache_free(ctx);
+    }
+    if (!ctx->xpath_cache) {
+        ctx->xpath_cache = lyht_new(64, sizeof exp_p, lyxp_expr_cache_equal, NULL, 1);
+        LY_CHECK_ERR_GOTO(!ctx->xpath_cache, LOGMEM(ctx); exp_p = NULL, cleanup);
+        ctx->xpath_cache_set_id = ctx->models.module_set_id;
+    }
+
+    if (!lyht_find(ctx->xpath_cache, &exp_p, hash, (void **)&match)) {
+        /* compiled before */
+        exp_p = *match;
+        goto cleanup;
+    }
+
+    exp_p = lyxp_expr_compile(ctx, expr);
+    if (exp_p && lyht_insert(ctx->xpath_cache, &exp_p, hash, NULL)) {
+        LOGINT(ctx);
+        lyxp_expr_free(exp_p);
+        exp_p = NULL;
     }
 
-    rc = eval_expr_select(exp, &exp_idx, 0, (struct lyd_node *)cur_node, (struct lys_module *)local_mod, set, options);
+cleanup:
+    pthread_mutex_unlock(&ctx->xpath_cache_lock);
+    return exp_p;
+}
+
+void
+lyxp_expr_cache_free(struct ly_ctx *ctx)
+{
+    struct ht_rec *rec;
+    uint32_t i;
+
+    if (!ctx->xpath_cache) {
+        return;
+    }
+
+    for (i = 0; i < ctx->xpath_cache->size; ++i) {
+        rec = lyht_get_rec(ctx->xpath_cache->recs, ctx->xpath_cache->rec_size, i);
+        if (rec->hits > 0) {
+            lyxp_expr_free(*(struct lyxp_expr **)rec->val);
+        }
+    }
+    lyht_free(ctx->xpath_cache);
+    ctx->xpath_cache = NULL;
+}
+
+int
+lyxp_eval_expr(struct lyxp_expr *exp, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+               const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    uint16_t exp_idx;
+    uint32_t invalid;
+    int rc;
+
+    if (!exp || !local_mod || !set) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    lyxp_doc_pos_hold();
+    while (1) {
+        memset(set, 0, sizeof *set);
+        set->type = LYXP_SET_EMPTY;
+        if (cur_node) {
+            set_insert_node(set, (struct lyd_node *)cur_node, 0, cur_node_type, 0);
+        }
+
+        exp_idx = 0;
+        invalid = doc_pos_invalid;
+        rc = eval_expr_select(exp, &exp_idx, 0, (struct lyd_node *)cur_node, (struct lys_module *)local_mod, set, options);
+        if ((rc == -1) || (invalid == doc_pos_invalid)) {
+            break;
+        }
+
+        /* lazy nodes were parsed after some positions were used, evaluate again in the complete tree */
+        set_free_content(set);
+    }
+    lyxp_doc_pos_release();
     if (rc == 2) {
         rc = EXIT_SUCCESS;
     }
     if ((rc == -1) && cur_node) {
-        LOGPATH(ctx, LY_VLOG_LYD, cur_node);
+        LOGPATH(local_mod->ctx, LY_VLOG_LYD, cur_node);
         lyxp_set_cast(set, LYXP_SET_EMPTY, cur_node, local_mod, options);
     }
 
-finish:
+    return rc;
+}
+
+int
+lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+          const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    struct lyxp_expr *exp;
+    int rc;
+
+    if (!expr || !local_mod || !set) {
+        LOGARG;
+        return EXIT_FAILURE;
+    }
+
+    exp = lyxp_expr_compile(local_mod->ctx, expr);
+    if (!exp) {
+        return -1;
+    }
+
+    rc = lyxp_eval_expr(exp, cur_node, cur_node_type, local_mod, set, options);
+
     lyxp_expr_free(exp);
     return rc;
 }
@@ -256,6 +256,56 @@ struct lyxp_set {
 int lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
               const struct lys_module *local_mod, struct lyxp_set *set, int options);
 
+/**
+ * @brief Evaluate an already parsed XPath expression. Otherwise the same as lyxp_eval().
+ *
+ * @param[in] exp Parsed XPath expression, see lyxp_expr_cached(). It is not modified.
+ * @param[in] cur_node Current (context) data node, see lyxp_eval().
+ * @param[in] cur_node_type Current (context) data node type, see lyxp_eval().
+ * @param[in] local_mod Local module relative to the \p exp.
+ * @param[out] set Result set, see lyxp_eval().
+ * @param[in] options Whether to apply some evaluation restrictions, see lyxp_eval().
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when dependency, -1 on error.
+ */
+int lyxp_eval_expr(struct lyxp_expr *exp, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                   const struct lys_module *local_mod, struct lyxp_set *set, int options);
+
+/**
+ * @brief Get the parsed form of an XPath expression from the context cache, parse it
+ * and store it in the cache if not there yet. Logs directly.
+ *
+ * The expressions of must and when conditions are evaluated for every validated data node
+ * so they are parsed only once this way. The cache is flushed whenever the context
+ * modules change.
+ *
+ * @param[in] ctx libyang context with the cache.
+ * @param[in] expr XPath expression to get.
+ *
+ * @return Parsed expression owned by the cache, NULL on error.
+ */
+struct lyxp_expr *lyxp_expr_cached(struct ly_ctx *ctx, const char *expr);
+
+/**
+ * @brief Free all the cached parsed XPath expressions of a context.
+ *
+ * @param[in] ctx libyang context with the cache.
+ */
+void lyxp_expr_cache_free(struct ly_ctx *ctx);
+
+/**
+ * @brief Keep the document positions of data nodes computed by this thread until the matching
+ * lyxp_doc_pos_release() so that node-set sorting does not traverse the tree again for each set.
+ *
+ * Calls can be nested. The data trees must not be modified while the positions are held.
+ */
+void lyxp_doc_pos_hold(void);
+
+/**
+ * @brief Release the document positions held by lyxp_doc_pos_hold(), they are freed by the last release.
+ */
+void lyxp_doc_pos_release(void);
+
 /**
  * @brief Get all the partial XPath nodes (atoms) that are required for \p expr to be evaluated.
  *
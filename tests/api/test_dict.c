@@ -26,9 +26,11 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "tests/config.h"
 #include "libyang.h"
+#include "../../src/context.h"
 
 struct ly_ctx *ctx = NULL;
 
@@ -246,6 +248,59 @@ test_similar_strings(void **state) {
     lydict_remove(ctx, "bbba");
 }
 
+static void *
+dict_thread(void *arg)
+{
+    const char *strs[500];
+    char buf[32];
+    int i, j;
+
+    for (j = 0; j < 20; ++j) {
+        for (i = 0; i < 500; ++i) {
+            /* all the threads share some of the strings */
+            sprintf(buf, "str%d-%d", i, (i % 2) ? 0 : *(int *)arg);
+            strs[i] = lydict_insert(ctx, buf, 0);
+            if (!strs[i] || strcmp(strs[i], buf)) {
+                return (void *)1;
+            }
+        }
+        for (i = 0; i < 500; ++i) {
+            lydict_remove(ctx, strs[i]);
+        }
+    }
+
+    return NULL;
+}
+
+static void
+test_lydict_threads(void **state)
+{
+    (void) state; /* unused */
+    pthread_t threads[8];
+    int ids[8], i;
+    uint32_t used = 0;
+    void *ret;
+
+    for (i = 0; i < LYDICT_SHARDS; ++i) {
+        used += ctx->dict.shards[i].hash_tab->used;
+    }
+
+    for (i = 0; i < 8; ++i) {
+        ids[i] = i + 1;
+        assert_int_equal(pthread_create(&threads[i], NULL, dict_thread, &ids[i]), 0);
+    }
+    for (i = 0; i < 8; ++i) {
+        assert_int_equal(pthread_join(threads[i], &ret), 0);
+        assert_ptr_equal(ret, NULL);
+    }
+
+    /* all the strings were removed */
+    for (i = 0; i < LYDICT_SHARDS; ++i) {
+        used -= ctx->dict.shards[i].hash_tab->used;
+    }
+    assert_int_equal(used, 0);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -253,6 +308,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lydict_insert_zc, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lydict_remove, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_similar_strings, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lydict_threads, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
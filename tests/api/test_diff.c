@@ -15,6 +15,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <cmocka.h>
 
@@ -561,6 +562,144 @@ test_wd1(void **state)
     lyd_free_diff(diff);
 }
 
+static void
+test_move_many(void **state)
+{
+    struct state *st = (*state);
+    const char *schema = "module t {namespace urn:t; prefix t;"
+                         "container c {leaf-list ll {ordered-by user; type uint32;}}"
+                         "list l {key k; ordered-by user; leaf k {type uint32;} leaf v {type string;}}}";
+    const int n = 300;
+    char *xml1, *xml2, *p1, *p2;
+    struct lyd_node *root, *iter, *node;
+    struct lyd_difflist *diff;
+    int i, k, deleted = 0, created = 0, changed = 0, moved = 0;
+    uint32_t ll1[300], ll2[300], l1[300], l2[300];
+    int ll1_count, ll2_count, l1_count, l2_count;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, schema, LYS_IN_YANG), NULL);
+
+    p1 = xml1 = malloc(n * 128);
+    p2 = xml2 = malloc(n * 128);
+    assert_ptr_not_equal(xml1, NULL);
+    assert_ptr_not_equal(xml2, NULL);
+
+    /* the leaf-list is reversed */
+    p1 += sprintf(p1, "<c xmlns=\"urn:t\">");
+    p2 += sprintf(p2, "<c xmlns=\"urn:t\">");
+    for (i = 0; i < n; i++) {
+        p1 += sprintf(p1, "<ll>%d</ll>", i);
+        p2 += sprintf(p2, "<ll>%d</ll>", n - 1 - i);
+    }
+    p1 += sprintf(p1, "</c>");
+    p2 += sprintf(p2, "</c>");
+
+    /* the list is shuffled, some instances are deleted, created and changed */
+    for (i = 0; i < n; i++) {
+        p1 += sprintf(p1, "<l xmlns=\"urn:t\"><k>%d</k><v>a</v></l>", i);
+
+        k = (i * 211) % n;
+        if (!(k % 97)) {
+            continue;
+        }
+        p2 += sprintf(p2, "<l xmlns=\"urn:t\"><k>%d</k><v>%s</v></l>", k, (k % 31) ? "a" : "b");
+        if (i == n / 2) {
+            p2 += sprintf(p2, "<l xmlns=\"urn:t\"><k>%d</k><v>a</v></l>", n);
+        }
+    }
+    p2 += sprintf(p2, "<l xmlns=\"urn:t\"><k>%d</k><v>a</v></l>", n + 1);
+
+    st->first = lyd_parse_mem(st->ctx, xml1, LYD_XML, LYD_OPT_CONFIG);
+    st->second = lyd_parse_mem(st->ctx, xml2, LYD_XML, LYD_OPT_CONFIG);
+    free(xml1);
+    free(xml2);
+    assert_ptr_not_equal(st->first, NULL);
+    assert_ptr_not_equal(st->second, NULL);
+    /* the container is never deleted */
+    root = st->first;
+    assert_string_equal(root->schema->name, "c");
+
+    assert_ptr_not_equal((diff = lyd_diff(st->first, st->second, 0)), NULL);
+    assert_ptr_not_equal(diff->type, NULL);
+
+    /* apply the changes on the first tree */
+    for (i = 0; diff->type[i] != LYD_DIFF_END; i++) {
+        switch (diff->type[i]) {
+        case LYD_DIFF_DELETED:
+            lyd_free(diff->first[i]);
+            deleted++;
+            break;
+        case LYD_DIFF_CHANGED:
+            assert_string_equal(diff->second[i]->schema->name, "v");
+            changed++;
+            break;
+        case LYD_DIFF_MOVEDAFTER1:
+            node = diff->first[i];
+            if (diff->second[i]) {
+                assert_int_equal(lyd_insert_after(diff->second[i], node), 0);
+            } else {
+                /* the first instance */
+                for (iter = node->parent ? node->parent->child : root; iter->schema != node->schema; iter = iter->next);
+                if (iter != node) {
+                    assert_int_equal(lyd_insert_before(iter, node), 0);
+                }
+            }
+            moved++;
+            break;
+        case LYD_DIFF_CREATED:
+        case LYD_DIFF_MOVEDAFTER2:
+            created++;
+            break;
+        default:
+            fail();
+        }
+    }
+    lyd_free_diff(diff);
+
+    assert_int_equal(deleted, 4);
+    assert_int_equal(changed, 9);
+    /* created and moved after creation */
+    assert_int_equal(created, 4);
+    /* all, but one leaf-list instances and some list instances */
+    assert_true(moved >= n - 1);
+    assert_true(moved < 2 * n - 1);
+
+    /* the first tree is in the order of the second one now */
+    for (; root->prev->next; root = root->prev);
+    ll1_count = l1_count = 0;
+    LY_TREE_FOR(root, iter) {
+        if (!strcmp(iter->schema->name, "c")) {
+            LY_TREE_FOR(iter->child, node) {
+                ll1[ll1_count++] = ((struct lyd_node_leaf_list *)node)->value.uint32;
+            }
+        } else if (!strcmp(iter->schema->name, "l")) {
+            l1[l1_count++] = ((struct lyd_node_leaf_list *)iter->child)->value.uint32;
+        }
+    }
+    ll2_count = l2_count = 0;
+    LY_TREE_FOR(st->second, iter) {
+        if (!strcmp(iter->schema->name, "c")) {
+            LY_TREE_FOR(iter->child, node) {
+                ll2[ll2_count++] = ((struct lyd_node_leaf_list *)node)->value.uint32;
+            }
+        } else if (!strcmp(iter->schema->name, "l") && (((struct lyd_node_leaf_list *)iter->child)->value.uint32 < (unsigned)n)) {
+            l2[l2_count++] = ((struct lyd_node_leaf_list *)iter->child)->value.uint32;
+        }
+    }
+    assert_int_equal(ll1_count, n);
+    assert_int_equal(ll2_count, n);
+    for (i = 0; i < n; i++) {
+        assert_int_equal(ll1[i], ll2[i]);
+    }
+    assert_int_equal(l1_count, n - 4);
+    assert_int_equal(l2_count, n - 4);
+    for (i = 0; i < n - 4; i++) {
+        assert_int_equal(l1[i], l2[i]);
+    }
+
+    st->first = root;
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -575,7 +714,8 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_move3, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_mix1, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_mix2, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_wd1, setup_f, teardown_f), };
+                    cmocka_unit_test_setup_teardown(test_wd1, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_move_many, setup_f, teardown_f), };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
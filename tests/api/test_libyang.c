@@ -38,6 +38,19 @@ struct ly_ctx *ctx = NULL;
 struct lyd_node *root = NULL;
 const struct lys_module *module = NULL;
 
+/* number of strings in all the dictionary shards */
+static uint32_t
+dict_count(struct ly_ctx *ctx)
+{
+    uint32_t i, count = 0;
+
+    for (i = 0; i < LYDICT_SHARDS; ++i) {
+        count += ctx->dict.shards[i].hash_tab->used;
+    }
+
+    return count;
+}
+
 static int
 setup_f(void **state)
 {
@@ -450,6 +463,75 @@ test_ly_ctx_load_module(void **state)
     assert_string_equal("b", module->name);
 }
 
+static void
+test_ly_ctx_load_module_searchdir_changes(void **state)
+{
+    (void) state; /* unused */
+    struct ly_ctx *ctx;
+    const struct lys_module *mod;
+    char dir[] = "/tmp/libyang-test-searchdir-XXXXXX", path[128];
+    FILE *f;
+
+    assert_non_null(mkdtemp(dir));
+    ctx = ly_ctx_new(dir, LY_CTX_DISABLE_SEARCHDIR_CWD);
+    assert_non_null(ctx);
+
+    /* the search dir is read ... */
+    assert_null(ly_ctx_load_module(ctx, "x1", NULL));
+
+    /* ... and read again once a module is added into it */
+    sprintf(path, "%s/x1.yang", dir);
+    f = fopen(path, "w");
+    assert_non_null(f);
+    fprintf(f, "module x1 {namespace urn:x1; prefix x1; import x2 {prefix x2;}}");
+    fclose(f);
+
+    sprintf(path, "%s/sub", dir);
+    assert_int_equal(mkdir(path, 0700), 0);
+    sprintf(path, "%s/sub/x2@2018-01-01.yang", dir);
+    f = fopen(path, "w");
+    assert_non_null(f);
+    fprintf(f, "module x2 {namespace urn:x2; prefix x2; revision 2018-01-01;}");
+    fclose(f);
+    sprintf(path, "%s/sub/x2@2019-01-01.yin", dir);
+    f = fopen(path, "w");
+    assert_non_null(f);
+    fprintf(f, "<module name=\"x2\" xmlns=\"urn:ietf:params:xml:ns:yang:yin:1\"><namespace uri=\"urn:x2\"/>"
+               "<prefix value=\"x2\"/><revision date=\"2019-01-01\"/></module>");
+    fclose(f);
+
+    mod = ly_ctx_load_module(ctx, "x1", NULL);
+    assert_non_null(mod);
+    assert_int_equal(mod->imp_size, 1);
+    assert_string_equal(mod->imp[0].module->rev[0].date, "2019-01-01");
+
+    ly_ctx_destroy(ctx, NULL);
+
+    /* a removed module is not found */
+    ctx = ly_ctx_new(dir, LY_CTX_DISABLE_SEARCHDIR_CWD);
+    assert_non_null(ctx);
+    assert_null(ly_ctx_load_module(ctx, "x3", NULL));
+    sprintf(path, "%s/x1.yang", dir);
+    unlink(path);
+    assert_null(ly_ctx_load_module(ctx, "x1", NULL));
+
+    /* explicit refresh */
+    ly_ctx_refresh_searchdirs(ctx);
+    mod = ly_ctx_load_module(ctx, "x2", "2018-01-01");
+    assert_non_null(mod);
+    assert_string_equal(mod->rev[0].date, "2018-01-01");
+
+    ly_ctx_destroy(ctx, NULL);
+
+    sprintf(path, "%s/sub/x2@2018-01-01.yang", dir);
+    unlink(path);
+    sprintf(path, "%s/sub/x2@2019-01-01.yin", dir);
+    unlink(path);
+    sprintf(path, "%s/sub", dir);
+    rmdir(path);
+    rmdir(dir);
+}
+
 static void
 test_ly_ctx_clean(void **state)
 {
@@ -464,25 +546,25 @@ test_ly_ctx_clean(void **state)
     /* remember starting values */
     setid = ctx->models.module_set_id;
     modules_count = ctx->models.used;
-    dict_used = ctx->dict.hash_tab->used;
+    dict_used = dict_count(ctx);
 
     /* add a module */
     mod = ly_ctx_load_module(ctx, "x", NULL);
     assert_ptr_not_equal(mod, NULL);
     assert_int_equal(modules_count + 1, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
 
     /* clean the context */
     ly_ctx_clean(ctx, NULL);
     assert_int_equal(setid + 2, ctx->models.module_set_id);
     assert_int_equal(modules_count, ctx->models.used);
-    assert_int_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_equal(dict_used, dict_count(ctx));
 
     /* add a module again ... */
     mod = ly_ctx_load_module(ctx, "x", NULL);
     assert_ptr_not_equal(mod, NULL);
     assert_int_equal(modules_count + 1, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
 
     /* .. and add some string into dictionary */
     assert_ptr_not_equal(lydict_insert(ctx, "qwertyuiop", 0), NULL);
@@ -492,7 +574,7 @@ test_ly_ctx_clean(void **state)
     ly_ctx_clean(ctx, NULL);
     assert_int_equal(setid + 4, ctx->models.module_set_id);
     assert_int_equal(modules_count, ctx->models.used);
-    assert_int_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_equal(dict_used, dict_count(ctx));
 
     /* cleanup */
     lydict_remove(ctx, "qwertyuiop");
@@ -512,7 +594,7 @@ test_ly_ctx_remove_module(void **state)
     /* remember starting values */
     setid = ctx->models.module_set_id;
     modules_count = ctx->models.used;
-    dict_used = ctx->dict.hash_tab->used;
+    dict_used = dict_count(ctx);
 
     mod = ly_ctx_load_module(ctx, "x", NULL);
     ly_ctx_remove_module(mod, NULL);
@@ -523,7 +605,7 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 2, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
 
     /* remove the imported module (x), that should cause removing also the loaded module (y) */
     mod = ly_ctx_get_module(ctx, "x", NULL, 0);
@@ -532,7 +614,7 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count, ctx->models.used);
-    assert_int_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_equal(dict_used, dict_count(ctx));
 
     /* add a module again ... */
     mod = ly_ctx_load_module(ctx, "y", NULL);
@@ -540,14 +622,14 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 2, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
     /* ... now remove the loaded module, the imported module is supposed to be removed because it is not
      * used in any other module */
     ly_ctx_remove_module(mod, NULL);
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count, ctx->models.used);
-    assert_int_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_equal(dict_used, dict_count(ctx));
 
     /* add a module again ... */
     mod = ly_ctx_load_module(ctx, "y", NULL);
@@ -555,7 +637,7 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 2, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
     /* and mark even the imported module 'x' as implemented ... */
     assert_int_equal(lys_set_implemented(mod->imp[0].module), EXIT_SUCCESS);
     /* ... now remove the loaded module, the imported module is supposed to be kept because it is implemented */
@@ -563,7 +645,7 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 1, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
     mod = ly_ctx_get_module(ctx, "y", NULL, 0);
     assert_ptr_equal(mod, NULL);
     mod = ly_ctx_get_module(ctx, "x", NULL, 0);
@@ -575,7 +657,7 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 2, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
     /* and add another one also importing module 'x' ... */
     assert_ptr_not_equal(ly_ctx_load_module(ctx, "z", NULL), NULL);
     assert_true(setid < ctx->models.module_set_id);
@@ -587,7 +669,7 @@ test_ly_ctx_remove_module(void **state)
     assert_true(setid < ctx->models.module_set_id);
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 2, ctx->models.used);
-    assert_int_not_equal(dict_used, ctx->dict.hash_tab->used);
+    assert_int_not_equal(dict_used, dict_count(ctx));
     mod = ly_ctx_get_module(ctx, "y", NULL, 0);
     assert_ptr_equal(mod, NULL);
     mod = ly_ctx_get_module(ctx, "x", NULL, 0);
@@ -765,6 +847,105 @@ test_ly_ctx_get_module_by_ns(void **state)
     assert_string_equal("b", module->name);
 }
 
+static const char *
+test_ly_ctx_get_module_many_clb(const char *mod_name, const char *mod_rev, const char *submod_name,
+                                const char *sub_rev, void *user_data, LYS_INFORMAT *format,
+                                void (**free_module_data)(void *model_data, void *user_data))
+{
+    char *buf = (char *)user_data;
+    (void) submod_name; /* unused */
+    (void) sub_rev; /* unused */
+
+    /* the older revision of the module */
+    assert_string_equal(mod_rev, "2018-01-01");
+    sprintf(buf, "module %s {namespace urn:%s; prefix m; revision 2018-01-01;}", mod_name, mod_name);
+    *format = LYS_IN_YANG;
+    *free_module_data = NULL;
+    return buf;
+}
+
+static void
+test_ly_ctx_get_module_many(void **state)
+{
+    (void) state; /* unused */
+    struct ly_ctx *ctx;
+    const struct lys_module *mod, *imp;
+    char buf[8192], clb_buf[128], name[16], ns[32];
+    int i;
+
+    ctx = ly_ctx_new(NULL, 0);
+    assert_non_null(ctx);
+    ly_ctx_set_module_imp_clb(ctx, test_ly_ctx_get_module_many_clb, clb_buf);
+
+    /* enough modules for the indexes to be resized, the implemented ones ... */
+    for (i = 0; i < 100; ++i) {
+        sprintf(buf, "module m%d {namespace urn:m%d; prefix m; revision 2019-01-01; revision 2018-01-01;}", i, i);
+        assert_non_null(lys_parse_mem(ctx, buf, LYS_IN_YANG));
+    }
+
+    /* ... and their older revisions, only imported */
+    strcpy(buf, "module top {namespace urn:top; prefix t;");
+    for (i = 0; i < 100; ++i) {
+        sprintf(buf + strlen(buf), " import m%d {prefix m%d; revision-date 2018-01-01;}", i, i);
+    }
+    strcat(buf, "}");
+    assert_non_null(lys_parse_mem(ctx, buf, LYS_IN_YANG));
+
+    for (i = 0; i < 100; ++i) {
+        sprintf(name, "m%d", i);
+        sprintf(ns, "urn:m%d", i);
+
+        mod = ly_ctx_get_module(ctx, name, NULL, 0);
+        assert_non_null(mod);
+        assert_string_equal(mod->name, name);
+        assert_string_equal(mod->rev[0].date, "2019-01-01");
+        assert_int_equal(mod->implemented, 1);
+        assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, ns, NULL, 0), mod);
+        assert_ptr_equal(ly_ctx_get_module(ctx, name, NULL, 1), mod);
+
+        imp = ly_ctx_get_module(ctx, name, "2018-01-01", 0);
+        assert_non_null(imp);
+        assert_string_equal(imp->rev[0].date, "2018-01-01");
+        assert_int_equal(imp->implemented, 0);
+        assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, ns, "2018-01-01", 0), imp);
+
+        assert_null(ly_ctx_get_module(ctx, name, "2017-01-01", 0));
+    }
+    assert_null(ly_ctx_get_module(ctx, "m100", NULL, 0));
+    assert_null(ly_ctx_get_module_by_ns(ctx, "urn:m100", NULL, 0));
+
+    /* disabled module */
+    mod = ly_ctx_get_module(ctx, "top", NULL, 0);
+    assert_int_equal(lys_set_disabled(mod), 0);
+    assert_null(ly_ctx_get_module(ctx, "top", NULL, 0));
+    assert_null(ly_ctx_get_module_by_ns(ctx, "urn:top", NULL, 0));
+    assert_int_equal(lys_set_enabled(mod), 0);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "urn:top", NULL, 0), mod);
+
+    /* removed module, with its no longer needed imports */
+    assert_int_equal(ly_ctx_remove_module(mod, NULL), 0);
+    assert_null(ly_ctx_get_module(ctx, "top", NULL, 0));
+    assert_null(ly_ctx_get_module(ctx, "m1", "2018-01-01", 0));
+    assert_non_null(ly_ctx_get_module(ctx, "m1", "2019-01-01", 0));
+
+    /* failed module */
+    assert_null(lys_parse_mem(ctx, "module m100 {namespace urn:m100; prefix m; import m1 {prefix m; revision-date 2000-01-01;}}",
+                              LYS_IN_YANG));
+    assert_null(ly_ctx_get_module(ctx, "m100", NULL, 0));
+
+    /* a module loaded again after clean */
+    ly_ctx_clean(ctx, NULL);
+    assert_null(ly_ctx_get_module(ctx, "m2", NULL, 0));
+    assert_null(ly_ctx_get_module_by_ns(ctx, "urn:m2", NULL, 0));
+    assert_non_null(ly_ctx_get_module(ctx, "ietf-yang-library", NULL, 0));
+    mod = lys_parse_mem(ctx, "module m2 {namespace urn:m2; prefix m;}", LYS_IN_YANG);
+    assert_non_null(mod);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "m2", NULL, 0), mod);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "urn:m2", NULL, 1), mod);
+
+    ly_ctx_destroy(ctx, NULL);
+}
+
 static void
 test_ly_ctx_get_submodule(void **state)
 {
@@ -1563,6 +1744,87 @@ test_ly_set_contains(void **state)
     }
 }
 
+void
+test_ly_set_large(void **state)
+{
+    (void) state;
+    struct ly_set *set, *set2, set3 = {0, 0, {NULL}};
+    int objs[1000];
+    int i;
+
+    set = ly_set_new();
+    assert_ptr_not_equal(set, NULL);
+
+    /* large set, no duplicities */
+    for (i = 0; i < 1000; ++i) {
+        assert_int_equal(ly_set_add(set, &objs[i], 0), i);
+    }
+    for (i = 0; i < 1000; i += 7) {
+        assert_int_equal(ly_set_add(set, &objs[i], 0), i);
+    }
+    assert_int_equal(set->number, 1000);
+    assert_int_equal(ly_set_contains(set, &i), -1);
+
+    /* removing moves the last object */
+    assert_int_equal(ly_set_rm(set, &objs[10]), 0);
+    assert_int_equal(ly_set_contains(set, &objs[10]), -1);
+    assert_int_equal(ly_set_contains(set, &objs[999]), 10);
+    assert_int_equal(ly_set_rm_index(set, 0), 0);
+    assert_int_equal(ly_set_contains(set, &objs[998]), 0);
+    assert_int_equal(set->number, 998);
+
+    /* direct modification of the set */
+    set->number--;
+    assert_int_equal(ly_set_contains(set, &objs[997]), -1);
+    assert_int_equal(ly_set_contains(set, &objs[996]), 996);
+
+    /* merge with duplicities, indexed during the merge */
+    set2 = ly_set_new();
+    for (i = 0; i < 1000; i += 2) {
+        ly_set_add(set2, &objs[i], 0);
+    }
+    assert_int_equal(ly_set_merge(set, set2, 0), 2);
+    assert_int_equal(set->number, 999);
+    for (i = 0; i < 1000; ++i) {
+        if (i == 997) {
+            assert_int_equal(ly_set_contains(set, &objs[i]), -1);
+        } else {
+            assert_int_not_equal(ly_set_contains(set, &objs[i]), -1);
+        }
+    }
+
+    /* used as a list */
+    ly_set_add(set, &objs[5], LY_SET_OPT_USEASLIST);
+    assert_int_equal(set->number, 1000);
+    assert_int_equal(ly_set_contains(set, &objs[5]), 5);
+
+    ly_set_clean(set);
+    assert_int_equal(ly_set_contains(set, &objs[5]), -1);
+    ly_set_free(set);
+
+    /* declared by the caller, discarded without ly_set_free() */
+    for (i = 0; i < 1000; ++i) {
+        assert_int_equal(ly_set_add(&set3, &objs[i], 0), i);
+    }
+    assert_int_equal(ly_set_add(&set3, &objs[500], 0), 500);
+    assert_int_equal(ly_set_rm(&set3, &objs[0]), 0);
+    assert_int_equal(ly_set_contains(&set3, &objs[999]), 0);
+    free(set3.set.g);
+
+    /* duplicate of a large set */
+    set = ly_set_new();
+    for (i = 0; i < 100; ++i) {
+        ly_set_add(set, &objs[i], 0);
+    }
+    set2 = ly_set_dup(set);
+    assert_non_null(set2);
+    ly_set_free(set);
+    assert_int_equal(ly_set_add(set2, &objs[50], 0), 50);
+    assert_int_equal(ly_set_rm(set2, &objs[50]), 0);
+    assert_int_equal(ly_set_contains(set2, &objs[99]), 50);
+    ly_set_free(set2);
+}
+
 void
 test_ly_vecode(void **state)
 {
@@ -1614,12 +1876,14 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_module, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_module_older, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_load_module, setup_f, teardown_f),
+        cmocka_unit_test(test_ly_ctx_load_module_searchdir_changes),
         cmocka_unit_test_teardown(test_ly_ctx_remove_module, teardown_f),
         cmocka_unit_test_teardown(test_ly_ctx_remove_module2, teardown_f),
         cmocka_unit_test_teardown(test_lys_set_enabled, teardown_f),
         cmocka_unit_test_teardown(test_lys_set_disabled, teardown_f),
         cmocka_unit_test(test_ly_ctx_clean),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_module_by_ns, setup_f, teardown_f),
+        cmocka_unit_test(test_ly_ctx_get_module_many),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_submodule, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_submodule2, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lys_find_path, setup_f, teardown_f),
@@ -1628,6 +1892,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_ly_set_rm, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_rm_index, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_free, setup_f, teardown_f),
+        cmocka_unit_test(test_ly_set_large),
         cmocka_unit_test(test_ly_verb),
         cmocka_unit_test(test_ly_get_log_clb),
         cmocka_unit_test(test_ly_set_log_clb),
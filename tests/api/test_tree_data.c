@@ -489,6 +489,190 @@ error:
     fail();
 }
 
+static void
+test_lyd_parse_mem_xml_stream(void **state)
+{
+    (void) state; /* unused */
+    struct lyd_node *node = NULL, *node_xml = NULL;
+    struct lyxml_elem *root_xml = NULL;
+    char *str1 = NULL, *str2 = NULL;
+    const char *data = "<?xml version=\"1.0\"?><!-- comment -->\n"
+                       "<x xmlns=\"urn:a\"><?pi ignored?>\n"
+                       "  <unknown xmlns=\"urn:unknown\"><deep>text<deeper/></deep></unknown>\n"
+                       "  <bubba><![CDATA[<test>]]> &amp; more</bubba>\n"
+                       "  <number32>42</number32><!-- comment -->\n"
+                       "</x>\n"
+                       "<y xmlns=\"urn:a\">value</y>";
+
+    /* the data are parsed directly from the input, the result must be the same as from the XML tree */
+    node = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_non_null(node);
+    root_xml = lyxml_parse_mem(ctx, data, LYXML_PARSE_MULTIROOT);
+    assert_non_null(root_xml);
+    node_xml = lyd_parse_xml(ctx, &root_xml, LYD_OPT_CONFIG);
+    assert_non_null(node_xml);
+
+    lyd_print_mem(&str1, node, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_print_mem(&str2, node_xml, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(str1, str2);
+    assert_string_equal(str1, "<x xmlns=\"urn:a\"><bubba>&lt;test&gt; &amp; more</bubba><number32>42</number32></x>"
+                        "<y xmlns=\"urn:a\">value</y>");
+
+    free(str1);
+    free(str2);
+    lyd_free_withsiblings(node);
+    lyd_free_withsiblings(node_xml);
+    lyxml_free_withsiblings(ctx, root_xml);
+
+    /* invalid input in the middle of the data */
+    node = lyd_parse_mem(ctx, "<x xmlns=\"urn:a\"><bubba>test</bubba><number32>1</number64></x>", LYD_XML, LYD_OPT_CONFIG);
+    assert_null(node);
+    node = lyd_parse_mem(ctx, "<x xmlns=\"urn:a\"><bubba>test</bubba>", LYD_XML, LYD_OPT_CONFIG);
+    assert_null(node);
+
+    /* mixed content */
+    node = lyd_parse_mem(ctx, "<x xmlns=\"urn:a\"><bubba>test</bubba>text</x>", LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_null(node);
+    node = lyd_parse_mem(ctx, "<x xmlns=\"urn:a\"><bubba>test</bubba>text</x>", LYD_XML, LYD_OPT_CONFIG);
+    assert_int_equal(ly_errno, LY_SUCCESS);
+    /* the element was ignored, only the default container was created */
+    assert_non_null(node);
+    assert_int_equal(node->dflt, 1);
+    lyd_free_withsiblings(node);
+
+    /* text mixed with an unknown element is ignored the same way */
+    node = lyd_parse_mem(ctx, "<x xmlns=\"urn:a\"><unknown xmlns=\"urn:unknown\"/>text</x>", LYD_XML, LYD_OPT_CONFIG);
+    assert_int_equal(ly_errno, LY_SUCCESS);
+    assert_non_null(node);
+    assert_int_equal(node->dflt, 1);
+    lyd_free_withsiblings(node);
+    node = lyd_parse_mem(ctx, "<x xmlns=\"urn:a\"><unknown xmlns=\"urn:unknown\"/>text</x>", LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_null(node);
+
+    /* ignored element with a notification inside, which is then missing */
+    assert_non_null(lys_parse_mem(ctx, "module mixed-notif {yang-version 1.1; namespace urn:mn; prefix mn;"
+                                  "container c {notification n {leaf l {type string;}}}}", LYS_IN_YANG));
+    node = lyd_parse_mem(ctx, "<c xmlns=\"urn:mn\"><n><l>val</l></n>text</c>", LYD_XML, LYD_OPT_NOTIF, NULL);
+    assert_null(node);
+    assert_int_equal(ly_vecode(ctx), LYVE_INELEM);
+}
+
+static void
+check_printed_equal(const char *str1, const char *str2, LYD_FORMAT format)
+{
+    struct lyd_node *tree1, *tree2;
+    char *xml1, *xml2;
+
+    if (format != LYD_LYB) {
+        assert_string_equal(str1, str2);
+        return;
+    }
+
+    /* binary data include the implicit nodes, compare the explicit ones */
+    tree1 = lyd_parse_mem(ctx, str1, LYD_LYB, LYD_OPT_CONFIG);
+    assert_non_null(tree1);
+    tree2 = lyd_parse_mem(ctx, str2, LYD_LYB, LYD_OPT_CONFIG);
+    assert_non_null(tree2);
+    lyd_print_mem(&xml1, tree1, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_print_mem(&xml2, tree2, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(xml1, xml2);
+
+    free(xml1);
+    free(xml2);
+    lyd_free_withsiblings(tree1);
+    lyd_free_withsiblings(tree2);
+}
+
+static void
+test_lyd_parse_mem_arena(void **state)
+{
+    (void) state; /* unused */
+    struct lyd_node *node, *other, *leaf, *dup;
+    LYD_FORMAT formats[] = {LYD_XML, LYD_JSON, LYD_LYB};
+    char *str1 = NULL, *str2 = NULL;
+    int i;
+
+    node = lyd_parse_mem(ctx, a_data_xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_non_null(node);
+    assert_int_equal(node->arena, 0);
+
+    for (i = 0; i < 3; ++i) {
+        lyd_print_mem(&str1, node, formats[i], LYP_WITHSIBLINGS);
+        assert_non_null(str1);
+
+        /* the same data allocated from an arena */
+        other = lyd_parse_mem(ctx, str1, formats[i], LYD_OPT_CONFIG | LYD_OPT_ARENA);
+        assert_non_null(other);
+        assert_int_equal(other->arena, 1);
+        assert_int_equal(other->child->arena, 1);
+        lyd_print_mem(&str2, other, formats[i], LYP_WITHSIBLINGS);
+        check_printed_equal(str1, str2, formats[i]);
+        free(str2);
+
+        /* duplicates are allocated separately */
+        dup = lyd_dup(other, LYD_DUP_OPT_RECURSIVE);
+        assert_non_null(dup);
+        assert_int_equal(dup->arena, 0);
+        assert_int_equal(dup->child->arena, 0);
+
+        /* the nodes from an arena can be freed one by one and moved into another tree */
+        for (leaf = other->child; leaf && strcmp(leaf->schema->name, "bubba"); leaf = leaf->next);
+        assert_non_null(leaf);
+        lyd_free(dup->child);
+        assert_int_equal(lyd_insert(dup, leaf), 0);
+        lyd_free(other->child);
+        lyd_free_withsiblings(other);
+
+        lyd_print_mem(&str2, dup, formats[i], LYP_WITHSIBLINGS);
+        check_printed_equal(str1, str2, formats[i]);
+        free(str1);
+        free(str2);
+        lyd_free_withsiblings(dup);
+    }
+
+    lyd_free_withsiblings(node);
+}
+
+static void
+test_lyd_parse_fd_lyb(void **state)
+{
+    (void) state; /* unused */
+    struct lyd_node *node, *leaf;
+    const char *values[] = {"", "test", NULL};
+    char long_value[1001];
+    FILE *f;
+    int i;
+
+    /* longer than a LYB chunk */
+    memset(long_value, 'a', 1000);
+    long_value[1000] = '\0';
+    values[2] = long_value;
+
+    for (leaf = root->child; leaf && strcmp(leaf->schema->name, "bubba"); leaf = leaf->next);
+    assert_non_null(leaf);
+
+    for (i = 0; i < 3; ++i) {
+        assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)leaf, values[i]), 0);
+
+        f = tmpfile();
+        assert_non_null(f);
+        assert_int_equal(lyd_print_fd(fileno(f), root, LYD_LYB, LYP_WITHSIBLINGS), 0);
+
+        /* strings are inserted into the dictionary directly from the mapped file */
+        node = lyd_parse_fd(ctx, fileno(f), LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+        fclose(f);
+        assert_non_null(node);
+
+        for (leaf = node->child; leaf && strcmp(leaf->schema->name, "bubba"); leaf = leaf->next);
+        assert_non_null(leaf);
+        assert_string_equal(((struct lyd_node_leaf_list *)leaf)->value_str, values[i]);
+        assert_ptr_equal(((struct lyd_node_leaf_list *)leaf)->value.string, ((struct lyd_node_leaf_list *)leaf)->value_str);
+        lyd_free_withsiblings(node);
+
+        for (leaf = root->child; leaf && strcmp(leaf->schema->name, "bubba"); leaf = leaf->next);
+    }
+}
+
 static void
 test_lyd_new(void **state)
 {
@@ -974,6 +1158,64 @@ test_lyd_schema_sort(void **state)
     lyd_free_withsiblings(root);
 }
 
+static void
+test_lyd_schema_sort_instances(void **state)
+{
+    (void) state; /* unused */
+    const struct lys_module *module, *module_b;
+    struct lyd_node *root, *node;
+    char key[8];
+    int i;
+
+    module = ly_ctx_get_module(ctx, "a", NULL, 0);
+    assert_non_null(module);
+
+    /* instances of the list mixed with other nodes */
+    root = lyd_new_leaf(NULL, module, "y", "y");
+    assert_non_null(root);
+    for (i = 0; i < 10; ++i) {
+        node = lyd_new(NULL, module, "l");
+        assert_non_null(node);
+        sprintf(key, "%d", (i * 7) % 10);
+        assert_non_null(lyd_new_leaf(node, NULL, "key1", key));
+        assert_non_null(lyd_new_leaf(node, NULL, "key2", "1"));
+        assert_int_equal(lyd_insert_after(root->prev, node), 0);
+        if (i == 4) {
+            node = lyd_new(NULL, module, "x");
+            assert_non_null(node);
+            assert_int_equal(lyd_insert_after(root->prev, node), 0);
+        }
+    }
+
+    assert_int_equal(lyd_schema_sort(root, 1), 0);
+    root = lyd_first_sibling(root);
+    assert_string_equal(root->schema->name, "x");
+    assert_string_equal(root->next->schema->name, "y");
+
+    /* the instances kept their order */
+    for (i = 0, node = root->next->next; i < 10; ++i, node = node->next) {
+        assert_string_equal(node->schema->name, "l");
+        sprintf(key, "%d", (i * 7) % 10);
+        assert_string_equal(((struct lyd_node_leaf_list *)node->child)->value_str, key);
+    }
+    assert_null(node);
+
+    /* nodes of a module added to the context later follow */
+    module_b = lys_parse_mem(ctx, "module sort-b {namespace urn:sort-b; prefix b; leaf b {type string;}}", LYS_IN_YANG);
+    assert_non_null(module_b);
+    node = lyd_new_leaf(NULL, module_b, "b", "b");
+    assert_non_null(node);
+    assert_int_equal(lyd_insert_before(root, node), 0);
+
+    assert_int_equal(lyd_schema_sort(node, 0), 0);
+    root = lyd_first_sibling(node);
+    assert_string_equal(root->schema->name, "x");
+    assert_string_equal(root->prev->schema->name, "b");
+    assert_string_equal(root->prev->prev->schema->name, "l");
+
+    lyd_free_withsiblings(root);
+}
+
 static void
 test_lyd_find_path(void **state)
 {
@@ -1118,6 +1360,86 @@ test_lyd_find_sibling(void **state)
     lyd_free_withsiblings(data);
 }
 
+static void
+test_lyd_find_sibling_module(void **state)
+{
+    struct ly_ctx *ctx = (struct ly_ctx *)*state;
+    const char *yang_a =
+    "module hash-a {"
+        "namespace urn:hash-a;"
+        "prefix a;"
+        "container cont {"
+            "leaf x {type string;}"
+            "list lt {key k; leaf k {type uint8;}}"
+        "}"
+    "}";
+    const char *yang_b =
+    "module hash-b {"
+        "namespace urn:hash-b;"
+        "prefix b;"
+        "import hash-a {prefix a;}"
+        "augment /a:cont {"
+            "leaf x {type string;}"
+            "list lt {key k; leaf k {type uint8;}}"
+        "}"
+    "}";
+    const struct lys_module *mod_a, *mod_b;
+    const struct lys_node *schema;
+    struct lyd_node *data, *match, *iter;
+    char key[4];
+    int i;
+
+    mod_a = lys_parse_mem(ctx, yang_a, LYS_IN_YANG);
+    assert_ptr_not_equal(mod_a, NULL);
+    mod_b = lys_parse_mem(ctx, yang_b, LYS_IN_YANG);
+    assert_ptr_not_equal(mod_b, NULL);
+
+    /* nodes of both modules with the same names and values, enough of them for the children hash table */
+    data = lyd_new(NULL, mod_a, "cont");
+    assert_ptr_not_equal(data, NULL);
+    assert_ptr_not_equal(lyd_new_leaf(data, mod_a, "x", "val"), NULL);
+    assert_ptr_not_equal(lyd_new_leaf(data, mod_b, "x", "val"), NULL);
+    for (i = 0; i < 10; ++i) {
+        sprintf(key, "%d", i);
+        iter = lyd_new(data, mod_a, "lt");
+        assert_ptr_not_equal(lyd_new_leaf(iter, mod_a, "k", key), NULL);
+        iter = lyd_new(data, mod_b, "lt");
+        assert_ptr_not_equal(lyd_new_leaf(iter, mod_b, "k", key), NULL);
+    }
+    assert_int_equal(lyd_validate(&data, LYD_OPT_CONFIG | LYD_OPT_VAL_PARALLEL, NULL), 0);
+
+    /* the module is a part of the instance hash */
+    assert_string_equal(data->child->schema->name, "x");
+    assert_string_equal(data->child->next->schema->name, "x");
+    assert_int_not_equal(data->child->hash, data->child->next->hash);
+
+    schema = ly_ctx_get_node(ctx, NULL, "/hash-a:cont/hash-b:x", 0);
+    assert_ptr_not_equal(schema, NULL);
+    assert_int_equal(lyd_find_sibling_val(data->child, schema, NULL, &match), 0);
+    assert_ptr_not_equal(match, NULL);
+    assert_ptr_equal(match->schema, schema);
+
+    schema = ly_ctx_get_node(ctx, NULL, "/hash-a:cont/hash-a:lt", 0);
+    assert_ptr_not_equal(schema, NULL);
+    assert_int_equal(lyd_find_sibling_val(data->child, schema, "[k='7']", &match), 0);
+    assert_ptr_not_equal(match, NULL);
+    assert_ptr_equal(match->schema, schema);
+    schema = ly_ctx_get_node(ctx, NULL, "/hash-a:cont/hash-b:lt", 0);
+    assert_ptr_not_equal(schema, NULL);
+    assert_int_equal(lyd_find_sibling_val(data->child, schema, "[k='7']", &match), 0);
+    assert_ptr_not_equal(match, NULL);
+    assert_ptr_equal(match->schema, schema);
+
+    /* a duplicate instance is still found */
+    iter = lyd_new(data, mod_b, "lt");
+    assert_ptr_not_equal(lyd_new_leaf(iter, mod_b, "k", "7"), NULL);
+    assert_int_not_equal(lyd_validate(&data, LYD_OPT_CONFIG | LYD_OPT_VAL_PARALLEL, NULL), 0);
+    assert_int_equal(ly_vecode(ctx), LYVE_DUPLIST);
+
+    /* cleanup */
+    lyd_free_withsiblings(data);
+}
+
 static void
 test_lyd_validate(void **state)
 {
@@ -1151,6 +1473,172 @@ test_lyd_validate(void **state)
     }
 }
 
+static void
+test_lyd_validate_incremental(void **state)
+{
+    (void) state; /* unused */
+    const char *yang = "module incr {namespace urn:incr; prefix i;"
+        "container top {"
+        "  list item {key name; leaf name {type string;} leaf value {type uint8;} leaf dflt {type uint8; default 5;}}"
+        "  leaf limit {type uint8; must \". >= count(../item)\";}"
+        "  leaf ref {type leafref {path \"../item/name\";}}"
+        "  container conf {leaf req {type string; mandatory true;}}"
+        "}}";
+    const char *xml = "<top xmlns=\"urn:incr\">"
+        "<item><name>a</name></item><item><name>b</name></item><item><name>c</name></item>"
+        "<limit>3</limit><ref>b</ref><conf><req>x</req></conf>"
+        "</top>";
+    const int options = LYD_OPT_CONFIG | LYD_OPT_VAL_INCREMENTAL;
+    const struct lys_module *mod;
+    struct lyd_node *data, *item, *limit, *ref, *node;
+    struct ly_set *set;
+
+    mod = lys_parse_mem(ctx, yang, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(data, NULL);
+    assert_int_equal(lyd_validate(&data, options, NULL), 0);
+
+    item = data->child;
+    limit = item->next->next->next;
+    ref = limit->next;
+
+    /* must depending on a changed list */
+    node = lyd_new(data, mod, "item");
+    assert_ptr_not_equal(lyd_new_leaf(node, mod, "name", "d"), NULL);
+    assert_int_not_equal(lyd_validate(&data, options, NULL), 0);
+    assert_int_equal(ly_vecode(ctx), LYVE_NOMUST);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)limit, "4"), 0);
+    assert_int_equal(lyd_validate(&data, options, NULL), 0);
+
+    /* default node added into the new list instance */
+    set = lyd_find_path(data, "/incr:top/item[name='d']/dflt");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    ly_set_free(set);
+
+    /* duplicate list instance in a parent that was not changed */
+    node = lyd_new(data, mod, "item");
+    assert_ptr_not_equal(lyd_new_leaf(node, mod, "name", "a"), NULL);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)limit, "5"), 0);
+    assert_int_not_equal(lyd_validate(&data, options, NULL), 0);
+    assert_int_equal(ly_vecode(ctx), LYVE_DUPLIST);
+    lyd_free(node);
+    assert_int_equal(lyd_validate(&data, options, NULL), 0);
+
+    /* removed leafref target */
+    lyd_free(item->next);
+    assert_int_not_equal(lyd_validate(&data, options, NULL), 0);
+    assert_int_equal(ly_vecode(ctx), LYVE_NOLEAFREF);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)ref, "c"), 0);
+    assert_int_equal(lyd_validate(&data, options, NULL), 0);
+
+    /* removed mandatory node */
+    lyd_free(ref->next->child);
+    assert_int_not_equal(lyd_validate(&data, options, NULL), 0);
+    assert_int_equal(ly_vecode(ctx), LYVE_MISSELEM);
+    assert_ptr_not_equal(lyd_new_leaf(ref->next, mod, "req", "y"), NULL);
+    assert_int_equal(lyd_validate(&data, options, NULL), 0);
+
+    /* the same result as the full validation */
+    assert_int_equal(lyd_validate(&data, LYD_OPT_CONFIG, NULL), 0);
+
+    lyd_free_withsiblings(data);
+}
+
+static int ignored_must_count;
+
+static void
+ignored_must_clb(LY_LOG_LEVEL level, const char *msg, const char *path)
+{
+    (void)path;
+
+    if ((level == LY_LLVRB) && strstr(msg, "not satisfied, but it is not required")) {
+        ++ignored_must_count;
+    }
+}
+
+static void
+test_lyd_validate_parallel(void **state)
+{
+    (void) state; /* unused */
+    const char *yang = "module par {namespace urn:par; prefix p;"
+        "container top {list item {key name; leaf name {type uint32;} leaf value {type uint32; must \". < ../name\";}}}}";
+    const char *rpc_yang = "module par-rpc {namespace urn:par-rpc; prefix pr; container top {leaf limit {type uint32;}}"
+        "rpc check {input {list entry {key id; leaf id {type uint32;} leaf val {type uint32; must \". < /pr:top/limit\";}}}}}";
+    const struct lys_module *mod;
+    struct lyd_node *data, *item, *fail1, *fail2;
+    char name[16], value[16], *path;
+    int i;
+
+    mod = lys_parse_mem(ctx, yang, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+    ly_ctx_set_val_threads(ctx, 4);
+    assert_int_equal(ly_ctx_get_val_threads(ctx), 4);
+
+    data = lyd_new(NULL, mod, "top");
+    assert_ptr_not_equal(data, NULL);
+    fail1 = fail2 = NULL;
+    for (i = 1; i <= 1000; ++i) {
+        item = lyd_new(data, mod, "item");
+        sprintf(name, "%d", i);
+        sprintf(value, "%d", i - 1);
+        assert_ptr_not_equal(lyd_new_leaf(item, mod, "name", name), NULL);
+        assert_ptr_not_equal(lyd_new_leaf(item, mod, "value", value), NULL);
+        if ((i == 300) || (i == 700)) {
+            if (!fail1) {
+                fail1 = item;
+            } else {
+                fail2 = item;
+            }
+        }
+    }
+    assert_int_equal(lyd_validate(&data, LYD_OPT_CONFIG | LYD_OPT_VAL_PARALLEL, NULL), 0);
+
+    /* the first failing instance is always reported */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)fail2->child->next, "800"), 0);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)fail1->child->next, "400"), 0);
+    for (i = 0; i < 2; ++i) {
+        assert_int_not_equal(lyd_validate(&data, LYD_OPT_CONFIG | (i ? LYD_OPT_VAL_PARALLEL : 0), NULL), 0);
+        assert_int_equal(ly_vecode(ctx), LYVE_NOMUST);
+        assert_string_equal(ly_errpath(ctx), "/par:top/item[name='300']/value");
+    }
+
+    lyd_free(fail1);
+    assert_int_not_equal(lyd_validate(&data, LYD_OPT_CONFIG | LYD_OPT_VAL_PARALLEL, NULL), 0);
+    path = lyd_path(fail2->child->next);
+    assert_string_equal(ly_errpath(ctx), path);
+    free(path);
+
+    lyd_free(fail2);
+    assert_int_equal(lyd_validate(&data, LYD_OPT_CONFIG | LYD_OPT_VAL_PARALLEL, NULL), 0);
+
+    lyd_free_withsiblings(data);
+
+    /* the ignored failures of conditions depending on the missing data tree are still reported */
+    mod = lys_parse_mem(ctx, rpc_yang, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+    data = lyd_new(NULL, mod, "check");
+    assert_ptr_not_equal(data, NULL);
+    for (i = 1; i <= 200; ++i) {
+        item = lyd_new(data, mod, "entry");
+        sprintf(name, "%d", i);
+        assert_ptr_not_equal(lyd_new_leaf(item, mod, "id", name), NULL);
+        assert_ptr_not_equal(lyd_new_leaf(item, mod, "val", name), NULL);
+    }
+    ly_set_log_clb(ignored_must_clb, 0);
+    ly_verb(LY_LLVRB);
+    for (i = 0; i < 2; ++i) {
+        ignored_must_count = 0;
+        assert_int_equal(lyd_validate(&data, LYD_OPT_RPC | LYD_OPT_NOEXTDEPS | (i ? LYD_OPT_VAL_PARALLEL : 0), NULL), 0);
+        assert_int_equal(ignored_must_count, 200);
+    }
+    ly_verb(LY_LLERR);
+    ly_set_log_clb(NULL, 1);
+
+    lyd_free_withsiblings(data);
+}
+
 static void
 test_lyd_unlink(void **state)
 {
@@ -1437,6 +1925,35 @@ error:
     fail();
 }
 
+static ssize_t
+print_clb_fail(void *arg, const void *buf, size_t count)
+{
+    (void)buf;
+    (void)count;
+
+    /* the first call fails, the second writes nothing */
+    return (*(int *)arg)++ ? 0 : -1;
+}
+
+static void
+test_lyd_print_write_error(void **state)
+{
+    (void) state; /* unused */
+    int fd, calls = 0;
+
+    /* write() fails */
+    fd = open("/dev/null", O_RDONLY);
+    assert_int_not_equal(fd, -1);
+    assert_int_not_equal(lyd_print_fd(fd, root, LYD_XML, LYP_WITHSIBLINGS), 0);
+    assert_int_not_equal(lys_print_fd(fd, root->schema->module, LYS_OUT_YANG, NULL, 0, 0), 0);
+    close(fd);
+
+    /* the callback fails and then writes nothing */
+    assert_int_not_equal(lyd_print_clb(print_clb_fail, &calls, root, LYD_XML, LYP_WITHSIBLINGS), 0);
+    assert_int_not_equal(lyd_print_clb(print_clb_fail, &calls, root, LYD_JSON, LYP_WITHSIBLINGS), 0);
+    assert_int_equal(calls, 2);
+}
+
 static void
 test_lyd_print_file_xml(void **state)
 {
@@ -1697,6 +2214,59 @@ test_lyd_print_clb_json(void **state)
     free(buf);
 }
 
+static void
+test_lyd_print_clb_fd_large(void **state)
+{
+    (void) state; /* unused */
+    char *value, *result = NULL, *mapped;
+    char file_name[20];
+    struct buff buf;
+    struct stat sb;
+    int i, rc, fd;
+
+    /* the data are larger than the printer output buffer */
+    value = malloc(100001);
+    if (!value) {
+        fail();
+    }
+    for (i = 0; i < 100000; ++i) {
+        value[i] = (i % 100) ? 'a' + i % 26 : '&';
+    }
+    value[i] = '\0';
+    rc = lyd_change_leaf((struct lyd_node_leaf_list *)root->child, value);
+    free(value);
+    assert_int_equal(rc, 0);
+
+    rc = lyd_print_mem(&result, root, LYD_XML, LYP_FORMAT);
+    assert_int_equal(rc, 0);
+    assert_true(strlen(result) > 100000);
+
+    /* callback */
+    buf.len = 0;
+    buf.cmp = result;
+    rc = lyd_print_clb(custom_lyd_print_clb, &buf, root, LYD_XML, LYP_FORMAT);
+    assert_int_equal(rc, 0);
+    assert_int_equal(buf.len, strlen(result));
+
+    /* file descriptor */
+    memset(file_name, 0, sizeof(file_name));
+    strncpy(file_name, TMP_TEMPLATE, sizeof(file_name));
+    fd = mkstemp(file_name);
+    assert_true(fd > 0);
+    rc = lyd_print_fd(fd, root, LYD_XML, LYP_FORMAT);
+    assert_int_equal(rc, 0);
+    assert_int_equal(fstat(fd, &sb), 0);
+    assert_int_equal(sb.st_size, strlen(result));
+    mapped = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    assert_ptr_not_equal(mapped, MAP_FAILED);
+    assert_int_equal(memcmp(mapped, result, sb.st_size), 0);
+
+    munmap(mapped, sb.st_size);
+    close(fd);
+    unlink(file_name);
+    free(result);
+}
+
 static void
 test_lyd_path(void **state)
 {
@@ -2027,6 +2597,9 @@ int main(void)
         cmocka_unit_test(test_lyd_parse_fd),
         cmocka_unit_test(test_lyd_parse_path),
         cmocka_unit_test(test_lyd_parse_xml),
+        cmocka_unit_test_setup_teardown(test_lyd_parse_mem_xml_stream, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_parse_mem_arena, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_parse_fd_lyb, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_new, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_new_leaf, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_change_leaf, setup_f, teardown_f),
@@ -2038,10 +2611,14 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyd_insert_before, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_insert_after, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_schema_sort, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_schema_sort_instances, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_find_path, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_find_instance, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_find_sibling, setup_f2, teardown_f2),
+        cmocka_unit_test_setup_teardown(test_lyd_find_sibling_module, setup_f2, teardown_f2),
         cmocka_unit_test_setup_teardown(test_lyd_validate, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_validate_incremental, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_validate_parallel, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_unlink, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_free, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_free_withsiblings, setup_f, teardown_f),
@@ -2053,12 +2630,14 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyd_print_fd_xml, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_fd_xml_format, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_fd_json, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_print_write_error, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_file_xml, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_file_xml_format, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_file_json, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_xml, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_xml_format, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_json, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_print_clb_fd_large, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_path, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_leaf_type, setup_f2, teardown_f2),
         cmocka_unit_test_setup_teardown(test_lyd_validation_dflt_empty_containers, setup_f, teardown_f),
@@ -285,6 +285,60 @@ test_advanced(void **state)
     st->set = NULL;
 }
 
+static void
+test_key_predicates(void **state)
+{
+    struct state *st = (*state);
+    char path[128];
+    int i;
+
+    /* enough instances for the parent to have a hash table of its children */
+    for (i = 3; i < 20; ++i) {
+        sprintf(path, "/ietf-interfaces:interfaces/interface[name='iface%d']/description", i);
+        assert_ptr_not_equal(lyd_new_path(st->dt, NULL, path, "dsc", 0, 0), NULL);
+    }
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[name='iface7']/description");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    assert_string_equal(st->set->set.d[0]->parent->child->schema->name, "name");
+    assert_string_equal(((struct lyd_node_leaf_list *)st->set->set.d[0]->parent->child)->value_str, "iface7");
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[ietf-interfaces:name='iface1']/ietf-ip:ipv4/ietf-ip:mtu");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->set->set.d[0])->value_str, "68");
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[name='iface7'][1]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[name='iface7'][2]");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 0);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[name='iface20']");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 0);
+    ly_set_free(st->set);
+    st->set = NULL;
+
+    st->set = lyd_find_path(st->dt, "/ietf-interfaces:interfaces/interface[name='iface2']/ietf-ip:ipv4/ietf-ip:address[ietf-ip:ip='172.0.0.5']/ietf-ip:prefix-length");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)st->set->set.d[0])->value_str, "16");
+    ly_set_free(st->set);
+    st->set = NULL;
+}
+
 static void
 test_functions_operators(void **state)
 {
@@ -367,6 +421,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_invalid, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_simple, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_advanced, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_key_predicates, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_functions_operators, setup_f, teardown_f),
                     };
 
@@ -111,6 +111,30 @@ test_func_re_match(void **state)
     assert_int_equal(st->set->number, 2);
 }
 
+static void
+test_func_re_match_many(void **state)
+{
+    struct state *st = (*state);
+    char path[128];
+    int i;
+
+    st->dt = lyd_parse_mem(st->ctx, data1, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+
+    /* more patterns than the context caches, each used several times */
+    for (i = 0; i < 600; ++i) {
+        sprintf(path, "/xpath-1.1:top/*[re-match(., 'a{2}b{2}(c{%d})?')]", (i % 300) + 1);
+        st->set = lyd_find_path(st->dt, path);
+        assert_ptr_not_equal(st->set, NULL);
+        assert_int_equal(st->set->number, (i % 300) == 1 ? 3 : 1);
+        ly_set_free(st->set);
+    }
+
+    /* invalid pattern */
+    st->set = lyd_find_path(st->dt, "/xpath-1.1:top/*[re-match(., 'a(b')]");
+    assert_ptr_equal(st->set, NULL);
+}
+
 static void
 test_func_deref(void **state)
 {
@@ -288,6 +312,7 @@ main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_func_re_match, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_func_re_match_many, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_func_deref, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_func_derived_from1, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_func_derived_from2, setup_f, teardown_f),
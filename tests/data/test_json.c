@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <cmocka.h>
@@ -449,6 +450,40 @@ static const char *string_data_024 =
 "}"
 ;
 
+/* arrays are not matched in the anydata value, only its objects are counted */
+static const char *string_data_025 =
+"{"
+  "\"ietf-anydata:anydata-con\" : {"
+        "\"anyvalue\" : {\n]  \"some\": \"content\"\n}"
+  "}"
+"}"
+;
+
+/* end-object inside a string of the anydata value */
+static const char *string_data_026 =
+"{"
+  "\"ietf-anydata:anydata-con\" : {"
+        "\"anyvalue\" : {\"some\": \"con}\\\"tent\"}"
+  "}"
+"}"
+;
+
+/* unknown nodes are skipped */
+static const char *unknown_data =
+"{"
+  "\"unknown:x\": {\"a\": [1, \"]\", {\"b\": \"}\\\"\"}], \"c\": true},"
+  "\"ietf-interfaces:interfaces\": {"
+    "\"interface\": ["
+      "{"
+        "\"name\": \"iface1\","
+        "\"unknown:y\": -1.5e3,"
+        "\"type\": \"iana-if-type:ethernetCsmacd\""
+      "}"
+    "]"
+  "}"
+"}"
+;
+
 static int
 setup_f(struct state **state, const char *search_dir, const char **modules, int module_count)
 {
@@ -692,6 +727,121 @@ test_parse_string(void **state)
 
     st->dt = lyd_parse_mem(st->ctx, string_data_024, LYD_JSON, LYD_OPT_CONFIG);
     assert_ptr_equal(st->dt, NULL);
+
+    st->dt = lyd_parse_mem(st->ctx, string_data_025, LYD_JSON, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_string_equal(((struct lyd_node_anydata *)st->dt->child)->value.str, "{\n]  \"some\": \"content\"\n}");
+    lyd_free_withsiblings(st->dt);
+
+    st->dt = lyd_parse_mem(st->ctx, string_data_026, LYD_JSON, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_string_equal(((struct lyd_node_anydata *)st->dt->child)->value.str, "{\"some\": \"con}\\\"tent\"}");
+}
+
+static struct lyd_node *
+parse_stream(struct ly_ctx *ctx, const char *data, size_t chunk, int options)
+{
+    struct lyd_json_stream *stream;
+    struct lyd_node *node = NULL;
+    size_t len = strlen(data), i;
+
+    stream = lyd_json_stream_new(ctx, options);
+    if (!stream) {
+        return NULL;
+    }
+
+    for (i = 0; i < len; i += chunk) {
+        if (lyd_json_stream_feed(stream, &data[i], (len - i < chunk) ? len - i : chunk)) {
+            goto cleanup;
+        }
+    }
+    node = lyd_json_stream_finish(stream);
+
+cleanup:
+    lyd_json_stream_free(stream);
+    return node;
+}
+
+static void
+test_parse_stream(void **state)
+{
+    struct state *st;
+    const char *modules[] = {"ietf-interfaces", "ietf-ip", "iana-if-type"};
+    const char *strings[] = {string_data_001, string_data_002, string_data_003, string_data_004, string_data_005,
+                             string_data_006, string_data_007, string_data_008, string_data_009, string_data_010,
+                             string_data_011, string_data_012, string_data_013, string_data_014, string_data_015,
+                             string_data_016, string_data_017, string_data_018, string_data_019, string_data_020,
+                             string_data_021, string_data_022, string_data_023, string_data_024, string_data_025,
+                             string_data_026};
+    const size_t chunks[] = {1, 7, 4096};
+    struct lyd_node *node;
+    char *mem, *str;
+    unsigned int i, j;
+
+    if (setup_f(&st, TESTS_DIR "/schema/yin/ietf", modules, 3)) {
+        fail();
+    }
+
+    (*state) = st;
+
+    st->dt = lyd_parse_mem(st->ctx, if_data, LYD_JSON, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_print_mem(&mem, st->dt, LYD_JSON, LYP_WITHSIBLINGS);
+    lyd_free_withsiblings(st->dt);
+    st->dt = NULL;
+
+    /* the same tree regardless of how the data are split */
+    for (i = 0; i < sizeof chunks / sizeof *chunks; ++i) {
+        node = parse_stream(st->ctx, if_data, chunks[i], LYD_OPT_CONFIG);
+        assert_ptr_not_equal(node, NULL);
+        lyd_print_mem(&str, node, LYD_JSON, LYP_WITHSIBLINGS);
+        lyd_free_withsiblings(node);
+        assert_string_equal(str, mem);
+        free(str);
+    }
+    free(mem);
+
+    st->dt = lyd_parse_mem(st->ctx, unknown_data, LYD_JSON, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_print_mem(&mem, st->dt, LYD_JSON, LYP_WITHSIBLINGS);
+    lyd_free_withsiblings(st->dt);
+    st->dt = NULL;
+    for (i = 0; i < sizeof chunks / sizeof *chunks; ++i) {
+        node = parse_stream(st->ctx, unknown_data, chunks[i], LYD_OPT_CONFIG);
+        assert_ptr_not_equal(node, NULL);
+        lyd_print_mem(&str, node, LYD_JSON, LYP_WITHSIBLINGS);
+        lyd_free_withsiblings(node);
+        assert_string_equal(str, mem);
+        free(str);
+    }
+    free(mem);
+    assert_ptr_equal(parse_stream(st->ctx, unknown_data, 1, LYD_OPT_CONFIG | LYD_OPT_STRICT), NULL);
+
+    /* incomplete data */
+    assert_ptr_equal(parse_stream(st->ctx, "{\"ietf-interfaces:interfaces\": {\"interface\": [{\"name\": \"a\"}", 3,
+                                  LYD_OPT_CONFIG), NULL);
+    assert_ptr_equal(parse_stream(st->ctx, "", 1, LYD_OPT_CONFIG), NULL);
+    assert_int_not_equal(ly_errno, LY_SUCCESS);
+
+    /* the same errors as when parsing the data at once */
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, text_schema, LYS_IN_YIN), NULL);
+    for (i = 0; i < sizeof strings / sizeof *strings; ++i) {
+        st->dt = lyd_parse_mem(st->ctx, strings[i], LYD_JSON, LYD_OPT_CONFIG);
+        for (j = 0; j < sizeof chunks / sizeof *chunks; ++j) {
+            node = parse_stream(st->ctx, strings[i], chunks[j], LYD_OPT_CONFIG);
+            assert_int_equal(!node, !st->dt);
+            if (node) {
+                lyd_print_mem(&mem, st->dt, LYD_JSON, LYP_WITHSIBLINGS);
+                lyd_print_mem(&str, node, LYD_JSON, LYP_WITHSIBLINGS);
+                assert_string_equal(str, mem);
+                free(mem);
+                free(str);
+            }
+            lyd_free_withsiblings(node);
+        }
+        lyd_free_withsiblings(st->dt);
+        st->dt = NULL;
+    }
 }
 
 int
@@ -702,6 +852,7 @@ main(void)
                     cmocka_unit_test_teardown(test_parse_numbers, teardown_f),
                     cmocka_unit_test_teardown(test_parse_error_numbers, teardown_f),
                     cmocka_unit_test_teardown(test_parse_string, teardown_f),
+                    cmocka_unit_test_teardown(test_parse_stream, teardown_f),
                     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
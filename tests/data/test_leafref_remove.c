@@ -124,12 +124,78 @@ test_leafref_unlink2(void **state)
     assert_int_equal(r, 0);
 }
 
+static void
+test_leafref_targets(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *data, *node;
+    struct lyd_node_leaf_list *leaf;
+    const char *yang = "module lref-targets {namespace urn:lref-targets; prefix lt;"
+        "container top {"
+        "  list one-key {key name; leaf name {type string;}}"
+        "  list two-keys {key \"a b\"; leaf a {type string;} leaf b {type string;}}"
+        "  leaf-list llist {type string;}"
+        "  leaf single {type string;}"
+        "  container refs {"
+        "    leaf key-abs {type leafref {path \"/lt:top/lt:one-key/lt:name\";}}"
+        "    leaf key-rel {type leafref {path \"../../one-key/name\";}}"
+        "    leaf llist {type leafref {path \"/top/llist\";}}"
+        "    leaf single {type leafref {path \"../../single\";}}"
+        "    leaf two-keys {type leafref {path \"/top/two-keys/b\";}}"
+        "    leaf pred {type leafref {path \"/top/two-keys[a = current()/../key-abs]/b\";}}"
+        "  }"
+        "}}";
+    const char *xml = "<top xmlns=\"urn:lref-targets\">"
+        "<one-key><name>a</name></one-key><one-key><name>b</name></one-key><one-key><name>c</name></one-key>"
+        "<one-key><name>d</name></one-key><one-key><name>e</name></one-key>"
+        "<two-keys><a>b</a><b>x</b></two-keys><two-keys><a>c</a><b>y</b></two-keys>"
+        "<llist>p</llist><llist>q</llist><llist>r</llist><llist>s</llist><llist>t</llist>"
+        "<single>z</single>"
+        "<refs><key-abs>c</key-abs><key-rel>e</key-rel><llist>s</llist><single>z</single><two-keys>y</two-keys>"
+        "<pred>y</pred></refs>"
+        "</top>";
+    const char *targets[] = {"c", "e", "s", "z", "y", "y"};
+    int i, j;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, yang, LYS_IN_YANG), NULL);
+
+    data = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(data, NULL);
+
+    /* all the leafrefs point to the correct nodes */
+    i = 0;
+    LY_TREE_FOR(data->child->prev->child, node) {
+        leaf = (struct lyd_node_leaf_list *)node;
+        assert_int_equal(leaf->value_type, LY_TYPE_LEAFREF);
+        assert_ptr_not_equal(leaf->value.leafref, NULL);
+        assert_string_equal(((struct lyd_node_leaf_list *)leaf->value.leafref)->value_str, targets[i]);
+        ++i;
+    }
+    assert_int_equal(i, 6);
+
+    /* missing targets */
+    for (i = 0; i < 5; ++i) {
+        node = data->child->prev->child;
+        for (j = 0; j < i; ++j) {
+            node = node->next;
+        }
+        assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, "none"), 0);
+        assert_int_not_equal(lyd_validate(&data, LYD_OPT_CONFIG, NULL), 0);
+        assert_int_equal(ly_vecode(st->ctx), LYVE_NOLEAFREF);
+        assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, targets[i]), 0);
+        assert_int_equal(lyd_validate(&data, LYD_OPT_CONFIG, NULL), 0);
+    }
+
+    lyd_free_withsiblings(data);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
                     cmocka_unit_test_setup_teardown(test_leafref_free, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_leafref_unlink, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_leafref_unlink2, setup_f, teardown_f), };
+                    cmocka_unit_test_setup_teardown(test_leafref_unlink2, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_leafref_targets, setup_f, teardown_f), };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
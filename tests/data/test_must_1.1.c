@@ -181,13 +181,48 @@ test_notif(void **state)
     assert_int_equal(lyd_validate(&(st->dt), LYD_OPT_NOTIF, NULL), 0);
 }
 
+static void
+test_cached_expr(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const char *yang1 = "module must-cache {namespace urn:must-cache; prefix mc;"
+                        "container c {leaf a {type uint8; must \". > 5\";} leaf b {type uint8; must \". > 5\";}}}";
+    const char *yang2 = "module must-cache {namespace urn:must-cache; prefix mc;"
+                        "container c {leaf a {type uint8; must \". < 5\";} leaf b {type uint8; must \"../a < .\";}}}";
+    const char *data = "<c xmlns=\"urn:must-cache\"><a>3</a><b>7</b></c>";
+    int i;
+
+    st->mod = lys_parse_mem(st->ctx, yang1, LYS_IN_YANG);
+    assert_ptr_not_equal(st->mod, NULL);
+
+    /* the same conditions evaluated repeatedly */
+    for (i = 0; i < 3; ++i) {
+        st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+        assert_ptr_equal(st->dt, NULL);
+        assert_int_equal(ly_vecode(st->ctx), LYVE_NOMUST);
+    }
+
+    /* the context changes, the conditions are different now */
+    assert_int_equal(ly_ctx_remove_module(st->mod, NULL), 0);
+    st->mod = lys_parse_mem(st->ctx, yang2, LYS_IN_YANG);
+    assert_ptr_not_equal(st->mod, NULL);
+
+    for (i = 0; i < 3; ++i) {
+        st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+        assert_ptr_not_equal(st->dt, NULL);
+        lyd_free_withsiblings(st->dt);
+        st->dt = NULL;
+    }
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
                     cmocka_unit_test_setup_teardown(test_dependency_rpc, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_dependency_action, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_inout, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_notif, setup_f, teardown_f)
+                    cmocka_unit_test_setup_teardown(test_notif, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_cached_expr, setup_f, teardown_f)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
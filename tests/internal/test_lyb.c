@@ -502,6 +502,77 @@ test_union2(void **state)
     check_data_tree(st->dt1, st->dt2);
 }
 
+static void
+test_union_native(void **state)
+{
+    struct state *st = (*state);
+    struct lys_node_leaf *sleaf;
+    struct lyd_node_leaf_list *leaf;
+    struct lyd_node *iter;
+    int ret;
+    const char *lyb_union_mod =
+    "module lyb-union {"
+    "   namespace \"urn:lyb-union\";"
+    "   prefix u;"
+    "   identity base1;"
+    "   identity base2;"
+    "   identity id1 { base base1; }"
+    "   identity id2 { base base2; }"
+    "   typedef num {"
+    "       type union {"
+    "           type int8 { range \"1..10\"; }"
+    "           type decimal64 { fraction-digits 2; range \"20..30\"; }"
+    "       }"
+    "   }"
+    "   container cont {"
+    "       leaf enm { type union { type enumeration { enum a; enum b; } type enumeration { enum c; enum d; } } }"
+    "       leaf dec { type union { type decimal64 { fraction-digits 2; range \"0..1\"; } type decimal64 { fraction-digits 3; } } }"
+    "       leaf bts { type union { type bits { bit x; bit y; } type bits { bit y; bit z; } } }"
+    "       leaf idr { type union { type identityref { base base1; } type identityref { base base2; } } }"
+    "       leaf str { type union { type string { pattern \"[0-9]+\"; } type string { pattern \"[a-z]+\"; } } }"
+    "       leaf-list nested { type union { type num; type uint64; type string; } }"
+    "   }"
+    "}";
+    const char *xml =
+    "<cont xmlns=\"urn:lyb-union\">"
+    "<enm>d</enm>"
+    "<dec>2.5</dec>"
+    "<bts>y z</bts>"
+    "<idr xmlns:u=\"urn:lyb-union\">u:id2</idr>"
+    "<str>abc</str>"
+    "<nested>5</nested>"
+    "<nested>25.5</nested>"
+    "<nested>100</nested>"
+    "<nested>abc</nested>"
+    "</cont>";
+
+    assert_non_null(lys_parse_mem(st->ctx, lyb_union_mod, LYS_YANG));
+
+    st->dt1 = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+
+    /* values are read as the member types they were stored as */
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+
+    check_data_tree(st->dt1, st->dt2);
+
+    LY_TREE_FOR(st->dt2->child, iter) {
+        if (!strcmp(iter->schema->name, "bts")) {
+            break;
+        }
+    }
+    assert_non_null(iter);
+    leaf = (struct lyd_node_leaf_list *)iter;
+    sleaf = (struct lys_node_leaf *)iter->schema;
+    assert_int_equal(leaf->value_type, LY_TYPE_BITS);
+    assert_ptr_equal(leaf->value.bit[0], &sleaf->type.info.uni.types[1].info.bits.bit[0]);
+    assert_ptr_equal(leaf->value.bit[1], &sleaf->type.info.uni.types[1].info.bits.bit[1]);
+}
+
 static void
 test_collisions(void **state)
 {
@@ -658,6 +729,319 @@ test_leafrefs(void **state)
     check_data_tree(st->dt1, st->dt2);
 }
 
+static void
+test_version1(void **state)
+{
+    struct state *st = (*state);
+    int ret, i;
+    char xml[512], descr[301];
+    const char *lyb_v1_mod =
+    "module lyb-v1 {"
+    "   namespace \"urn:lyb-v1\";"
+    "   prefix v1;"
+    "   container cont {"
+    "       list item {"
+    "           key name;"
+    "           leaf name { type string; }"
+    "           leaf descr { type string; }"
+    "           leaf-list mtu { type uint16; }"
+    "       }"
+    "   }"
+    "   leaf top { type string; }"
+    "}";
+    /* printed by the LYB v1 printer, the long value is split into several chunks */
+    const unsigned char lyb_v1_data[] = {
+        0x6c, 0x79, 0x62, 0x00, 0x01, 0x00, 0x06, 0x00, 0x6c, 0x79, 0x62, 0x2d,
+        0x76, 0x31, 0x00, 0x00, 0xff, 0x03, 0x06, 0x00, 0x6c, 0x79, 0x62, 0x2d,
+        0x76, 0x31, 0x00, 0x00, 0xae, 0x00, 0xff, 0x02, 0x98, 0x00, 0x07, 0x00,
+        0x8d, 0x00, 0x0a, 0x65, 0x74, 0x68, 0x30, 0xff, 0x00, 0xde, 0x00, 0x0a,
+        0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c,
+        0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+        0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+        0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76,
+        0x77, 0x78, 0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+        0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74,
+        0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
+        0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+        0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x61, 0x62, 0x63, 0x64,
+        0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70,
+        0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x61, 0x62,
+        0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e,
+        0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a,
+        0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c,
+        0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+        0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+        0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76,
+        0x77, 0x78, 0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+        0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74,
+        0x75, 0x76, 0x77, 0x58, 0x06, 0x78, 0x79, 0x7a, 0x61, 0x62, 0x63, 0x64,
+        0x65, 0x66, 0x67, 0x68, 0x69, 0x43, 0x03, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e,
+        0x6f, 0x70, 0x71, 0x72, 0x30, 0x00, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+        0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+        0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76,
+        0x77, 0x78, 0x79, 0x7a, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+        0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x05, 0x00, 0xdd, 0x00, 0x0f, 0xdc,
+        0x05, 0x05, 0x00, 0xdd, 0x00, 0x0f, 0x28, 0x23, 0x09, 0x01, 0x98, 0x00,
+        0x07, 0x00, 0x8d, 0x00, 0x0a, 0x65, 0x74, 0x68, 0x31, 0x12, 0x00, 0x06,
+        0x00, 0x6c, 0x79, 0x62, 0x2d, 0x76, 0x31, 0x00, 0x00, 0x80, 0x00, 0x0a,
+        0x76, 0x61, 0x6c, 0x75, 0x65, 0x00
+    };
+
+    assert_non_null(lys_parse_mem(st->ctx, lyb_v1_mod, LYS_YANG));
+
+    for (i = 0; i < 300; ++i) {
+        descr[i] = 'a' + i % 26;
+    }
+    descr[300] = '\0';
+    sprintf(xml, "<cont xmlns=\"urn:lyb-v1\"><item><name>eth0</name><descr>%s</descr><mtu>1500</mtu><mtu>9000</mtu></item>"
+            "<item><name>eth1</name></item></cont><top xmlns=\"urn:lyb-v1\">value</top>", descr);
+    st->dt1 = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    /* v1 data are still read */
+    assert_int_equal(lyd_lyb_data_length((const char *)lyb_v1_data), sizeof lyb_v1_data);
+    st->dt2 = lyd_parse_mem(st->ctx, (const char *)lyb_v1_data, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+    lyd_free_withsiblings(st->dt2);
+
+    /* v2 data with the offsets of the top-level subtrees are shorter */
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    assert_int_equal(st->mem[3] & LYB_VERSION_MASK, LYB_VERSION_2);
+    assert_true(st->mem[3] & LYB_HEADER_OFFSETS);
+    assert_true(lyd_lyb_data_length(st->mem) < (signed)sizeof lyb_v1_data);
+
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+    lyd_free_withsiblings(st->dt2);
+
+    /* v1 data cannot be parsed lazily */
+    st->dt2 = lyd_parse_mem(st->ctx, (const char *)lyb_v1_data, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_LAZY);
+    assert_ptr_not_equal(st->dt2, NULL);
+    check_data_tree(st->dt1, st->dt2);
+}
+
+static void
+test_lazy(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *item, *dup;
+    struct ly_set *set;
+    int ret, i;
+    char xml[4096];
+    const char *lyb_lazy_mod =
+    "module lyb-lazy {"
+    "   namespace \"urn:lyb-lazy\";"
+    "   prefix l;"
+    "   container cont {"
+    "       list item {"
+    "           key name;"
+    "           leaf name { type string; }"
+    "           container sub {"
+    "               leaf descr { type string; }"
+    "           }"
+    "       }"
+    "       leaf ref { type leafref { path \"../item/name\"; } }"
+    "   }"
+    "}";
+
+    assert_non_null(lys_parse_mem(st->ctx, lyb_lazy_mod, LYS_YANG));
+
+    strcpy(xml, "<cont xmlns=\"urn:lyb-lazy\">");
+    for (i = 0; i < 20; ++i) {
+        sprintf(xml + strlen(xml), "<item><name>eth%d</name><sub><descr>port %d</descr></sub></item>", i, i);
+    }
+    strcat(xml, "<ref>eth5</ref></cont>");
+    st->dt1 = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt1, NULL);
+
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+
+    /* only the top-level node is parsed, the input is not needed afterwards */
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_LAZY);
+    assert_ptr_not_equal(st->dt2, NULL);
+    free(st->mem);
+    st->mem = NULL;
+    assert_null(st->dt2->child);
+
+    /* parsed on access, only the subtrees on the path */
+    set = lyd_find_path(st->dt2, "/lyb-lazy:cont/item[name='eth7']/sub/descr");
+    assert_non_null(set);
+    assert_int_equal(set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "port 7");
+    ly_set_free(set);
+
+    set = lyd_find_path(st->dt2, "/lyb-lazy:cont/item[name='eth3']");
+    assert_non_null(set);
+    assert_int_equal(set->number, 1);
+    item = set->set.d[0];
+    ly_set_free(set);
+    assert_string_equal(item->child->schema->name, "name");
+    assert_null(item->child->next);
+
+    /* the leafref was resolved when its parent was parsed */
+    set = lyd_find_path(st->dt2, "/lyb-lazy:cont/ref");
+    assert_non_null(set);
+    assert_int_equal(set->number, 1);
+    assert_ptr_not_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value.leafref, NULL);
+    ly_set_free(set);
+
+    /* children parsed after the union was sorted, still in the document order */
+    set = lyd_find_path(st->dt2, "(/lyb-lazy:cont/item[name='eth12'] | /lyb-lazy:cont/item[name='eth2'])/sub/descr");
+    assert_non_null(set);
+    assert_int_equal(set->number, 2);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "port 2");
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[1])->value_str, "port 12");
+    ly_set_free(set);
+
+    /* duplicated whole */
+    dup = lyd_dup(item, LYD_DUP_OPT_RECURSIVE);
+    assert_non_null(dup);
+    assert_non_null(item->child->next);
+    assert_string_equal(((struct lyd_node_leaf_list *)dup->child->next->child)->value_str, "port 3");
+    lyd_free(dup);
+
+    /* the rest parsed explicitly */
+    assert_int_equal(lyd_lyb_load(st->dt2), EXIT_SUCCESS);
+    check_data_tree(st->dt1, st->dt2);
+
+    /* freed without ever being parsed */
+    lyd_free_withsiblings(st->dt2);
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    st->dt2 = lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_LAZY);
+    assert_ptr_not_equal(st->dt2, NULL);
+}
+
+static struct lyd_node *
+parse_lazy(struct state *st)
+{
+    return lyd_parse_mem(st->ctx, st->mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT | LYD_OPT_LYB_LAZY);
+}
+
+static void
+test_lazy_complete(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+    struct lyd_node *c, *other;
+    struct lyd_difflist *diff;
+    struct ly_set *set;
+    char *xml, *str;
+    int ret;
+    const char *lyb_lazy_mod =
+    "module lyb-lazy-complete {"
+    "   namespace \"urn:lz\";"
+    "   prefix lz;"
+    "   container top {"
+    "       container c {"
+    "           leaf m { type string; mandatory true; }"
+    "           leaf x { type string; must \". != 'bad'\"; }"
+    "           leaf-list y { type string; }"
+    "       }"
+    "   }"
+    "}";
+
+    mod = lys_parse_mem(st->ctx, lyb_lazy_mod, LYS_YANG);
+    assert_non_null(mod);
+
+    st->dt1 = lyd_parse_mem(st->ctx, "<top xmlns=\"urn:lz\"><c><m>1</m><x>a</x><y>1</y><y>2</y></c></top>", LYD_XML,
+                            LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_not_equal(st->dt1, NULL);
+    ret = lyd_print_mem(&st->mem, st->dt1, LYD_LYB, LYP_WITHSIBLINGS);
+    assert_int_equal(ret, 0);
+    lyd_print_mem(&xml, st->dt1, LYD_XML, LYP_WITHSIBLINGS);
+
+    /* validated whole, also in parallel */
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_null(st->dt2->child);
+    assert_int_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_int_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG | LYD_OPT_VAL_PARALLEL, NULL), 0);
+    lyd_free_withsiblings(st->dt2);
+
+    /* printed whole */
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    lyd_print_mem(&str, st->dt2, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(str, xml);
+    free(str);
+    lyd_free_withsiblings(st->dt2);
+
+    /* instances found in the not yet parsed children */
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_null(st->dt2->child);
+    set = lyd_find_instance(st->dt2, ly_ctx_get_node(st->ctx, NULL, "/lyb-lazy-complete:top/c/y", 0));
+    assert_non_null(set);
+    assert_int_equal(set->number, 2);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "1");
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[1])->value_str, "2");
+    ly_set_free(set);
+    lyd_free_withsiblings(st->dt2);
+
+    /* a new instance is added next to the not yet parsed one, as into a parsed tree */
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    set = lyd_find_path(st->dt2, "/lyb-lazy-complete:top/c");
+    assert_non_null(set);
+    assert_int_equal(set->number, 1);
+    c = set->set.d[0];
+    ly_set_free(set);
+    assert_null(c->child);
+    other = lyd_new_leaf(c, mod, "x", "b");
+    assert_non_null(other);
+    assert_string_equal(c->child->schema->name, "m");
+    assert_string_equal(c->child->prev->schema->name, "x");
+    assert_int_not_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_TOOMANY);
+    lyd_free(other);
+    set = lyd_find_path(st->dt2, "/lyb-lazy-complete:top/c/x");
+    assert_non_null(set);
+    assert_int_equal(set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "a");
+    ly_set_free(set);
+    assert_int_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+    lyd_free_withsiblings(st->dt2);
+
+    /* a duplicate of a not yet parsed instance */
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    set = lyd_find_path(st->dt2, "/lyb-lazy-complete:top/c");
+    assert_non_null(set);
+    c = set->set.d[0];
+    ly_set_free(set);
+    other = lyd_new_leaf(c, mod, "y", "2");
+    assert_non_null(other);
+    assert_int_not_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode(st->ctx), LYVE_DUPLEAFLIST);
+    lyd_free(other);
+    assert_int_equal(lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL), 0);
+    lyd_free_withsiblings(st->dt2);
+
+    /* merged and compared whole */
+    st->dt2 = parse_lazy(st);
+    assert_ptr_not_equal(st->dt2, NULL);
+    other = parse_lazy(st);
+    assert_ptr_not_equal(other, NULL);
+    diff = lyd_diff(st->dt1, other, 0);
+    assert_non_null(diff);
+    assert_int_equal(diff->type[0], LYD_DIFF_END);
+    lyd_free_diff(diff);
+    assert_int_equal(lyd_merge(st->dt2, other, LYD_OPT_DESTRUCT), 0);
+    lyd_print_mem(&str, st->dt2, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(str, xml);
+    free(str);
+
+    free(xml);
+}
+
 int
 main(void)
 {
@@ -671,11 +1055,15 @@ main(void)
         cmocka_unit_test_setup_teardown(test_many_child_annot, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_union, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_union2, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_union_native, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_collisions, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_anydata, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_submodule_feature, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_coliding_augments, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_leafrefs, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_version1, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lazy, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lazy_complete, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,144 @@
+/**
+ * @file arena.c
+ * @brief performance test - parsing and freeing data allocated separately and from a memory arena.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module arena-perf {"
+	"  namespace urn:libyang:performance:arena;"
+	"  prefix ap;"
+	"  container interfaces {"
+	"    list interface {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf description {type string;}"
+	"      leaf mtu {type uint16;}"
+	"      leaf enabled {type boolean;}"
+	"      container statistics {"
+	"        leaf in-octets {type uint64;}"
+	"        leaf out-octets {type uint64;}"
+	"      }"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+parse_free(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, int rounds, double *parse,
+           double *free_)
+{
+	struct lyd_node *tree;
+	double start;
+	int i;
+
+	*parse = *free_ = 0;
+	for (i = 0; i < rounds; ++i) {
+		start = now();
+		tree = lyd_parse_mem(ctx, data, format, options);
+		if (!tree) {
+			fprintf(stderr, "Failed to parse data.\n");
+			return 1;
+		}
+		*parse += now() - start;
+
+		start = now();
+		lyd_free_withsiblings(tree);
+		*free_ += now() - start;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *node, *stats;
+	LYD_FORMAT formats[] = {LYD_XML, LYD_LYB};
+	const char *names[] = {"xml", "lyb"};
+	char *str = NULL, name[32];
+	double parse, free_;
+	int i, j, items = 10000, rounds = 10;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	data = lyd_new_path(NULL, ctx, "/arena-perf:interfaces", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		sprintf(name, "GigabitEthernet0/%d", i);
+		node = lyd_new(data, NULL, "interface");
+		lyd_new_leaf(node, NULL, "name", name);
+		lyd_new_leaf(node, NULL, "description", "uplink");
+		lyd_new_leaf(node, NULL, "mtu", "1500");
+		lyd_new_leaf(node, NULL, "enabled", "true");
+		stats = lyd_new(node, NULL, "statistics");
+		lyd_new_leaf(stats, NULL, "in-octets", "123456789");
+		lyd_new_leaf(stats, NULL, "out-octets", "987654321");
+	}
+
+	for (j = 0; j < 2; ++j) {
+		lyd_print_mem(&str, data, formats[j], LYP_WITHSIBLINGS);
+
+		if (parse_free(ctx, str, formats[j], LYD_OPT_CONFIG, rounds, &parse, &free_)) {
+			goto cleanup;
+		}
+		fprintf(stdout, " %s separate  parse %8.3fs free %8.3fs\n", names[j], parse, free_);
+
+		if (parse_free(ctx, str, formats[j], LYD_OPT_CONFIG | LYD_OPT_ARENA, rounds, &parse, &free_)) {
+			goto cleanup;
+		}
+		fprintf(stdout, " %s arena     parse %8.3fs free %8.3fs\n", names[j], parse, free_);
+
+		free(str);
+		str = NULL;
+	}
+
+cleanup:
+	free(str);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
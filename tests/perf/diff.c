@@ -0,0 +1,215 @@
+/**
+ * @file diff.c
+ * @brief performance test - diff of data trees with large lists, scaled from the callgrind lists data.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+#define SCHEMA "../callgrind/files/lists.yang"
+#define DATA "../callgrind/files/lists.xml"
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *
+read_file(const char *path)
+{
+	FILE *f;
+	char *buf;
+	long len;
+
+	f = fopen(path, "r");
+	if (!f) {
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	/* room for the ordered-by statements */
+	buf = malloc(len + 64);
+	if (!buf || (fread(buf, 1, len, f) != (size_t)len)) {
+		free(buf);
+		fclose(f);
+		return NULL;
+	}
+	buf[len] = '\0';
+	fclose(f);
+	return buf;
+}
+
+static int
+insert_after(char *schema, const char *stmt, const char *str)
+{
+	char *ptr;
+
+	ptr = strstr(schema, stmt);
+	if (!ptr) {
+		return 1;
+	}
+	ptr += strlen(stmt);
+	memmove(ptr + strlen(str), ptr, strlen(ptr) + 1);
+	memcpy(ptr, str, strlen(str));
+	return 0;
+}
+
+/* the template values of the instances of one schema node */
+static char **
+template_values(struct lyd_node *cont, const char *name, int *count)
+{
+	struct lyd_node *node;
+	char **values = NULL;
+
+	*count = 0;
+	LY_TREE_FOR(cont->child, node) {
+		if (strcmp(node->schema->name, name)) {
+			continue;
+		}
+		values = realloc(values, (*count + 1) * sizeof *values);
+		/* the list key or the leaf-list value */
+		values[(*count)++] = (char *)((struct lyd_node_leaf_list *)((node->schema->nodetype == LYS_LIST) ? node->child : node))->value_str;
+	}
+	return values;
+}
+
+/* the template instances copied scale times, shuffled, with some replaced and changed in the second tree */
+static struct lyd_node *
+scale_data(const struct lys_module *mod, struct lyd_node *templ, int scale, int shuffle)
+{
+	struct lyd_node *cont, *node;
+	char **keys, **values, value[64];
+	int i, k, key_count, value_count, total;
+
+	keys = template_values(templ, "list1", &key_count);
+	values = template_values(templ, "llist1", &value_count);
+
+	cont = lyd_new(NULL, mod, "cont");
+	total = key_count * scale;
+	for (i = 0; i < total; ++i) {
+		k = shuffle ? (int)(((long)i * 7919) % total) : i;
+		sprintf(value, "%s-%d%s", keys[k % key_count], k / key_count, (shuffle && !(k % 1000)) ? "-new" : "");
+		node = lyd_new(cont, mod, "list1");
+		if (!node || !lyd_new_leaf(node, mod, "key1", value)
+				|| !lyd_new_leaf(node, mod, "leaf1", (shuffle && !(k % 100)) ? "1" : "0")) {
+			return NULL;
+		}
+	}
+	total = value_count * scale;
+	for (i = 0; i < total; ++i) {
+		k = shuffle ? (int)(((long)i * 7919) % total) : i;
+		sprintf(value, "%s-%d%s", values[k % value_count], k / value_count, (shuffle && !(k % 1000)) ? "-new" : "");
+		if (!lyd_new_leaf(cont, mod, "llist1", value)) {
+			return NULL;
+		}
+	}
+
+	free(keys);
+	free(values);
+	return cont;
+}
+
+static int
+run(const char *schema, const char *data, int scale, const char *desc)
+{
+	struct ly_ctx *ctx;
+	const struct lys_module *mod;
+	struct lyd_node *templ, *first, *second, *iter;
+	struct lyd_difflist *diff;
+	int i, count;
+	double start;
+
+	ctx = ly_ctx_new(NULL, 0);
+	mod = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+	if (!mod) {
+		fprintf(stderr, "Failed to load the schema.\n");
+		return 1;
+	}
+	templ = lyd_parse_path(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+	if (!templ) {
+		fprintf(stderr, "Failed to load the data.\n");
+		return 1;
+	}
+
+	first = scale_data(mod, templ, scale, 0);
+	second = scale_data(mod, templ, scale, 1);
+	if (!first || !second) {
+		fprintf(stderr, "Failed to create the data.\n");
+		return 1;
+	}
+	for (count = 0, iter = templ->child; iter; iter = iter->next, ++count);
+	count *= scale;
+
+	start = now();
+	diff = lyd_diff(first, second, 0);
+	if (!diff) {
+		fprintf(stderr, "Failed to diff the data.\n");
+		return 1;
+	}
+	for (i = 0; diff->type[i] != LYD_DIFF_END; ++i);
+	fprintf(stdout, " diff %8d %s list and leaf-list instances %8.3fs (%d changes)\n", count, desc, now() - start, i);
+
+	lyd_free_diff(diff);
+	lyd_free_withsiblings(first);
+	lyd_free_withsiblings(second);
+	lyd_free_withsiblings(templ);
+	ly_ctx_destroy(ctx, NULL);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *schema_path = SCHEMA, *data_path = DATA;
+	char *schema;
+	int scale = 100;
+
+	if (argc > 1) {
+		scale = atoi(argv[1]);
+	}
+	if (argc > 3) {
+		schema_path = argv[2];
+		data_path = argv[3];
+	}
+
+	schema = read_file(schema_path);
+	if (!schema) {
+		fprintf(stderr, "Failed to read \"%s\".\n", schema_path);
+		return 1;
+	}
+
+	if (run(schema, data_path, scale, "system-ordered")) {
+		return 1;
+	}
+
+	/* the same lists ordered by the user, so the moves are detected too */
+	if (insert_after(schema, "list list1 {", " ordered-by user;")
+			|| insert_after(schema, "leaf-list llist1 {", " ordered-by user;")) {
+		fprintf(stderr, "Unexpected schema \"%s\".\n", schema_path);
+		return 1;
+	}
+	if (run(schema, data_path, scale, "user-ordered")) {
+		return 1;
+	}
+
+	free(schema);
+	return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file escape.c
+ * @brief performance test - printing (escaping) large string values in XML and JSON.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module escape {namespace urn:perf:escape; prefix e;"
+"  container c {leaf bin {type binary;} leaf text {type string;}}}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *
+create_value(size_t len, int text)
+{
+	const char *b64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const char *words = "The <value> of \"leaf\" & its description\\n ";
+	char *value;
+	size_t i;
+
+	value = malloc(len + 1);
+	if (!value) {
+		return NULL;
+	}
+	for (i = 0; i < len; ++i) {
+		value[i] = text ? words[i % strlen(words)] : b64[(i * 7) % 64];
+	}
+	value[len] = '\0';
+
+	return value;
+}
+
+static int
+print(struct lyd_node *node, LYD_FORMAT format, const char *name, size_t len, int count)
+{
+	char *str;
+	double start;
+	int i;
+
+	start = now();
+	for (i = 0; i < count; ++i) {
+		if (lyd_print_mem(&str, node, format, 0)) {
+			return 1;
+		}
+		free(str);
+	}
+	fprintf(stdout, " %-4s %-6s %8.1f MB/s\n", format == LYD_XML ? "XML" : "JSON", name,
+	        (double)len * count / (now() - start) / 1e6);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	const struct lys_module *mod;
+	struct lyd_node *root, *bin, *text;
+	char *value;
+	size_t len = 4 * 1024 * 1024;
+	int count = 10;
+
+	if (argc > 1) {
+		len = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		count = atoi(argv[2]);
+	}
+
+	ctx = ly_ctx_new(NULL, 0);
+	mod = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+	if (!mod) {
+		fprintf(stderr, "Failed to load the schema.\n");
+		return 1;
+	}
+
+	/* base64 value (nothing to escape) and text with some characters to escape */
+	root = lyd_new(NULL, mod, "c");
+	value = create_value(len, 0);
+	bin = lyd_new_leaf(root, mod, "bin", value);
+	free(value);
+	value = create_value(len, 1);
+	text = lyd_new_leaf(root, mod, "text", value);
+	free(value);
+	if (!bin || !text) {
+		fprintf(stderr, "Failed to create the data.\n");
+		return 1;
+	}
+
+	lyd_unlink(text);
+	if (print(root, LYD_XML, "binary", len, count) || print(root, LYD_JSON, "binary", len, count)) {
+		fprintf(stderr, "Failed to print the data.\n");
+		return 1;
+	}
+	lyd_insert(root, text);
+	lyd_unlink(bin);
+	if (print(root, LYD_XML, "text", len, count) || print(root, LYD_JSON, "text", len, count)) {
+		fprintf(stderr, "Failed to print the data.\n");
+		return 1;
+	}
+
+	lyd_free(bin);
+	lyd_free_withsiblings(root);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
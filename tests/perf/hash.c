@@ -0,0 +1,139 @@
+/**
+ * @file hash.c
+ * @brief performance test - hashing strings in the dictionary.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+#define STRINGS 100000
+
+static const char *idents[] = {
+	"ietf-interfaces", "interfaces", "interface", "name", "description", "type", "enabled",
+	"link-up-down-trap-enable", "admin-status", "oper-status", "last-change", "if-index",
+	"phys-address", "higher-layer-if", "lower-layer-if", "speed", "statistics", "discontinuity-time",
+	"in-octets", "in-unicast-pkts", "in-broadcast-pkts", "in-multicast-pkts", "in-discards",
+	"in-errors", "in-unknown-protos", "out-octets", "out-unicast-pkts", "out-broadcast-pkts",
+	"ietf-ip", "ipv4", "ipv6", "address", "ip", "prefix-length", "netmask", "origin", "neighbor",
+	"link-layer-address", "forwarding", "mtu", "dup-addr-detect-transmits", "autoconf",
+	"create-global-addresses", "temporary-valid-lifetime", "ietf-netconf-acm", "nacm", "rule-list",
+	"module-name", "access-operations", "action", "urn:ietf:params:xml:ns:yang:ietf-interfaces"
+};
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* realistic YANG identifiers and key values */
+static char *
+gen_string(int i)
+{
+	char buf[128];
+	int n = sizeof idents / sizeof *idents;
+
+	switch (i % 5) {
+	case 0:
+		sprintf(buf, "%s-%d", idents[i % n], i);
+		break;
+	case 1:
+		sprintf(buf, "GigabitEthernet%d/%d/%d", i % 4, (i / 4) % 8, i / 32);
+		break;
+	case 2:
+		sprintf(buf, "10.%d.%d.%d", (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff);
+		break;
+	case 3:
+		sprintf(buf, "2001:db8:%x::%x", i >> 8, i & 0xff);
+		break;
+	default:
+		sprintf(buf, "/%s:%s/%s[name='eth%d']/%s", idents[0], idents[1], idents[2], i, idents[i % n]);
+		break;
+	}
+
+	return strdup(buf);
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	char **strs;
+	const char **dict;
+	size_t bytes = 0;
+	double start, secs;
+	int i, j, rounds = 10;
+
+	if (argc > 1) {
+		rounds = atoi(argv[1]);
+	}
+
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	strs = malloc(STRINGS * sizeof *strs);
+	dict = malloc(STRINGS * sizeof *dict);
+	for (i = 0; i < STRINGS; ++i) {
+		strs[i] = gen_string(i);
+		bytes += strlen(strs[i]);
+	}
+	fprintf(stdout, " %d strings, average length %.1f\n", STRINGS, (double)bytes / STRINGS);
+
+	/* new strings */
+	start = now();
+	for (j = 0; j < rounds; ++j) {
+		for (i = 0; i < STRINGS; ++i) {
+			dict[i] = lydict_insert(ctx, strs[i], 0);
+		}
+		for (i = 0; i < STRINGS; ++i) {
+			lydict_remove(ctx, dict[i]);
+		}
+	}
+	secs = now() - start;
+	fprintf(stdout, " insert+remove new  %8.1f ns/string\n", secs * 1e9 / (rounds * STRINGS));
+
+	/* strings already in the dictionary */
+	for (i = 0; i < STRINGS; ++i) {
+		dict[i] = lydict_insert(ctx, strs[i], 0);
+	}
+	start = now();
+	for (j = 0; j < rounds; ++j) {
+		for (i = 0; i < STRINGS; ++i) {
+			lydict_insert(ctx, strs[i], 0);
+		}
+		for (i = 0; i < STRINGS; ++i) {
+			lydict_remove(ctx, dict[i]);
+		}
+	}
+	secs = now() - start;
+	fprintf(stdout, " insert+remove dup  %8.1f ns/string\n", secs * 1e9 / (rounds * STRINGS));
+
+	for (i = 0; i < STRINGS; ++i) {
+		lydict_remove(ctx, dict[i]);
+		free(strs[i]);
+	}
+	free(strs);
+	free(dict);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
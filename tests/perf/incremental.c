@@ -0,0 +1,143 @@
+/**
+ * @file incremental.c
+ * @brief performance test - full and incremental validation of a small change in a large data tree.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module val-perf {"
+	"  namespace urn:libyang:performance:validate;"
+	"  prefix vp;"
+	"  container interfaces {"
+	"    list interface {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf mtu {type uint16; default 1500; must \". >= 68\";}"
+	"      leaf enabled {type boolean; default true;}"
+	"      leaf description {type string;}"
+	"    }"
+	"  }"
+	"  container vrfs {"
+	"    list vrf {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf-list interface {type leafref {path \"/vp:interfaces/vp:interface/vp:name\";}}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* change the description of a single interface and validate the whole tree */
+static double
+change_validate(struct lyd_node **data, struct lyd_node **descs, int items, int rounds, int options)
+{
+	char value[32];
+	double start, secs = 0;
+	int i;
+
+	for (i = 0; i < rounds; ++i) {
+		sprintf(value, "round %d", i);
+		lyd_change_leaf((struct lyd_node_leaf_list *)descs[(i * 7919) % items], value);
+
+		start = now();
+		if (lyd_validate(data, options, NULL)) {
+			fprintf(stderr, "Failed to validate data.\n");
+			return -1;
+		}
+		secs += now() - start;
+	}
+
+	return secs;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *vrfs, *vrf = NULL, *node, **descs = NULL;
+	char name[32];
+	double full, incr;
+	int i, items = 10000, rounds = 20;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data, every interface is referenced from a VRF */
+	descs = malloc(items * sizeof *descs);
+	data = lyd_new_path(NULL, ctx, "/val-perf:interfaces", NULL, 0, 0);
+	vrfs = lyd_new_path(data, ctx, "/val-perf:vrfs", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		sprintf(name, "GigabitEthernet0/%d", i);
+		node = lyd_new(data, NULL, "interface");
+		lyd_new_leaf(node, NULL, "name", name);
+		descs[i] = lyd_new_leaf(node, NULL, "description", "uplink");
+
+		if (!(i % 16)) {
+			vrf = lyd_new(vrfs, NULL, "vrf");
+			sprintf(name, "vrf%d", i / 16);
+			lyd_new_leaf(vrf, NULL, "name", name);
+			sprintf(name, "GigabitEthernet0/%d", i);
+		}
+		lyd_new_leaf(vrf, NULL, "interface", name);
+	}
+	if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+		fprintf(stderr, "Failed to validate data.\n");
+		goto cleanup;
+	}
+
+	full = change_validate(&data, descs, items, rounds, LYD_OPT_CONFIG);
+	incr = change_validate(&data, descs, items, rounds, LYD_OPT_CONFIG | LYD_OPT_VAL_INCREMENTAL);
+	if ((full < 0) || (incr < 0)) {
+		goto cleanup;
+	}
+	fprintf(stdout, " %d interfaces, %d changes\n", items, rounds);
+	fprintf(stdout, " full        %10.1f us/validation\n", full * 1e6 / rounds);
+	fprintf(stdout, " incremental %10.1f us/validation speedup %.1f\n", incr * 1e6 / rounds, full / incr);
+
+cleanup:
+	free(descs);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file json_stream.c
+ * @brief performance test - parsing JSON data fed in chunks compared to parsing them at once.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module stream {namespace urn:perf:stream; prefix s;"
+"  container c {list l {key k; leaf k {type uint32;} leaf v {type string;}"
+"    container inner {leaf-list ll {type int8;} leaf e {type empty;}}}}}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *
+create_data(int count)
+{
+	char *data;
+	size_t len = 0;
+	int i;
+
+	data = malloc(100 * (count + 1));
+	if (!data) {
+		return NULL;
+	}
+
+	len += sprintf(data + len, "{\"stream:c\": {\"l\": [");
+	for (i = 0; i < count; ++i) {
+		len += sprintf(data + len, "%s{\"k\": %d, \"v\": \"value %d\", \"inner\": {\"ll\": [1, -2, 3], \"e\": [null]}}",
+		               i ? ", " : "", i, i);
+	}
+	sprintf(data + len, "]}}");
+
+	return data;
+}
+
+static struct lyd_node *
+parse_stream(struct ly_ctx *ctx, const char *data, size_t chunk)
+{
+	struct lyd_json_stream *stream;
+	struct lyd_node *node = NULL;
+	size_t len = strlen(data), i;
+
+	stream = lyd_json_stream_new(ctx, LYD_OPT_CONFIG);
+	for (i = 0; i < len; i += chunk) {
+		if (lyd_json_stream_feed(stream, &data[i], (len - i < chunk) ? len - i : chunk)) {
+			goto cleanup;
+		}
+	}
+	node = lyd_json_stream_finish(stream);
+
+cleanup:
+	lyd_json_stream_free(stream);
+	return node;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *node;
+	const size_t chunks[] = {16, 1460};
+	char *data;
+	int i, count = 50000;
+	double start;
+
+	if (argc > 1) {
+		count = atoi(argv[1]);
+	}
+
+	ctx = ly_ctx_new(NULL, 0);
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load the schema.\n");
+		return 1;
+	}
+
+	data = create_data(count);
+	if (!data) {
+		fprintf(stderr, "Failed to create the data.\n");
+		return 1;
+	}
+
+	start = now();
+	node = lyd_parse_mem(ctx, data, LYD_JSON, LYD_OPT_CONFIG);
+	if (!node) {
+		fprintf(stderr, "Failed to parse the data.\n");
+		return 1;
+	}
+	fprintf(stdout, " at once            %8d list instances %8.3fs\n", count, now() - start);
+	lyd_free_withsiblings(node);
+
+	for (i = 0; i < 2; ++i) {
+		start = now();
+		node = parse_stream(ctx, data, chunks[i]);
+		if (!node) {
+			fprintf(stderr, "Failed to parse the data.\n");
+			return 1;
+		}
+		fprintf(stdout, " in %4d-byte chunks %8d list instances %8.3fs\n", (int)chunks[i], count, now() - start);
+		lyd_free_withsiblings(node);
+	}
+
+	free(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
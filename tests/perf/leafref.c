@@ -0,0 +1,119 @@
+/**
+ * @file leafref.c
+ * @brief performance test - resolving leafrefs into a large keyed list.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module lref-perf {"
+	"  namespace urn:libyang:performance:leafref;"
+	"  prefix lp;"
+	"  container interfaces {"
+	"    list interface {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf mtu {type uint16;}"
+	"    }"
+	"  }"
+	"  container vrfs {"
+	"    list vrf {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf-list interface {type leafref {path \"/lp:interfaces/lp:interface/lp:name\";}}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *vrfs, *vrf = NULL, *node;
+	char name[32];
+	double start, secs;
+	int i, items = 10000, rounds = 5;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data, every interface is referenced from a VRF */
+	data = lyd_new_path(NULL, ctx, "/lref-perf:interfaces", NULL, 0, 0);
+	vrfs = lyd_new_path(data, ctx, "/lref-perf:vrfs", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		sprintf(name, "GigabitEthernet0/%d", i);
+		node = lyd_new(data, NULL, "interface");
+		lyd_new_leaf(node, NULL, "name", name);
+		lyd_new_leaf(node, NULL, "mtu", "1500");
+
+		if (!(i % 16)) {
+			vrf = lyd_new(vrfs, NULL, "vrf");
+			sprintf(name, "vrf%d", i / 16);
+			lyd_new_leaf(vrf, NULL, "name", name);
+			sprintf(name, "GigabitEthernet0/%d", i);
+		}
+		lyd_new_leaf(vrf, NULL, "interface", name);
+	}
+
+	for (i = 0, secs = 0; i < rounds; ++i) {
+		start = now();
+		if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+			fprintf(stderr, "Failed to validate data.\n");
+			goto cleanup;
+		}
+		secs += now() - start;
+
+		/* force the next validation of all the nodes */
+		node = data;
+		data = lyd_dup_withsiblings(node, LYD_DUP_OPT_RECURSIVE);
+		lyd_free_withsiblings(node);
+	}
+	fprintf(stdout, " %d references, %d rounds %8.3fs %10.1f us/reference\n", items, rounds, secs,
+	        secs * 1e6 / (rounds * items));
+
+cleanup:
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
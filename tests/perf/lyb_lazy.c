@@ -0,0 +1,143 @@
+/**
+ * @file lyb_lazy.c
+ * @brief performance test - parsing LYB data lazily and looking up a few nodes.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module lyb-lazy-perf {"
+	"  namespace urn:libyang:performance:lyb-lazy;"
+	"  prefix llp;"
+	"  container routes {"
+	"    list route {"
+	"      key prefix;"
+	"      leaf prefix {type string;}"
+	"      leaf next-hop {type string;}"
+	"      leaf description {type string;}"
+	"      leaf metric {type uint32;}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+parse_find(struct ly_ctx *ctx, const char *mem, int options, int items, int lookups, int rounds, const char *label)
+{
+	struct lyd_node *data;
+	struct ly_set *set;
+	char path[128];
+	double start, secs;
+	int i, j, k;
+
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		data = lyd_parse_mem(ctx, mem, LYD_LYB, options);
+		if (!data) {
+			fprintf(stderr, "Failed to parse data.\n");
+			return 1;
+		}
+
+		for (j = 0; j < lookups; ++j) {
+			k = (j * 97) % items;
+			sprintf(path, "/lyb-lazy-perf:routes/route[prefix='%d.%d.%d.0/24']/next-hop", k >> 16, (k >> 8) & 0xff, k & 0xff);
+			set = lyd_find_path(data, path);
+			if (!set || (set->number != 1)) {
+				fprintf(stderr, "Failed to find \"%s\".\n", path);
+				ly_set_free(set);
+				lyd_free_withsiblings(data);
+				return 1;
+			}
+			ly_set_free(set);
+		}
+
+		lyd_free_withsiblings(data);
+	}
+	secs = now() - start;
+	fprintf(stdout, " %-6s %4d lookups %8.3fs %10.2f ms/parse\n", label, lookups, secs, secs * 1e3 / rounds);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *node;
+	char *mem = NULL, buf[64];
+	int i, items = 100000, rounds = 10;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	data = lyd_new_path(NULL, ctx, "/lyb-lazy-perf:routes", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		node = lyd_new(data, NULL, "route");
+		sprintf(buf, "%d.%d.%d.0/24", i >> 16, (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(node, NULL, "prefix", buf);
+		sprintf(buf, "192.168.%d.%d", (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(node, NULL, "next-hop", buf);
+		sprintf(buf, "static route number %d towards the core", i);
+		lyd_new_leaf(node, NULL, "description", buf);
+		lyd_new_leaf(node, NULL, "metric", "10");
+	}
+	if (lyd_print_mem(&mem, data, LYD_LYB, LYP_WITHSIBLINGS)) {
+		fprintf(stderr, "Failed to print data.\n");
+		goto cleanup;
+	}
+
+	/* the whole tree parsed vs only what the lookups need */
+	if (parse_find(ctx, mem, LYD_OPT_CONFIG | LYD_OPT_TRUSTED, items, 10, rounds, "whole")
+			|| parse_find(ctx, mem, LYD_OPT_CONFIG | LYD_OPT_TRUSTED | LYD_OPT_LYB_LAZY, items, 10, rounds, "lazy")
+			|| parse_find(ctx, mem, LYD_OPT_CONFIG | LYD_OPT_TRUSTED | LYD_OPT_LYB_LAZY, items, 1000, rounds, "lazy")) {
+		goto cleanup;
+	}
+
+cleanup:
+	free(mem);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file lyb_mmap.c
+ * @brief performance test - parsing a LYB snapshot from a file.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module lyb-perf {"
+	"  namespace urn:libyang:performance:lyb;"
+	"  prefix lp;"
+	"  container routes {"
+	"    list route {"
+	"      key prefix;"
+	"      leaf prefix {type string;}"
+	"      leaf next-hop {type string;}"
+	"      leaf description {type string;}"
+	"      leaf metric {type uint32;}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *node, *tree;
+	struct stat sb;
+	char path[] = "/tmp/lyb_mmap_XXXXXX", buf[64];
+	double start, secs;
+	int i, fd = -1, items = 100000, rounds = 10;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data, unique strings so that the dictionary cannot just reuse them */
+	data = lyd_new_path(NULL, ctx, "/lyb-perf:routes", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		node = lyd_new(data, NULL, "route");
+		sprintf(buf, "10.%d.%d.0/24", (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(node, NULL, "prefix", buf);
+		sprintf(buf, "192.168.%d.%d", (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(node, NULL, "next-hop", buf);
+		sprintf(buf, "static route number %d towards the core", i);
+		lyd_new_leaf(node, NULL, "description", buf);
+		lyd_new_leaf(node, NULL, "metric", "10");
+	}
+
+	/* snapshot */
+	fd = mkstemp(path);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to create a temporary file.\n");
+		goto cleanup;
+	}
+	unlink(path);
+	if (lyd_print_fd(fd, data, LYD_LYB, LYP_WITHSIBLINGS) || fstat(fd, &sb)) {
+		fprintf(stderr, "Failed to print data.\n");
+		goto cleanup;
+	}
+
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		tree = lyd_parse_fd(ctx, fd, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+		if (!tree) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+		lyd_free_withsiblings(tree);
+	}
+	secs = now() - start;
+	fprintf(stdout, " %10lu bytes %8.3fs %10.2f MB/s\n", (unsigned long)sb.st_size, secs,
+	        rounds * sb.st_size / secs / (1024 * 1024));
+
+cleanup:
+	if (fd > -1) {
+		close(fd);
+	}
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
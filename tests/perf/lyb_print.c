@@ -0,0 +1,143 @@
+/**
+ * @file lyb_print.c
+ * @brief performance test - printing a large data tree in LYB and skipping it.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module lyb-perf {"
+	"  namespace urn:libyang:performance:lyb;"
+	"  prefix lp;"
+	"  container routes {"
+	"    list route {"
+	"      key prefix;"
+	"      leaf prefix {type string;}"
+	"      leaf next-hop {type string;}"
+	"      leaf description {type string;}"
+	"      leaf metric {type uint32;}"
+	"    }"
+	"  }"
+	"  leaf-list tag {type string;}"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *node;
+	char *mem = NULL, buf[64];
+	double start, secs;
+	int i, len = 0, items = 100000, rounds = 10;
+	FILE *f;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data, one large subtree and many small top-level ones */
+	data = lyd_new_path(NULL, ctx, "/lyb-perf:routes", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		node = lyd_new(data, NULL, "route");
+		sprintf(buf, "10.%d.%d.0/24", (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(node, NULL, "prefix", buf);
+		sprintf(buf, "192.168.%d.%d", (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(node, NULL, "next-hop", buf);
+		sprintf(buf, "static route number %d towards the core", i);
+		lyd_new_leaf(node, NULL, "description", buf);
+		lyd_new_leaf(node, NULL, "metric", "10");
+	}
+	for (i = 0; i < items / 10; ++i) {
+		sprintf(buf, "tag%d", i);
+		lyd_insert_after(data->prev, lyd_new_path(NULL, ctx, "/lyb-perf:tag", buf, 0, 0));
+	}
+
+	/* into memory */
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		free(mem);
+		if (lyd_print_mem(&mem, data, LYD_LYB, LYP_WITHSIBLINGS)) {
+			fprintf(stderr, "Failed to print data.\n");
+			goto cleanup;
+		}
+	}
+	secs = now() - start;
+	len = lyd_lyb_data_length(mem);
+	fprintf(stdout, " memory %10d bytes %8.3fs %10.2f MB/s\n", len, secs, rounds * len / secs / (1024 * 1024));
+
+	/* into a file */
+	f = fopen("/dev/null", "w");
+	if (!f) {
+		fprintf(stderr, "Failed to open \"/dev/null\".\n");
+		goto cleanup;
+	}
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		if (lyd_print_file(f, data, LYD_LYB, LYP_WITHSIBLINGS)) {
+			fprintf(stderr, "Failed to print data.\n");
+			fclose(f);
+			goto cleanup;
+		}
+	}
+	secs = now() - start;
+	fclose(f);
+	fprintf(stdout, " file   %10d bytes %8.3fs %10.2f MB/s\n", len, secs, rounds * len / secs / (1024 * 1024));
+
+	/* skip the data */
+	start = now();
+	for (i = 0; i < rounds * 100; ++i) {
+		if (lyd_lyb_data_length(mem) != len) {
+			fprintf(stderr, "Failed to get data length.\n");
+			goto cleanup;
+		}
+	}
+	secs = now() - start;
+	fprintf(stdout, " length                   %8.3fs %10.1f us/call\n", secs, secs * 1e6 / (rounds * 100));
+
+cleanup:
+	free(mem);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
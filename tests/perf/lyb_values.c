@@ -0,0 +1,131 @@
+/**
+ * @file lyb_values.c
+ * @brief performance test - parsing LYB data with union, identityref, decimal64, and bits values.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module lyb-values-perf {"
+	"  namespace urn:libyang:performance:lyb-values;"
+	"  prefix lvp;"
+	"  identity proto;"
+	"  identity static {base proto;}"
+	"  identity ospf {base proto;}"
+	"  identity bgp {base proto;}"
+	"  container routes {"
+	"    list route {"
+	"      key id;"
+	"      leaf id {type uint32;}"
+	"      leaf protocol {type identityref {base proto;}}"
+	"      leaf metric {type union {type enumeration {enum unreachable;} type uint32; type string;}}"
+	"      leaf address {type union {type string {pattern '[0-9.]+';} type string {pattern '[0-9a-f:]+';}}}"
+	"      leaf weight {type decimal64 {fraction-digits 3;}}"
+	"      leaf flags {type bits {bit active; bit backup; bit blackhole;}}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *node, *parsed;
+	const char *protos[] = {"static", "ospf", "bgp"}, *flags[] = {"active", "backup", "active blackhole"};
+	char *mem = NULL, buf[64];
+	double start, secs;
+	int i, items = 100000, rounds = 10;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	data = lyd_new_path(NULL, ctx, "/lyb-values-perf:routes", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		node = lyd_new(data, NULL, "route");
+		sprintf(buf, "%d", i);
+		lyd_new_leaf(node, NULL, "id", buf);
+		sprintf(buf, "lyb-values-perf:%s", protos[i % 3]);
+		lyd_new_leaf(node, NULL, "protocol", buf);
+		if (i % 10) {
+			sprintf(buf, "%d", i % 1000);
+		} else {
+			strcpy(buf, (i % 20) ? "unreachable" : "infinite");
+		}
+		lyd_new_leaf(node, NULL, "metric", buf);
+		if (i % 2) {
+			sprintf(buf, "10.%d.%d.1", (i >> 8) & 0xff, i & 0xff);
+		} else {
+			sprintf(buf, "fd00::%x", i);
+		}
+		lyd_new_leaf(node, NULL, "address", buf);
+		sprintf(buf, "%d.%03d", i % 100, i % 1000);
+		lyd_new_leaf(node, NULL, "weight", buf);
+		lyd_new_leaf(node, NULL, "flags", flags[i % 3]);
+	}
+	if (lyd_print_mem(&mem, data, LYD_LYB, LYP_WITHSIBLINGS)) {
+		fprintf(stderr, "Failed to print data.\n");
+		goto cleanup;
+	}
+
+	/* parse */
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		parsed = lyd_parse_mem(ctx, mem, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_TRUSTED);
+		if (!parsed) {
+			fprintf(stderr, "Failed to parse data.\n");
+			goto cleanup;
+		}
+		lyd_free_withsiblings(parsed);
+	}
+	secs = now() - start;
+	fprintf(stdout, " parse  %10d bytes %8.3fs %10.2f ms/parse\n", lyd_lyb_data_length(mem), secs, secs * 1e3 / rounds);
+
+cleanup:
+	free(mem);
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
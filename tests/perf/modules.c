@@ -0,0 +1,76 @@
+/**
+ * @file modules.c
+ * @brief performance test - searching for modules by name and namespace in a context with many modules.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	char buf[128], (*names)[16], (*nss)[32];
+	int i, found = 0, count = 300, rounds = 1000;
+	double start;
+
+	if (argc > 1) {
+		count = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+	names = calloc(count, sizeof *names);
+	nss = calloc(count, sizeof *nss);
+
+	ctx = ly_ctx_new(NULL, 0);
+	for (i = 0; i < count; ++i) {
+		sprintf(names[i], "module%d", i);
+		sprintf(nss[i], "urn:perf:module%d", i);
+		sprintf(buf, "module %s {namespace \"%s\"; prefix m;}", names[i], nss[i]);
+		if (!lys_parse_mem(ctx, buf, LYS_IN_YANG)) {
+			fprintf(stderr, "Failed to load module \"%s\".\n", names[i]);
+			return 1;
+		}
+	}
+
+	start = now();
+	for (i = 0; i < count * rounds; ++i) {
+		found += (ly_ctx_get_module(ctx, names[i % count], NULL, 0) != NULL);
+	}
+	fprintf(stdout, " by name      %8d lookups %8.3fs\n", found, now() - start);
+
+	found = 0;
+	start = now();
+	for (i = 0; i < count * rounds; ++i) {
+		found += (ly_ctx_get_module_by_ns(ctx, nss[i % count], NULL, 0) != NULL);
+	}
+	fprintf(stdout, " by namespace %8d lookups %8.3fs\n", found, now() - start);
+
+	ly_ctx_destroy(ctx, NULL);
+	free(names);
+	free(nss);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file must.c
+ * @brief performance test - validating data with must and when conditions.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module must-perf {"
+	"  namespace urn:libyang:performance:must;"
+	"  prefix mp;"
+	"  container top {"
+	"    list item {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf type {type string;}"
+	"      leaf mtu {type uint16; must \". >= 68 and . <= 9000\"; must \"../type != 'loopback' or . = 65535 or . > 100\";}"
+	"      leaf speed {when \"../type = 'ethernet'\"; type uint32;}"
+	"      container ipv4 {must \"count(address) <= 8\"; leaf-list address {type string;}}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *item;
+	char name[32], val[32];
+	double start, secs;
+	int i, items = 10000, rounds = 10, options = LYD_OPT_CONFIG;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	if (argc > 3) {
+		/* evaluate the conditions in this number of threads (0 for the number of processors) */
+		ly_ctx_set_val_threads(ctx, atoi(argv[3]));
+		options |= LYD_OPT_VAL_PARALLEL;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	data = lyd_new_path(NULL, ctx, "/must-perf:top", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		sprintf(name, "eth%d", i);
+		item = lyd_new(data, NULL, "item");
+		lyd_new_leaf(item, NULL, "name", name);
+		lyd_new_leaf(item, NULL, "type", "ethernet");
+		sprintf(val, "%d", 1500 + i % 100);
+		lyd_new_leaf(item, NULL, "mtu", val);
+		lyd_new_leaf(item, NULL, "speed", "1000");
+		item = lyd_new(item, NULL, "ipv4");
+		sprintf(val, "10.0.%d.%d", (i >> 8) & 0xff, i & 0xff);
+		lyd_new_leaf(item, NULL, "address", val);
+	}
+
+	for (i = 0, secs = 0; i < rounds; ++i) {
+		start = now();
+		if (lyd_validate(&data, options, NULL)) {
+			fprintf(stderr, "Failed to validate data.\n");
+			goto cleanup;
+		}
+		secs += now() - start;
+
+		/* force the next validation of all the nodes */
+		item = data;
+		data = lyd_dup(item, LYD_DUP_OPT_RECURSIVE);
+		lyd_free(item);
+	}
+	fprintf(stdout, " %d items, %d rounds%s %8.3fs %10.1f us/item\n", items, rounds,
+	        (options & LYD_OPT_VAL_PARALLEL) ? " (parallel)" : "", secs, secs * 1e6 / (rounds * items));
+
+cleanup:
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
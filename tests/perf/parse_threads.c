@@ -0,0 +1,129 @@
+/**
+ * @file parse_threads.c
+ * @brief performance test - parsing data in several threads sharing a context.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <libyang/libyang.h>
+
+struct ly_ctx *ctx;
+const char *data;
+int rounds = 10;
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *
+parse_thread(void *arg)
+{
+	struct lyd_node *tree;
+	int i;
+
+	(void)arg;
+
+	for (i = 0; i < rounds; ++i) {
+		tree = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+		if (!tree) {
+			return (void *)1;
+		}
+		lyd_free_withsiblings(tree);
+	}
+
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t threads[16];
+	struct stat sb;
+	double start, base = 0, secs;
+	char *buf = NULL;
+	void *ret;
+	int i, n, fd, max_threads = 16;
+
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s model.yin data.xml [rounds [threads]]\n", argv[0]);
+		return 1;
+	}
+	if (argc > 3) {
+		rounds = atoi(argv[3]);
+	}
+	if (argc > 4) {
+		max_threads = atoi(argv[4]);
+		if (max_threads > 16) {
+			max_threads = 16;
+		}
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_path(ctx, argv[1], LYS_IN_YIN)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	fd = open(argv[2], O_RDONLY);
+	if (fd < 0 || fstat(fd, &sb) || !(buf = calloc(1, sb.st_size + 1)) || read(fd, buf, sb.st_size) != sb.st_size) {
+		fprintf(stderr, "Failed to read data.\n");
+		goto cleanup;
+	}
+	close(fd);
+	data = buf;
+
+	/* every thread parses the data rounds times */
+	for (n = 1; n <= max_threads; n *= 2) {
+		start = now();
+		for (i = 0; i < n; ++i) {
+			pthread_create(&threads[i], NULL, parse_thread, NULL);
+		}
+		for (i = 0; i < n; ++i) {
+			pthread_join(threads[i], &ret);
+			if (ret) {
+				fprintf(stderr, "Failed to parse data.\n");
+			}
+		}
+		secs = now() - start;
+		if (n == 1) {
+			base = secs;
+		}
+		fprintf(stdout, " %2d threads %8.3fs %8.2f parses/s speedup %5.2f\n", n, secs, n * rounds / secs,
+		        n * base / secs);
+	}
+
+cleanup:
+	free(buf);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file pattern.c
+ * @brief performance test - validating values against pattern restrictions and re-match() evaluation.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module pattern {"
+"  yang-version 1.1;"
+"  namespace urn:perf:pattern;"
+"  prefix p;"
+"  import ietf-inet-types {prefix inet;}"
+"  container top {"
+"    list server {"
+"      key name;"
+"      leaf name {type inet:domain-name;}"
+"      leaf address {type inet:ip-address;}"
+"    }"
+"  }"
+"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data;
+	struct ly_set *set;
+	char *xml, *ptr;
+	int i, count = 20000, rounds = 20, found = 0;
+	double start;
+
+	if (argc > 1) {
+		count = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx || !lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load the schema.\n");
+		return 1;
+	}
+
+	xml = malloc(count * 160 + 64);
+	ptr = xml + sprintf(xml, "<top xmlns=\"urn:perf:pattern\">");
+	for (i = 0; i < count; ++i) {
+		if (i % 2) {
+			ptr += sprintf(ptr, "<server><name>host%d.example.com</name><address>10.%d.%d.%d</address></server>",
+			               i, (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff);
+		} else {
+			ptr += sprintf(ptr, "<server><name>host%d.example.net</name><address>2001:db8::%x:%x</address></server>",
+			               i, (i >> 16) & 0xffff, i & 0xffff);
+		}
+	}
+	sprintf(ptr, "</top>");
+
+	start = now();
+	data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+	if (!data) {
+		fprintf(stderr, "Failed to parse the data.\n");
+		return 1;
+	}
+	fprintf(stdout, " validate %8d values  %8.3fs\n", 2 * count, now() - start);
+
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		set = lyd_find_path(data, "/pattern:top/server[re-match(name, '.*\\.example\\.com')]");
+		if (!set) {
+			fprintf(stderr, "Failed to evaluate re-match().\n");
+			return 1;
+		}
+		found += set->number;
+		ly_set_free(set);
+	}
+	fprintf(stdout, " re-match %8d matches %8.3fs\n", found, now() - start);
+
+	lyd_free_withsiblings(data);
+	free(xml);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file print.c
+ * @brief performance test - printing data.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static ssize_t
+print_clb(void *arg, const void *buf, size_t count)
+{
+	(void)buf;
+
+	*(size_t *)arg += count;
+	return count;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+print_result(const char *what, size_t bytes, double start)
+{
+	double secs = now() - start;
+
+	fprintf(stdout, " %-12s %10lu bytes %8.3fs %10.2f MB/s\n", what, (unsigned long)bytes, secs,
+	        bytes / secs / (1024 * 1024));
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL;
+	LYD_FORMAT formats[] = {LYD_XML, LYD_JSON};
+	const char *names[] = {"xml", "json"};
+	char *str, what[32];
+	size_t bytes, len;
+	double start;
+	int i, j, fd, rounds = 10;
+
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s model.yin data.xml [rounds]\n", argv[0]);
+		return 1;
+	}
+	if (argc > 3) {
+		rounds = atoi(argv[3]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_path(ctx, argv[1], LYS_IN_YIN)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	data = lyd_parse_path(ctx, argv[2], LYD_XML, LYD_OPT_CONFIG);
+	if (!data) {
+		fprintf(stderr, "Failed to load data.\n");
+		goto cleanup;
+	}
+
+	fd = open("/dev/null", O_WRONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open /dev/null.\n");
+		goto cleanup;
+	}
+
+	for (j = 0; j < 2; ++j) {
+		/* memory */
+		start = now();
+		for (i = bytes = 0; i < rounds; ++i) {
+			lyd_print_mem(&str, data, formats[j], LYP_WITHSIBLINGS | LYP_FORMAT);
+			bytes += strlen(str);
+			free(str);
+		}
+		sprintf(what, "%s mem", names[j]);
+		print_result(what, bytes, start);
+
+		/* file descriptor, count the data by printing them into memory once */
+		lyd_print_mem(&str, data, formats[j], LYP_WITHSIBLINGS | LYP_FORMAT);
+		len = strlen(str);
+		free(str);
+		start = now();
+		for (i = bytes = 0; i < rounds; ++i) {
+			lyd_print_fd(fd, data, formats[j], LYP_WITHSIBLINGS | LYP_FORMAT);
+			bytes += len;
+		}
+		sprintf(what, "%s fd", names[j]);
+		print_result(what, bytes, start);
+
+		/* callback */
+		start = now();
+		for (i = bytes = 0; i < rounds; ++i) {
+			lyd_print_clb(print_clb, &bytes, data, formats[j], LYP_WITHSIBLINGS | LYP_FORMAT);
+		}
+		sprintf(what, "%s clb", names[j]);
+		print_result(what, bytes, start);
+	}
+
+	close(fd);
+
+cleanup:
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
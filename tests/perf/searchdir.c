@@ -0,0 +1,101 @@
+/**
+ * @file searchdir.c
+ * @brief performance test - resolving imports from a search directory with many modules.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	char dir[] = "/tmp/searchdir_XXXXXX", path[256];
+	FILE *f;
+	int i, files = 2000, imports = 200, ret = 1;
+	double start;
+
+	if (argc > 1) {
+		files = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		imports = atoi(argv[2]);
+	}
+	if (imports > files) {
+		imports = files;
+	}
+
+	if (!mkdtemp(dir)) {
+		fprintf(stderr, "Failed to create a temporary directory.\n");
+		return 1;
+	}
+
+	/* modules to import and one module importing some of them */
+	for (i = 0; i < files; ++i) {
+		sprintf(path, "%s/mod%d.yang", dir, i);
+		f = fopen(path, "w");
+		if (!f) {
+			fprintf(stderr, "Failed to create \"%s\".\n", path);
+			goto cleanup;
+		}
+		fprintf(f, "module mod%d {namespace urn:perf:mod%d; prefix m;}\n", i, i);
+		fclose(f);
+	}
+	sprintf(path, "%s/top.yang", dir);
+	f = fopen(path, "w");
+	if (!f) {
+		fprintf(stderr, "Failed to create \"%s\".\n", path);
+		goto cleanup;
+	}
+	fprintf(f, "module top {namespace urn:perf:top; prefix t;\n");
+	for (i = 0; i < imports; ++i) {
+		fprintf(f, "  import mod%d {prefix m%d;}\n", i * (files / imports), i);
+	}
+	fprintf(f, "}\n");
+	fclose(f);
+
+	start = now();
+	ctx = ly_ctx_new(dir, LY_CTX_DISABLE_SEARCHDIR_CWD);
+	if (!ctx || !ly_ctx_load_module(ctx, "top", NULL)) {
+		fprintf(stderr, "Failed to load the modules.\n");
+		ly_ctx_destroy(ctx, NULL);
+		goto cleanup;
+	}
+	fprintf(stdout, " %d imports from %d files %8.3fs\n", imports, files, now() - start);
+	ly_ctx_destroy(ctx, NULL);
+	ret = 0;
+
+cleanup:
+	for (i = 0; i < files; ++i) {
+		sprintf(path, "%s/mod%d.yang", dir, i);
+		unlink(path);
+	}
+	sprintf(path, "%s/top.yang", dir);
+	unlink(path);
+	rmdir(dir);
+
+	return ret;
+}
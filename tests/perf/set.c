@@ -0,0 +1,77 @@
+/**
+ * @file set.c
+ * @brief performance test - adding, searching and merging large sets.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_set *set, *set2;
+	int *objs, i, found = 0, items = 20000;
+	double start;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+	objs = calloc(items, sizeof *objs);
+
+	/* add with duplicity checks */
+	set = ly_set_new();
+	start = now();
+	for (i = 0; i < items; ++i) {
+		ly_set_add(set, &objs[i], 0);
+	}
+	fprintf(stdout, " add      %8d objects %8.3fs\n", items, now() - start);
+
+	/* search */
+	start = now();
+	for (i = 0; i < items; ++i) {
+		found += (ly_set_contains(set, &objs[items - i - 1]) > -1);
+	}
+	fprintf(stdout, " contains %8d objects %8.3fs\n", found, now() - start);
+
+	/* merge half of the objects again */
+	set2 = ly_set_new();
+	for (i = 0; i < items; i += 2) {
+		ly_set_add(set2, &objs[i], LY_SET_OPT_USEASLIST);
+	}
+	start = now();
+	ly_set_merge(set, set2, 0);
+	fprintf(stdout, " merge    %8d objects %8.3fs\n", items / 2, now() - start);
+
+	/* remove */
+	start = now();
+	for (i = 0; i < items; ++i) {
+		ly_set_rm(set, &objs[i]);
+	}
+	fprintf(stdout, " rm       %8d objects %8.3fs\n", items, now() - start);
+
+	ly_set_free(set);
+	free(objs);
+
+	return 0;
+}
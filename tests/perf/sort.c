@@ -0,0 +1,97 @@
+/**
+ * @file sort.c
+ * @brief performance test - sorting data nodes in the schema order.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	const struct lys_module *mod;
+	struct lyd_node *root = NULL, *node;
+	char *schema, *ptr, name[16];
+	int i, j, leaves = 200, count = 500, rounds = 10;
+	double start;
+
+	if (argc > 1) {
+		leaves = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		count = atoi(argv[2]);
+	}
+
+	/* a list with many leaves */
+	schema = malloc(leaves * 48 + 256);
+	ptr = schema + sprintf(schema, "module sort {namespace urn:perf:sort; prefix s; list item {key k; leaf k {type uint32;}");
+	for (i = 0; i < leaves; ++i) {
+		ptr += sprintf(ptr, " leaf l%d {type uint32;}", i);
+	}
+	sprintf(ptr, "}}");
+
+	ctx = ly_ctx_new(NULL, 0);
+	mod = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+	if (!mod) {
+		fprintf(stderr, "Failed to load the schema.\n");
+		return 1;
+	}
+
+	/* list instances with the leaves in the reverse order */
+	for (i = 0; i < count; ++i) {
+		sprintf(name, "%d", i);
+		node = lyd_new(NULL, mod, "item");
+		if (!node || !lyd_new_leaf(node, mod, "k", name)) {
+			fprintf(stderr, "Failed to create the data.\n");
+			return 1;
+		}
+		for (j = leaves - 1; j >= 0; --j) {
+			sprintf(name, "l%d", j);
+			lyd_new_leaf(node, mod, name, "1");
+		}
+		if (root) {
+			lyd_insert_after(root->prev, node);
+		} else {
+			root = node;
+		}
+	}
+
+	start = now();
+	for (i = 0; i < rounds; ++i) {
+		if (lyd_schema_sort(root, 1)) {
+			fprintf(stderr, "Failed to sort the data.\n");
+			return 1;
+		}
+		root = lyd_first_sibling(root);
+	}
+	fprintf(stdout, " sort %8d nodes %d times %8.3fs\n", count * (leaves + 2), rounds, now() - start);
+
+	lyd_free_withsiblings(root);
+	ly_ctx_destroy(ctx, NULL);
+	free(schema);
+
+	return 0;
+}
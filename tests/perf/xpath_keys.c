@@ -0,0 +1,100 @@
+/**
+ * @file xpath_keys.c
+ * @brief performance test - finding list instances by their keys with XPath.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module xpath-perf {"
+	"  namespace urn:libyang:performance:xpath;"
+	"  prefix xp;"
+	"  container interfaces {"
+	"    list interface {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf mtu {type uint16;}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *node;
+	struct ly_set *set;
+	char path[128];
+	double start, secs;
+	int i, items = 10000, found = 0;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data */
+	data = lyd_new_path(NULL, ctx, "/xpath-perf:interfaces", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		sprintf(path, "eth%d", i);
+		node = lyd_new(data, NULL, "interface");
+		lyd_new_leaf(node, NULL, "name", path);
+		lyd_new_leaf(node, NULL, "mtu", "1500");
+	}
+
+	/* look up every instance */
+	start = now();
+	for (i = 0; i < items; ++i) {
+		sprintf(path, "/xpath-perf:interfaces/interface[name='eth%d']/mtu", i);
+		set = lyd_find_path(data, path);
+		if (!set) {
+			fprintf(stderr, "Failed to evaluate \"%s\".\n", path);
+			goto cleanup;
+		}
+		found += set->number;
+		ly_set_free(set);
+	}
+	secs = now() - start;
+	fprintf(stdout, " %d instances, %d found %8.3fs %10.1f us/lookup\n", items, found, secs, secs * 1e6 / items);
+
+cleanup:
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file xpath_union.c
+ * @brief performance test - validating must conditions with node-set unions.
+ *
+ * Copyright (c) 2016 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+	"module union-perf {"
+	"  namespace urn:libyang:performance:union;"
+	"  prefix up;"
+	"  container top {"
+	"    list item {"
+	"      key name;"
+	"      leaf name {type string;}"
+	"      leaf mtu {type uint16; must \"count(../../limits/min | ../../limits/max | ../../limits/default) = 3\";}"
+	"    }"
+	"    container limits {"
+	"      leaf min {type uint16;}"
+	"      leaf max {type uint16;}"
+	"      leaf default {type uint16;}"
+	"    }"
+	"  }"
+	"}";
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+	struct ly_ctx *ctx;
+	struct lyd_node *data = NULL, *item;
+	char name[32];
+	double start, secs;
+	int i, items = 10000;
+
+	if (argc > 1) {
+		items = atoi(argv[1]);
+	}
+
+	/* libyang context */
+	ctx = ly_ctx_new(NULL, 0);
+	if (!ctx) {
+		fprintf(stderr, "Failed to create context.\n");
+		return 1;
+	}
+
+	/* schema */
+	if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+		fprintf(stderr, "Failed to load data model.\n");
+		goto cleanup;
+	}
+
+	/* data, the united nodes follow all the list instances in the document order */
+	data = lyd_new_path(NULL, ctx, "/union-perf:top", NULL, 0, 0);
+	for (i = 0; i < items; ++i) {
+		sprintf(name, "eth%d", i);
+		item = lyd_new(data, NULL, "item");
+		lyd_new_leaf(item, NULL, "name", name);
+		lyd_new_leaf(item, NULL, "mtu", "1500");
+	}
+	item = lyd_new(data, NULL, "limits");
+	lyd_new_leaf(item, NULL, "min", "68");
+	lyd_new_leaf(item, NULL, "max", "9000");
+	lyd_new_leaf(item, NULL, "default", "1500");
+
+	start = now();
+	if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+		fprintf(stderr, "Failed to validate data.\n");
+		goto cleanup;
+	}
+	secs = now() - start;
+	fprintf(stdout, " %d items %8.3fs %10.1f us/item\n", items, secs, secs * 1e6 / items);
+
+cleanup:
+	lyd_free_withsiblings(data);
+	ly_ctx_destroy(ctx, NULL);
+
+	return 0;
+}